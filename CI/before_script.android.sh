@@ -41,6 +41,8 @@ cmake \
 -DBUILD_WIZARD=0 \
 -DBUILD_NAVMESHTOOL=OFF \
 -DBUILD_BULLETOBJECTTOOL=OFF \
+-DBUILD_LODTOOL=OFF \
+-DBUILD_SHADERTOOL=OFF \
 -DOPENMW_USE_SYSTEM_MYGUI=OFF \
 -DOPENMW_USE_SYSTEM_SQLITE3=OFF \
 -DOPENMW_USE_SYSTEM_YAML_CPP=OFF \
@@ -94,6 +94,8 @@ if [[ "${BUILD_TESTS_ONLY}" ]]; then
         -DBUILD_WIZARD=OFF \
         -DBUILD_NAVMESHTOOL=OFF \
         -DBUILD_BULLETOBJECTTOOL=OFF \
+        -DBUILD_LODTOOL=OFF \
+        -DBUILD_SHADERTOOL=OFF \
         -DBUILD_NIFTEST=OFF \
         -DBUILD_COMPONENTS_TESTS=ON \
         -DBUILD_OPENMW_TESTS=ON \
@@ -113,6 +115,8 @@ elif [[ "${BUILD_OPENMW_ONLY}" ]]; then
         -DBUILD_WIZARD=OFF \
         -DBUILD_NAVMESHTOOL=OFF \
         -DBUILD_BULLETOBJECTTOOL=OFF \
+        -DBUILD_LODTOOL=OFF \
+        -DBUILD_SHADERTOOL=OFF \
         -DBUILD_NIFTEST=OFF \
         ..
 else
@@ -48,5 +48,7 @@ cmake \
 -D BUILD_NIFTEST=TRUE \
 -D BUILD_NAVMESHTOOL=TRUE \
 -D BUILD_BULLETOBJECTTOOL=TRUE \
+-D BUILD_LODTOOL=TRUE \
+-D BUILD_SHADERTOOL=TRUE \
 -G"Unix Makefiles" \
 ..
@@ -21,6 +21,8 @@ cmake \
     -D BUILD_BENCHMARKS=ON \
     -D BUILD_BSATOOL=ON \
     -D BUILD_BULLETOBJECTTOOL=ON \
+    -D BUILD_LODTOOL=ON \
+    -D BUILD_SHADERTOOL=ON \
     -D BUILD_ESMTOOL=ON \
     -D BUILD_ESSIMPORTER=ON \
     -D BUILD_LAUNCHER=ON \
@@ -0,0 +1,747 @@
+#include <components/debug/debugging.hpp>
+#include <components/debug/debuglog.hpp>
+#include <components/esm3/cellref.hpp>
+#include <components/esm3/esmreader.hpp>
+#include <components/esm3/loadcell.hpp>
+#include <components/esm3/loadland.hpp>
+#include <components/esm3/readerscache.hpp>
+#include <components/esmloader/esmdata.hpp>
+#include <components/esmloader/lessbyid.hpp>
+#include <components/esmloader/load.hpp>
+#include <components/esmloader/record.hpp>
+#include <components/esmterrain/storage.hpp>
+#include <components/fallback/fallback.hpp>
+#include <components/fallback/validate.hpp>
+#include <components/files/collections.hpp>
+#include <components/files/configurationmanager.hpp>
+#include <components/files/multidircollection.hpp>
+#include <components/misc/constants.hpp>
+#include <components/misc/convert.hpp>
+#include <components/misc/resourcehelpers.hpp>
+#include <components/misc/strings/algorithm.hpp>
+#include <components/platform/platform.hpp>
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/mwshadowtechnique.hpp>
+#include <components/sceneutil/nodecallback.hpp>
+#include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/settings/settings.hpp>
+#include <components/settings/values.hpp>
+#include <components/terrain/quadtreeworld.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+#include <components/version/version.hpp>
+#include <components/vfs/manager.hpp>
+#include <components/vfs/registerarchives.hpp>
+
+#include <osg/Camera>
+#include <osg/FrameStamp>
+#include <osg/Light>
+#include <osg/LightSource>
+#include <osg/Timer>
+
+#include <osgShadow/ShadowedScene>
+
+#include <osgUtil/CullVisitor>
+#include <osgUtil/RenderStage>
+#include <osgUtil/StateGraph>
+#include <osgUtil/UpdateVisitor>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+    namespace bpo = boost::program_options;
+
+    using StringsVector = std::vector<std::string>;
+
+    constexpr std::string_view applicationName = "CullBenchmark";
+
+    bpo::options_description makeOptionsDescription()
+    {
+        using Fallback::FallbackMap;
+
+        bpo::options_description result;
+        auto addOption = result.add_options();
+        addOption("help", "print help message");
+
+        addOption("data",
+            bpo::value<Files::MaybeQuotedPathContainer>()
+                ->default_value(Files::MaybeQuotedPathContainer(), "data")
+                ->multitoken()
+                ->composing(),
+            "set data directories (later directories have higher priority)");
+
+        addOption("data-local",
+            bpo::value<Files::MaybeQuotedPathContainer::value_type>()->default_value(
+                Files::MaybeQuotedPathContainer::value_type(), ""),
+            "set local data directory (highest priority)");
+
+        addOption("fallback-archive",
+            bpo::value<StringsVector>()->default_value(StringsVector(), "fallback-archive")->multitoken()->composing(),
+            "set fallback BSA archives (later archives have higher priority)");
+
+        addOption("content", bpo::value<StringsVector>()->default_value(StringsVector(), "")->multitoken()->composing(),
+            "content file(s): esm/esp, or omwgame/omwaddon/omwscripts");
+
+        addOption("encoding", bpo::value<std::string>()->default_value("win1252"),
+            "Character encoding used in OpenMW game messages:\n"
+            "\n\twin1250 - Central and Eastern European such as Polish, Czech, Slovak, Hungarian, Slovene, Bosnian, "
+            "Croatian, Serbian (Latin script), Romanian and Albanian languages\n"
+            "\n\twin1251 - Cyrillic alphabet such as Russian, Bulgarian, Serbian Cyrillic and other languages\n"
+            "\n\twin1252 - Western European (Latin) alphabet, used by default");
+
+        addOption("fallback", bpo::value<FallbackMap>()->default_value(FallbackMap(), "")->multitoken()->composing(),
+            "fallback values");
+
+        addOption("cell-x", bpo::value<int>()->default_value(0), "x coordinate of the central exterior cell");
+
+        addOption("cell-y", bpo::value<int>()->default_value(0), "y coordinate of the central exterior cell");
+
+        addOption("radius", bpo::value<int>()->default_value(1),
+            "number of cells around the central cell with objects loaded, like the active grid");
+
+        addOption("view-distance", bpo::value<float>()->default_value(Constants::CellSizeInUnits * 4),
+            "view distance for terrain and camera far plane");
+
+        addOption("lights", bpo::value<std::size_t>()->default_value(32),
+            "number of point lights randomly placed over the loaded cells");
+
+        addOption("lighting-method", bpo::value<std::string>()->default_value("shaders compatibility"),
+            "lighting method to cull with: legacy, shaders compatibility, shaders or shaders clustered");
+
+        addOption("max-lights", bpo::value<int>()->default_value(8), "maximum number of lights per object or cluster");
+
+        addOption("shadows", bpo::value<bool>()->implicit_value(true)->default_value(false),
+            "cull the shadow maps of the sun too, using the shadows settings other than enable shadows");
+
+        addOption("camera-path", bpo::value<Files::MaybeQuotedPath>()->default_value(Files::MaybeQuotedPath(), ""),
+            "file with camera keyframes, one \"x y z heading pitch\" line per keyframe, angles in degrees. "
+            "By default the camera flies over the central cell");
+
+        addOption("frames", bpo::value<std::size_t>()->default_value(600), "number of measured frames");
+
+        addOption("warmup-frames", bpo::value<std::size_t>()->default_value(60),
+            "number of frames culled before measuring to let terrain and caches settle");
+
+        Files::ConfigurationManager::addCommonOptions(result);
+
+        return result;
+    }
+
+    struct CameraKey
+    {
+        osg::Vec3f mPosition;
+        float mHeading;
+        float mPitch;
+    };
+
+    std::vector<CameraKey> readCameraPath(const std::filesystem::path& path)
+    {
+        std::ifstream stream(path);
+        if (!stream)
+            throw std::runtime_error("Failed to open camera path file: " + path.string());
+        std::vector<CameraKey> result;
+        CameraKey key;
+        while (stream >> key.mPosition.x() >> key.mPosition.y() >> key.mPosition.z() >> key.mHeading >> key.mPitch)
+        {
+            key.mHeading = osg::DegreesToRadians(key.mHeading);
+            key.mPitch = osg::DegreesToRadians(key.mPitch);
+            result.push_back(key);
+        }
+        if (result.empty())
+            throw std::runtime_error("Camera path file has no keyframes: " + path.string());
+        return result;
+    }
+
+    std::vector<CameraKey> makeDefaultCameraPath(int cellX, int cellY, float height)
+    {
+        const float cellSize = Constants::CellSizeInUnits;
+        const osg::Vec3f center((cellX + 0.5f) * cellSize, (cellY + 0.5f) * cellSize, height);
+        std::vector<CameraKey> result;
+        constexpr int keys = 8;
+        for (int i = 0; i <= keys; ++i)
+        {
+            const float angle = osg::PI * 2 * i / keys;
+            const osg::Vec3f offset(std::cos(angle), std::sin(angle), 0);
+            result.push_back(CameraKey{ center + offset * cellSize * 0.5f, angle + osg::PI_2f, -0.1f });
+        }
+        return result;
+    }
+
+    CameraKey interpolate(const std::vector<CameraKey>& path, float ratio)
+    {
+        if (path.size() == 1)
+            return path.front();
+        const float position = std::clamp(ratio, 0.0f, 1.0f) * (path.size() - 1);
+        const std::size_t index = std::min(static_cast<std::size_t>(position), path.size() - 2);
+        const float factor = position - index;
+        const CameraKey& from = path[index];
+        const CameraKey& to = path[index + 1];
+        return CameraKey{ from.mPosition * (1 - factor) + to.mPosition * factor,
+            from.mHeading * (1 - factor) + to.mHeading * factor, from.mPitch * (1 - factor) + to.mPitch * factor };
+    }
+
+    osg::Matrixd makeViewMatrix(const CameraKey& key)
+    {
+        const osg::Quat orient
+            = osg::Quat(key.mPitch, osg::Vec3d(1, 0, 0)) * osg::Quat(-key.mHeading, osg::Vec3d(0, 0, 1));
+        const osg::Vec3d forward = orient * osg::Vec3d(0, 1, 0);
+        const osg::Vec3d up = orient * osg::Vec3d(0, 0, 1);
+        return osg::Matrixd::lookAt(key.mPosition, key.mPosition + forward, up);
+    }
+
+    class Storage final : public ESMTerrain::Storage
+    {
+    public:
+        Storage(const VFS::Manager* vfs, const std::vector<ESM::Land>& lands)
+            : ESMTerrain::Storage(vfs)
+            , mLands(lands)
+        {
+        }
+
+        osg::ref_ptr<const ESMTerrain::LandObject> getLand(ESM::ExteriorCellLocation cellLocation) override
+        {
+            const auto it = std::lower_bound(mLands.begin(), mLands.end(), cellLocation, LessByPosition{});
+            if (it == mLands.end() || it->mX != cellLocation.mX || it->mY != cellLocation.mY)
+                return nullptr;
+            // Land textures are not loaded, so every chunk uses the default texture.
+            return new ESMTerrain::LandObject(*it, ESM::Land::DATA_VHGT | ESM::Land::DATA_VNML | ESM::Land::DATA_VCLR);
+        }
+
+        const std::string* getLandTexture(std::uint16_t /*index*/, int /*plugin*/) override { return nullptr; }
+
+        bool hasData(ESM::ExteriorCellLocation cellLocation) override
+        {
+            return std::binary_search(mLands.begin(), mLands.end(), cellLocation, LessByPosition{});
+        }
+
+        void getBounds(float& minX, float& maxX, float& minY, float& maxY, ESM::RefId /*worldspace*/) override
+        {
+            minX = maxX = minY = maxY = 0;
+            for (const ESM::Land& land : mLands)
+            {
+                minX = std::min<float>(minX, land.mX);
+                maxX = std::max<float>(maxX, land.mX);
+                minY = std::min<float>(minY, land.mY);
+                maxY = std::max<float>(maxY, land.mY);
+            }
+            // since grid coords are at cell origin, we need to add 1 cell
+            maxX += 1;
+            maxY += 1;
+        }
+
+    private:
+        struct LessByPosition
+        {
+            static std::pair<int, int> key(const ESM::Land& land) { return { land.mX, land.mY }; }
+            static std::pair<int, int> key(ESM::ExteriorCellLocation location) { return { location.mX, location.mY }; }
+
+            template <class L, class R>
+            bool operator()(const L& l, const R& r) const
+            {
+                return key(l) < key(r);
+            }
+        };
+
+        const std::vector<ESM::Land>& mLands;
+    };
+
+    class CullTimer : public SceneUtil::NodeCallback<CullTimer, osg::Node*, osgUtil::CullVisitor*>
+    {
+    public:
+        /// @param camera Only the traversals of this camera are timed when set, the shadow cameras traverse the
+        /// same nodes.
+        explicit CullTimer(double& time, const osg::Camera* camera = nullptr)
+            : mTime(time)
+            , mCamera(camera)
+        {
+        }
+
+        void operator()(osg::Node* node, osgUtil::CullVisitor* cv)
+        {
+            if (mCamera != nullptr && cv->getCurrentCamera() != mCamera)
+                return traverse(node, cv);
+            const osg::Timer* const timer = osg::Timer::instance();
+            const osg::Timer_t start = timer->tick();
+            traverse(node, cv);
+            mTime += timer->delta_s(start, timer->tick());
+        }
+
+    private:
+        double& mTime;
+        const osg::Camera* mCamera;
+    };
+
+    struct FrameStats
+    {
+        double mCullTime = 0;
+        double mObjectsTime = 0;
+        double mTerrainTime = 0;
+        double mShadowsTime = 0;
+        std::size_t mDrawables = 0;
+        std::size_t mStateChanges = 0;
+    };
+
+    // Counts render leaves in draw order and how often consecutive leaves use a different state graph, which is
+    // what the draw traversal turns into state changes.
+    void countRenderLeaves(const osgUtil::RenderBin& bin, const osgUtil::StateGraph*& last, FrameStats& stats)
+    {
+        const auto visitLeaf = [&](const osgUtil::RenderLeaf& leaf) {
+            ++stats.mDrawables;
+            if (leaf._parent != last)
+                ++stats.mStateChanges;
+            last = leaf._parent;
+        };
+
+        const osgUtil::RenderBin::RenderBinList& bins = bin.getRenderBinList();
+        auto it = bins.begin();
+        for (; it != bins.end() && it->first < 0; ++it)
+            countRenderLeaves(*it->second, last, stats);
+
+        for (const osgUtil::RenderLeaf* leaf : bin.getRenderLeafList())
+            visitLeaf(*leaf);
+
+        for (const osgUtil::StateGraph* stateGraph : bin.getStateGraphList())
+            for (const osg::ref_ptr<osgUtil::RenderLeaf>& leaf : stateGraph->_leaves)
+                visitLeaf(*leaf);
+
+        for (; it != bins.end(); ++it)
+            countRenderLeaves(*it->second, last, stats);
+    }
+
+    class Scene
+    {
+    public:
+        Scene(Resource::ResourceSystem& resourceSystem, Storage& storage, float viewDistance,
+            SceneUtil::LightingMethod lightingMethod, int maxLights, bool shadows)
+            : mRoot(new osg::Group)
+            , mCamera(new osg::Camera)
+            , mLightManager(new SceneUtil::LightManager(SceneUtil::LightSettings{
+                  .mLightingMethod = lightingMethod,
+                  .mMaxLights = maxLights,
+                  .mMaximumLightDistance = viewDistance,
+                  .mLightFadeStart = 0.85f,
+                  .mLightBoundsMultiplier = 1.65f,
+                  // there is no graphics context, the texture unit is never used
+                  .mClusterTextureUnit = 0,
+                  .mWithoutGraphicsContext = true,
+              }))
+            , mObjects(new osg::Group)
+            , mTerrainRoot(new osg::Group)
+            , mCompileRoot(new osg::Group)
+        {
+            mLightManager->setStartLight(1);
+            mLightManager->addChild(mObjects);
+            mLightManager->addChild(mTerrainRoot);
+            mObjects->addCullCallback(new CullTimer(mObjectsTime, mCamera));
+            mTerrainRoot->addCullCallback(new CullTimer(mTerrainTime, mCamera));
+
+            osg::ref_ptr<osg::Light> sun = new osg::Light;
+            sun->setPosition(osg::Vec4f(0.3f, 0.3f, 1, 0));
+            osg::ref_ptr<osg::LightSource> sunSource = new osg::LightSource;
+            sunSource->setLight(sun);
+            mLightManager->setSunlight(sun);
+            mLightManager->addChild(sunSource);
+
+            if (shadows)
+                mRoot->addChild(createShadowedScene());
+            else
+                mRoot->addChild(mLightManager);
+
+            mTerrain = std::make_unique<Terrain::QuadTreeWorld>(mTerrainRoot, mCompileRoot, &resourceSystem, &storage,
+                ~0u, 0, 0, 512, 4, 0.5f, 0, 1.f / 4, false, ESM::Cell::sDefaultWorldspaceId, 0);
+            mTerrain->setViewDistance(viewDistance);
+            mTerrain->enable(true);
+        }
+
+        Terrain::QuadTreeWorld& getTerrain() { return *mTerrain; }
+
+        void addObject(osg::ref_ptr<osg::Node> node, const ESM::Position& position, float scale)
+        {
+            osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform = new SceneUtil::PositionAttitudeTransform;
+            transform->setPosition(position.asVec3());
+            transform->setAttitude(Misc::Convert::makeOsgQuat(position));
+            transform->setScale(osg::Vec3f(scale, scale, scale));
+            transform->addChild(node);
+            transform->addCullCallback(new SceneUtil::LightListCallback);
+            mObjects->addChild(transform);
+        }
+
+        void addLight(const osg::Vec3f& position, float radius)
+        {
+            osg::ref_ptr<osg::Light> light = new osg::Light;
+            light->setDiffuse(osg::Vec4f(1, 0.9f, 0.7f, 1));
+            light->setConstantAttenuation(0);
+            light->setLinearAttenuation(3.f / radius);
+            light->setQuadraticAttenuation(0);
+
+            osg::ref_ptr<SceneUtil::LightSource> lightSource = new SceneUtil::LightSource;
+            lightSource->setLight(light);
+            lightSource->setRadius(radius);
+
+            osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform = new SceneUtil::PositionAttitudeTransform;
+            transform->setPosition(position);
+            transform->addChild(lightSource);
+            mObjects->addChild(transform);
+        }
+
+        std::size_t getNumObjects() const { return mObjects->getNumChildren(); }
+
+        // Set up like SceneUtil::ShadowManager, except for the casting shader which needs a graphics context and does
+        // not take part in the cull traversal.
+        osg::ref_ptr<osg::Node> createShadowedScene()
+        {
+            const Settings::ShadowsCategory& settings = Settings::shadows();
+
+            osg::ref_ptr<SceneUtil::MWShadowTechnique> technique = new SceneUtil::MWShadowTechnique;
+            osg::ref_ptr<osgShadow::ShadowedScene> shadowedScene = new osgShadow::ShadowedScene(technique);
+            shadowedScene->addChild(mLightManager);
+            shadowedScene->addCullCallback(new CullTimer(mShadowedSceneTime));
+            mLightManager->addCullCallback(new CullTimer(mLightManagerTime, mCamera));
+
+            osgShadow::ShadowSettings& shadowSettings = *shadowedScene->getShadowSettings();
+            shadowSettings.setLightNum(0);
+            shadowSettings.setReceivesShadowTraversalMask(~0u);
+            shadowSettings.setCastsShadowTraversalMask(~0u);
+            shadowSettings.setNumShadowMapsPerLight(settings.mNumberOfShadowMaps);
+            shadowSettings.setBaseShadowTextureUnit(1);
+            shadowSettings.setMultipleShadowMapHint(osgShadow::ShadowSettings::CASCADED);
+            shadowSettings.setMinimumShadowMapNearFarRatio(settings.mMinimumLispsmNearFarRatio);
+            shadowSettings.setTextureSize(osg::Vec2s(settings.mShadowMapResolution, settings.mShadowMapResolution));
+            if (settings.mMaximumShadowMapDistance > 0)
+            {
+                shadowSettings.setMaximumShadowMapDistance(settings.mMaximumShadowMapDistance);
+                technique->setShadowFadeStart(settings.mMaximumShadowMapDistance * settings.mShadowFadeStart);
+            }
+            if (Misc::StringUtils::ciEqual(settings.mComputeSceneBounds.get(), "primitives"))
+                shadowSettings.setComputeNearFarModeOverride(osg::CullSettings::COMPUTE_NEAR_FAR_USING_PRIMITIVES);
+            else if (Misc::StringUtils::ciEqual(settings.mComputeSceneBounds.get(), "bounds"))
+                shadowSettings.setComputeNearFarModeOverride(
+                    osg::CullSettings::COMPUTE_NEAR_FAR_USING_BOUNDING_VOLUMES);
+
+            technique->enableShadows();
+            technique->setSplitPointUniformLogarithmicRatio(settings.mSplitPointUniformLogarithmicRatio);
+            technique->setSplitPointDeltaBias(settings.mSplitPointBias);
+            technique->setParallelCasterCulling(settings.mParallelCasterCulling);
+            technique->setWorldMask(~0u);
+
+            return shadowedScene;
+        }
+
+        FrameStats cull(const osg::Matrixd& view, float viewDistance, unsigned frameNumber)
+        {
+            constexpr int width = 1920;
+            constexpr int height = 1080;
+
+            mObjectsTime = 0;
+            mTerrainTime = 0;
+            mShadowedSceneTime = 0;
+            mLightManagerTime = 0;
+
+            osg::ref_ptr<osg::FrameStamp> frameStamp = new osg::FrameStamp;
+            frameStamp->setFrameNumber(frameNumber);
+            frameStamp->setReferenceTime(frameNumber / 60.0);
+            frameStamp->setSimulationTime(frameNumber / 60.0);
+
+            osgUtil::UpdateVisitor updateVisitor;
+            updateVisitor.setFrameStamp(frameStamp);
+            updateVisitor.setTraversalNumber(frameNumber);
+            mRoot->accept(updateVisitor);
+
+            osg::Camera* const camera = mCamera;
+            camera->setViewport(0, 0, width, height);
+            camera->setProjectionMatrixAsPerspective(60, static_cast<double>(width) / height, 1, viewDistance);
+            camera->setViewMatrix(view);
+            camera->addChild(mRoot);
+
+            osg::ref_ptr<osg::State> state = new osg::State;
+            state->setFrameStamp(frameStamp);
+
+            osg::ref_ptr<osgUtil::RenderStage> renderStage = new osgUtil::RenderStage;
+            renderStage->setCamera(camera);
+            renderStage->setViewport(camera->getViewport());
+
+            osg::ref_ptr<osgUtil::StateGraph> stateGraph = new osgUtil::StateGraph;
+
+            osg::ref_ptr<osgUtil::CullVisitor> cv = new osgUtil::CullVisitor;
+            cv->setFrameStamp(frameStamp);
+            cv->setTraversalNumber(frameNumber);
+            cv->setRenderInfo(osg::RenderInfo(state, nullptr));
+            cv->setStateGraph(stateGraph);
+            cv->setRenderStage(renderStage);
+            cv->setComputeNearFarMode(osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR);
+
+            const osg::Timer* const timer = osg::Timer::instance();
+            const osg::Timer_t start = timer->tick();
+
+            cv->pushViewport(camera->getViewport());
+            cv->pushProjectionMatrix(new osg::RefMatrix(camera->getProjectionMatrix()));
+            cv->pushModelViewMatrix(new osg::RefMatrix(camera->getViewMatrix()), osg::Transform::ABSOLUTE_RF);
+            cv->traverse(*camera);
+            cv->popModelViewMatrix();
+            cv->popProjectionMatrix();
+            cv->popViewport();
+
+            renderStage->sort();
+            stateGraph->prune();
+
+            FrameStats result;
+            result.mCullTime = timer->delta_s(start, timer->tick());
+            result.mObjectsTime = mObjectsTime;
+            result.mTerrainTime = mTerrainTime;
+            // The main view is culled within the shadowed scene, the rest of its time goes to the shadow maps
+            result.mShadowsTime = std::max(0.0, mShadowedSceneTime - mLightManagerTime);
+            const osgUtil::StateGraph* last = nullptr;
+            countRenderLeaves(*renderStage, last, result);
+
+            camera->removeChildren(0, camera->getNumChildren());
+
+            return result;
+        }
+
+    private:
+        osg::ref_ptr<osg::Group> mRoot;
+        osg::ref_ptr<osg::Camera> mCamera;
+        osg::ref_ptr<SceneUtil::LightManager> mLightManager;
+        osg::ref_ptr<osg::Group> mObjects;
+        osg::ref_ptr<osg::Group> mTerrainRoot;
+        osg::ref_ptr<osg::Group> mCompileRoot;
+        std::unique_ptr<Terrain::QuadTreeWorld> mTerrain;
+        double mObjectsTime = 0;
+        double mTerrainTime = 0;
+        double mShadowedSceneTime = 0;
+        double mLightManagerTime = 0;
+    };
+
+    ESM::RecNameInts getType(const EsmLoader::EsmData& esmData, const ESM::RefId& refId)
+    {
+        const auto it = std::lower_bound(
+            esmData.mRefIdTypes.begin(), esmData.mRefIdTypes.end(), refId, EsmLoader::LessById{});
+        if (it == esmData.mRefIdTypes.end() || it->mId != refId)
+            return {};
+        return it->mType;
+    }
+
+    void loadCellObjects(const ESM::Cell& cell, const EsmLoader::EsmData& esmData, ESM::ReadersCache& readers,
+        const VFS::Manager& vfs, Resource::SceneManager& sceneManager, Scene& scene)
+    {
+        std::vector<EsmLoader::Record<ESM::CellRef>> cellRefs;
+
+        for (std::size_t i = 0; i < cell.mContextList.size(); i++)
+        {
+            const ESM::ReadersCache::BusyItem reader
+                = readers.get(static_cast<std::size_t>(cell.mContextList[i].index));
+            cell.restore(*reader, static_cast<int>(i));
+            ESM::CellRef cellRef;
+            bool deleted = false;
+            while (ESM::Cell::getNextRef(*reader, cellRef, deleted))
+                cellRefs.emplace_back(deleted, std::move(cellRef));
+        }
+
+        const auto getKey = [](const EsmLoader::Record<ESM::CellRef>& v) -> ESM::RefNum { return v.mValue.mRefNum; };
+
+        for (const ESM::CellRef& cellRef : EsmLoader::prepareRecords(cellRefs, getKey))
+        {
+            const ESM::RecNameInts type = getType(esmData, cellRef.mRefID);
+            if (type == ESM::RecNameInts{})
+                continue;
+            std::string model(EsmLoader::getModel(esmData, cellRef.mRefID, type));
+            if (model.empty())
+                continue;
+
+            if (type != ESM::REC_STAT)
+                model = Misc::ResourceHelpers::correctActorModelPath(model, &vfs);
+
+            try
+            {
+                scene.addObject(sceneManager.getInstance("meshes/" + model), cellRef.mPos, cellRef.mScale);
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Warning) << "Failed to load cell ref \"" << cellRef.mRefID << "\" model \"" << model
+                                    << "\": " << e.what();
+            }
+        }
+    }
+
+    void printStats(std::string_view name, std::vector<double> values, std::string_view unit)
+    {
+        std::sort(values.begin(), values.end());
+        double sum = 0;
+        for (double value : values)
+            sum += value;
+        const auto percentile = [&](double p) { return values[static_cast<std::size_t>(p * (values.size() - 1))]; };
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+                  << " mean=" << sum / values.size() << unit << " median=" << percentile(0.5) << unit
+                  << " p95=" << percentile(0.95) << unit << " max=" << values.back() << unit << std::endl;
+    }
+
+    int runCullBenchmark(int argc, char* argv[])
+    {
+        Platform::init();
+
+        bpo::options_description desc = makeOptionsDescription();
+
+        bpo::parsed_options options = bpo::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+        bpo::variables_map variables;
+
+        bpo::store(options, variables);
+        bpo::notify(variables);
+
+        if (variables.find("help") != variables.end())
+        {
+            Debug::getRawStdout() << desc << std::endl;
+            return 0;
+        }
+
+        Files::ConfigurationManager config;
+        config.readConfiguration(variables, desc);
+
+        Debug::setupLogging(config.getLogPath(), applicationName);
+
+        const std::string encoding(variables["encoding"].as<std::string>());
+        Log(Debug::Info) << ToUTF8::encodingUsingMessage(encoding);
+        ToUTF8::Utf8Encoder encoder(ToUTF8::calculateEncoding(encoding));
+
+        Files::PathContainer dataDirs(asPathContainer(variables["data"].as<Files::MaybeQuotedPathContainer>()));
+
+        auto local = variables["data-local"].as<Files::MaybeQuotedPathContainer::value_type>();
+        if (!local.empty())
+            dataDirs.push_back(std::move(local));
+
+        config.filterOutNonExistingPaths(dataDirs);
+
+        const auto& resDir = variables["resources"].as<Files::MaybeQuotedPath>();
+        Log(Debug::Info) << Version::getOpenmwVersionDescription();
+        dataDirs.insert(dataDirs.begin(), resDir / "vfs");
+        const Files::Collections fileCollections(dataDirs);
+        const auto& archives = variables["fallback-archive"].as<StringsVector>();
+        StringsVector contentFiles{ "builtin.omwscripts" };
+        const auto& configContentFiles = variables["content"].as<StringsVector>();
+        contentFiles.insert(contentFiles.end(), configContentFiles.begin(), configContentFiles.end());
+
+        Fallback::Map::init(variables["fallback"].as<Fallback::FallbackMap>().mMap);
+
+        VFS::Manager vfs;
+
+        VFS::registerArchives(&vfs, fileCollections, archives, true);
+
+        Settings::Manager::load(config);
+
+        const int cellX = variables["cell-x"].as<int>();
+        const int cellY = variables["cell-y"].as<int>();
+        const int radius = variables["radius"].as<int>();
+        const float viewDistance = variables["view-distance"].as<float>();
+        const std::size_t lights = variables["lights"].as<std::size_t>();
+        const std::size_t frames = std::max<std::size_t>(1, variables["frames"].as<std::size_t>());
+        const std::size_t warmupFrames = variables["warmup-frames"].as<std::size_t>();
+
+        ESM::ReadersCache readers;
+        EsmLoader::Query query;
+        query.mLoadActivators = true;
+        query.mLoadCells = true;
+        query.mLoadContainers = true;
+        query.mLoadDoors = true;
+        query.mLoadLands = true;
+        query.mLoadStatics = true;
+        EsmLoader::EsmData esmData = EsmLoader::loadEsmData(query, contentFiles, fileCollections, readers, &encoder);
+
+        std::sort(esmData.mLands.begin(), esmData.mLands.end(),
+            [](const ESM::Land& l, const ESM::Land& r) { return std::tie(l.mX, l.mY) < std::tie(r.mX, r.mY); });
+
+        constexpr double expiryDelay = 0;
+        Resource::ResourceSystem resourceSystem(&vfs, expiryDelay, &encoder.getStatelessEncoder());
+        Storage storage(&vfs, esmData.mLands);
+        const SceneUtil::LightingMethod lightingMethod
+            = SceneUtil::LightManager::getLightingMethodFromString(variables["lighting-method"].as<std::string>());
+        const bool shadows = variables["shadows"].as<bool>();
+        Scene scene(
+            resourceSystem, storage, viewDistance, lightingMethod, variables["max-lights"].as<int>(), shadows);
+
+        for (const ESM::Cell& cell : esmData.mCells)
+        {
+            if (!cell.isExterior() || std::abs(cell.getGridX() - cellX) > radius
+                || std::abs(cell.getGridY() - cellY) > radius)
+                continue;
+            loadCellObjects(cell, esmData, readers, vfs, *resourceSystem.getSceneManager(), scene);
+            scene.getTerrain().loadCell(cell.getGridX(), cell.getGridY());
+        }
+
+        const float cellSize = Constants::CellSizeInUnits;
+        std::mt19937 random;
+        std::uniform_real_distribution<float> distribution(-radius * cellSize, (radius + 1) * cellSize);
+        for (std::size_t i = 0; i < lights; ++i)
+        {
+            const float x = cellX * cellSize + distribution(random);
+            const float y = cellY * cellSize + distribution(random);
+            const float z = storage.getHeightAt(osg::Vec3f(x, y, 0), ESM::Cell::sDefaultWorldspaceId) + 100;
+            scene.addLight(osg::Vec3f(x, y, z), 512);
+        }
+
+        Log(Debug::Info) << "Loaded " << scene.getNumObjects() << " objects and lights";
+
+        const auto& cameraPathFile = variables["camera-path"].as<Files::MaybeQuotedPath>();
+        const std::vector<CameraKey> cameraPath = cameraPathFile.empty()
+            ? makeDefaultCameraPath(cellX, cellY,
+                storage.getHeightAt(osg::Vec3f((cellX + 0.5f) * cellSize, (cellY + 0.5f) * cellSize, 0),
+                    ESM::Cell::sDefaultWorldspaceId)
+                    + 1000)
+            : readCameraPath(cameraPathFile);
+
+        for (std::size_t i = 0; i < warmupFrames; ++i)
+            scene.cull(makeViewMatrix(cameraPath.front()), viewDistance, static_cast<unsigned>(i));
+
+        std::vector<double> cullTimes;
+        std::vector<double> objectsTimes;
+        std::vector<double> terrainTimes;
+        std::vector<double> shadowsTimes;
+        std::vector<double> drawables;
+        std::vector<double> stateChanges;
+
+        for (std::size_t i = 0; i < frames; ++i)
+        {
+            const CameraKey key = interpolate(cameraPath, static_cast<float>(i) / frames);
+            const FrameStats stats
+                = scene.cull(makeViewMatrix(key), viewDistance, static_cast<unsigned>(warmupFrames + i));
+            cullTimes.push_back(stats.mCullTime * 1000);
+            objectsTimes.push_back(stats.mObjectsTime * 1000);
+            terrainTimes.push_back(stats.mTerrainTime * 1000);
+            shadowsTimes.push_back(stats.mShadowsTime * 1000);
+            drawables.push_back(static_cast<double>(stats.mDrawables));
+            stateChanges.push_back(static_cast<double>(stats.mStateChanges));
+        }
+
+        std::cout << "Culled " << frames << " frames with " << scene.getNumObjects() << " objects and lights using "
+                  << SceneUtil::LightManager::getLightingMethodString(lightingMethod) << " lighting" << std::endl;
+        printStats("Cull", cullTimes, "ms");
+        printStats("Objects", objectsTimes, "ms");
+        printStats("Terrain", terrainTimes, "ms");
+        if (shadows)
+            printStats("Shadows", shadowsTimes, "ms");
+        printStats("Drawables", drawables, "");
+        printStats("StateChanges", stateChanges, "");
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    return Debug::wrapApplication(runCullBenchmark, argc, argv, applicationName);
+}
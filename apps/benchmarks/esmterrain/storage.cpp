@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+
+#include <components/esm3/loadcell.hpp>
+#include <components/esm3/loadland.hpp>
+#include <components/esmterrain/storage.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int gridSize = 8;
+    constexpr int landFlags = ESM::Land::DATA_VHGT | ESM::Land::DATA_VNML | ESM::Land::DATA_VCLR;
+
+    // Rolling hills with noisy normals and colours, the content doesn't matter as long as nothing is constant
+    std::vector<ESM::Land> generateLands()
+    {
+        std::minstd_rand random;
+        std::uniform_int_distribution<int> distribution(-127, 127);
+        constexpr int landSize = ESM::Land::LAND_SIZE;
+
+        std::vector<ESM::Land> result(gridSize * gridSize);
+        for (int cellX = 0; cellX < gridSize; ++cellX)
+        {
+            for (int cellY = 0; cellY < gridSize; ++cellY)
+            {
+                ESM::Land& land = result[cellX * gridSize + cellY];
+                land.mX = cellX;
+                land.mY = cellY;
+                land.add(landFlags);
+                ESM::Land::LandData& data = *land.getLandData();
+                for (int col = 0; col < landSize; ++col)
+                {
+                    for (int row = 0; row < landSize; ++row)
+                    {
+                        const int index = col * landSize + row;
+                        const float x = static_cast<float>(cellX * (landSize - 1) + row);
+                        const float y = static_cast<float>(cellY * (landSize - 1) + col);
+                        data.mHeights[index] = std::round(std::sin(x / 50) * std::cos(y / 70) * 256) * 8;
+                        data.mNormals[index * 3] = static_cast<std::int8_t>(distribution(random) / 4);
+                        data.mNormals[index * 3 + 1] = static_cast<std::int8_t>(distribution(random) / 4);
+                        data.mNormals[index * 3 + 2] = 127;
+                        for (int i = 0; i < 3; ++i)
+                            data.mColours[index * 3 + i] = static_cast<std::uint8_t>(distribution(random) + 128);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    class Storage final : public ESMTerrain::Storage
+    {
+    public:
+        Storage(const VFS::Manager* vfs, const std::vector<ESM::Land>& lands)
+            : ESMTerrain::Storage(vfs)
+            , mLands(lands)
+        {
+        }
+
+        osg::ref_ptr<const ESMTerrain::LandObject> getLand(ESM::ExteriorCellLocation cellLocation) override
+        {
+            if (cellLocation.mX < 0 || cellLocation.mX >= gridSize || cellLocation.mY < 0
+                || cellLocation.mY >= gridSize)
+                return nullptr;
+            return new ESMTerrain::LandObject(mLands[cellLocation.mX * gridSize + cellLocation.mY], landFlags);
+        }
+
+        const std::string* getLandTexture(std::uint16_t /*index*/, int /*plugin*/) override { return nullptr; }
+
+        void getBounds(float& minX, float& maxX, float& minY, float& maxY, ESM::RefId /*worldspace*/) override
+        {
+            minX = minY = 0;
+            maxX = maxY = gridSize;
+        }
+
+    private:
+        const std::vector<ESM::Land>& mLands;
+    };
+
+    // Every chunk of the given size and LOD level covering the grid, like the terrain of a new game session before the
+    // chunks are cached
+    void fillVertexBuffers(benchmark::State& state)
+    {
+        const std::vector<ESM::Land> lands = generateLands();
+        const VFS::Manager vfs;
+        Storage storage(&vfs, lands);
+        const float size = static_cast<float>(state.range(0)) / 4;
+        const int lodLevel = static_cast<int>(state.range(1));
+        osg::ref_ptr<osg::Vec3Array> positions(new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals(new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4ubArray> colours(new osg::Vec4ubArray);
+        std::size_t vertices = 0;
+
+        for (auto _ : state)
+        {
+            for (float x = size / 2; x < gridSize; x += size)
+            {
+                for (float y = size / 2; y < gridSize; y += size)
+                {
+                    storage.fillVertexBuffers(lodLevel, size, osg::Vec2f(x, y), ESM::Cell::sDefaultWorldspaceId,
+                        *positions, *normals, *colours);
+                    vertices += positions->size();
+                    benchmark::DoNotOptimize(colours->data());
+                }
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(vertices));
+    }
+}
+
+// Chunk sizes in quarters of a cell, from the closest chunks at full detail to the distant ones
+BENCHMARK(fillVertexBuffers)
+    ->ArgNames({ "quarters", "lod" })
+    ->Args({ 1, 0 })
+    ->Args({ 4, 0 })
+    ->Args({ 4, 2 })
+    ->Args({ 16, 2 })
+    ->Args({ 16, 4 })
+    ->Args({ 32, 5 });
+
+BENCHMARK_MAIN();
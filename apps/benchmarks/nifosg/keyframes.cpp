@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <components/nif/nifkey.hpp>
+#include <components/nifosg/controller.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Roughly a creature skeleton, every bone animated by its own rotation, translation and scale tracks
+    constexpr std::size_t bonesCount = 64;
+    constexpr std::size_t keysCount = 300;
+    constexpr float duration = 10;
+    constexpr float frameDuration = 1 / 60.0f;
+
+    template <class KeyMap, class Random, class Generate>
+    std::shared_ptr<const KeyMap> generateTrack(Random& random, Generate&& generate)
+    {
+        auto result = std::make_shared<KeyMap>();
+        result->mInterpolationType = Nif::InterpolationType_Linear;
+        for (std::size_t i = 0; i < keysCount; ++i)
+        {
+            typename KeyMap::KeyType key{};
+            key.mValue = generate(random);
+            result->addKey(duration * static_cast<float>(i) / (keysCount - 1), key);
+        }
+        result->sortKeys();
+        return result;
+    }
+
+    struct Skeleton
+    {
+        std::vector<NifOsg::QuaternionInterpolator> mRotations;
+        std::vector<NifOsg::Vec3Interpolator> mTranslations;
+        std::vector<NifOsg::FloatInterpolator> mScales;
+    };
+
+    template <class Random>
+    Skeleton generateSkeleton(Random& random)
+    {
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        const auto generateFloat = [&](Random& r) { return distribution(r); };
+        const auto generateVec3 = [&](Random& r) {
+            return osg::Vec3f(distribution(r), distribution(r), distribution(r));
+        };
+        const auto generateQuat = [&](Random& r) {
+            osg::Quat result(distribution(r), distribution(r), distribution(r), distribution(r));
+            return result / result.length();
+        };
+
+        Skeleton result;
+        for (std::size_t i = 0; i < bonesCount; ++i)
+        {
+            result.mRotations.emplace_back(generateTrack<Nif::QuaternionKeyMap>(random, generateQuat));
+            result.mTranslations.emplace_back(generateTrack<Nif::Vector3KeyMap>(random, generateVec3));
+            result.mScales.emplace_back(generateTrack<Nif::FloatKeyMap>(random, generateFloat));
+        }
+        return result;
+    }
+
+    void evaluate(const Skeleton& skeleton, float time)
+    {
+        for (std::size_t i = 0; i < bonesCount; ++i)
+        {
+            benchmark::DoNotOptimize(skeleton.mRotations[i].interpKey(time));
+            benchmark::DoNotOptimize(skeleton.mTranslations[i].interpKey(time));
+            benchmark::DoNotOptimize(skeleton.mScales[i].interpKey(time));
+        }
+    }
+
+    void interpolateSkeletonPlayback(benchmark::State& state)
+    {
+        std::minstd_rand random;
+        const Skeleton skeleton = generateSkeleton(random);
+        float time = 0;
+
+        for (auto _ : state)
+        {
+            evaluate(skeleton, time);
+            time += frameDuration;
+            if (time > duration)
+                time = 0;
+        }
+
+        state.SetItemsProcessed(state.iterations() * bonesCount * 3);
+    }
+
+    void interpolateSkeletonRandomTime(benchmark::State& state)
+    {
+        std::minstd_rand random;
+        const Skeleton skeleton = generateSkeleton(random);
+        std::uniform_real_distribution<float> distribution(0, duration);
+        std::vector<float> times(1024);
+        for (float& time : times)
+            time = distribution(random);
+        std::size_t i = 0;
+
+        for (auto _ : state)
+        {
+            evaluate(skeleton, times[i]);
+            if (++i >= times.size())
+                i = 0;
+        }
+
+        state.SetItemsProcessed(state.iterations() * bonesCount * 3);
+    }
+}
+
+BENCHMARK(interpolateSkeletonPlayback);
+BENCHMARK(interpolateSkeletonRandomTime);
+
+BENCHMARK_MAIN();
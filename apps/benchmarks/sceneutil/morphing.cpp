@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <components/sceneutil/morphing.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t targetsCount = 12;
+
+    struct Head
+    {
+        std::vector<osg::Vec3f> mPositions;
+        std::vector<SceneUtil::MorphTargetOffsets> mSparseTargets;
+        std::vector<SceneUtil::MorphTargetOffsets> mDenseTargets;
+    };
+
+    // Every expression or phoneme moves a region of the face around the eyes or the mouth, a few percents of the
+    // vertices of the head.
+    Head generateHead(std::size_t verticesCount)
+    {
+        std::minstd_rand random;
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        const auto generateVec3 = [&] {
+            return osg::Vec3f(distribution(random), distribution(random), distribution(random));
+        };
+
+        Head result;
+        for (std::size_t i = 0; i < verticesCount; ++i)
+            result.mPositions.push_back(generateVec3() * 10);
+
+        std::uniform_int_distribution<std::size_t> regionStart(0, verticesCount - verticesCount / 10);
+        for (std::size_t i = 0; i < targetsCount; ++i)
+        {
+            std::vector<osg::Vec3f> offsets(verticesCount);
+            const std::size_t start = regionStart(random);
+            for (std::size_t j = start; j < start + verticesCount / 10; ++j)
+                if (distribution(random) > 0)
+                    offsets[j] = generateVec3();
+            result.mSparseTargets.push_back(SceneUtil::makeMorphTargetOffsets(offsets));
+            result.mDenseTargets.push_back(SceneUtil::MorphTargetOffsets{ false, {}, std::move(offsets) });
+        }
+
+        return result;
+    }
+
+    template <auto addOffsets>
+    void animateHead(benchmark::State& state, bool sparse)
+    {
+        const Head head = generateHead(static_cast<std::size_t>(state.range(0)));
+        const std::vector<SceneUtil::MorphTargetOffsets>& targets = sparse ? head.mSparseTargets : head.mDenseTargets;
+        std::vector<osg::Vec3f> positions(head.mPositions.size());
+        std::size_t frame = 0;
+
+        for (auto _ : state)
+        {
+            std::copy(head.mPositions.begin(), head.mPositions.end(), positions.begin());
+            // Talking and blinking, every target is blended in and out over a different period
+            for (std::size_t i = 0; i < targets.size(); ++i)
+                addOffsets(targets[i], static_cast<float>((frame + i * 7) % (i + 10)) / (i + 10), positions.data());
+            ++frame;
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void addMorphOffsetsSparse(benchmark::State& state)
+    {
+        animateHead<SceneUtil::addMorphOffsets>(state, true);
+    }
+
+    void addMorphOffsetsDense(benchmark::State& state)
+    {
+        animateHead<SceneUtil::addMorphOffsets>(state, false);
+    }
+
+    void addMorphOffsetsScalarDense(benchmark::State& state)
+    {
+        animateHead<SceneUtil::addMorphOffsetsScalar>(state, false);
+    }
+}
+
+// A vanilla head and a high-poly replacer head, the scalar blending of dense targets is how every morph target used
+// to be applied
+BENCHMARK(addMorphOffsetsSparse)->ArgName("vertices")->Arg(1000)->Arg(10000);
+BENCHMARK(addMorphOffsetsDense)->ArgName("vertices")->Arg(1000)->Arg(10000);
+BENCHMARK(addMorphOffsetsScalarDense)->ArgName("vertices")->Arg(1000)->Arg(10000);
+
+BENCHMARK_MAIN();
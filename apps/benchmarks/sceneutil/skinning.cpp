@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <components/sceneutil/skinning.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t bonesCount = 40;
+
+    struct Mesh
+    {
+        std::vector<osg::Vec3f> mPositions;
+        std::vector<osg::Vec3f> mNormals;
+        std::vector<osg::Vec4f> mTangents;
+        SceneUtil::SkinningLayout mLayout;
+        std::vector<osg::Matrixf> mMatrices;
+    };
+
+    // Most vertices follow a single bone, the ones around the joints have their own blend of weights shared with few
+    // other vertices, which makes for many small groups.
+    Mesh generateMesh(std::size_t verticesCount)
+    {
+        std::minstd_rand random;
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        const auto generateVec3 = [&] {
+            return osg::Vec3f(distribution(random), distribution(random), distribution(random));
+        };
+
+        Mesh result;
+        for (std::size_t i = 0; i < verticesCount; ++i)
+        {
+            result.mPositions.push_back(generateVec3() * 100);
+            result.mNormals.push_back(generateVec3());
+            result.mTangents.emplace_back(generateVec3(), 1);
+        }
+
+        std::vector<unsigned short> vertices(verticesCount);
+        for (std::size_t i = 0; i < verticesCount; ++i)
+            vertices[i] = static_cast<unsigned short>(i);
+        std::shuffle(vertices.begin(), vertices.end(), random);
+
+        const std::size_t rigidCount = verticesCount * 3 / 5;
+        std::vector<std::vector<unsigned short>> groups(bonesCount);
+        for (std::size_t i = 0; i < rigidCount; ++i)
+            groups[i % bonesCount].push_back(vertices[i]);
+
+        std::uniform_int_distribution<std::size_t> blendedGroupSize(1, 6);
+        for (std::size_t i = rigidCount; i < verticesCount;)
+        {
+            const std::size_t size = std::min(blendedGroupSize(random), verticesCount - i);
+            groups.emplace_back(vertices.begin() + i, vertices.begin() + i + size);
+            i += size;
+        }
+
+        for (const std::vector<unsigned short>& group : groups)
+        {
+            result.mLayout.addGroup(
+                group, result.mPositions.data(), result.mNormals.data(), result.mTangents.data());
+            result.mMatrices.push_back(osg::Matrixf::rotate(distribution(random), generateVec3())
+                * osg::Matrixf::translate(generateVec3() * 10));
+        }
+
+        return result;
+    }
+
+    template <auto skin>
+    void skinMesh(benchmark::State& state)
+    {
+        const Mesh mesh = generateMesh(static_cast<std::size_t>(state.range(0)));
+        std::vector<osg::Vec3f> positions(mesh.mPositions.size());
+        std::vector<osg::Vec3f> normals(mesh.mNormals.size());
+        std::vector<osg::Vec4f> tangents(mesh.mTangents.size());
+
+        for (auto _ : state)
+        {
+            skin(mesh.mLayout, mesh.mMatrices, positions.data(), normals.data(), tangents.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void skinVertices(benchmark::State& state)
+    {
+        skinMesh<SceneUtil::skinVertices>(state);
+    }
+
+    void skinVerticesScalar(benchmark::State& state)
+    {
+        skinMesh<SceneUtil::skinVerticesScalar>(state);
+    }
+}
+
+// A typical NPC body with its head, hands and clothes, and a high-poly replacer body
+BENCHMARK(skinVertices)->ArgName("vertices")->Arg(4000)->Arg(40000);
+BENCHMARK(skinVerticesScalar)->ArgName("vertices")->Arg(4000)->Arg(40000);
+
+BENCHMARK_MAIN();
@@ -363,6 +363,71 @@ namespace ESMTerrain
                     Sample{ .mCellX = 3, .mCellY = 3, .mLocalX = 2, .mLocalY = 2, .mVertexX = 1, .mVertexY = 1 }));
         }
 
+        std::vector<Sample> expandRows(const std::vector<CellRow>& rows, std::size_t sampleSize)
+        {
+            std::vector<Sample> result;
+            for (const CellRow& row : rows)
+                for (std::size_t i = 0; i < row.mCount; ++i)
+                    result.push_back(Sample{
+                        .mCellX = row.mCellX,
+                        .mCellY = row.mCellY,
+                        .mLocalX = row.mLocalX + i * sampleSize,
+                        .mLocalY = row.mLocalY,
+                        .mVertexX = row.mVertexX + i,
+                        .mVertexY = row.mVertexY,
+                    });
+            return result;
+        }
+
+        TEST(ESMTerrainSampleCellGridRows, shouldGroupSamplesOfCellRow)
+        {
+            const std::size_t cellSize = 3;
+            const std::size_t sampleSize = 1;
+            const std::size_t beginX = 1;
+            const std::size_t beginY = 0;
+            const std::size_t distance = 5;
+            std::vector<CellRow> rows;
+            sampleCellGridRows(cellSize, sampleSize, beginX, beginY, distance,
+                [&](const CellRow& row) { rows.push_back(row); });
+            ASSERT_EQ(rows.size(), 15);
+            EXPECT_EQ(rows[0].mCellX, 0);
+            EXPECT_EQ(rows[0].mLocalX, 1);
+            EXPECT_EQ(rows[0].mLocalY, 0);
+            EXPECT_EQ(rows[0].mVertexX, 0);
+            EXPECT_EQ(rows[0].mCount, 2);
+            EXPECT_EQ(rows[1].mCellX, 0);
+            EXPECT_EQ(rows[1].mLocalY, 1);
+            EXPECT_EQ(rows[1].mVertexY, 1);
+            EXPECT_EQ(rows[3].mCellX, 1);
+            EXPECT_EQ(rows[3].mLocalX, 1);
+            EXPECT_EQ(rows[3].mVertexX, 2);
+            EXPECT_EQ(rows[3].mCount, 2);
+            EXPECT_EQ(rows[6].mCellX, 2);
+            EXPECT_EQ(rows[6].mLocalX, 1);
+            EXPECT_EQ(rows[6].mVertexX, 4);
+            EXPECT_EQ(rows[6].mCount, 1);
+        }
+
+        TEST(ESMTerrainSampleCellGridRows, shouldProduceSameSamplesAsSampleCellGrid)
+        {
+            for (const std::size_t cellSize : { 3, 5, 65 })
+                for (const std::size_t sampleSize : { 1, 2, 4, 8, 128 })
+                    for (const std::size_t begin : { 0, 2, 64 })
+                        for (const std::size_t distance : { 2, 3, 5, 17, 65, 129 })
+                        {
+                            if (sampleSize >= distance)
+                                continue;
+
+                            std::vector<Sample> samples;
+                            sampleCellGrid(cellSize, sampleSize, begin, begin, distance, Collect{ samples });
+                            std::vector<CellRow> rows;
+                            sampleCellGridRows(cellSize, sampleSize, begin, begin, distance,
+                                [&](const CellRow& row) { rows.push_back(row); });
+                            EXPECT_EQ(expandRows(rows, sampleSize), samples)
+                                << cellSize << " " << sampleSize << " " << begin << " " << distance;
+                        }
+        }
+
         auto tie(const CellSample& v)
         {
             return std::tie(v.mCellX, v.mCellY, v.mSrcRow, v.mSrcCol, v.mDstRow, v.mDstCol);
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <array>
 #include <fstream>
+#include <span>
 #include <sstream>
 #include <string>
 
@@ -61,6 +62,13 @@ namespace
         EXPECT_EQ(getHash(Files::pathToUnicodeString(file), *stream), GetParam().mHash);
     }
 
+    TEST_P(FilesGetHash, shouldReturnHashForBuffer)
+    {
+        std::string content;
+        std::fill_n(std::back_inserter(content), GetParam().mSize, 'a');
+        EXPECT_EQ(getHash(std::span<const char>(content)), GetParam().mHash);
+    }
+
     INSTANTIATE_TEST_SUITE_P(Params, FilesGetHash,
         Values(Params{ 0, { 0, 0 } }, Params{ 1, { 9607679276477937801ull, 16624257681780017498ull } },
             Params{ 128, { 15287858148353394424ull, 16818615825966581310ull } },
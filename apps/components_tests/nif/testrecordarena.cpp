@@ -0,0 +1,65 @@
+#include <components/nif/recordarena.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using namespace Nif;
+
+    std::vector<int> destroyed;
+
+    template <std::size_t size>
+    struct TestRecord : Record
+    {
+        int mId = 0;
+        std::array<char, size> mPayload{};
+
+        void read(NIFStream* /*nif*/) override {}
+
+        ~TestRecord() override { destroyed.push_back(mId); }
+    };
+
+    TEST(NifRecordArenaTest, shouldDestroyRecordsInReverseOrder)
+    {
+        destroyed.clear();
+        {
+            RecordArena arena;
+            for (int i = 0; i < 3; ++i)
+                arena.create<TestRecord<16>>()->mId = i;
+            EXPECT_EQ(arena.size(), 3u);
+            EXPECT_TRUE(destroyed.empty());
+        }
+        EXPECT_EQ(destroyed, (std::vector<int>{ 2, 1, 0 }));
+    }
+
+    TEST(NifRecordArenaTest, shouldKeepRecordsAlignedAndDistinct)
+    {
+        RecordArena arena;
+        std::vector<Record*> records;
+        for (int i = 0; i < 1000; ++i)
+        {
+            TestRecord<13>* record = arena.create<TestRecord<13>>();
+            record->mId = i;
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(record) % alignof(TestRecord<13>), 0u);
+            records.push_back(record);
+        }
+        for (int i = 0; i < 1000; ++i)
+            EXPECT_EQ(static_cast<TestRecord<13>*>(records[i])->mId, i);
+    }
+
+    TEST(NifRecordArenaTest, shouldCreateRecordsLargerThanBlock)
+    {
+        destroyed.clear();
+        {
+            RecordArena arena;
+            arena.create<TestRecord<16>>()->mId = 1;
+            arena.create<TestRecord<100000>>()->mId = 2;
+            arena.create<TestRecord<16>>()->mId = 3;
+        }
+        EXPECT_EQ(destroyed, (std::vector<int>{ 3, 2, 1 }));
+    }
+}
@@ -0,0 +1,194 @@
+#include <components/resource/imageprocessing.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+
+namespace
+{
+    using namespace Resource;
+
+    osg::ref_ptr<osg::Image> makeImage(int width, int height, GLenum pixelFormat)
+    {
+        osg::ref_ptr<osg::Image> image = new osg::Image;
+        image->allocateImage(width, height, 1, pixelFormat, GL_UNSIGNED_BYTE);
+        return image;
+    }
+
+    std::array<int, 3> decodeRgb565(std::uint16_t value)
+    {
+        const int r = (value >> 11) & 31;
+        const int g = (value >> 5) & 63;
+        const int b = value & 31;
+        return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+    }
+
+    // Colour of the pixel at the given index of a 4 colour mode BC1 block
+    std::array<int, 3> decodeColour(const unsigned char* block, std::size_t index)
+    {
+        const std::array<int, 3> colour0 = decodeRgb565(static_cast<std::uint16_t>(block[0] | block[1] << 8));
+        const std::array<int, 3> colour1 = decodeRgb565(static_cast<std::uint16_t>(block[2] | block[3] << 8));
+        std::uint32_t indices = 0;
+        for (std::size_t i = 0; i < 4; ++i)
+            indices |= static_cast<std::uint32_t>(block[4 + i]) << (8 * i);
+        std::array<int, 3> result;
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            switch ((indices >> (2 * index)) & 3)
+            {
+                case 0:
+                    result[i] = colour0[i];
+                    break;
+                case 1:
+                    result[i] = colour1[i];
+                    break;
+                case 2:
+                    result[i] = (2 * colour0[i] + colour1[i]) / 3;
+                    break;
+                default:
+                    result[i] = (colour0[i] + 2 * colour1[i]) / 3;
+                    break;
+            }
+        }
+        return result;
+    }
+
+    // Alpha of the pixel at the given index of an 8 alpha mode BC3 block
+    int decodeAlpha(const unsigned char* block, std::size_t index)
+    {
+        std::uint64_t indices = 0;
+        for (std::size_t i = 0; i < 6; ++i)
+            indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+        const int alpha0 = block[0];
+        const int alpha1 = block[1];
+        const int code = static_cast<int>((indices >> (3 * index)) & 7);
+        if (code < 2)
+            return code == 0 ? alpha0 : alpha1;
+        return ((8 - code) * alpha0 + (code - 1) * alpha1) / 7;
+    }
+
+    TEST(ResourceGenerateMipmapsTest, shouldAverageBlocksOfPixels)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(4, 2, GL_LUMINANCE);
+        const unsigned char values[] = { 0, 2, 10, 20, 4, 6, 30, 40 };
+        std::copy(std::begin(values), std::end(values), image->data());
+
+        ASSERT_TRUE(generateMipmaps(*image));
+
+        ASSERT_EQ(image->getNumMipmapLevels(), 3);
+        EXPECT_EQ(image->getMipmapData(0)[0], 0);
+        EXPECT_EQ(image->getMipmapData(0)[7], 40);
+        EXPECT_EQ(image->getMipmapData(1)[0], 3);
+        EXPECT_EQ(image->getMipmapData(1)[1], 25);
+        EXPECT_EQ(image->getMipmapData(2)[0], 14);
+    }
+
+    TEST(ResourceGenerateMipmapsTest, shouldNotChangeImageWithMipmaps)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(4, 4, GL_RGBA);
+        ASSERT_TRUE(generateMipmaps(*image));
+        EXPECT_FALSE(generateMipmaps(*image));
+        EXPECT_EQ(image->getNumMipmapLevels(), 3);
+    }
+
+    TEST(ResourceCompressImageS3TCTest, shouldNotSupportSizesNotMultipleOfFour)
+    {
+        EXPECT_EQ(compressImageS3TC(*makeImage(6, 4, GL_RGB)), nullptr);
+    }
+
+    TEST(ResourceCompressImageS3TCTest, shouldUseBC1ForOpaqueImages)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(8, 4, GL_RGBA);
+        for (std::size_t i = 0; i < 8 * 4; ++i)
+        {
+            image->data()[i * 4] = static_cast<unsigned char>(i * 2);
+            image->data()[i * 4 + 1] = 128;
+            image->data()[i * 4 + 2] = static_cast<unsigned char>(255 - i * 2);
+            image->data()[i * 4 + 3] = 255;
+        }
+
+        const osg::ref_ptr<osg::Image> compressed = compressImageS3TC(*image);
+
+        ASSERT_NE(compressed, nullptr);
+        EXPECT_EQ(compressed->getPixelFormat(), static_cast<GLenum>(GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+        EXPECT_EQ(compressed->getTotalSizeInBytes(), 2 * 8);
+        for (std::size_t y = 0; y < 4; ++y)
+        {
+            for (std::size_t x = 0; x < 8; ++x)
+            {
+                const unsigned char* pixel = image->data() + (y * 8 + x) * 4;
+                const std::array<int, 3> decoded = decodeColour(compressed->data() + (x / 4) * 8, y * 4 + x % 4);
+                for (std::size_t i = 0; i < 3; ++i)
+                    EXPECT_LE(std::abs(decoded[i] - pixel[i]), 24) << x << " " << y << " " << i;
+            }
+        }
+    }
+
+    TEST(ResourceCompressImageS3TCTest, shouldUseBC3ForTranslucentImages)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(4, 4, GL_BGRA);
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            image->data()[i * 4] = 255;
+            image->data()[i * 4 + 1] = 0;
+            image->data()[i * 4 + 2] = 0;
+            image->data()[i * 4 + 3] = static_cast<unsigned char>(i * 17);
+        }
+
+        const osg::ref_ptr<osg::Image> compressed = compressImageS3TC(*image);
+
+        ASSERT_NE(compressed, nullptr);
+        EXPECT_EQ(compressed->getPixelFormat(), static_cast<GLenum>(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+        ASSERT_EQ(compressed->getTotalSizeInBytes(), 16);
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            EXPECT_LE(std::abs(decodeAlpha(compressed->data(), i) - static_cast<int>(i) * 17), 19) << i;
+            EXPECT_EQ(decodeColour(compressed->data() + 8, i), (std::array<int, 3>{ 0, 0, 255 })) << i;
+        }
+    }
+
+    TEST(ResourceCompressImageS3TCTest, shouldCompressEveryMipmap)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(8, 8, GL_RGB);
+        ASSERT_TRUE(generateMipmaps(*image));
+
+        const osg::ref_ptr<osg::Image> compressed = compressImageS3TC(*image);
+
+        ASSERT_NE(compressed, nullptr);
+        ASSERT_EQ(compressed->getNumMipmapLevels(), 4);
+        EXPECT_EQ(compressed->getTotalSizeInBytesIncludingMipmaps(), (4 + 1 + 1 + 1) * 8);
+    }
+
+    TEST(ResourceDropMipmapsTest, shouldMakeTheNextMipmapTheImage)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(8, 4, GL_LUMINANCE);
+        for (std::size_t i = 0; i < 8 * 4; ++i)
+            image->data()[i] = static_cast<unsigned char>(i * 4);
+        ASSERT_TRUE(generateMipmaps(*image));
+        image->setFileName("texture.dds");
+
+        const osg::ref_ptr<osg::Image> dropped = dropMipmaps(*image, 1);
+
+        ASSERT_NE(dropped, nullptr);
+        EXPECT_EQ(dropped->s(), 4);
+        EXPECT_EQ(dropped->t(), 2);
+        EXPECT_EQ(dropped->getFileName(), "texture.dds");
+        ASSERT_EQ(dropped->getNumMipmapLevels(), image->getNumMipmapLevels() - 1);
+        for (unsigned int level = 0; level < dropped->getNumMipmapLevels(); ++level)
+            EXPECT_EQ(dropped->getMipmapData(level)[0], image->getMipmapData(level + 1)[0]) << level;
+    }
+
+    TEST(ResourceDropMipmapsTest, shouldKeepAtLeastOneMipmap)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(4, 4, GL_RGB);
+        EXPECT_EQ(dropMipmaps(*image, 1), nullptr);
+        ASSERT_TRUE(generateMipmaps(*image));
+        EXPECT_EQ(dropMipmaps(*image, 3), nullptr);
+        ASSERT_NE(dropMipmaps(*image, 2), nullptr);
+        EXPECT_EQ(dropMipmaps(*image, 2)->getTotalSizeInBytesIncludingMipmaps(), 3);
+    }
+}
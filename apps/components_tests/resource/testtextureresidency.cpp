@@ -0,0 +1,99 @@
+#include <components/resource/textureresidency.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+    using namespace testing;
+    using namespace Resource;
+
+    // 256x256 RGBA texture
+    constexpr std::array<std::size_t, 9> levelSizes{ 262144, 65536, 16384, 4096, 1024, 256, 64, 16, 4 };
+
+    TextureResidency makeTexture(unsigned int level, unsigned int wantedLevel, unsigned int lastVisibleFrame)
+    {
+        return TextureResidency{
+            .mLevelSizes = levelSizes,
+            .mLevel = level,
+            .mInitialLevel = 2,
+            .mWantedLevel = wantedLevel,
+            .mLastVisibleFrame = lastVisibleFrame,
+            .mPending = false,
+        };
+    }
+
+    TEST(ResourceTextureResidencyTest, getResidentSizeShouldSumTheLevelAndSmallerOnes)
+    {
+        EXPECT_EQ(getResidentSize(levelSizes, 6), 84);
+        EXPECT_EQ(getResidentSize(levelSizes, 9), 0);
+    }
+
+    TEST(ResourceTextureResidencyTest, getWantedLevelShouldDependOnTexelsPerPixel)
+    {
+        EXPECT_EQ(getWantedLevel(1024, 2048, 11), 0);
+        EXPECT_EQ(getWantedLevel(1024, 1024, 11), 0);
+        EXPECT_EQ(getWantedLevel(1024, 300, 11), 1);
+        EXPECT_EQ(getWantedLevel(1024, 256, 11), 2);
+        EXPECT_EQ(getWantedLevel(1024, 0.1f, 11), 10);
+        EXPECT_EQ(getWantedLevel(1024, 0, 11), 10);
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldUpgradeVisibleTexturesToWantedLevel)
+    {
+        const std::vector<TextureResidency> textures{ makeTexture(2, 0, 10), makeTexture(2, 1, 10),
+            makeTexture(2, 3, 10) };
+
+        EXPECT_THAT(planTextureResidency(textures, 1 << 20, 10, 5),
+            ElementsAre(TextureResidencyChange{ 0, 0 }, TextureResidencyChange{ 1, 1 }));
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldUpgradeToTheFinestLevelFittingInBudget)
+    {
+        const std::vector<TextureResidency> textures{ makeTexture(2, 0, 10) };
+
+        EXPECT_THAT(planTextureResidency(textures, 100000, 10, 5), ElementsAre(TextureResidencyChange{ 0, 1 }));
+        EXPECT_THAT(planTextureResidency(textures, 20000, 10, 5), IsEmpty());
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldUpgradeTexturesMissingMoreLevelsFirst)
+    {
+        const std::vector<TextureResidency> textures{ makeTexture(2, 1, 10), makeTexture(2, 0, 10) };
+
+        EXPECT_THAT(planTextureResidency(textures, 400000, 10, 5), ElementsAre(TextureResidencyChange{ 1, 0 }));
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldReleaseTexturesNotVisibleForReleaseDelay)
+    {
+        const std::vector<TextureResidency> textures{ makeTexture(0, 0, 10), makeTexture(0, 0, 4) };
+
+        EXPECT_THAT(planTextureResidency(textures, 1 << 20, 10, 5), ElementsAre(TextureResidencyChange{ 1, 2 }));
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldReduceLeastRecentlyVisibleTexturesWhenOverBudget)
+    {
+        const std::vector<TextureResidency> textures{ makeTexture(0, 0, 10), makeTexture(0, 0, 9) };
+
+        EXPECT_THAT(planTextureResidency(textures, 400000, 10, 5), ElementsAre(TextureResidencyChange{ 1, 2 }));
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldNotReduceTexturesBelowInitialLevel)
+    {
+        const std::vector<TextureResidency> textures{ makeTexture(2, 2, 10) };
+
+        EXPECT_THAT(planTextureResidency(textures, 0, 10, 5), IsEmpty());
+    }
+
+    TEST(ResourceTextureResidencyTest, shouldIgnorePendingTextures)
+    {
+        std::vector<TextureResidency> textures{ makeTexture(2, 0, 10), makeTexture(0, 0, 0) };
+        textures[0].mPending = true;
+        textures[1].mPending = true;
+
+        EXPECT_THAT(planTextureResidency(textures, 1 << 20, 10, 5), IsEmpty());
+    }
+}
@@ -0,0 +1,110 @@
+#include <components/sceneutil/meshsimplifier.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    // Square grid of size x size quads in the XY plane, with 2 triangles per quad
+    void makeGrid(int size, float (*height)(float, float), std::vector<osg::Vec3f>& vertices,
+        std::vector<unsigned int>& triangles)
+    {
+        for (int y = 0; y <= size; ++y)
+            for (int x = 0; x <= size; ++x)
+                vertices.emplace_back(x, y, height(x, y));
+        const auto index = [&](int x, int y) { return static_cast<unsigned int>(y * (size + 1) + x); };
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                triangles.insert(triangles.end(), { index(x, y), index(x + 1, y), index(x + 1, y + 1) });
+                triangles.insert(triangles.end(), { index(x, y), index(x + 1, y + 1), index(x, y + 1) });
+            }
+        }
+    }
+
+    float getArea(const std::vector<osg::Vec3f>& vertices, const std::vector<unsigned int>& triangles)
+    {
+        float result = 0;
+        for (std::size_t i = 0; i < triangles.size(); i += 3)
+        {
+            const osg::Vec3f a = vertices[triangles[i]];
+            const osg::Vec3f b = vertices[triangles[i + 1]];
+            const osg::Vec3f c = vertices[triangles[i + 2]];
+            result += ((b - a) ^ (c - a)).length() / 2;
+        }
+        return result;
+    }
+
+    TEST(SceneUtilMeshSimplifierTest, shouldReduceFlatGridToFewTrianglesWithoutChangingItsShape)
+    {
+        std::vector<osg::Vec3f> vertices;
+        std::vector<unsigned int> triangles;
+        makeGrid(8, [](float, float) { return 0.f; }, vertices, triangles);
+
+        const std::vector<unsigned int> result = simplifyMesh(vertices, triangles, 0, 0.001f);
+
+        EXPECT_LE(result.size(), 4 * 3u);
+        EXPECT_FLOAT_EQ(getArea(vertices, result), 64);
+    }
+
+    TEST(SceneUtilMeshSimplifierTest, shouldStopAtTargetTriangles)
+    {
+        std::vector<osg::Vec3f> vertices;
+        std::vector<unsigned int> triangles;
+        makeGrid(8, [](float, float) { return 0.f; }, vertices, triangles);
+
+        const std::vector<unsigned int> result = simplifyMesh(vertices, triangles, 100, 0.001f);
+
+        EXPECT_EQ(result.size(), 100 * 3u);
+    }
+
+    TEST(SceneUtilMeshSimplifierTest, shouldNotExceedMaxError)
+    {
+        const std::vector<osg::Vec3f> vertices{
+            osg::Vec3f(1, 0, 0),
+            osg::Vec3f(-1, 0, 0),
+            osg::Vec3f(0, 1, 0),
+            osg::Vec3f(0, -1, 0),
+            osg::Vec3f(0, 0, 1),
+            osg::Vec3f(0, 0, -1),
+        };
+        const std::vector<unsigned int> triangles{
+            0, 2, 4, // +x +y +z
+            2, 1, 4, // -x +y +z
+            1, 3, 4, // -x -y +z
+            3, 0, 4, // +x -y +z
+            2, 0, 5, // +x +y -z
+            1, 2, 5, // -x +y -z
+            3, 1, 5, // -x -y -z
+            0, 3, 5, // +x -y -z
+        };
+
+        const std::vector<unsigned int> result = simplifyMesh(vertices, triangles, 0, 0.1f);
+
+        EXPECT_EQ(result, triangles);
+    }
+
+    TEST(SceneUtilMeshSimplifierTest, shouldOnlyReferenceInputVertices)
+    {
+        std::vector<osg::Vec3f> vertices;
+        std::vector<unsigned int> triangles;
+        makeGrid(8, [](float x, float y) { return std::sin(x) * std::cos(y); }, vertices, triangles);
+
+        const std::vector<unsigned int> result = simplifyMesh(vertices, triangles, 16, 1);
+
+        ASSERT_EQ(result.size() % 3, 0u);
+        EXPECT_LT(result.size(), triangles.size());
+        for (std::size_t i = 0; i < result.size(); i += 3)
+        {
+            EXPECT_LT(result[i], vertices.size());
+            EXPECT_NE(result[i], result[i + 1]);
+            EXPECT_NE(result[i + 1], result[i + 2]);
+            EXPECT_NE(result[i], result[i + 2]);
+        }
+    }
+}
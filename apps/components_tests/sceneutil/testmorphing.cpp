@@ -0,0 +1,77 @@
+#include <components/sceneutil/morphing.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    // Offsets of a morph target moving every step-th vertex
+    std::vector<osg::Vec3f> makeOffsets(std::size_t numVertices, std::size_t step)
+    {
+        std::minstd_rand random;
+        std::uniform_real_distribution<float> distribution(-1, 1);
+
+        std::vector<osg::Vec3f> result(numVertices);
+        for (std::size_t i = 0; i < numVertices; i += step)
+            result[i] = osg::Vec3f(distribution(random), distribution(random), distribution(random));
+        return result;
+    }
+
+    std::vector<osg::Vec3f> makePositions(std::size_t numVertices)
+    {
+        std::vector<osg::Vec3f> result;
+        for (std::size_t i = 0; i < numVertices; ++i)
+            result.emplace_back(static_cast<float>(i), static_cast<float>(i) * 2, static_cast<float>(i) * 3);
+        return result;
+    }
+
+    TEST(SceneUtilMorphingTest, makeMorphTargetOffsetsShouldStoreOnlyNonZeroOffsetsOfSparseTargets)
+    {
+        const std::vector<osg::Vec3f> offsets{ osg::Vec3f(), osg::Vec3f(1, 2, 3), osg::Vec3f(), osg::Vec3f() };
+
+        const MorphTargetOffsets result = makeMorphTargetOffsets(offsets);
+
+        EXPECT_TRUE(result.mSparse);
+        EXPECT_EQ(result.mVertices, std::vector<unsigned int>{ 1 });
+        EXPECT_EQ(result.mOffsets, std::vector<osg::Vec3f>{ osg::Vec3f(1, 2, 3) });
+    }
+
+    TEST(SceneUtilMorphingTest, makeMorphTargetOffsetsShouldKeepAllOffsetsOfDenseTargets)
+    {
+        const std::vector<osg::Vec3f> offsets{ osg::Vec3f(1, 0, 0), osg::Vec3f(), osg::Vec3f(0, 0, 1) };
+
+        const MorphTargetOffsets result = makeMorphTargetOffsets(offsets);
+
+        EXPECT_FALSE(result.mSparse);
+        EXPECT_TRUE(result.mVertices.empty());
+        EXPECT_EQ(result.mOffsets, offsets);
+    }
+
+    TEST(SceneUtilMorphingTest, addMorphOffsetsShouldMatchDenseBlending)
+    {
+        // Sizes not multiple of the SIMD width to cover the remainder of dense targets
+        for (const std::size_t step : { 1, 2, 7 })
+        {
+            const std::vector<osg::Vec3f> offsets = makeOffsets(103, step);
+            const MorphTargetOffsets target = makeMorphTargetOffsets(offsets);
+            const float weight = 0.37f;
+
+            std::vector<osg::Vec3f> expected = makePositions(offsets.size());
+            for (std::size_t i = 0; i < offsets.size(); ++i)
+                expected[i] += offsets[i] * weight;
+
+            std::vector<osg::Vec3f> scalar = makePositions(offsets.size());
+            addMorphOffsetsScalar(target, weight, scalar.data());
+            EXPECT_EQ(scalar, expected) << step;
+
+            std::vector<osg::Vec3f> positions = makePositions(offsets.size());
+            addMorphOffsets(target, weight, positions.data());
+            EXPECT_EQ(positions, expected) << step;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include <components/sceneutil/sharedcull.hpp>
+
+#include <osg/BoundingSphere>
+#include <osg/Matrixd>
+#include <osg/Polytope>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    // Looking along the y axis from the given height, z being up
+    osg::Matrixd makeViewProjection(double height)
+    {
+        const osg::Matrixd view = osg::Matrixd::lookAt(
+            osg::Vec3d(0, 0, height), osg::Vec3d(0, 1, height), osg::Vec3d(0, 0, 1));
+        return view * osg::Matrixd::perspective(60, 1, 1, 100);
+    }
+
+    TEST(SceneUtilSharedCullTest, makeSideFrustumShouldContainBoundInFrontOfView)
+    {
+        osg::Polytope frustum = makeSideFrustum(makeViewProjection(0));
+        EXPECT_TRUE(frustum.contains(osg::BoundingSphere(osg::Vec3f(0, 10, 0), 1)));
+    }
+
+    TEST(SceneUtilSharedCullTest, makeSideFrustumShouldNotContainBoundBehindView)
+    {
+        osg::Polytope frustum = makeSideFrustum(makeViewProjection(0));
+        EXPECT_FALSE(frustum.contains(osg::BoundingSphere(osg::Vec3f(0, -10, 0), 1)));
+    }
+
+    TEST(SceneUtilSharedCullTest, makeSideFrustumShouldNotContainBoundOutsideOfSidePlanes)
+    {
+        osg::Polytope frustum = makeSideFrustum(makeViewProjection(0));
+        EXPECT_FALSE(frustum.contains(osg::BoundingSphere(osg::Vec3f(20, 10, 0), 1)));
+        EXPECT_FALSE(frustum.contains(osg::BoundingSphere(osg::Vec3f(0, 10, 20), 1)));
+    }
+
+    TEST(SceneUtilSharedCullTest, makeSideFrustumShouldIgnoreFarPlane)
+    {
+        osg::Polytope frustum = makeSideFrustum(makeViewProjection(0));
+        EXPECT_TRUE(frustum.contains(osg::BoundingSphere(osg::Vec3f(0, 1000, 0), 1)));
+    }
+
+    TEST(SceneUtilSharedCullTest, makeSideFrustumOfReflectionShouldContainBoundMirroredByWaterPlane)
+    {
+        const osg::Matrixd reflection = osg::Matrixd::scale(1, 1, -1);
+        osg::Polytope frustum = makeSideFrustum(reflection * makeViewProjection(10));
+        EXPECT_TRUE(frustum.contains(osg::BoundingSphere(osg::Vec3f(0, 10, -10), 0.1f)));
+        EXPECT_FALSE(frustum.contains(osg::BoundingSphere(osg::Vec3f(0, 10, 10), 0.1f)));
+    }
+
+    TEST(SceneUtilSharedCullVolumeTest, withoutFrustaShouldContainAnything)
+    {
+        SharedCullVolume volume;
+        EXPECT_TRUE(volume.contains(osg::BoundingSphere(osg::Vec3f(0, -10, 0), 1)));
+    }
+
+    TEST(SceneUtilSharedCullVolumeTest, shouldContainBoundInsideAnyFrustum)
+    {
+        const osg::Matrixd backwards = osg::Matrixd::rotate(osg::PI, osg::Vec3d(0, 0, 1));
+        SharedCullVolume volume({ SharedCullFrustum{ .mViewProjection = makeViewProjection(0) },
+            SharedCullFrustum{ .mViewProjection = backwards * makeViewProjection(0) } });
+        EXPECT_TRUE(volume.contains(osg::BoundingSphere(osg::Vec3f(0, 10, 0), 1)));
+        EXPECT_TRUE(volume.contains(osg::BoundingSphere(osg::Vec3f(0, -10, 0), 1)));
+        EXPECT_FALSE(volume.contains(osg::BoundingSphere(osg::Vec3f(20, 0, 0), 1)));
+    }
+
+    TEST(SceneUtilSharedCullVolumeTest, shouldGrowBoundsByMargin)
+    {
+        SharedCullVolume volume({ SharedCullFrustum{ .mViewProjection = makeViewProjection(0), .mMargin = 20 } });
+        EXPECT_TRUE(volume.contains(osg::BoundingSphere(osg::Vec3f(0, -10, 0), 1)));
+    }
+
+    struct SceneUtilSelectSharedCullItemsTest : Test
+    {
+        SharedCullVolume mVolume{ { SharedCullFrustum{ .mViewProjection = makeViewProjection(0) } } };
+        const osg::BoundingSphere mInside{ osg::Vec3f(0, 10, 0), 1 };
+        const osg::BoundingSphere mOutside{ osg::Vec3f(0, -10, 0), 1 };
+        std::vector<std::size_t> mItems;
+    };
+
+    TEST_F(SceneUtilSelectSharedCullItemsTest, shouldSelectItemsInsideVolume)
+    {
+        const std::vector<SharedCullTreeNode> tree = {
+            { .mBound = mInside, .mEnd = 1, .mItem = 0 },
+            { .mBound = mOutside, .mEnd = 2, .mItem = 1 },
+            { .mBound = mInside, .mEnd = 3, .mItem = 2 },
+        };
+        EXPECT_EQ(selectSharedCullItems(tree, mVolume, mItems), 3);
+        EXPECT_THAT(mItems, ElementsAre(0, 2));
+    }
+
+    TEST_F(SceneUtilSelectSharedCullItemsTest, shouldSkipSubtreeOutsideVolume)
+    {
+        const std::vector<SharedCullTreeNode> tree = {
+            { .mBound = mOutside, .mEnd = 3 },
+            { .mBound = mInside, .mEnd = 2, .mItem = 0 },
+            { .mBound = mInside, .mEnd = 3, .mItem = 1 },
+            { .mBound = mInside, .mEnd = 4, .mItem = 2 },
+        };
+        EXPECT_EQ(selectSharedCullItems(tree, mVolume, mItems), 2);
+        EXPECT_THAT(mItems, ElementsAre(2));
+    }
+
+    TEST_F(SceneUtilSelectSharedCullItemsTest, shouldTestChildrenOfSubtreeInsideVolume)
+    {
+        const std::vector<SharedCullTreeNode> tree = {
+            { .mBound = mInside, .mEnd = 3 },
+            { .mBound = mOutside, .mEnd = 2, .mItem = 0 },
+            { .mBound = mInside, .mEnd = 3, .mItem = 1 },
+        };
+        EXPECT_EQ(selectSharedCullItems(tree, mVolume, mItems), 3);
+        EXPECT_THAT(mItems, ElementsAre(1));
+    }
+
+    TEST_F(SceneUtilSelectSharedCullItemsTest, shouldKeepNodesWithoutBound)
+    {
+        const std::vector<SharedCullTreeNode> tree = {
+            { .mBound = osg::BoundingSphere(), .mEnd = 2 },
+            { .mBound = osg::BoundingSphere(), .mEnd = 2, .mItem = 0 },
+        };
+        EXPECT_EQ(selectSharedCullItems(tree, mVolume, mItems), 0);
+        EXPECT_THAT(mItems, ElementsAre(0));
+    }
+}
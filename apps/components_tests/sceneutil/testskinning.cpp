@@ -0,0 +1,191 @@
+#include <components/sceneutil/skinning.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    struct Mesh
+    {
+        std::vector<osg::Vec3f> mPositions;
+        std::vector<osg::Vec3f> mNormals;
+        std::vector<osg::Vec4f> mTangents;
+        // Vertices skinned with the same matrix, shuffled across the mesh like in real meshes
+        std::vector<std::vector<unsigned short>> mGroups;
+        std::vector<osg::Matrixf> mMatrices;
+    };
+
+    Mesh makeMesh(std::size_t numVertices, std::size_t numGroups)
+    {
+        std::minstd_rand random;
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        const auto vec3 = [&] { return osg::Vec3f(distribution(random), distribution(random), distribution(random)); };
+
+        Mesh result;
+        for (std::size_t i = 0; i < numVertices; ++i)
+        {
+            result.mPositions.push_back(vec3() * 100);
+            result.mNormals.push_back(vec3());
+            result.mTangents.emplace_back(vec3(), distribution(random) < 0 ? -1 : 1);
+        }
+
+        std::vector<unsigned short> vertices(numVertices);
+        for (std::size_t i = 0; i < numVertices; ++i)
+            vertices[i] = static_cast<unsigned short>(i);
+        std::shuffle(vertices.begin(), vertices.end(), random);
+
+        // Groups of all sizes, from single vertices to runs of several vertices
+        result.mGroups.resize(numGroups);
+        std::size_t offset = 0;
+        for (std::size_t i = 0; offset < numVertices; ++i)
+        {
+            const std::size_t size = std::min(i % 13 + 1, numVertices - offset);
+            auto& group = result.mGroups[i % numGroups];
+            group.insert(group.end(), vertices.begin() + offset, vertices.begin() + offset + size);
+            offset += size;
+        }
+
+        for (std::size_t i = 0; i < numGroups; ++i)
+        {
+            osg::Matrixf matrix = osg::Matrixf::rotate(distribution(random) * 3, vec3())
+                * osg::Matrixf::scale(osg::Vec3f(1, 1, 1) + vec3() * 0.1f) * osg::Matrixf::translate(vec3() * 50);
+            result.mMatrices.push_back(matrix);
+        }
+
+        return result;
+    }
+
+    SkinningLayout makeLayout(const Mesh& mesh, bool normals, bool tangents)
+    {
+        SkinningLayout result;
+        for (const auto& group : mesh.mGroups)
+            result.addGroup(group, mesh.mPositions.data(), normals ? mesh.mNormals.data() : nullptr,
+                tangents ? mesh.mTangents.data() : nullptr);
+        return result;
+    }
+
+    TEST(SceneUtilSkinningTest, scalarSkinningShouldTransformEveryVertexByMatrixOfItsGroup)
+    {
+        const Mesh mesh = makeMesh(200, 7);
+        const SkinningLayout layout = makeLayout(mesh, true, true);
+
+        std::vector<osg::Vec3f> positions(mesh.mPositions.size());
+        std::vector<osg::Vec3f> normals(mesh.mNormals.size());
+        std::vector<osg::Vec4f> tangents(mesh.mTangents.size());
+        skinVerticesScalar(layout, mesh.mMatrices, positions.data(), normals.data(), tangents.data());
+
+        for (std::size_t group = 0; group < mesh.mGroups.size(); ++group)
+        {
+            const osg::Matrixf& matrix = mesh.mMatrices[group];
+            for (unsigned short vertex : mesh.mGroups[group])
+            {
+                const osg::Vec4f& tangent = mesh.mTangents[vertex];
+                EXPECT_EQ(positions[vertex], matrix.preMult(mesh.mPositions[vertex])) << vertex;
+                EXPECT_EQ(normals[vertex], osg::Matrixf::transform3x3(mesh.mNormals[vertex], matrix)) << vertex;
+                EXPECT_EQ(tangents[vertex],
+                    osg::Vec4f(osg::Matrixf::transform3x3(osg::Vec3f(tangent.x(), tangent.y(), tangent.z()), matrix),
+                        tangent.w()))
+                    << vertex;
+            }
+        }
+    }
+
+    TEST(SceneUtilSkinningTest, skinningShouldMatchScalarSkinning)
+    {
+        const Mesh mesh = makeMesh(1000, 23);
+        const SkinningLayout layout = makeLayout(mesh, true, true);
+
+        std::vector<osg::Vec3f> expectedPositions(mesh.mPositions.size());
+        std::vector<osg::Vec3f> expectedNormals(mesh.mNormals.size());
+        std::vector<osg::Vec4f> expectedTangents(mesh.mTangents.size());
+        skinVerticesScalar(layout, mesh.mMatrices, expectedPositions.data(), expectedNormals.data(),
+            expectedTangents.data());
+
+        std::vector<osg::Vec3f> positions(mesh.mPositions.size());
+        std::vector<osg::Vec3f> normals(mesh.mNormals.size());
+        std::vector<osg::Vec4f> tangents(mesh.mTangents.size());
+        skinVertices(layout, mesh.mMatrices, positions.data(), normals.data(), tangents.data());
+
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                EXPECT_FLOAT_EQ(positions[i][j], expectedPositions[i][j]) << i << ' ' << j;
+                EXPECT_FLOAT_EQ(normals[i][j], expectedNormals[i][j]) << i << ' ' << j;
+            }
+            for (int j = 0; j < 4; ++j)
+                EXPECT_FLOAT_EQ(tangents[i][j], expectedTangents[i][j]) << i << ' ' << j;
+        }
+    }
+
+    TEST(SceneUtilSkinningTest, skinningShouldIgnoreDestinationOfComponentsMissingInLayout)
+    {
+        const Mesh mesh = makeMesh(50, 3);
+        const SkinningLayout layout = makeLayout(mesh, false, false);
+
+        std::vector<osg::Vec3f> expectedPositions(mesh.mPositions.size());
+        skinVerticesScalar(layout, mesh.mMatrices, expectedPositions.data(), nullptr, nullptr);
+
+        std::vector<osg::Vec3f> positions(mesh.mPositions.size());
+        std::vector<osg::Vec3f> normals(mesh.mNormals.size(), osg::Vec3f(1, 2, 3));
+        skinVertices(layout, mesh.mMatrices, positions.data(), normals.data(), nullptr);
+
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                EXPECT_FLOAT_EQ(positions[i][j], expectedPositions[i][j]) << i << ' ' << j;
+            EXPECT_EQ(normals[i], osg::Vec3f(1, 2, 3)) << i;
+        }
+    }
+
+    TEST(SceneUtilSkinningTest, makeGpuSkinningInfluencesShouldSetBonesAndWeightsOfEveryVertex)
+    {
+        const std::vector<SkinningInfluenceGroup> groups{
+            { { { 3, 1.0f } }, { 0, 2 } },
+            { { { 1, 0.25f }, { 5, 0.75f } }, { 1 } },
+        };
+
+        const std::optional<GpuSkinningInfluences> result = makeGpuSkinningInfluences(3, groups);
+
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result->mBoneIndices,
+            (std::vector<osg::Vec4f>{ osg::Vec4f(3, 0, 0, 0), osg::Vec4f(1, 5, 0, 0), osg::Vec4f(3, 0, 0, 0) }));
+        EXPECT_EQ(result->mBoneWeights,
+            (std::vector<osg::Vec4f>{
+                osg::Vec4f(1, 0, 0, 0), osg::Vec4f(0.25f, 0.75f, 0, 0), osg::Vec4f(1, 0, 0, 0) }));
+    }
+
+    TEST(SceneUtilSkinningTest, makeGpuSkinningInfluencesShouldFailForVertexWithTooManyBones)
+    {
+        const std::vector<SkinningInfluenceGroup> groups{
+            { { { 0, 0.2f }, { 1, 0.2f }, { 2, 0.2f }, { 3, 0.2f }, { 4, 0.2f } }, { 0 } },
+        };
+
+        EXPECT_EQ(makeGpuSkinningInfluences(1, groups), std::nullopt);
+    }
+
+    TEST(SceneUtilSkinningTest, makeGpuSkinningInfluencesShouldFailForBoneOutsidePalette)
+    {
+        const std::vector<SkinningInfluenceGroup> groups{
+            { { { maxGpuSkinningBones, 1.0f } }, { 0 } },
+        };
+
+        EXPECT_EQ(makeGpuSkinningInfluences(1, groups), std::nullopt);
+    }
+
+    TEST(SceneUtilSkinningTest, makeGpuSkinningInfluencesShouldFailForVertexWithoutBones)
+    {
+        const std::vector<SkinningInfluenceGroup> groups{
+            { { { 0, 1.0f } }, { 0 } },
+        };
+
+        EXPECT_EQ(makeGpuSkinningInfluences(2, groups), std::nullopt);
+    }
+}
@@ -0,0 +1,62 @@
+#include <components/sceneutil/uploadbudget.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    TEST(SceneUtilUploadBudgetTest, getAvailableUploadTimeShouldUseTimeLeftToTargetFrameTime)
+    {
+        EXPECT_DOUBLE_EQ(getAvailableUploadTime(50, 0.01, 0.5, 0.001), 0.005);
+    }
+
+    TEST(SceneUtilUploadBudgetTest, getAvailableUploadTimeShouldNotBeLowerThanMinimum)
+    {
+        EXPECT_DOUBLE_EQ(getAvailableUploadTime(50, 0.03, 0.5, 0.001), 0.001);
+        EXPECT_DOUBLE_EQ(getAvailableUploadTime(0, 0, 0.5, 0.001), 0.001);
+    }
+
+    TEST(SceneUtilUploadBudgetTest, shouldGiveNothingWithoutPendingWork)
+    {
+        const std::vector<UploadQueue> queues{ UploadQueue{ .mShare = 0.5, .mPriority = 0, .mPending = false } };
+
+        EXPECT_THAT(planUploadBudget(queues, 1), ElementsAre(0.0));
+    }
+
+    TEST(SceneUtilUploadBudgetTest, shouldGiveSharesAndRestToHighestPriority)
+    {
+        const std::vector<UploadQueue> queues{
+            UploadQueue{ .mShare = 0.25, .mPriority = 2, .mPending = true },
+            UploadQueue{ .mShare = 0.25, .mPriority = 1, .mPending = true },
+            UploadQueue{ .mShare = 0.25, .mPriority = 0, .mPending = false },
+        };
+
+        EXPECT_THAT(planUploadBudget(queues, 1), ElementsAre(0.25, 0.75, 0.0));
+    }
+
+    TEST(SceneUtilUploadBudgetTest, shouldScaleSharesAddingUpToMoreThanAvailable)
+    {
+        const std::vector<UploadQueue> queues{
+            UploadQueue{ .mShare = 1, .mPriority = 0, .mPending = true },
+            UploadQueue{ .mShare = 3, .mPriority = 1, .mPending = true },
+        };
+
+        EXPECT_THAT(planUploadBudget(queues, 2), ElementsAre(0.5, 1.5));
+    }
+
+    TEST(SceneUtilUploadBudgetTest, getUploadOrderShouldSortByPriorityKeepingOrderOfEqualOnes)
+    {
+        const std::vector<UploadQueue> queues{
+            UploadQueue{ .mShare = 0, .mPriority = 1, .mPending = false },
+            UploadQueue{ .mShare = 0, .mPriority = 0, .mPending = false },
+            UploadQueue{ .mShare = 0, .mPriority = 1, .mPending = false },
+        };
+
+        EXPECT_THAT(getUploadOrder(queues), ElementsAre(1, 0, 2));
+    }
+}
@@ -0,0 +1,122 @@
+#include <components/shader/programmanifest.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <sstream>
+
+namespace
+{
+    using namespace testing;
+    using namespace Shader;
+
+    ProgramPermutation makePermutation()
+    {
+        return ProgramPermutation{
+            .mTemplateName = "objects",
+            .mDefines = { { "alphaFunc", "0" }, { "empty", "" }, { "spaces", "a b  c" } },
+            .mAttribLocations = { { "aBoneIndices", 6 } },
+            .mUniformBlockBindings = { { "LightBufferBinding", 1 } },
+        };
+    }
+
+    TEST(ShaderProgramManifestTest, shouldReadWrittenPermutations)
+    {
+        std::set<ProgramPermutation> permutations{ makePermutation(), ProgramPermutation{ .mTemplateName = "sky" } };
+        std::stringstream stream;
+        writeProgramManifest(permutations, stream);
+        EXPECT_EQ(readProgramManifest(stream), permutations);
+    }
+
+    TEST(ShaderProgramManifestTest, shouldWriteOneLinePerDefineAndBinding)
+    {
+        std::stringstream stream;
+        writeProgramManifest({ makePermutation() }, stream);
+        EXPECT_EQ(stream.str(),
+            "program objects\n"
+            "define alphaFunc 0\n"
+            "define empty \n"
+            "define spaces a b  c\n"
+            "attrib aBoneIndices 6\n"
+            "block LightBufferBinding 1\n"
+            "end\n");
+    }
+
+    TEST(ShaderProgramManifestTest, shouldWriteUsesAsComments)
+    {
+        const ProgramPermutation sky{ .mTemplateName = "sky" };
+        const ProgramPermutation water{ .mTemplateName = "water" };
+        std::stringstream stream;
+        writeProgramManifest({ sky, water }, stream, { { water, 3 } });
+        EXPECT_EQ(stream.str(),
+            "program sky\n"
+            "end\n"
+            "# uses 3\n"
+            "program water\n"
+            "end\n");
+        EXPECT_THAT(readProgramManifest(stream), ElementsAre(sky, water));
+    }
+
+    TEST(ShaderProgramManifestTest, shouldReadWrittenUnusedSessions)
+    {
+        const ProgramPermutation sky{ .mTemplateName = "sky" };
+        const ProgramPermutation water{ .mTemplateName = "water" };
+        std::stringstream stream;
+        writeProgramManifest({ sky, water }, stream, {}, { { sky, 0 }, { water, 2 } });
+        EXPECT_EQ(stream.str(),
+            "program sky\n"
+            "end\n"
+            "program water\n"
+            "unused 2\n"
+            "end\n");
+        std::map<ProgramPermutation, unsigned int> unusedSessions;
+        EXPECT_THAT(readProgramManifest(stream, &unusedSessions), ElementsAre(sky, water));
+        EXPECT_THAT(unusedSessions, ElementsAre(Pair(water, 2u)));
+    }
+
+    TEST(ShaderProgramManifestTest, shouldSkipPermutationsWithMalformedUnusedSessions)
+    {
+        std::stringstream stream(
+            "program water\n"
+            "unused x\n"
+            "end\n"
+            "program sky\n"
+            "unused 1 2\n"
+            "end\n"
+            "program objects\n"
+            "unused 3\n"
+            "end\n");
+        std::map<ProgramPermutation, unsigned int> unusedSessions;
+        const ProgramPermutation objects{ .mTemplateName = "objects" };
+        EXPECT_THAT(readProgramManifest(stream, &unusedSessions), ElementsAre(objects));
+        EXPECT_THAT(unusedSessions, ElementsAre(Pair(objects, 3u)));
+    }
+
+    TEST(ShaderProgramManifestTest, shouldNotWritePermutationsWithNewLines)
+    {
+        ProgramPermutation permutation = makePermutation();
+        permutation.mDefines["multiline"] = "a\nb";
+        std::stringstream stream;
+        writeProgramManifest({ permutation }, stream);
+        EXPECT_EQ(stream.str(), "");
+    }
+
+    TEST(ShaderProgramManifestTest, shouldSkipCommentsAndMalformedPermutations)
+    {
+        std::stringstream stream(
+            "# comment\n"
+            "program water\n"
+            "attrib aPosition x\n"
+            "end\n"
+            "program objects\n"
+            "unknown keyword\n"
+            "end\n"
+            "program sky\n"
+            "define a 1\n"
+            "end\n"
+            "program truncated\n");
+        EXPECT_THAT(readProgramManifest(stream),
+            ElementsAre(ProgramPermutation{ .mTemplateName = "sky", .mDefines = { { "a", "1" } } }));
+    }
+}
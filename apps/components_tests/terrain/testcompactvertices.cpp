@@ -0,0 +1,107 @@
+#include <components/terrain/compactvertices.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+
+namespace
+{
+    using namespace Terrain;
+
+    constexpr std::size_t numVerts = 17;
+    constexpr float extent = 8192;
+
+    // Grid laid out like BufferCache::getUVBuffer with the positions of ESMTerrain::Storage::fillVertexBuffers
+    struct Chunk
+    {
+        osg::ref_ptr<osg::Vec3Array> mPositions = new osg::Vec3Array;
+        osg::ref_ptr<osg::Vec3Array> mNormals = new osg::Vec3Array;
+        osg::ref_ptr<osg::Vec2Array> mUvs = new osg::Vec2Array;
+    };
+
+    template <class GenerateHeight>
+    Chunk makeChunk(GenerateHeight&& generateHeight)
+    {
+        std::minstd_rand random;
+        std::uniform_real_distribution<float> distribution(-1, 1);
+
+        Chunk result;
+        for (std::size_t col = 0; col < numVerts; ++col)
+        {
+            for (std::size_t row = 0; row < numVerts; ++row)
+            {
+                result.mPositions->push_back(osg::Vec3f((col / static_cast<float>(numVerts - 1) - 0.5f) * extent,
+                    (row / static_cast<float>(numVerts - 1) - 0.5f) * extent, generateHeight(random)));
+                osg::Vec3f normal(distribution(random), distribution(random), distribution(random) + 1.5f);
+                normal.normalize();
+                result.mNormals->push_back(normal);
+                result.mUvs->push_back(osg::Vec2f(col / static_cast<float>(numVerts - 1),
+                    (numVerts - 1 - row) / static_cast<float>(numVerts - 1)));
+            }
+        }
+        return result;
+    }
+
+    TEST(TerrainCompactVerticesTest, shouldStoreHeightsOfVanillaLandExactly)
+    {
+        // Vanilla heights are sums of 8-bit deltas scaled by 8
+        std::uniform_int_distribution<int> distribution(-2048, 4096);
+        const Chunk chunk = makeChunk([&](std::minstd_rand& random) { return distribution(random) * 8.f; });
+
+        const CompactVertices compact = makeCompactVertices(*chunk.mPositions, *chunk.mNormals, extent);
+
+        ASSERT_EQ(compact.mVertices->size(), chunk.mPositions->size());
+        for (std::size_t i = 0; i < chunk.mPositions->size(); ++i)
+            EXPECT_EQ(decodeCompactHeight(compact, i), (*chunk.mPositions)[i].z()) << i;
+    }
+
+    TEST(TerrainCompactVerticesTest, shouldStoreHeightsWithinHalfAStep)
+    {
+        for (const float range : { 100.f, 8000.f, 50000.f })
+        {
+            std::uniform_real_distribution<float> distribution(-range / 2, range / 2);
+            const Chunk chunk = makeChunk([&](std::minstd_rand& random) { return distribution(random); });
+
+            const CompactVertices compact = makeCompactVertices(*chunk.mPositions, *chunk.mNormals, extent);
+
+            EXPECT_GE(compact.mHeightStep, 0.125f) << range;
+            EXPECT_LE(compact.mHeightStep, std::max(0.125f, range / 65535 * 2)) << range;
+            for (std::size_t i = 0; i < chunk.mPositions->size(); ++i)
+                EXPECT_NEAR(decodeCompactHeight(compact, i), (*chunk.mPositions)[i].z(), compact.mHeightStep / 2)
+                    << range << " " << i;
+        }
+    }
+
+    TEST(TerrainCompactVerticesTest, decodeCompactPositionsShouldMatchPositions)
+    {
+        std::uniform_real_distribution<float> distribution(-1000, 3000);
+        const Chunk chunk = makeChunk([&](std::minstd_rand& random) { return distribution(random); });
+
+        const CompactVertices compact = makeCompactVertices(*chunk.mPositions, *chunk.mNormals, extent);
+        const osg::ref_ptr<osg::Vec3Array> positions = decodeCompactPositions(compact, *chunk.mUvs);
+
+        ASSERT_EQ(positions->size(), chunk.mPositions->size());
+        for (std::size_t i = 0; i < positions->size(); ++i)
+        {
+            EXPECT_NEAR((*positions)[i].x(), (*chunk.mPositions)[i].x(), 1e-3f) << i;
+            EXPECT_NEAR((*positions)[i].y(), (*chunk.mPositions)[i].y(), 1e-3f) << i;
+            EXPECT_NEAR((*positions)[i].z(), (*chunk.mPositions)[i].z(), compact.mHeightStep / 2) << i;
+        }
+    }
+
+    TEST(TerrainCompactVerticesTest, octahedralNormalsShouldBeCloseToOriginal)
+    {
+        const Chunk chunk = makeChunk([](std::minstd_rand&) { return 0.f; });
+
+        for (osg::Vec3f normal : *chunk.mNormals)
+        {
+            const osg::Vec3f decoded = decodeOctahedralNormal(encodeOctahedralNormal(normal));
+            EXPECT_NEAR(decoded * normal, 1.f, 1e-6f);
+            // Downwards normals are folded over the octahedron
+            normal.z() = -normal.z();
+            EXPECT_NEAR(decodeOctahedralNormal(encodeOctahedralNormal(normal)) * normal, 1.f, 1e-6f);
+        }
+    }
+}
@@ -267,6 +267,9 @@ bool Launcher::SettingsPage::loadSettings()
             case SceneUtil::LightingMethod::SingleUBO:
                 lightingMethod = 2;
                 break;
+            case SceneUtil::LightingMethod::Clustered:
+                lightingMethod = 3;
+                break;
         }
         lightingMethodComboBox->setCurrentIndex(lightingMethod);
     }
@@ -418,10 +421,11 @@ void Launcher::SettingsPage::saveSettings()
         saveSettingBool(*skyBlendingCheckBox, Settings::fog().mSkyBlending);
         Settings::fog().mSkyBlendingStart.set(skyBlendingStartComboBox->value());
 
-        static constexpr std::array<SceneUtil::LightingMethod, 3> lightingMethodMap = {
+        static constexpr std::array<SceneUtil::LightingMethod, 4> lightingMethodMap = {
             SceneUtil::LightingMethod::FFP,
             SceneUtil::LightingMethod::PerObjectUniform,
             SceneUtil::LightingMethod::SingleUBO,
+            SceneUtil::LightingMethod::Clustered,
         };
         Settings::shaders().mLightingMethod.set(lightingMethodMap[lightingMethodComboBox->currentIndex()]);
 
@@ -0,0 +1,418 @@
+#include "lod.hpp"
+
+#include <components/debug/debuglog.hpp>
+#include <components/esmloader/esmdata.hpp>
+#include <components/misc/pathhelpers.hpp>
+#include <components/misc/resourcehelpers.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/meshsimplifier.hpp>
+#include <components/sceneutil/texturetype.hpp>
+#include <components/sceneutil/writescene.hpp>
+#include <components/vfs/manager.hpp>
+#include <components/vfs/pathutil.hpp>
+
+#include <osg/Geometry>
+#include <osg/LOD>
+#include <osg/Sequence>
+#include <osg/Switch>
+#include <osg/Texture>
+#include <osg/TriangleIndexFunctor>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace LodTool
+{
+    namespace
+    {
+        struct CollectTriangles
+        {
+            std::vector<unsigned int>* mTriangles;
+            unsigned int mBaseVertex;
+
+            void operator()(unsigned int v1, unsigned int v2, unsigned int v3)
+            {
+                mTriangles->insert(mTriangles->end(), { mBaseVertex + v1, mBaseVertex + v2, mBaseVertex + v3 });
+            }
+        };
+
+        /// Geometry of a model sharing the same state and vertex layout, in the model's coordinates.
+        struct Batch
+        {
+            osg::ref_ptr<osg::StateSet> mStateSet;
+            std::vector<osg::Vec3f> mVertices;
+            std::vector<osg::Vec3f> mNormals;
+            std::vector<osg::Vec4f> mColors;
+            std::map<unsigned int, std::vector<osg::Vec2f>> mTexCoords;
+            std::vector<unsigned int> mTriangles;
+        };
+
+        // Statesets along the path of a drawable, and the texture units and arrays it uses
+        using BatchKey = std::tuple<std::vector<const osg::StateSet*>, bool, bool, std::vector<unsigned int>>;
+
+        /// Flattens the parts of a model visible from close by into batches, the way object paging would draw it.
+        class CollectBatchesVisitor : public osg::NodeVisitor
+        {
+        public:
+            CollectBatchesVisitor()
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            {
+                mMatrices.emplace_back();
+            }
+
+            void apply(osg::Node& node) override
+            {
+                pushStateSet(node.getStateSet());
+                traverse(node);
+                popStateSet(node.getStateSet());
+            }
+
+            void apply(osg::Transform& transform) override
+            {
+                osg::Matrix matrix = mMatrices.back();
+                transform.computeLocalToWorldMatrix(matrix, this);
+                mMatrices.push_back(matrix);
+                pushStateSet(transform.getStateSet());
+                traverse(transform);
+                popStateSet(transform.getStateSet());
+                mMatrices.pop_back();
+            }
+
+            void apply(osg::LOD& lod) override
+            {
+                // Only the most detailed child is simplified, coarser ones are what the generated levels replace
+                if (lod.getNumChildren() == 0)
+                    return;
+                unsigned int best = 0;
+                for (unsigned int i = 1; i < std::min(lod.getNumChildren(), lod.getNumRanges()); ++i)
+                    if (lod.getMinRange(i) < lod.getMinRange(best))
+                        best = i;
+                pushStateSet(lod.getStateSet());
+                lod.getChild(best)->accept(*this);
+                popStateSet(lod.getStateSet());
+            }
+
+            void apply(osg::Switch& node) override
+            {
+                pushStateSet(node.getStateSet());
+                for (unsigned int i = 0; i < node.getNumChildren(); ++i)
+                    if (node.getValue(i))
+                        node.getChild(i)->accept(*this);
+                popStateSet(node.getStateSet());
+            }
+
+            void apply(osg::Sequence& node) override
+            {
+                pushStateSet(node.getStateSet());
+                if (node.getNumChildren() > 0)
+                    node.getChild(0)->accept(*this);
+                popStateSet(node.getStateSet());
+            }
+
+            void apply(osg::Drawable& drawable) override
+            {
+                // Skinned, morphed and particle drawables are not static, so they are left out
+                osg::Geometry* geometry = drawable.asGeometry();
+                if (geometry == nullptr || std::string_view(geometry->className()) != "Geometry")
+                    return;
+                const osg::Vec3Array* vertices = dynamic_cast<const osg::Vec3Array*>(geometry->getVertexArray());
+                if (vertices == nullptr || vertices->empty())
+                    return;
+
+                const osg::Vec3Array* normals = dynamic_cast<const osg::Vec3Array*>(geometry->getNormalArray());
+                if (normals != nullptr
+                    && (normals->getBinding() != osg::Array::BIND_PER_VERTEX || normals->size() != vertices->size()))
+                    normals = nullptr;
+                const osg::Vec4Array* colors = dynamic_cast<const osg::Vec4Array*>(geometry->getColorArray());
+                if (colors != nullptr
+                    && (colors->getBinding() != osg::Array::BIND_PER_VERTEX || colors->size() != vertices->size()))
+                    colors = nullptr;
+                std::vector<unsigned int> units;
+                for (unsigned int unit = 0; unit < geometry->getNumTexCoordArrays(); ++unit)
+                {
+                    const osg::Vec2Array* texCoords
+                        = dynamic_cast<const osg::Vec2Array*>(geometry->getTexCoordArray(unit));
+                    if (texCoords != nullptr && texCoords->size() == vertices->size())
+                        units.push_back(unit);
+                }
+
+                pushStateSet(geometry->getStateSet());
+                BatchKey key{ mStateSets, normals != nullptr, colors != nullptr, units };
+                auto found = mBatchIndices.find(key);
+                if (found == mBatchIndices.end())
+                {
+                    found = mBatchIndices.emplace(std::move(key), mBatches.size()).first;
+                    mBatches.emplace_back().mStateSet = makeStateSet(mStateSets);
+                }
+                popStateSet(geometry->getStateSet());
+
+                Batch& batch = mBatches[found->second];
+                const osg::Matrix& matrix = mMatrices.back();
+                const osg::Matrix normalMatrix = osg::Matrix::inverse(matrix);
+                const unsigned int baseVertex = static_cast<unsigned int>(batch.mVertices.size());
+                for (std::size_t i = 0; i < vertices->size(); ++i)
+                {
+                    batch.mVertices.push_back((*vertices)[i] * matrix);
+                    if (normals != nullptr)
+                    {
+                        // Normals are transformed by the inverse transpose
+                        osg::Vec3f normal = osg::Matrix::transform3x3(normalMatrix, (*normals)[i]);
+                        normal.normalize();
+                        batch.mNormals.push_back(normal);
+                    }
+                    if (colors != nullptr)
+                        batch.mColors.push_back((*colors)[i]);
+                }
+                for (unsigned int unit : units)
+                {
+                    const osg::Vec2Array& texCoords
+                        = static_cast<const osg::Vec2Array&>(*geometry->getTexCoordArray(unit));
+                    std::vector<osg::Vec2f>& out = batch.mTexCoords[unit];
+                    out.insert(out.end(), texCoords.begin(), texCoords.end());
+                }
+
+                osg::TriangleIndexFunctor<CollectTriangles> functor;
+                functor.mTriangles = &batch.mTriangles;
+                functor.mBaseVertex = baseVertex;
+                geometry->accept(functor);
+            }
+
+            std::vector<Batch>& getBatches() { return mBatches; }
+
+        private:
+            std::vector<osg::Matrix> mMatrices;
+            std::vector<const osg::StateSet*> mStateSets;
+            std::map<BatchKey, std::size_t> mBatchIndices;
+            std::vector<Batch> mBatches;
+
+            void pushStateSet(const osg::StateSet* stateSet)
+            {
+                if (stateSet != nullptr)
+                    mStateSets.push_back(stateSet);
+            }
+
+            void popStateSet(const osg::StateSet* stateSet)
+            {
+                if (stateSet != nullptr)
+                    mStateSets.pop_back();
+            }
+
+            static osg::ref_ptr<osg::StateSet> makeStateSet(const std::vector<const osg::StateSet*>& stateSets)
+            {
+                osg::ref_ptr<osg::StateSet> result = new osg::StateSet;
+                for (const osg::StateSet* stateSet : stateSets)
+                {
+                    // State replaced by shaders is kept aside by Shader::ShaderVisitor
+                    if (const osg::UserDataContainer* userData = stateSet->getUserDataContainer())
+                        if (const osg::Object* removed = userData->getUserObject("removedState"))
+                            if (const osg::StateSet* removedState = dynamic_cast<const osg::StateSet*>(removed))
+                                result->merge(*removedState);
+                    result->merge(*stateSet);
+                }
+
+                // Shaders are generated again when the level is loaded
+                result->removeAttribute(osg::StateAttribute::PROGRAM);
+                result->setUniformList(osg::StateSet::UniformList());
+                result->setDefineList(osg::StateSet::DefineList());
+
+                // The type of a texture is stored in its name instead, to only need serializers of OSG itself
+                for (unsigned int unit = 0; unit < result->getTextureAttributeList().size(); ++unit)
+                {
+                    const auto* type = static_cast<const SceneUtil::TextureType*>(
+                        result->getTextureAttribute(unit, SceneUtil::TextureType::AttributeType));
+                    if (type == nullptr)
+                        continue;
+                    const std::string name = type->getName();
+                    result->removeTextureAttribute(unit, SceneUtil::TextureType::AttributeType);
+                    const osg::StateSet::RefAttributePair* texture
+                        = result->getTextureAttributePair(unit, osg::StateAttribute::TEXTURE);
+                    if (texture == nullptr)
+                        continue;
+                    osg::ref_ptr<osg::StateAttribute> renamed
+                        = static_cast<osg::StateAttribute*>(texture->first->clone(osg::CopyOp::SHALLOW_COPY));
+                    renamed->setName(name);
+                    result->setTextureAttribute(unit, renamed, texture->second);
+                }
+                return result;
+            }
+        };
+
+        std::size_t countTriangles(const std::vector<std::vector<unsigned int>>& triangles)
+        {
+            std::size_t result = 0;
+            for (const std::vector<unsigned int>& batchTriangles : triangles)
+                result += batchTriangles.size() / 3;
+            return result;
+        }
+
+        osg::ref_ptr<osg::Geometry> makeGeometry(const Batch& batch, const std::vector<unsigned int>& triangles)
+        {
+            // Only vertices still referenced by a triangle are kept
+            std::vector<unsigned int> remap(batch.mVertices.size(), std::numeric_limits<unsigned int>::max());
+            std::vector<unsigned int> used;
+            for (unsigned int vertex : triangles)
+            {
+                if (remap[vertex] != std::numeric_limits<unsigned int>::max())
+                    continue;
+                remap[vertex] = static_cast<unsigned int>(used.size());
+                used.push_back(vertex);
+            }
+
+            osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+            geometry->setStateSet(batch.mStateSet);
+
+            osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+            vertices->reserve(used.size());
+            for (unsigned int vertex : used)
+                vertices->push_back(batch.mVertices[vertex]);
+            geometry->setVertexArray(vertices);
+
+            if (!batch.mNormals.empty())
+            {
+                osg::ref_ptr<osg::Vec3Array> normals = new osg::Vec3Array;
+                normals->reserve(used.size());
+                for (unsigned int vertex : used)
+                    normals->push_back(batch.mNormals[vertex]);
+                geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
+            }
+
+            if (!batch.mColors.empty())
+            {
+                osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array;
+                colors->reserve(used.size());
+                for (unsigned int vertex : used)
+                    colors->push_back(batch.mColors[vertex]);
+                geometry->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
+            }
+
+            for (const auto& [unit, batchTexCoords] : batch.mTexCoords)
+            {
+                osg::ref_ptr<osg::Vec2Array> texCoords = new osg::Vec2Array;
+                texCoords->reserve(used.size());
+                for (unsigned int vertex : used)
+                    texCoords->push_back(batchTexCoords[vertex]);
+                geometry->setTexCoordArray(unit, texCoords, osg::Array::BIND_PER_VERTEX);
+            }
+
+            if (used.size() <= std::numeric_limits<unsigned short>::max())
+            {
+                osg::ref_ptr<osg::DrawElementsUShort> elements = new osg::DrawElementsUShort(GL_TRIANGLES);
+                elements->reserve(triangles.size());
+                for (unsigned int vertex : triangles)
+                    elements->push_back(static_cast<unsigned short>(remap[vertex]));
+                geometry->addPrimitiveSet(elements);
+            }
+            else
+            {
+                osg::ref_ptr<osg::DrawElementsUInt> elements = new osg::DrawElementsUInt(GL_TRIANGLES);
+                elements->reserve(triangles.size());
+                for (unsigned int vertex : triangles)
+                    elements->push_back(remap[vertex]);
+                geometry->addPrimitiveSet(elements);
+            }
+
+            return geometry;
+        }
+    }
+
+    std::vector<std::string> collectModels(const EsmLoader::EsmData& esmData)
+    {
+        // Containers are only paged within the active grid, where the original models are used
+        std::set<std::string> models;
+        const auto add = [&](const std::string& model) {
+            if (!model.empty())
+                models.insert(VFS::Path::normalizeFilename(Misc::ResourceHelpers::correctMeshPath(model)));
+        };
+        for (const ESM::Static& record : esmData.mStatics)
+            add(record.mModel);
+        for (const ESM::Activator& record : esmData.mActivators)
+            add(record.mModel);
+        for (const ESM::Door& record : esmData.mDoors)
+            add(record.mModel);
+        return std::vector<std::string>(models.begin(), models.end());
+    }
+
+    std::string makeLodPath(
+        std::string_view model, std::string_view suffix, std::size_t level, std::string_view extension)
+    {
+        std::string result(model.substr(0, Misc::findExtension(model)));
+        result += suffix;
+        result += '_';
+        result += std::to_string(level);
+        result += '.';
+        result += extension;
+        return result;
+    }
+
+    bool hasLod(const VFS::Manager& vfs, std::string_view model, std::string_view suffix, std::size_t levels)
+    {
+        const std::string_view stem = model.substr(0, Misc::findExtension(model));
+        for (const std::string_view extension : { Misc::getFileExtension(model), std::string_view("osgb") })
+        {
+            std::string path(stem);
+            path += suffix;
+            path += '.';
+            path += extension;
+            if (vfs.exists(VFS::Path::Normalized(path)))
+                return true;
+            for (std::size_t level = 0; level < levels; ++level)
+                if (vfs.exists(VFS::Path::Normalized(makeLodPath(model, suffix, level, extension))))
+                    return true;
+        }
+        return false;
+    }
+
+    std::size_t generateLods(Resource::SceneManager& sceneManager, const std::string& model,
+        const LodSettings& settings, const std::filesystem::path& output)
+    {
+        osg::ref_ptr<const osg::Node> node = sceneManager.getTemplate(model, false);
+        CollectBatchesVisitor visitor;
+        const_cast<osg::Node*>(node.get())->accept(visitor);
+        std::vector<Batch>& batches = visitor.getBatches();
+
+        std::vector<std::vector<unsigned int>> triangles;
+        for (const Batch& batch : batches)
+            triangles.push_back(batch.mTriangles);
+
+        std::size_t numTriangles = countTriangles(triangles);
+        if (numTriangles < settings.mMinTriangles)
+            return 0;
+
+        const float radius = node->getBound().valid() ? node->getBound().radius() : 0.f;
+        float maxError = settings.mMaxError * radius;
+        std::size_t numLevels = 0;
+        for (; numLevels < settings.mLevels; ++numLevels)
+        {
+            // Every level starts from the previous one, so errors add up the way they do for the original
+            for (std::size_t i = 0; i < batches.size(); ++i)
+            {
+                const std::size_t target = static_cast<std::size_t>(triangles[i].size() / 3 * settings.mRatio);
+                triangles[i] = SceneUtil::simplifyMesh(batches[i].mVertices, triangles[i], target, maxError);
+            }
+
+            const std::size_t simplifiedTriangles = countTriangles(triangles);
+            // A level which barely differs from the previous one only costs memory
+            if (simplifiedTriangles == 0 || simplifiedTriangles > numTriangles * (1 + settings.mRatio) / 2)
+                break;
+            numTriangles = simplifiedTriangles;
+
+            osg::ref_ptr<osg::Group> group = new osg::Group;
+            for (std::size_t i = 0; i < batches.size(); ++i)
+                if (!triangles[i].empty())
+                    group->addChild(makeGeometry(batches[i], triangles[i]));
+
+            const std::filesystem::path path = output / makeLodPath(model, settings.mSuffix, numLevels, "osgb");
+            std::filesystem::create_directories(path.parent_path());
+            SceneUtil::writeScene(group, path, "Binary");
+
+            Log(Debug::Verbose) << "Written " << path << " with " << numTriangles << " triangles";
+
+            maxError *= 2;
+        }
+        return numLevels;
+    }
+}
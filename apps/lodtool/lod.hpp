@@ -0,0 +1,55 @@
+#ifndef OPENMW_LODTOOL_LOD_H
+#define OPENMW_LODTOOL_LOD_H
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace EsmLoader
+{
+    struct EsmData;
+}
+
+namespace Resource
+{
+    class SceneManager;
+}
+
+namespace VFS
+{
+    class Manager;
+}
+
+namespace LodTool
+{
+    struct LodSettings
+    {
+        // Inserted before the extension of the model, as expected by Misc::ResourceHelpers::getLODMeshName
+        std::string mSuffix;
+        std::size_t mLevels;
+        // Fraction of the triangles of the previous level kept by every level
+        float mRatio;
+        // Largest deviation from the original model at the first level, relative to its radius
+        float mMaxError;
+        std::size_t mMinTriangles;
+    };
+
+    /// @return Normalized paths of the models of all records object paging draws at a distance.
+    std::vector<std::string> collectModels(const EsmLoader::EsmData& esmData);
+
+    /// @return The path of the given level of detail of a model, relative to a data directory.
+    std::string makeLodPath(
+        std::string_view model, std::string_view suffix, std::size_t level, std::string_view extension);
+
+    /// @return true if the data directories already provide any level of detail for the model.
+    bool hasLod(const VFS::Manager& vfs, std::string_view model, std::string_view suffix, std::size_t levels);
+
+    /// Writes simplified copies of the model into the output directory, one per level, until a level is not worth it.
+    /// @return Number of levels written.
+    std::size_t generateLods(Resource::SceneManager& sceneManager, const std::string& model,
+        const LodSettings& settings, const std::filesystem::path& output);
+}
+
+#endif
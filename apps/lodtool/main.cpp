@@ -0,0 +1,239 @@
+#include "lod.hpp"
+
+#include <components/debug/debugging.hpp>
+#include <components/debug/debuglog.hpp>
+#include <components/esm3/readerscache.hpp>
+#include <components/esmloader/esmdata.hpp>
+#include <components/esmloader/load.hpp>
+#include <components/fallback/fallback.hpp>
+#include <components/fallback/validate.hpp>
+#include <components/files/collections.hpp>
+#include <components/files/configurationmanager.hpp>
+#include <components/files/conversion.hpp>
+#include <components/files/multidircollection.hpp>
+#include <components/platform/platform.hpp>
+#include <components/resource/bgsmfilemanager.hpp>
+#include <components/resource/imagemanager.hpp>
+#include <components/resource/niffilemanager.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/settings/settings.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+#include <components/version/version.hpp>
+#include <components/vfs/manager.hpp>
+#include <components/vfs/registerarchives.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    namespace bpo = boost::program_options;
+
+    using StringsVector = std::vector<std::string>;
+
+    constexpr std::string_view applicationName = "LodTool";
+
+    bpo::options_description makeOptionsDescription()
+    {
+        using Fallback::FallbackMap;
+
+        bpo::options_description result;
+        auto addOption = result.add_options();
+        addOption("help", "print help message");
+
+        addOption("version", "print version information and quit");
+
+        addOption("data",
+            bpo::value<Files::MaybeQuotedPathContainer>()
+                ->default_value(Files::MaybeQuotedPathContainer(), "data")
+                ->multitoken()
+                ->composing(),
+            "set data directories (later directories have higher priority)");
+
+        addOption("data-local",
+            bpo::value<Files::MaybeQuotedPathContainer::value_type>()->default_value(
+                Files::MaybeQuotedPathContainer::value_type(), ""),
+            "set local data directory (highest priority)");
+
+        addOption("fallback-archive",
+            bpo::value<StringsVector>()->default_value(StringsVector(), "fallback-archive")->multitoken()->composing(),
+            "set fallback BSA archives (later archives have higher priority)");
+
+        addOption("content", bpo::value<StringsVector>()->default_value(StringsVector(), "")->multitoken()->composing(),
+            "content file(s): esm/esp, or omwgame/omwaddon/omwscripts");
+
+        addOption("encoding", bpo::value<std::string>()->default_value("win1252"),
+            "Character encoding used in OpenMW game messages:\n"
+            "\n\twin1250 - Central and Eastern European such as Polish, Czech, Slovak, Hungarian, Slovene, Bosnian, "
+            "Croatian, Serbian (Latin script), Romanian and Albanian languages\n"
+            "\n\twin1251 - Cyrillic alphabet such as Russian, Bulgarian, Serbian Cyrillic and other languages\n"
+            "\n\twin1252 - Western European (Latin) alphabet, used by default");
+
+        addOption("fallback", bpo::value<FallbackMap>()->default_value(FallbackMap(), "")->multitoken()->composing(),
+            "fallback values");
+
+        addOption("output", bpo::value<Files::MaybeQuotedPath>(),
+            "directory to write the generated meshes to, add it as a data directory to use them");
+
+        addOption("suffix", bpo::value<std::string>()->default_value("_dist"),
+            "inserted before the extension of generated meshes, as expected for the version of the content files");
+
+        addOption("levels", bpo::value<std::size_t>()->default_value(3), "number of levels of detail per mesh");
+
+        addOption("ratio", bpo::value<float>()->default_value(0.5f),
+            "fraction of the triangles of the previous level kept by every level");
+
+        addOption("max-error", bpo::value<float>()->default_value(0.01f),
+            "largest deviation from the original mesh at the first level relative to its radius, doubled for every "
+            "next level");
+
+        addOption("min-triangles", bpo::value<std::size_t>()->default_value(100),
+            "meshes with fewer triangles are not simplified");
+
+        addOption("overwrite", bpo::value<bool>()->implicit_value(true)->default_value(false),
+            "generate meshes which already have a level of detail in the data directories");
+
+        Files::ConfigurationManager::addCommonOptions(result);
+
+        return result;
+    }
+
+    int runLodTool(int argc, char* argv[])
+    {
+        Platform::init();
+
+        bpo::options_description desc = makeOptionsDescription();
+
+        bpo::parsed_options options = bpo::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+        bpo::variables_map variables;
+
+        bpo::store(options, variables);
+        bpo::notify(variables);
+
+        if (variables.find("help") != variables.end())
+        {
+            Debug::getRawStdout() << desc << std::endl;
+            return 0;
+        }
+
+        if (variables.find("output") == variables.end())
+        {
+            std::cerr << "Missing output directory" << std::endl;
+            return -1;
+        }
+
+        Files::ConfigurationManager config;
+        config.readConfiguration(variables, desc);
+
+        Debug::setupLogging(config.getLogPath(), applicationName);
+
+        const std::string encoding(variables["encoding"].as<std::string>());
+        Log(Debug::Info) << ToUTF8::encodingUsingMessage(encoding);
+        ToUTF8::Utf8Encoder encoder(ToUTF8::calculateEncoding(encoding));
+
+        Files::PathContainer dataDirs(asPathContainer(variables["data"].as<Files::MaybeQuotedPathContainer>()));
+
+        auto local = variables["data-local"].as<Files::MaybeQuotedPathContainer::value_type>();
+        if (!local.empty())
+            dataDirs.push_back(std::move(local));
+
+        config.filterOutNonExistingPaths(dataDirs);
+
+        const auto& resDir = variables["resources"].as<Files::MaybeQuotedPath>();
+        Log(Debug::Info) << Version::getOpenmwVersionDescription();
+        dataDirs.insert(dataDirs.begin(), resDir / "vfs");
+        const Files::Collections fileCollections(dataDirs);
+        const auto& archives = variables["fallback-archive"].as<StringsVector>();
+        StringsVector contentFiles{ "builtin.omwscripts" };
+        const auto& configContentFiles = variables["content"].as<StringsVector>();
+        contentFiles.insert(contentFiles.end(), configContentFiles.begin(), configContentFiles.end());
+
+        const std::filesystem::path output = variables["output"].as<Files::MaybeQuotedPath>();
+        const bool overwrite = variables["overwrite"].as<bool>();
+        const LodTool::LodSettings lodSettings{
+            .mSuffix = variables["suffix"].as<std::string>(),
+            .mLevels = variables["levels"].as<std::size_t>(),
+            .mRatio = variables["ratio"].as<float>(),
+            .mMaxError = variables["max-error"].as<float>(),
+            .mMinTriangles = variables["min-triangles"].as<std::size_t>(),
+        };
+
+        if (lodSettings.mRatio <= 0 || lodSettings.mRatio >= 1)
+        {
+            std::cerr << "Invalid ratio: " << lodSettings.mRatio << ", expected > 0 and < 1" << std::endl;
+            return -1;
+        }
+
+        Fallback::Map::init(variables["fallback"].as<Fallback::FallbackMap>().mMap);
+
+        VFS::Manager vfs;
+
+        VFS::registerArchives(&vfs, fileCollections, archives, true);
+
+        Settings::Manager::load(config);
+
+        ESM::ReadersCache readers;
+        EsmLoader::Query query;
+        query.mLoadActivators = true;
+        query.mLoadDoors = true;
+        query.mLoadStatics = true;
+        const EsmLoader::EsmData esmData
+            = EsmLoader::loadEsmData(query, contentFiles, fileCollections, readers, &encoder);
+
+        constexpr double expiryDelay = 0;
+        Resource::ImageManager imageManager(&vfs, expiryDelay);
+        Resource::NifFileManager nifFileManager(&vfs, &encoder.getStatelessEncoder());
+        Resource::BgsmFileManager bgsmFileManager(&vfs, expiryDelay);
+        Resource::SceneManager sceneManager(&vfs, &imageManager, &nifFileManager, &bgsmFileManager, expiryDelay);
+
+        const std::vector<std::string> models = LodTool::collectModels(esmData);
+
+        Log(Debug::Info) << "Generating levels of detail for " << models.size() << " meshes into "
+                         << Files::pathToUnicodeString(output);
+
+        std::size_t numGenerated = 0;
+        for (std::size_t i = 0; i < models.size(); ++i)
+        {
+            const std::string& model = models[i];
+            if (!vfs.exists(VFS::Path::Normalized(model)))
+                continue;
+            if (!overwrite && LodTool::hasLod(vfs, model, lodSettings.mSuffix, lodSettings.mLevels))
+                continue;
+
+            try
+            {
+                if (LodTool::generateLods(sceneManager, model, lodSettings, output) > 0)
+                    ++numGenerated;
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Warning) << "Failed to generate levels of detail for \"" << model << "\": " << e.what();
+            }
+
+            // Templates are only needed once
+            sceneManager.clearCache();
+            imageManager.clearCache();
+            nifFileManager.clearCache();
+
+            if ((i + 1) % 100 == 0)
+                Log(Debug::Info) << "Processed " << (i + 1) << " of " << models.size() << " meshes";
+        }
+
+        Log(Debug::Info) << "Done, generated levels of detail for " << numGenerated << " meshes";
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    return Debug::wrapApplication(runLodTool, argc, argv, applicationName);
+}
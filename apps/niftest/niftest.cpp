@@ -1,5 +1,6 @@
 /// Program to test .nif files both on the FileSystem and in BSA archives.
 
+#include <chrono>
 #include <exception>
 #include <filesystem>
 #include <iostream>
@@ -25,6 +26,15 @@
 // Create local aliases for brevity
 namespace bpo = boost::program_options;
 
+/// Totals of the successfully parsed NIF and KF files
+struct BenchmarkStats
+{
+    std::size_t mFiles = 0;
+    std::size_t mBytes = 0;
+    std::size_t mRecords = 0;
+    std::chrono::steady_clock::duration mParseTime{};
+};
+
 /// See if the file has the named extension
 bool hasExtension(const std::filesystem::path& filename, std::string_view extensionToFind)
 {
@@ -59,8 +69,8 @@ std::unique_ptr<VFS::Archive> makeArchive(const std::filesystem::path& path)
     return nullptr;
 }
 
-void readFile(
-    const std::filesystem::path& source, const std::filesystem::path& path, const VFS::Manager* vfs, bool quiet)
+void readFile(const std::filesystem::path& source, const std::filesystem::path& path, const VFS::Manager* vfs,
+    bool quiet, BenchmarkStats* benchmark)
 {
     const std::string pathStr = Files::pathToUnicodeString(path);
     const bool isNif = isNIF(path);
@@ -81,10 +91,23 @@ void readFile(
         {
             Nif::NIFFile file(Files::pathToUnicodeString(fullPath));
             Nif::Reader reader(file, nullptr);
-            if (vfs != nullptr)
-                reader.parse(vfs->get(pathStr));
-            else
-                reader.parse(Files::openConstrainedFileStream(fullPath));
+            Files::IStreamPtr stream = vfs != nullptr ? vfs->get(pathStr) : Files::openConstrainedFileStream(fullPath);
+            std::streamoff size = 0;
+            if (benchmark != nullptr)
+            {
+                stream->seekg(0, std::ios_base::end);
+                size = stream->tellg();
+                stream->seekg(0);
+            }
+            const auto start = std::chrono::steady_clock::now();
+            reader.parse(std::move(stream));
+            if (benchmark != nullptr)
+            {
+                benchmark->mParseTime += std::chrono::steady_clock::now() - start;
+                benchmark->mFiles += 1;
+                benchmark->mBytes += static_cast<std::size_t>(size);
+                benchmark->mRecords += file.mRecords.size();
+            }
         }
         else
         {
@@ -102,7 +125,8 @@ void readFile(
 
 /// Check all the nif files in a given VFS::Archive
 /// \note Can not read a bsa file inside of a bsa file.
-void readVFS(std::unique_ptr<VFS::Archive>&& archive, const std::filesystem::path& archivePath, bool quiet)
+void readVFS(std::unique_ptr<VFS::Archive>&& archive, const std::filesystem::path& archivePath, bool quiet,
+    BenchmarkStats* benchmark)
 {
     if (archive == nullptr)
         return;
@@ -118,7 +142,7 @@ void readVFS(std::unique_ptr<VFS::Archive>&& archive, const std::filesystem::pat
     {
         if (isNIF(name.value()) || isMaterial(name.value()))
         {
-            readFile(archivePath, name.value(), &vfs, quiet);
+            readFile(archivePath, name.value(), &vfs, quiet, benchmark);
         }
     }
 
@@ -133,7 +157,7 @@ void readVFS(std::unique_ptr<VFS::Archive>&& archive, const std::filesystem::pat
             {
                 try
                 {
-                    readVFS(VFS::makeBsaArchive(file.second), file.second, quiet);
+                    readVFS(VFS::makeBsaArchive(file.second), file.second, quiet, benchmark);
                 }
                 catch (const std::exception& e)
                 {
@@ -146,7 +170,7 @@ void readVFS(std::unique_ptr<VFS::Archive>&& archive, const std::filesystem::pat
 }
 
 bool parseOptions(int argc, char** argv, Files::PathContainer& files, Files::PathContainer& archives,
-    bool& writeDebugLog, bool& quiet)
+    bool& writeDebugLog, bool& quiet, bool& benchmark)
 {
     bpo::options_description desc(R"(Ensure that OpenMW can use the provided NIF, KF, BGEM/BGSM and BSA/BA2 files
 
@@ -154,11 +178,15 @@ Usages:
   niftest <nif files, kf files, bgem/bgsm files, BSA/BA2 files, or directories>
       Scan the file or directories for NIF errors.
 
+  niftest --benchmark <directories or BSA/BA2 files>
+      Also report how fast the NIF and KF files were parsed.
+
 Allowed options)");
     auto addOption = desc.add_options();
     addOption("help,h", "print help message.");
     addOption("write-debug-log,v", "write debug log for unsupported nif files");
     addOption("quiet,q", "do not log read archives/files");
+    addOption("benchmark", "report the NIF/KF parsing throughput in MB/s and records/s");
     addOption("archives", bpo::value<Files::MaybeQuotedPathContainer>(), "path to archive files to provide files");
     addOption("input-file", bpo::value<Files::MaybeQuotedPathContainer>(), "input file");
 
@@ -179,6 +207,7 @@ Allowed options)");
         }
         writeDebugLog = variables.count("write-debug-log") > 0;
         quiet = variables.count("quiet") > 0;
+        benchmark = variables.count("benchmark") > 0;
         if (variables.count("input-file"))
         {
             files = asPathContainer(variables["input-file"].as<Files::MaybeQuotedPathContainer>());
@@ -203,7 +232,8 @@ int main(int argc, char** argv)
     Files::PathContainer files, sources;
     bool writeDebugLog = false;
     bool quiet = false;
-    if (!parseOptions(argc, argv, files, sources, writeDebugLog, quiet))
+    bool benchmark = false;
+    if (!parseOptions(argc, argv, files, sources, writeDebugLog, quiet, benchmark))
         return 1;
 
     Nif::Reader::setLoadUnsupportedFiles(true);
@@ -235,6 +265,7 @@ int main(int argc, char** argv)
         vfs->buildIndex();
     }
 
+    BenchmarkStats stats;
     for (const auto& path : files)
     {
         const std::string pathStr = Files::pathToUnicodeString(path);
@@ -242,11 +273,11 @@ int main(int argc, char** argv)
         {
             if (isNIF(path) || isMaterial(path))
             {
-                readFile({}, path, vfs.get(), quiet);
+                readFile({}, path, vfs.get(), quiet, benchmark ? &stats : nullptr);
             }
             else if (auto archive = makeArchive(path))
             {
-                readVFS(std::move(archive), path, quiet);
+                readVFS(std::move(archive), path, quiet, benchmark ? &stats : nullptr);
             }
             else
             {
@@ -259,5 +290,17 @@ int main(int argc, char** argv)
             std::cerr << "Failed to read '" << pathStr << "':  " << e.what() << std::endl;
         }
     }
+
+    if (benchmark)
+    {
+        const double seconds = std::chrono::duration<double>(stats.mParseTime).count();
+        const double megabytes = static_cast<double>(stats.mBytes) / (1024 * 1024);
+        std::cout << "Parsed " << stats.mFiles << " NIF/KF files, " << megabytes << " MB and " << stats.mRecords
+                  << " records in " << seconds << " s";
+        if (seconds > 0)
+            std::cout << ": " << megabytes / seconds << " MB/s, " << stats.mRecords / seconds << " records/s";
+        std::cout << std::endl;
+    }
+
     return 0;
 }
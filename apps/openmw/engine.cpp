@@ -22,6 +22,7 @@
 #include <components/sdlutil/imagetosurface.hpp>
 #include <components/sdlutil/sdlgraphicswindow.hpp>
 
+#include <components/resource/imagemanager.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
 #include <components/resource/stats.hpp>
@@ -415,6 +416,8 @@ OMW::Engine::~Engine()
     mScriptContext = nullptr;
 
     mUnrefQueue = nullptr;
+    if (mResourceSystem)
+        mResourceSystem->getImageManager()->setWorkQueue(nullptr);
     mWorkQueue = nullptr;
 
     mViewer = nullptr;
@@ -740,6 +743,15 @@ void OMW::Engine::prepareEngine()
     mWorkQueue = new SceneUtil::WorkQueue(Settings::cells().mPreloadNumThreads);
     mUnrefQueue = std::make_unique<SceneUtil::UnrefQueue>();
 
+    Resource::ImageManager* const imageManager = mResourceSystem->getImageManager();
+    imageManager->setWorkQueue(mWorkQueue);
+    imageManager->setGenerateMipmaps(
+        Settings::general().mGenerateMipmaps && Settings::general().mTextureMipmap.get() != "none");
+    imageManager->setTranscode(Settings::general().mTranscodeTextures);
+    if (Settings::general().mTextureStreaming)
+        imageManager->setTextureStreaming(Settings::general().mTextureStreamingBudget * 1024 * 1024,
+            static_cast<unsigned int>(Settings::general().mTextureStreamingInitialSize.get()));
+
     mScreenCaptureOperation = new SceneUtil::AsyncScreenCaptureOperation(mWorkQueue,
         new SceneUtil::WriteScreenshotToFileOperation(mCfgMgr.getScreenshotPath(),
             Settings::general().mScreenshotFormat,
@@ -73,6 +73,9 @@ namespace
             case SceneUtil::LightingMethod::PerObjectUniform:
                 result = "#{OMWEngine:LightingMethodShadersCompatibility}";
                 break;
+            case SceneUtil::LightingMethod::Clustered:
+                result = "#{OMWEngine:LightingMethodShadersClustered}";
+                break;
             case SceneUtil::LightingMethod::SingleUBO:
             default:
                 result = "#{OMWEngine:LightingMethodShaders}";
@@ -847,10 +850,11 @@ namespace MWGui
 
         mLightingMethodButton->removeAllItems();
 
-        std::array<SceneUtil::LightingMethod, 3> methods = {
+        std::array<SceneUtil::LightingMethod, 4> methods = {
             SceneUtil::LightingMethod::FFP,
             SceneUtil::LightingMethod::PerObjectUniform,
             SceneUtil::LightingMethod::SingleUBO,
+            SceneUtil::LightingMethod::Clustered,
         };
 
         for (const auto& method : methods)
@@ -10,6 +10,9 @@
 
 #include <LinearMath/btTransform.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <type_traits>
 
 #if BT_BULLET_VERSION < 310
@@ -50,22 +53,64 @@ namespace
 }
 #endif
 
+namespace
+{
+    float getCompressionScale(float minH, float maxH)
+    {
+        const float maxAbsHeight = std::max(std::abs(minH), std::abs(maxH));
+        if (maxAbsHeight == 0)
+            return 1;
+        return maxAbsHeight / std::numeric_limits<short>::max();
+    }
+
+    // Bullet multiplies short heights by the height scale and has no offset, so values are quantized around zero.
+    // They are clamped to the original range to keep the shape within the AABB defined by minH and maxH.
+    std::vector<short> compressHeights(const float* heights, int verts, float minH, float maxH, float scale)
+    {
+        const long minValue = std::lround(std::ceil(minH / scale));
+        const long maxValue = std::lround(std::floor(maxH / scale));
+        std::vector<short> result(static_cast<std::size_t>(verts * verts));
+        std::transform(heights, heights + result.size(), result.begin(), [&](float height) {
+            return static_cast<short>(std::clamp(std::lround(height / scale), minValue, maxValue));
+        });
+        return result;
+    }
+}
+
 namespace MWPhysics
 {
     HeightField::HeightField(const float* heights, int x, int y, int size, int verts, float minH, float maxH,
-        const osg::Object* holdObject, PhysicsTaskScheduler* scheduler)
-        : mHoldObject(holdObject)
+        const osg::Object* holdObject, bool compress, bool heightsResident, PhysicsTaskScheduler* scheduler)
+        : mTaskScheduler(scheduler)
+    {
+        if (compress)
+        {
+            const float scale = getCompressionScale(minH, maxH);
+            mCompressedHeights = compressHeights(heights, verts, minH, maxH, scale);
 #if BT_BULLET_VERSION < 310
-        , mHeights(makeHeights(heights, verts))
+            mShape = std::make_unique<btHeightfieldTerrainShape>(
+                verts, verts, mCompressedHeights.data(), scale, minH, maxH, 2, PHY_SHORT, false);
+#else
+            mShape = std::make_unique<btHeightfieldTerrainShape>(
+                verts, verts, mCompressedHeights.data(), scale, minH, maxH, 2, false);
 #endif
-        , mTaskScheduler(scheduler)
-    {
+            if (heightsResident)
+                mSharedMemoryUsage = static_cast<std::size_t>(verts * verts) * sizeof(float);
+        }
+        else
+        {
+            mHoldObject = holdObject;
 #if BT_BULLET_VERSION < 310
-        mShape = std::make_unique<btHeightfieldTerrainShape>(
-            verts, verts, getHeights(heights, mHeights), 1, minH, maxH, 2, PHY_FLOAT, false);
+            mHeights = makeHeights(heights, verts);
+            mShape = std::make_unique<btHeightfieldTerrainShape>(
+                verts, verts, getHeights(heights, mHeights), 1, minH, maxH, 2, PHY_FLOAT, false);
+            if (mHeights.empty())
+                mSharedMemoryUsage = static_cast<std::size_t>(verts * verts) * sizeof(float);
 #else
-        mShape = std::make_unique<btHeightfieldTerrainShape>(verts, verts, heights, minH, maxH, 2, false);
+            mShape = std::make_unique<btHeightfieldTerrainShape>(verts, verts, heights, minH, maxH, 2, false);
+            mSharedMemoryUsage = static_cast<std::size_t>(verts * verts) * sizeof(float);
 #endif
+        }
         mShape->setUseDiamondSubdivision(true);
 
         const float scaling = static_cast<float>(size) / static_cast<float>(verts - 1);
@@ -109,4 +154,18 @@ namespace MWPhysics
     {
         return mShape.get();
     }
+
+    std::size_t HeightField::getOwnedMemoryUsage() const
+    {
+        std::size_t result = mCompressedHeights.size() * sizeof(short);
+#if BT_BULLET_VERSION < 310
+        result += mHeights.size() * sizeof(btScalar);
+#endif
+        return result;
+    }
+
+    std::size_t HeightField::getSharedMemoryUsage() const
+    {
+        return mSharedMemoryUsage;
+    }
 }
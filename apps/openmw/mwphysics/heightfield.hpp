@@ -5,6 +5,7 @@
 
 #include <LinearMath/btScalar.h>
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -23,21 +24,33 @@ namespace MWPhysics
     class HeightField
     {
     public:
+        /// @param holdObject Object owning the height data. Referenced for the lifetime of the heightfield unless
+        /// the heights are compressed into a heightfield owned copy.
+        /// @param compress Store heights as 16-bit values instead of referencing the source data.
+        /// @param heightsResident The source data is kept in memory by another user when compressed.
         HeightField(const float* heights, int x, int y, int size, int verts, float minH, float maxH,
-            const osg::Object* holdObject, PhysicsTaskScheduler* scheduler);
+            const osg::Object* holdObject, bool compress, bool heightsResident, PhysicsTaskScheduler* scheduler);
         ~HeightField();
 
         btCollisionObject* getCollisionObject();
         const btCollisionObject* getCollisionObject() const;
         const btHeightfieldTerrainShape* getShape() const;
 
+        /// Size in bytes of the height data owned by this heightfield.
+        std::size_t getOwnedMemoryUsage() const;
+
+        /// Size in bytes of the source height data kept in memory for this heightfield, referenced without a copy.
+        std::size_t getSharedMemoryUsage() const;
+
     private:
         std::unique_ptr<btHeightfieldTerrainShape> mShape;
         std::unique_ptr<btCollisionObject> mCollisionObject;
         osg::ref_ptr<const osg::Object> mHoldObject;
+        std::vector<short> mCompressedHeights;
 #if BT_BULLET_VERSION < 310
         std::vector<btScalar> mHeights;
 #endif
+        std::size_t mSharedMemoryUsage = 0;
 
         PhysicsTaskScheduler* mTaskScheduler;
 
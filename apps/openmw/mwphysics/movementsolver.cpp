@@ -453,6 +453,8 @@ namespace MWPhysics
 
     void MovementSolver::move(ProjectileFrameData& projectile, float time, const btCollisionWorld* collisionWorld)
     {
+        projectile.mMovement.z() -= projectile.mGravity * time;
+
         btVector3 btFrom = Misc::Convert::toBullet(projectile.mPosition);
         btVector3 btTo = Misc::Convert::toBullet(projectile.mPosition + projectile.mMovement * time);
 
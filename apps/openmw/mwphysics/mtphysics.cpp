@@ -1,5 +1,6 @@
 #include "mtphysics.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
 #include <mutex>
@@ -192,7 +193,15 @@ namespace
                 frameData.mStuckFrames = actor->getStuckFrames();
                 frameData.mLastStuckPosition = actor->getLastStuckPosition();
             }
-            void operator()(MWPhysics::ProjectileSimulation& /*sim*/) const {}
+            void operator()(MWPhysics::ProjectileSimulation& sim) const
+            {
+                auto locked = sim.lock();
+                if (!locked.has_value())
+                    return;
+                auto& [proj, frameData] = *locked;
+                // Frame data is created before the previous simulation is synced, use its resulting velocity
+                frameData.get().mMovement = proj->getVelocity();
+            }
         };
 
         struct PreStep
@@ -299,6 +308,7 @@ namespace
                     return;
                 auto& [proj, frameData] = *locked;
                 proj->setSimulationPosition(::interpolateMovements(*proj, mTimeAccum, mPhysicsDt));
+                proj->setVelocity(frameData.get().mMovement);
             }
         };
     }
@@ -308,6 +318,9 @@ namespace MWPhysics
 {
     namespace
     {
+        // Projectiles only do a single sweep per step, so they are claimed by workers in batches
+        constexpr int projectileBatchSize = 16;
+
         unsigned getMaxBulletSupportedThreads()
         {
             auto broad = std::make_unique<btDbvtBroadphase>();
@@ -409,11 +422,15 @@ namespace MWPhysics
         , mLockingPolicy(detectLockingPolicy())
         , mNumThreads(getNumThreads(mLockingPolicy))
         , mNumJobs(0)
+        , mNumActorJobs(0)
         , mRemainingSteps(0)
         , mLOSCacheExpiry(Settings::physics().mLineofsightKeepInactiveCache)
         , mAdvanceSimulation(false)
         , mNextJob(0)
+        , mNextProjectileJob(0)
         , mNextLOS(0)
+        , mProjectilesTime(0)
+        , mLastProjectilesTime(0)
         , mFrameNumber(0)
         , mTimer(osg::Timer::instance())
         , mPrevStepCount(1)
@@ -450,6 +467,7 @@ namespace MWPhysics
         {
             MaybeExclusiveLock lock(mSimulationMutex, mLockingPolicy);
             mNumJobs = 0;
+            mNumActorJobs = 0;
             mRemainingSteps = 0;
         }
         if (mWorkersSync != nullptr)
@@ -551,7 +569,13 @@ namespace MWPhysics
         mSimulations = &simulations;
         mAdvanceSimulation = (mRemainingSteps != 0);
         mNumJobs = mSimulations->size();
+        // PhysicsSystem::prepareSimulation puts all actors before projectiles
+        mNumActorJobs = static_cast<int>(
+            std::find_if(simulations.begin(), simulations.end(),
+                [](const Simulation& sim) { return std::holds_alternative<ProjectileSimulation>(sim); })
+            - simulations.begin());
         mNextLOS.store(0, std::memory_order_relaxed);
+        mNextProjectileJob.store(mNumActorJobs, std::memory_order_relaxed);
         mNextJob.store(0, std::memory_order_release);
 
         if (mAdvanceSimulation)
@@ -786,9 +810,21 @@ namespace MWPhysics
             int job = 0;
             const Visitors::Move impl{ mPhysicsDt, mCollisionWorld, *mWorldFrameData };
             const Visitors::WithLockedPtr<Visitors::Move, MaybeLock> vis{ impl, mCollisionWorldMutex, mLockingPolicy };
-            while ((job = mNextJob.fetch_add(1, std::memory_order_relaxed)) < mNumJobs)
+            while ((job = mNextJob.fetch_add(1, std::memory_order_relaxed)) < mNumActorJobs)
                 std::visit(vis, (*mSimulations)[job]);
 
+            const osg::Timer_t projectilesStart = mTimer->tick();
+            bool hasProjectiles = false;
+            while ((job = mNextProjectileJob.fetch_add(projectileBatchSize, std::memory_order_relaxed)) < mNumJobs)
+            {
+                hasProjectiles = true;
+                const int end = std::min(job + projectileBatchSize, mNumJobs);
+                for (; job < end; ++job)
+                    std::visit(vis, (*mSimulations)[job]);
+            }
+            if (hasProjectiles)
+                mProjectilesTime.fetch_add(mTimer->tick() - projectilesStart, std::memory_order_relaxed);
+
             mPostStepBarrier->wait([this] { afterPostStep(); });
         }
 
@@ -811,6 +847,11 @@ namespace MWPhysics
         mFrameNumber = frameNumber;
     }
 
+    double PhysicsTaskScheduler::getProjectilesSimulationTime() const
+    {
+        return mTimer->delta_s(0, mLastProjectilesTime.load(std::memory_order_relaxed));
+    }
+
     void PhysicsTaskScheduler::debugDraw()
     {
         MaybeSharedLock lock(mCollisionWorldMutex, mLockingPolicy);
@@ -856,6 +897,7 @@ namespace MWPhysics
             --mRemainingSteps;
             updateActorsPositions();
         }
+        mNextProjectileJob.store(mNumActorJobs, std::memory_order_relaxed);
         mNextJob.store(0, std::memory_order_release);
     }
 
@@ -867,6 +909,7 @@ namespace MWPhysics
                 std::remove_if(mLOSCache.begin(), mLOSCache.end(), [](const LOSRequest& req) { return req.mStale; }),
                 mLOSCache.end());
         }
+        mLastProjectilesTime.store(mProjectilesTime.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
         mTimeEnd = mTimer->tick();
         if (mWorkersSync != nullptr)
             mWorkersSync->workIsDone();
@@ -68,6 +68,8 @@ namespace MWPhysics
         void updateSingleAabb(const std::shared_ptr<PtrHolder>& ptr, bool immediate = false);
         bool getLineOfSight(const std::shared_ptr<Actor>& actor1, const std::shared_ptr<Actor>& actor2);
         void debugDraw();
+        /// Time spent in projectile sweeps by all threads during the last completed simulation, in seconds
+        double getProjectilesSimulationTime() const;
         void* getUserPointer(const btCollisionObject* object) const;
         void releaseSharedStates(); // destroy all objects whose destructor can't be safely called from
                                     // ~PhysicsTaskScheduler()
@@ -111,11 +113,15 @@ namespace MWPhysics
         LockingPolicy mLockingPolicy;
         unsigned mNumThreads;
         int mNumJobs;
+        int mNumActorJobs;
         int mRemainingSteps;
         int mLOSCacheExpiry;
         bool mAdvanceSimulation;
         std::atomic<int> mNextJob;
+        std::atomic<int> mNextProjectileJob;
         std::atomic<int> mNextLOS;
+        std::atomic<osg::Timer_t> mProjectilesTime;
+        std::atomic<osg::Timer_t> mLastProjectilesTime;
         std::vector<std::thread> mThreads;
 
         mutable std::shared_mutex mSimulationMutex;
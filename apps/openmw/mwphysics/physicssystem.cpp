@@ -385,10 +385,11 @@ namespace MWPhysics
     }
 
     void PhysicsSystem::addHeightField(
-        const float* heights, int x, int y, int size, int verts, float minH, float maxH, const osg::Object* holdObject)
+        const float* heights, int x, int y, int size, int verts, float minH, float maxH, const osg::Object* holdObject,
+        bool heightsResident)
     {
-        mHeightFields[std::make_pair(x, y)]
-            = std::make_unique<HeightField>(heights, x, y, size, verts, minH, maxH, holdObject, mTaskScheduler.get());
+        mHeightFields[std::make_pair(x, y)] = std::make_unique<HeightField>(heights, x, y, size, verts, minH, maxH,
+            holdObject, Settings::physics().mCompressHeightfields, heightsResident, mTaskScheduler.get());
     }
 
     void PhysicsSystem::removeHeightField(int x, int y)
@@ -889,7 +890,19 @@ namespace MWPhysics
         stats.setAttribute(frameNumber, "Physics Actors", mActors.size());
         stats.setAttribute(frameNumber, "Physics Objects", mObjects.size());
         stats.setAttribute(frameNumber, "Physics Projectiles", mProjectiles.size());
+        stats.setAttribute(
+            frameNumber, "Physics Projectiles Time", mTaskScheduler->getProjectilesSimulationTime() * 1000000.0);
         stats.setAttribute(frameNumber, "Physics HeightFields", mHeightFields.size());
+
+        std::size_t heightFieldsMemory = 0;
+        std::size_t heightFieldsSharedMemory = 0;
+        for (const auto& [position, heightField] : mHeightFields)
+        {
+            heightFieldsMemory += heightField->getOwnedMemoryUsage();
+            heightFieldsSharedMemory += heightField->getSharedMemoryUsage();
+        }
+        stats.setAttribute(frameNumber, "Physics HeightFields Memory", heightFieldsMemory);
+        stats.setAttribute(frameNumber, "Physics HeightFields Shared", heightFieldsSharedMemory);
     }
 
     void PhysicsSystem::reportCollision(const btVector3& position, const btVector3& normal)
@@ -932,7 +945,8 @@ namespace MWPhysics
 
     ProjectileFrameData::ProjectileFrameData(Projectile& projectile)
         : mPosition(projectile.getPosition())
-        , mMovement(projectile.velocity())
+        , mMovement(projectile.getVelocity())
+        , mGravity(projectile.getGravity())
         , mCaster(projectile.getCasterCollisionObject())
         , mCollisionObject(projectile.getCollisionObject())
         , mProjectile(&projectile)
@@ -109,6 +109,7 @@ namespace MWPhysics
         explicit ProjectileFrameData(Projectile& projectile);
         osg::Vec3f mPosition;
         osg::Vec3f mMovement;
+        const float mGravity;
         const btCollisionObject* mCaster;
         const btCollisionObject* mCollisionObject;
         Projectile* mProjectile;
@@ -184,8 +185,9 @@ namespace MWPhysics
         void updateRotation(const MWWorld::Ptr& ptr, osg::Quat rotate);
         void updatePosition(const MWWorld::Ptr& ptr);
 
+        /// @param heightsResident The heights are kept in memory by another user when they are compressed.
         void addHeightField(const float* heights, int x, int y, int size, int verts, float minH, float maxH,
-            const osg::Object* holdObject);
+            const osg::Object* holdObject, bool heightsResident = false);
 
         void removeHeightField(int x, int y);
 
@@ -16,6 +16,7 @@ namespace MWPhysics
         PhysicsTaskScheduler* scheduler, PhysicsSystem* physicssystem)
         : PtrHolder(MWWorld::Ptr(), position)
         , mHitWater(false)
+        , mGravity(0)
         , mActive(true)
         , mHitTarget(nullptr)
         , mPhysics(physicssystem)
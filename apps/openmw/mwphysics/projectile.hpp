@@ -53,11 +53,20 @@ namespace MWPhysics
 
         btVector3 getHitPosition() const { return mHitPosition; }
 
+        /// Downward acceleration integrated by the simulation together with the movement.
+        void setGravity(float gravity) { mGravity = gravity; }
+
+        float getGravity() const { return mGravity; }
+
+        /// Unlike actors, projectiles keep their velocity between frames so it can be updated by the simulation.
+        osg::Vec3f getVelocity() const { return mVelocity; }
+
     private:
         std::unique_ptr<btCollisionShape> mShape;
         btConvexShape* mConvexShape;
 
         bool mHitWater;
+        float mGravity;
         std::atomic<bool> mActive;
         MWWorld::Ptr mCaster;
         const btCollisionObject* mCasterColObj;
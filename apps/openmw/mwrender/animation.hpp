@@ -333,6 +333,8 @@ namespace MWRender
 
         osg::Group* getObjectRoot();
 
+        SceneUtil::Skeleton* getSkeleton() { return mSkeleton; }
+
         /**
          * @brief Add an effect mesh attached to a bone or the insert scene node
          * @param model
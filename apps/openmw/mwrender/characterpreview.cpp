@@ -25,6 +25,7 @@
 #include <components/sceneutil/rtt.hpp>
 #include <components/sceneutil/shadow.hpp>
 #include <components/settings/values.hpp>
+#include <components/shader/shadermanager.hpp>
 #include <components/stereo/multiview.hpp>
 
 #include "../mwworld/class.hpp"
@@ -227,12 +228,17 @@ namespace MWRender
         mRTTNode = new CharacterPreviewRTTNode(sizeX, sizeY);
         mRTTNode->setNodeMask(Mask_RenderToTexture);
 
+        const SceneUtil::LightingMethod lightingMethod = mResourceSystem->getSceneManager()->getLightingMethod();
         osg::ref_ptr<SceneUtil::LightManager> lightManager = new SceneUtil::LightManager(SceneUtil::LightSettings{
-            .mLightingMethod = mResourceSystem->getSceneManager()->getLightingMethod(),
+            .mLightingMethod = lightingMethod,
             .mMaxLights = Settings::shaders().mMaxLights,
             .mMaximumLightDistance = Settings::shaders().mMaximumLightDistance,
             .mLightFadeStart = Settings::shaders().mLightFadeStart,
             .mLightBoundsMultiplier = Settings::shaders().mLightBoundsMultiplier,
+            .mClusterTextureUnit = lightingMethod == SceneUtil::LightingMethod::Clustered
+                ? mResourceSystem->getSceneManager()->getShaderManager().reserveGlobalTextureUnits(
+                    Shader::ShaderManager::Slot::LightClusters)
+                : -1,
         });
         lightManager->setStartLight(1);
         osg::ref_ptr<osg::StateSet> stateset = lightManager->getOrCreateStateSet();
@@ -0,0 +1,30 @@
+#ifndef OPENMW_MWRENDER_INSTANCING_H
+#define OPENMW_MWRENDER_INSTANCING_H
+
+#include <vector>
+
+#include <osg/BoundingBox>
+#include <osg/Drawable>
+#include <osg/Matrix>
+
+namespace MWRender
+{
+    /// @brief Computes the near and far planes for a drawable rendered with hardware instancing, as the cull visitor
+    /// can only see the primitives of a single instance.
+    class InstancedComputeNearFarCullCallback : public osg::DrawableCullCallback
+    {
+    public:
+        /// @param instanceMatrices Transform of each instance relative to the drawable.
+        /// @param instanceBounds Bounding box of a single instance.
+        InstancedComputeNearFarCullCallback(
+            std::vector<osg::Matrix> instanceMatrices, const osg::BoundingBox& instanceBounds);
+
+        bool cull(osg::NodeVisitor* nv, osg::Drawable* drawable, osg::RenderInfo* renderInfo) const override;
+
+    private:
+        std::vector<osg::Matrix> mInstanceMatrices;
+        osg::BoundingBox mInstanceBounds;
+    };
+}
+
+#endif
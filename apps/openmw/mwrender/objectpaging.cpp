@@ -1,13 +1,26 @@
 #include "objectpaging.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include <osg/LOD>
 #include <osg/Material>
 #include <osg/MatrixTransform>
+#include <osg/Program>
 #include <osg/Sequence>
 #include <osg/Switch>
+#include <osg/ValueObject>
+#include <osg/VertexAttribDivisor>
 #include <osgAnimation/BasicAnimationManager>
 #include <osgParticle/ParticleProcessor>
 #include <osgParticle/ParticleSystemUpdater>
@@ -22,6 +35,7 @@
 #include <components/esm3/readerscache.hpp>
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/rng.hpp>
+#include <components/resource/scenefilecache.hpp>
 #include <components/resource/scenemanager.hpp>
 #include <components/sceneutil/lightmanager.hpp>
 #include <components/sceneutil/morphgeometry.hpp>
@@ -29,14 +43,18 @@
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/riggeometryosgaextension.hpp>
+#include <components/sceneutil/uploadscheduler.hpp>
 #include <components/sceneutil/util.hpp>
+#include <components/sceneutil/workqueue.hpp>
 #include <components/settings/values.hpp>
+#include <components/shader/shadermanager.hpp>
 #include <components/vfs/manager.hpp>
 
 #include "apps/openmw/mwbase/environment.hpp"
 #include "apps/openmw/mwbase/world.hpp"
 #include "apps/openmw/mwworld/esmstore.hpp"
 
+#include "instancing.hpp"
 #include "vismask.hpp"
 
 namespace MWRender
@@ -89,11 +107,41 @@ namespace MWRender
             return static_cast<osg::Node*>(obj.get());
 
         const unsigned char lod = static_cast<unsigned char>(lodFlags >> (4 * 4));
+        const auto start = std::chrono::steady_clock::now();
         osg::ref_ptr<osg::Node> node = createChunk(size, center, activeGrid, viewPoint, compile, lod);
+        recordChunkBuildTime(std::chrono::steady_clock::now() - start);
         mCache->addEntryToObjectCache(id, node.get());
         return node;
     }
 
+    namespace
+    {
+        // Upper bounds of all but the last bucket of the chunk build time histogram
+        constexpr std::array<std::chrono::milliseconds, ObjectPaging::sNumChunkBuildTimeBuckets - 1>
+            chunkBuildTimeBounds{
+                std::chrono::milliseconds(1),
+                std::chrono::milliseconds(4),
+                std::chrono::milliseconds(16),
+                std::chrono::milliseconds(64),
+                std::chrono::milliseconds(256),
+            };
+
+        constexpr std::array<std::string_view, ObjectPaging::sNumChunkBuildTimeBuckets> chunkBuildTimeStatNames{
+            "Object Chunk Build <1ms",
+            "Object Chunk Build <4ms",
+            "Object Chunk Build <16ms",
+            "Object Chunk Build <64ms",
+            "Object Chunk Build <256ms",
+            "Object Chunk Build >=256ms",
+        };
+    }
+
+    void ObjectPaging::recordChunkBuildTime(std::chrono::steady_clock::duration duration)
+    {
+        const auto bound = std::upper_bound(chunkBuildTimeBounds.begin(), chunkBuildTimeBounds.end(), duration);
+        ++mChunkBuildTimes[static_cast<std::size_t>(bound - chunkBuildTimeBounds.begin())];
+    }
+
     namespace
     {
         class CanOptimizeCallback : public SceneUtil::Optimizer::IsOperationPermissibleForObjectCallback
@@ -333,6 +381,9 @@ namespace MWRender
             {
                 StateSetCounter mStateSetCounter;
                 unsigned int mNumVerts = 0;
+                unsigned int mNumDrawables = 0;
+                // false if the copies of the node can not share a single transform-free template
+                bool mInstanceable = true;
             };
 
             void apply(osg::Node& node) override
@@ -340,6 +391,8 @@ namespace MWRender
                 if (node.getStateSet())
                     mCurrentStateSet = node.getStateSet();
 
+                checkInstanceable(node);
+
                 if (osg::Switch* sw = node.asSwitch())
                 {
                     for (unsigned int i = 0; i < sw->getNumChildren(); ++i)
@@ -349,9 +402,16 @@ namespace MWRender
                 }
                 if (osg::LOD* lod = dynamic_cast<osg::LOD*>(&node))
                 {
+                    unsigned int numChildrenInRange = 0;
                     for (unsigned int i = 0; i < lod->getNumChildren(); ++i)
                         if (const auto r = intersection(lod->getRangeList()[i], mDistances); !empty(r))
+                        {
                             traverse(*lod->getChild(i));
+                            ++numChildrenInRange;
+                        }
+                    // The LOD level would have to be selected for each instance
+                    if (numChildrenInRange > 1)
+                        mResult.mInstanceable = false;
                     return;
                 }
                 if (osg::Sequence* sq = dynamic_cast<osg::Sequence*>(&node))
@@ -364,8 +424,11 @@ namespace MWRender
             }
             void apply(osg::Geometry& geom) override
             {
+                checkInstanceable(geom);
+
                 if (osg::Array* array = geom.getVertexArray())
                     mResult.mNumVerts += array->getNumElements();
+                ++mResult.mNumDrawables;
 
                 ++mResult.mStateSetCounter[mCurrentStateSet];
                 ++mGlobalStateSetCounter[mCurrentStateSet];
@@ -395,6 +458,15 @@ namespace MWRender
                 return mergeBenefit;
             }
 
+            void checkInstanceable(const osg::Node& node)
+            {
+                // Billboards and other cull callbacks depend on the placement of each copy, and only the objects
+                // shaders support instancing
+                std::string shaderPrefix;
+                if (node.getCullCallback() || node.getUserValue("shaderPrefix", shaderPrefix))
+                    mResult.mInstanceable = false;
+            }
+
             Result mResult;
             osg::StateSet* mCurrentStateSet;
             StateSetCounter mGlobalStateSetCounter;
@@ -447,22 +519,111 @@ namespace MWRender
                 node.getOrCreateUserDataContainer()->addUserObject(marker);
             }
         };
+
+        enum class PagingStrategy
+        {
+            Plain,
+            Merge,
+            Instance,
+        };
+
+        class ChunkStats : public osg::Object
+        {
+        public:
+            ChunkStats() {}
+            ChunkStats(const ChunkStats& copy, const osg::CopyOp&)
+                : mNumMerged(copy.mNumMerged)
+                , mNumInstanced(copy.mNumInstanced)
+                , mNumPlain(copy.mNumPlain)
+            {
+            }
+            META_Object(MWRender, ChunkStats)
+
+            void add(PagingStrategy strategy, unsigned int numReferences)
+            {
+                switch (strategy)
+                {
+                    case PagingStrategy::Plain:
+                        mNumPlain += numReferences;
+                        break;
+                    case PagingStrategy::Merge:
+                        mNumMerged += numReferences;
+                        break;
+                    case PagingStrategy::Instance:
+                        mNumInstanced += numReferences;
+                        break;
+                }
+            }
+
+            unsigned int mNumMerged = 0;
+            unsigned int mNumInstanced = 0;
+            unsigned int mNumPlain = 0;
+        };
+
+        class InstancingVisitor : public osg::NodeVisitor
+        {
+        public:
+            InstancingVisitor()
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            {
+            }
+
+            void apply(osg::Transform& transform) override
+            {
+                osg::Matrix matrix;
+                transform.computeLocalToWorldMatrix(matrix, this);
+                if (!matrix.isIdentity())
+                    mValid = false;
+                traverse(transform);
+            }
+            void apply(osg::Drawable& drawable) override { mValid = false; }
+            void apply(osg::Geometry& geom) override { mGeometries.push_back(&geom); }
+
+            bool mValid = true;
+            std::vector<osg::Geometry*> mGeometries;
+        };
+
+        osg::Quat makeAttitude(const osg::Vec3f& rotation)
+        {
+            return osg::Quat(rotation.z(), osg::Vec3f(0, 0, -1)) * osg::Quat(rotation.y(), osg::Vec3f(0, -1, 0))
+                * osg::Quat(rotation.x(), osg::Vec3f(-1, 0, 0));
+        }
     }
 
-    ObjectPaging::ObjectPaging(Resource::SceneManager* sceneManager, ESM::RefId worldspace)
+    ObjectPaging::ObjectPaging(Resource::SceneManager* sceneManager, ESM::RefId worldspace,
+        Resource::SceneFileCache* diskCache, SceneUtil::WorkQueue* workQueue)
         : GenericResourceManager<ChunkId>(nullptr, Settings::cells().mCacheExpiryDelay)
         , Terrain::QuadTreeWorld::ChunkManager(worldspace)
         , mSceneManager(sceneManager)
+        , mDiskCache(diskCache)
+        , mWorkQueue(workQueue)
         , mActiveGrid(Settings::terrain().mObjectPagingActiveGrid)
         , mDebugBatches(Settings::terrain().mDebugChunks)
         , mMergeFactor(Settings::terrain().mObjectPagingMergeFactor)
         , mMinSize(Settings::terrain().mObjectPagingMinSize)
         , mMinSizeMergeFactor(Settings::terrain().mObjectPagingMinSizeMergeFactor)
         , mMinSizeCostMultiplier(Settings::terrain().mObjectPagingMinSizeCostMultiplier)
+        , mInstancing(Settings::terrain().mObjectPagingInstancing)
+        , mInstancingMinInstances(Settings::terrain().mObjectPagingInstancingMinInstances)
         , mRefTrackerLocked(false)
     {
+        if (mInstancing)
+        {
+            mInstancingStateSet = new osg::StateSet;
+            mInstancingStateSet->setAttribute(new osg::VertexAttribDivisor(6, 1));
+            mInstancingStateSet->setAttribute(new osg::VertexAttribDivisor(7, 1));
+            mInstancingStateSet->addUniform(new osg::Uniform("useInstancing", true));
+
+            const osg::Program* programTemplate = mSceneManager->getShaderManager().getProgramTemplate();
+            mInstancingProgramTemplate = programTemplate ? Shader::ShaderManager::cloneProgram(programTemplate)
+                                                         : osg::ref_ptr<osg::Program>(new osg::Program);
+            mInstancingProgramTemplate->addBindAttribLocation("aOffset", 6);
+            mInstancingProgramTemplate->addBindAttribLocation("aRotation", 7);
+        }
     }
 
+    ObjectPaging::~ObjectPaging() = default;
+
     namespace
     {
         struct PagedCellRef
@@ -485,73 +646,202 @@ namespace MWRender
             };
         }
 
-        std::map<ESM::RefNum, PagedCellRef> collectESM3References(
-            float size, const osg::Vec2i& startCell, const MWWorld::ESMStore& store)
+        struct PagedCellRefChange
         {
-            std::map<ESM::RefNum, PagedCellRef> refs;
-            ESM::ReadersCache readers;
-            for (int cellX = startCell.x(); cellX < startCell.x() + size; ++cellX)
+            ESM::RefNum mRefNum;
+            std::optional<PagedCellRef> mRef; // nullopt if the reference is removed
+        };
+
+        void collectESM3CellReferences(const ESM::Cell& cell, float size, const MWWorld::ESMStore& store,
+            ESM::ReadersCache& readers, std::vector<PagedCellRefChange>& changes)
+        {
+            for (size_t i = 0; i < cell.mContextList.size(); ++i)
             {
-                for (int cellY = startCell.y(); cellY < startCell.y() + size; ++cellY)
+                try
                 {
-                    const ESM::Cell* cell = store.get<ESM::Cell>().searchStatic(cellX, cellY);
-                    if (!cell)
-                        continue;
-                    for (size_t i = 0; i < cell->mContextList.size(); ++i)
+                    const std::size_t index = static_cast<std::size_t>(cell.mContextList[i].index);
+                    const ESM::ReadersCache::BusyItem reader = readers.get(index);
+                    cell.restore(*reader, i);
+                    ESM::CellRef ref;
+                    ESM::MovedCellRef cMRef;
+                    bool deleted = false;
+                    bool moved = false;
+                    while (ESM::Cell::getNextRef(
+                        *reader, ref, deleted, cMRef, moved, ESM::Cell::GetNextRefMode::LoadOnlyNotMoved))
                     {
-                        try
-                        {
-                            const std::size_t index = static_cast<std::size_t>(cell->mContextList[i].index);
-                            const ESM::ReadersCache::BusyItem reader = readers.get(index);
-                            cell->restore(*reader, i);
-                            ESM::CellRef ref;
-                            ESM::MovedCellRef cMRef;
-                            bool deleted = false;
-                            bool moved = false;
-                            while (ESM::Cell::getNextRef(
-                                *reader, ref, deleted, cMRef, moved, ESM::Cell::GetNextRefMode::LoadOnlyNotMoved))
-                            {
-                                if (moved)
-                                    continue;
-
-                                if (std::find(cell->mMovedRefs.begin(), cell->mMovedRefs.end(), ref.mRefNum)
-                                    != cell->mMovedRefs.end())
-                                    continue;
-
-                                int type = store.findStatic(ref.mRefID);
-                                if (!typeFilter(type, size >= 2))
-                                    continue;
-                                if (deleted)
-                                {
-                                    refs.erase(ref.mRefNum);
-                                    continue;
-                                }
-                                refs.insert_or_assign(ref.mRefNum, makePagedCellRef(ref));
-                            }
-                        }
-                        catch (const std::exception& e)
-                        {
-                            Log(Debug::Warning) << "Failed to collect references from cell \"" << cell->getDescription()
-                                                << "\": " << e.what();
+                        if (moved)
                             continue;
-                        }
-                    }
-                    for (const auto& [ref, deleted] : cell->mLeasedRefs)
-                    {
-                        if (deleted)
-                        {
-                            refs.erase(ref.mRefNum);
+
+                        if (std::find(cell.mMovedRefs.begin(), cell.mMovedRefs.end(), ref.mRefNum)
+                            != cell.mMovedRefs.end())
                             continue;
-                        }
+
                         int type = store.findStatic(ref.mRefID);
                         if (!typeFilter(type, size >= 2))
                             continue;
-                        refs.insert_or_assign(ref.mRefNum, makePagedCellRef(ref));
+                        if (deleted)
+                        {
+                            changes.push_back({ ref.mRefNum, std::nullopt });
+                            continue;
+                        }
+                        changes.push_back({ ref.mRefNum, makePagedCellRef(ref) });
                     }
                 }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Warning) << "Failed to collect references from cell \"" << cell.getDescription()
+                                        << "\": " << e.what();
+                    continue;
+                }
+            }
+            for (const auto& [ref, deleted] : cell.mLeasedRefs)
+            {
+                if (deleted)
+                {
+                    changes.push_back({ ref.mRefNum, std::nullopt });
+                    continue;
+                }
+                int type = store.findStatic(ref.mRefID);
+                if (!typeFilter(type, size >= 2))
+                    continue;
+                changes.push_back({ ref.mRefNum, makePagedCellRef(ref) });
+            }
+        }
+
+        /// Readers of a chunk build, lent to one task at a time so the content files opened by a task are reused by
+        /// the next one instead of being opened again for every column.
+        class ReadersCachePool
+        {
+        public:
+            std::unique_ptr<ESM::ReadersCache> take()
+            {
+                std::lock_guard lock(mMutex);
+                if (mFree.empty())
+                    return std::make_unique<ESM::ReadersCache>();
+                std::unique_ptr<ESM::ReadersCache> result = std::move(mFree.back());
+                mFree.pop_back();
+                return result;
+            }
+
+            void giveBack(std::unique_ptr<ESM::ReadersCache> readers)
+            {
+                std::lock_guard lock(mMutex);
+                mFree.push_back(std::move(readers));
+            }
+
+        private:
+            std::mutex mMutex;
+            std::vector<std::unique_ptr<ESM::ReadersCache>> mFree;
+        };
+
+        std::map<ESM::RefNum, PagedCellRef> collectESM3References(
+            float size, const osg::Vec2i& startCell, const MWWorld::ESMStore& store, SceneUtil::WorkQueue* workQueue)
+        {
+            // Every column of cells is read by its own task, the changes are then applied in the order of the cells
+            const std::size_t numColumns = static_cast<std::size_t>(std::ceil(size));
+            std::vector<std::vector<PagedCellRefChange>> columnChanges(numColumns);
+            ReadersCachePool readersPool;
+            SceneUtil::runTasks(workQueue, columnChanges.size(), [&](std::size_t column) {
+                const int cellX = startCell.x() + static_cast<int>(column);
+                std::unique_ptr<ESM::ReadersCache> readers = readersPool.take();
+                for (int cellY = startCell.y(); cellY < startCell.y() + size; ++cellY)
+                {
+                    const ESM::Cell* cell = store.get<ESM::Cell>().searchStatic(cellX, cellY);
+                    if (cell)
+                        collectESM3CellReferences(*cell, size, store, *readers, columnChanges[column]);
+                }
+                readersPool.giveBack(std::move(readers));
+            });
+
+            std::map<ESM::RefNum, PagedCellRef> refs;
+            for (const std::vector<PagedCellRefChange>& changes : columnChanges)
+            {
+                for (const PagedCellRefChange& change : changes)
+                {
+                    if (change.mRef.has_value())
+                        refs.insert_or_assign(change.mRefNum, *change.mRef);
+                    else
+                        refs.erase(change.mRefNum);
+                }
             }
             return refs;
         }
+
+        template <class T>
+        void appendToKey(std::string& key, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void appendStringToKey(std::string& key, std::string_view value)
+        {
+            appendToKey(key, value.size());
+            key.append(value);
+        }
+
+        /// @return A single copy of the node drawing all instances, or nullptr if the node can not be instanced.
+        osg::ref_ptr<osg::Group> createInstancedNode(const osg::Node& templateNode, CopyOp& copyop,
+            const std::vector<const PagedCellRef*>& instances, const osg::Vec3f& worldCenter)
+        {
+            osg::ref_ptr<osg::Group> node = new osg::Group;
+            copyop.setCopyFlags(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES
+                | osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES);
+            copyop.copy(&templateNode, node);
+
+            // The instance transform must be the only one left, so bake the transforms of the mesh into its geometry
+            SceneUtil::Optimizer optimizer;
+            optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+            optimizer.optimize(node,
+                SceneUtil::Optimizer::FLATTEN_STATIC_TRANSFORMS | SceneUtil::Optimizer::REMOVE_REDUNDANT_NODES
+                    | SceneUtil::Optimizer::MERGE_GEOMETRY);
+
+            InstancingVisitor visitor;
+            node->accept(visitor);
+            if (!visitor.mValid || visitor.mGeometries.empty())
+                return nullptr;
+
+            osg::ref_ptr<osg::Vec4Array> offsets = new osg::Vec4Array(instances.size());
+            osg::ref_ptr<osg::Vec3Array> rotations = new osg::Vec3Array(instances.size());
+            std::vector<osg::Matrix> instanceMatrices;
+            instanceMatrices.reserve(instances.size());
+            for (std::size_t i = 0; i < instances.size(); ++i)
+            {
+                const PagedCellRef& ref = *instances[i];
+                const osg::Vec3f position = ref.mPosition - worldCenter;
+                (*offsets)[i] = osg::Vec4f(position, ref.mScale);
+                (*rotations)[i] = ref.mRotation;
+                instanceMatrices.push_back(osg::Matrix::scale(ref.mScale, ref.mScale, ref.mScale)
+                    * osg::Matrix::rotate(makeAttitude(ref.mRotation)) * osg::Matrix::translate(position));
+            }
+
+            for (osg::Geometry* geom : visitor.mGeometries)
+            {
+                const osg::BoundingBox instanceBounds = geom->getBoundingBox();
+                if (!instanceBounds.valid())
+                    return nullptr;
+
+                osg::BoundingBox bounds;
+                for (const osg::Matrix& matrix : instanceMatrices)
+                    for (unsigned int i = 0; i < 8; ++i)
+                        bounds.expandBy(instanceBounds.corner(i) * matrix);
+
+                for (unsigned int i = 0; i < geom->getNumPrimitiveSets(); ++i)
+                    geom->getPrimitiveSet(i)->setNumInstances(instances.size());
+
+                // Display lists do not support instancing in OSG 3.4
+                geom->setUseDisplayList(false);
+                geom->setUseVertexBufferObjects(true);
+
+                geom->setVertexAttribArray(6, offsets, osg::Array::BIND_PER_VERTEX);
+                geom->setVertexAttribArray(7, rotations, osg::Array::BIND_PER_VERTEX);
+
+                geom->setInitialBound(bounds);
+                geom->addCullCallback(new InstancedComputeNearFarCullCallback(instanceMatrices, instanceBounds));
+            }
+
+            return node;
+        }
     }
 
     osg::ref_ptr<osg::Node> ObjectPaging::createChunk(float size, const osg::Vec2f& center, bool activeGrid,
@@ -565,7 +855,7 @@ namespace MWRender
 
         if (mWorldspace == ESM::Cell::sDefaultWorldspaceId)
         {
-            refs = collectESM3References(size, startCell, store);
+            refs = collectESM3References(size, startCell, store, mWorkQueue);
         }
         else
         {
@@ -595,7 +885,12 @@ namespace MWRender
         {
             std::vector<const PagedCellRef*> mInstances;
             AnalyzeVisitor::Result mAnalyzeResult;
+            PagingStrategy mStrategy = PagingStrategy::Plain;
+            float mMergeCost = 0;
+            float mMergeBenefit = 0;
             bool mNeedCompile = false;
+            std::string mModel;
+            std::string mArchive;
         };
         typedef std::map<osg::ref_ptr<const osg::Node>, InstanceList> NodeMap;
         NodeMap nodes;
@@ -708,48 +1003,191 @@ namespace MWRender
                 const_cast<osg::Node*>(nodePtr)->accept(analyzeVisitor);
                 emplaced.first->second.mAnalyzeResult = analyzeVisitor.retrieveResult();
                 emplaced.first->second.mNeedCompile = compile && nodePtr->referenceCount() <= 2;
+                if (mDiskCache)
+                {
+                    emplaced.first->second.mArchive
+                        = mSceneManager->getVFS()->getArchive(VFS::Path::Normalized(model));
+                    emplaced.first->second.mModel = std::move(model);
+                }
             }
             else
                 analyzeVisitor.addInstance(emplaced.first->second.mAnalyzeResult);
             emplaced.first->second.mInstances.push_back(&ref);
         }
 
+        bool hasInstancing = false;
+        for (auto& [cnode, instanceList] : nodes)
+        {
+            const AnalyzeVisitor::Result& analyzeResult = instanceList.mAnalyzeResult;
+
+            instanceList.mMergeCost = analyzeResult.mNumVerts * size;
+            instanceList.mMergeBenefit = analyzeVisitor.getMergeBenefit(analyzeResult) * mMergeFactor;
+            instanceList.mStrategy = instanceList.mMergeBenefit > instanceList.mMergeCost ? PagingStrategy::Merge
+                                                                                          : PagingStrategy::Plain;
+
+            // Instancing saves as many draw calls as there are copies without duplicating the geometry, but unlike
+            // merging it can not batch different meshes sharing the same state
+            const std::size_t numInstances = instanceList.mInstances.size();
+            if (mInstancing && !activeGrid && analyzeResult.mInstanceable && numInstances >= mInstancingMinInstances)
+            {
+                const float instanceCost = analyzeResult.mNumDrawables * size;
+                const float instanceBenefit = numInstances * mMergeFactor;
+                if (instanceBenefit - instanceCost
+                    > std::max(0.f, instanceList.mMergeBenefit - instanceList.mMergeCost))
+                {
+                    instanceList.mStrategy = PagingStrategy::Instance;
+                    hasInstancing = true;
+                }
+            }
+        }
+
+        // Cached chunks are identified by their id and validated against everything the merged output depends on
+        Resource::SceneFileCache::Hash chunkHash{ 0, 0 };
+        Resource::SceneFileCache::Hash contentsHash{ 0, 0 };
+        // The cache can not restore instanced draws, so only chunks that are merged or plain take part
+        const bool useDiskCache = mDiskCache != nullptr && !activeGrid && !mDebugBatches && !hasInstancing;
+        if (useDiskCache)
+        {
+            std::string chunkKey;
+            appendStringToKey(chunkKey, mWorldspace.serializeText());
+            appendToKey(chunkKey, center);
+            appendToKey(chunkKey, size);
+            appendToKey(chunkKey, lod);
+            chunkHash = Resource::SceneFileCache::makeHash(chunkKey);
+
+            std::string contentsKey;
+            appendToKey(contentsKey, mMergeFactor);
+            appendToKey(contentsKey, mMinSize);
+            appendToKey(contentsKey, mMinSizeMergeFactor);
+            appendToKey(contentsKey, mMinSizeCostMultiplier);
+            for (const std::string& contentFile : world.getContentFiles())
+                appendStringToKey(contentsKey, contentFile);
+
+            // Disabled references are already filtered out, so toggling them changes the key
+            std::vector<std::pair<const PagedCellRef*, const InstanceList*>> instances;
+            for (const auto& [cnode, instanceList] : nodes)
+                for (const PagedCellRef* ref : instanceList.mInstances)
+                    instances.emplace_back(ref, &instanceList);
+            std::sort(instances.begin(), instances.end(),
+                [](const auto& l, const auto& r) { return l.first->mRefNum < r.first->mRefNum; });
+            for (const auto& [ref, instanceList] : instances)
+            {
+                appendToKey(contentsKey, ref->mRefNum);
+                appendStringToKey(contentsKey, instanceList->mModel);
+                appendStringToKey(contentsKey, instanceList->mArchive);
+                appendToKey(contentsKey, ref->mPosition);
+                appendToKey(contentsKey, ref->mRotation);
+                appendToKey(contentsKey, ref->mScale);
+            }
+            contentsHash = Resource::SceneFileCache::makeHash(contentsKey);
+
+            if (osg::ref_ptr<osg::Node> cached = mDiskCache->read(chunkHash, contentsHash))
+            {
+                osgUtil::IncrementalCompileOperation* const ico = mSceneManager->getIncrementalCompileOperation();
+                if (compile && ico)
+                    SceneUtil::addToCompile(*ico, *cached, SceneUtil::UploadSubsystem::ObjectPaging);
+                osg::ref_ptr<ChunkStats> chunkStats = new ChunkStats;
+                for (const auto& [cnode, instanceList] : nodes)
+                    chunkStats->add(instanceList.mStrategy, static_cast<unsigned int>(instanceList.mInstances.size()));
+                cached->getOrCreateUserDataContainer()->addUserObject(chunkStats);
+
+                cached->getBound();
+                cached->setNodeMask(Mask_Static);
+                return cached;
+            }
+        }
+
         const osg::Vec3f worldCenter = osg::Vec3f(center.x(), center.y(), 0) * getCellSize(mWorldspace);
         osg::ref_ptr<osg::Group> group = new osg::Group;
         osg::ref_ptr<osg::Group> mergeGroup = new osg::Group;
+        osg::ref_ptr<osg::Group> instanceGroup = new osg::Group;
         osg::ref_ptr<Resource::TemplateMultiRef> templateRefs = new Resource::TemplateMultiRef;
+        osg::ref_ptr<ChunkStats> chunkStats = new ChunkStats;
         osgUtil::StateToCompile stateToCompile(0, nullptr);
-        CopyOp copyop;
-        copyop.mCopyMask = copyMask;
-        for (const auto& pair : nodes)
+
+        const osg::Vec3f relativeViewPoint = viewPoint - worldCenter;
+        const auto setupOptimizer = [&](SceneUtil::Optimizer& optimizer) {
+            if (size > 1 / 8.f)
+            {
+                optimizer.setViewPoint(relativeViewPoint);
+                optimizer.setMergeAlphaBlending(true);
+            }
+            optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+        };
+
+        struct TemplateResult
         {
-            const osg::Node* cnode = pair.first;
+            PagingStrategy mStrategy = PagingStrategy::Plain;
+            unsigned int mNumInstances = 0;
+            // The instanced copy, or the transforms of all references
+            osg::ref_ptr<osg::Group> mNode;
+        };
+        std::vector<const NodeMap::value_type*> templates;
+        templates.reserve(nodes.size());
+        for (const auto& pair : nodes)
+            templates.push_back(&pair);
+        std::vector<TemplateResult> results(templates.size());
 
-            const AnalyzeVisitor::Result& analyzeResult = pair.second.mAnalyzeResult;
+        // Every mesh is copied by its own task, which also flattens the transforms of merged copies
+        SceneUtil::runTasks(mWorkQueue, templates.size(), [&](std::size_t index) {
+            const osg::Node* cnode = templates[index]->first;
+            const InstanceList& instanceList = templates[index]->second;
+            TemplateResult& result = results[index];
 
-            const float mergeCost = analyzeResult.mNumVerts * size;
-            const float mergeBenefit = analyzeVisitor.getMergeBenefit(analyzeResult) * mMergeFactor;
-            const bool merge = mergeBenefit > mergeCost;
+            const float mergeCost = instanceList.mMergeCost;
+            const float mergeBenefit = instanceList.mMergeBenefit;
+            PagingStrategy strategy = instanceList.mStrategy;
 
             const float factor2
                 = mergeBenefit > 0 ? std::min(1.f, mergeCost * mMinSizeCostMultiplier / mergeBenefit) : 1;
             const float minSizeMergeFactor2 = (1 - factor2) * mMinSizeMergeFactor + factor2;
             const float minSizeMerged = minSizeMergeFactor2 > 0 ? mMinSize * minSizeMergeFactor2 : mMinSize;
 
-            unsigned int numinstances = 0;
-            for (const PagedCellRef* refPtr : pair.second.mInstances)
+            const auto isTooSmall = [&](const PagedCellRef& ref) {
+                return !activeGrid && minSizeMerged != minSize
+                    && cnode->getBound().radius2() * ref.mScale * ref.mScale
+                    < (viewPoint - ref.mPosition).length2() * minSizeMerged * minSizeMerged;
+            };
+
+            CopyOp copyop;
+            copyop.mCopyMask = copyMask;
+
+            if (strategy == PagingStrategy::Instance)
+            {
+                std::vector<const PagedCellRef*> instances;
+                for (const PagedCellRef* refPtr : instanceList.mInstances)
+                    if (!isTooSmall(*refPtr))
+                        instances.push_back(refPtr);
+
+                if (instances.size() >= mInstancingMinInstances)
+                {
+                    copyop.mDistances
+                        = LODRange{ smallestDistanceToChunk, higherDistanceToChunk } / instances.front()->mScale;
+                    result.mNode = createInstancedNode(*cnode, copyop, instances, worldCenter);
+                }
+
+                if (result.mNode)
+                {
+                    result.mStrategy = strategy;
+                    result.mNumInstances = static_cast<unsigned int>(instances.size());
+                    return;
+                }
+
+                strategy = mergeBenefit > mergeCost ? PagingStrategy::Merge : PagingStrategy::Plain;
+            }
+            const bool merge = strategy == PagingStrategy::Merge;
+
+            result.mStrategy = strategy;
+            result.mNode = new osg::Group;
+            for (const PagedCellRef* refPtr : instanceList.mInstances)
             {
                 const PagedCellRef& ref = *refPtr;
 
-                if (!activeGrid && minSizeMerged != minSize
-                    && cnode->getBound().radius2() * ref.mScale * ref.mScale
-                        < (viewPoint - ref.mPosition).length2() * minSizeMerged * minSizeMerged)
+                if (isTooSmall(ref))
                     continue;
 
                 const osg::Vec3f nodePos = ref.mPosition - worldCenter;
-                const osg::Quat nodeAttitude = osg::Quat(ref.mRotation.z(), osg::Vec3f(0, 0, -1))
-                    * osg::Quat(ref.mRotation.y(), osg::Vec3f(0, -1, 0))
-                    * osg::Quat(ref.mRotation.x(), osg::Vec3f(-1, 0, 0));
+                const osg::Quat nodeAttitude = makeAttitude(ref.mRotation);
                 const osg::Vec3f nodeScale(ref.mScale, ref.mScale, ref.mScale);
 
                 osg::ref_ptr<osg::Group> trans;
@@ -803,42 +1241,89 @@ namespace MWRender
                     }
                 }
 
-                osg::Group* const attachTo = merge ? mergeGroup : group;
-                attachTo->addChild(trans);
-                ++numinstances;
+                result.mNode->addChild(trans);
+                ++result.mNumInstances;
             }
-            if (numinstances > 0)
+
+            if (merge && result.mNumInstances > 0)
             {
-                // add a ref to the original template to help verify the safety of shallow cloning operations
-                // in addition, we hint to the cache that it's still being used and should be kept in cache
-                templateRefs->addRef(cnode);
+                SceneUtil::Optimizer optimizer;
+                setupOptimizer(optimizer);
+                optimizer.optimize(result.mNode, SceneUtil::Optimizer::FLATTEN_STATIC_TRANSFORMS);
+            }
+        });
 
-                if (pair.second.mNeedCompile)
-                {
-                    int mode = osgUtil::GLObjectsVisitor::COMPILE_STATE_ATTRIBUTES;
-                    if (!merge)
-                        mode |= osgUtil::GLObjectsVisitor::COMPILE_DISPLAY_LISTS;
-                    stateToCompile._mode = mode;
-                    const_cast<osg::Node*>(cnode)->accept(stateToCompile);
-                }
+        const auto moveChildren = [](osg::Group& from, osg::Group& to) {
+            for (unsigned int i = 0; i < from.getNumChildren(); ++i)
+                to.addChild(from.getChild(i));
+            from.removeChildren(0, from.getNumChildren());
+        };
+
+        // Join the results in the order of the templates, so the chunk does not depend on the order of completion
+        for (std::size_t index = 0; index < templates.size(); ++index)
+        {
+            const osg::Node* cnode = templates[index]->first;
+            const TemplateResult& result = results[index];
+            if (result.mNumInstances == 0)
+                continue;
+
+            switch (result.mStrategy)
+            {
+                case PagingStrategy::Plain:
+                    moveChildren(*result.mNode, *group);
+                    break;
+                case PagingStrategy::Merge:
+                    moveChildren(*result.mNode, *mergeGroup);
+                    break;
+                case PagingStrategy::Instance:
+                    // the instanced copy has its own state and geometry, compiled along with the rest of the group
+                    instanceGroup->addChild(result.mNode);
+                    break;
             }
-        }
 
-        const osg::Vec3f relativeViewPoint = viewPoint - worldCenter;
+            // add a ref to the original template to help verify the safety of shallow cloning operations
+            // in addition, we hint to the cache that it's still being used and should be kept in cache
+            templateRefs->addRef(cnode);
+            chunkStats->add(result.mStrategy, result.mNumInstances);
+
+            if (templates[index]->second.mNeedCompile && result.mStrategy != PagingStrategy::Instance)
+            {
+                int mode = osgUtil::GLObjectsVisitor::COMPILE_STATE_ATTRIBUTES;
+                if (result.mStrategy == PagingStrategy::Plain)
+                    mode |= osgUtil::GLObjectsVisitor::COMPILE_DISPLAY_LISTS;
+                stateToCompile._mode = mode;
+                const_cast<osg::Node*>(cnode)->accept(stateToCompile);
+            }
+        }
 
         if (mergeGroup->getNumChildren())
         {
             SceneUtil::Optimizer optimizer;
-            if (size > 1 / 8.f)
+            setupOptimizer(optimizer);
+            optimizer.optimize(mergeGroup, SceneUtil::Optimizer::REMOVE_REDUNDANT_NODES);
+
+            // Only geometry sharing the same state can be merged, and redundant nodes are gone, so every state set
+            // among the children can be merged by its own task
+            std::vector<osg::ref_ptr<osg::Group>> partitions;
+            std::unordered_map<const osg::StateSet*, std::size_t> partitionIndices;
+            for (unsigned int i = 0; i < mergeGroup->getNumChildren(); ++i)
             {
-                optimizer.setViewPoint(relativeViewPoint);
-                optimizer.setMergeAlphaBlending(true);
+                osg::Node* child = mergeGroup->getChild(i);
+                const auto [it, inserted] = partitionIndices.emplace(child->getStateSet(), partitions.size());
+                if (inserted)
+                    partitions.push_back(new osg::Group);
+                partitions[it->second]->addChild(child);
             }
-            optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
-            const unsigned int options = SceneUtil::Optimizer::FLATTEN_STATIC_TRANSFORMS
-                | SceneUtil::Optimizer::REMOVE_REDUNDANT_NODES | SceneUtil::Optimizer::MERGE_GEOMETRY;
+            mergeGroup->removeChildren(0, mergeGroup->getNumChildren());
+
+            SceneUtil::runTasks(mWorkQueue, partitions.size(), [&](std::size_t index) {
+                SceneUtil::Optimizer partitionOptimizer;
+                setupOptimizer(partitionOptimizer);
+                partitionOptimizer.optimize(partitions[index], SceneUtil::Optimizer::MERGE_GEOMETRY);
+            });
 
-            optimizer.optimize(mergeGroup, options);
+            for (const osg::ref_ptr<osg::Group>& partition : partitions)
+                moveChildren(*partition, *mergeGroup);
 
             group->addChild(mergeGroup);
 
@@ -854,14 +1339,34 @@ namespace MWRender
             }
         }
 
-        osgUtil::IncrementalCompileOperation* const ico = mSceneManager->getIncrementalCompileOperation();
-        if (!stateToCompile.empty() && ico)
+        if (instanceGroup->getNumChildren())
         {
-            auto compileSet = new osgUtil::IncrementalCompileOperation::CompileSet(group);
-            compileSet->buildCompileMap(ico->getContextSet(), stateToCompile);
-            ico->add(compileSet, false);
+            instanceGroup->setStateSet(mInstancingStateSet);
+            instanceGroup->setUserValue("instancing", true);
+
+            if (mDebugBatches)
+            {
+                DebugVisitor dv;
+                instanceGroup->accept(dv);
+            }
+
+            mSceneManager->recreateShaders(instanceGroup, "objects", true, mInstancingProgramTemplate);
+            mSceneManager->shareState(instanceGroup);
+
+            group->addChild(instanceGroup);
+
+            if (compile)
+            {
+                stateToCompile._mode = osgUtil::GLObjectsVisitor::COMPILE_DISPLAY_LISTS
+                    | osgUtil::GLObjectsVisitor::COMPILE_STATE_ATTRIBUTES;
+                instanceGroup->accept(stateToCompile);
+            }
         }
 
+        osgUtil::IncrementalCompileOperation* const ico = mSceneManager->getIncrementalCompileOperation();
+        if (ico)
+            SceneUtil::addToCompile(*ico, *group, stateToCompile, SceneUtil::UploadSubsystem::ObjectPaging);
+
         group->getBound();
         group->setNodeMask(Mask_Static);
         osg::UserDataContainer* udc = group->getOrCreateUserDataContainer();
@@ -874,6 +1379,10 @@ namespace MWRender
             group->addCullCallback(new SceneUtil::LightListCallback);
         }
         udc->addUserObject(templateRefs);
+        udc->addUserObject(chunkStats);
+
+        if (useDiskCache && group->getNumChildren() > 0)
+            mDiskCache->write(chunkHash, contentsHash, group);
 
         return group;
     }
@@ -1038,9 +1547,45 @@ namespace MWRender
         out.erase(std::unique(out.begin(), out.end()), out.end());
     }
 
+    namespace
+    {
+        struct SumChunkStatsFunctor
+        {
+            void operator()(const ChunkId& /*chunkId*/, osg::Object* obj)
+            {
+                const osg::UserDataContainer* udc = obj->getUserDataContainer();
+                if (!udc)
+                    return;
+                for (unsigned int i = 0; i < udc->getNumUserObjects(); ++i)
+                {
+                    if (const ChunkStats* chunkStats = dynamic_cast<const ChunkStats*>(udc->getUserObject(i)))
+                    {
+                        mNumMerged += chunkStats->mNumMerged;
+                        mNumInstanced += chunkStats->mNumInstanced;
+                        mNumPlain += chunkStats->mNumPlain;
+                        return;
+                    }
+                }
+            }
+
+            unsigned int mNumMerged = 0;
+            unsigned int mNumInstanced = 0;
+            unsigned int mNumPlain = 0;
+        };
+    }
+
     void ObjectPaging::reportStats(unsigned int frameNumber, osg::Stats* stats) const
     {
         Resource::reportStats("Object Chunk", frameNumber, mCache->getStats(), *stats);
+
+        SumChunkStatsFunctor sum;
+        mCache->call(sum);
+        stats->setAttribute(frameNumber, "Object Chunk Merged", sum.mNumMerged);
+        stats->setAttribute(frameNumber, "Object Chunk Instanced", sum.mNumInstanced);
+        stats->setAttribute(frameNumber, "Object Chunk Plain", sum.mNumPlain);
+
+        for (std::size_t i = 0; i < mChunkBuildTimes.size(); ++i)
+            stats->setAttribute(frameNumber, std::string(chunkBuildTimeStatNames[i]), mChunkBuildTimes[i].load());
     }
 
 }
@@ -5,13 +5,28 @@
 #include <components/resource/resourcemanager.hpp>
 #include <components/terrain/quadtreeworld.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 
+namespace osg
+{
+    class Program;
+    class StateSet;
+}
+
 namespace Resource
 {
+    class SceneFileCache;
     class SceneManager;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWRender
 {
 
@@ -20,8 +35,14 @@ namespace MWRender
     class ObjectPaging : public Resource::GenericResourceManager<ChunkId>, public Terrain::QuadTreeWorld::ChunkManager
     {
     public:
-        ObjectPaging(Resource::SceneManager* sceneManager, ESM::RefId worldspace);
-        ~ObjectPaging() = default;
+        static constexpr std::size_t sNumChunkBuildTimeBuckets = 6;
+
+        /// @param diskCache Optional persistent storage for chunks outside of the active grid.
+        /// @param workQueue Optional queue to build parts of a chunk in parallel, otherwise chunks are built by the
+        /// calling thread alone.
+        ObjectPaging(Resource::SceneManager* sceneManager, ESM::RefId worldspace, Resource::SceneFileCache* diskCache,
+            SceneUtil::WorkQueue* workQueue);
+        ~ObjectPaging();
 
         osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags,
             bool activeGrid, const osg::Vec3f& viewPoint, bool compile) override;
@@ -49,12 +70,23 @@ namespace MWRender
 
     private:
         Resource::SceneManager* mSceneManager;
+        Resource::SceneFileCache* mDiskCache;
+        SceneUtil::WorkQueue* mWorkQueue;
         bool mActiveGrid;
         bool mDebugBatches;
         float mMergeFactor;
         float mMinSize;
         float mMinSizeMergeFactor;
         float mMinSizeCostMultiplier;
+        bool mInstancing;
+        unsigned int mInstancingMinInstances;
+        osg::ref_ptr<osg::Program> mInstancingProgramTemplate;
+        osg::ref_ptr<osg::StateSet> mInstancingStateSet;
+
+        // Number of chunks built within each range of time, since startup
+        std::array<std::atomic<unsigned int>, sNumChunkBuildTimeBuckets> mChunkBuildTimes{};
+
+        void recordChunkBuildTime(std::chrono::steady_clock::duration duration);
 
         std::mutex mRefTrackerMutex;
         struct RefTracker
@@ -6,6 +6,7 @@
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/strings/algorithm.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/skeleton.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
 
 #include "../mwworld/class.hpp"
@@ -249,4 +250,11 @@ namespace MWRender
         return nullptr;
     }
 
+    void Objects::collectSkeletons(std::vector<osg::ref_ptr<SceneUtil::Skeleton>>& skeletons) const
+    {
+        for (const auto& [ref, animation] : mObjects)
+            if (SceneUtil::Skeleton* skeleton = animation->getSkeleton())
+                skeletons.emplace_back(skeleton);
+    }
+
 }
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <osg/Object>
 #include <osg/ref_ptr>
@@ -26,6 +27,7 @@ namespace MWWorld
 
 namespace SceneUtil
 {
+    class Skeleton;
     class UnrefQueue;
 }
 
@@ -81,6 +83,9 @@ namespace MWRender
         Animation* getAnimation(const MWWorld::Ptr& ptr);
         const Animation* getAnimation(const MWWorld::ConstPtr& ptr) const;
 
+        /// Appends the skeletons of all objects having one.
+        void collectSkeletons(std::vector<osg::ref_ptr<SceneUtil::Skeleton>>& skeletons) const;
+
         bool removeObject(const MWWorld::Ptr& ptr);
         ///< \return found?
 
@@ -13,6 +13,7 @@
 #include <osg/PolygonMode>
 #include <osg/UserDataContainer>
 
+#include <osgUtil/CullVisitor>
 #include <osgUtil/LineSegmentIntersector>
 
 #include <osgViewer/Viewer>
@@ -27,7 +28,10 @@
 #include <components/resource/imagemanager.hpp>
 #include <components/resource/keyframemanager.hpp>
 #include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenefilecache.hpp>
+#include <components/resource/texturestreamer.hpp>
 
+#include <components/shader/programcache.hpp>
 #include <components/shader/removedalphafunc.hpp>
 #include <components/shader/shadermanager.hpp>
 
@@ -36,16 +40,23 @@
 #include <components/sceneutil/cullsafeboundsvisitor.hpp>
 #include <components/sceneutil/depth.hpp>
 #include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/nodecallback.hpp>
+#include <components/sceneutil/parallelskeletonupdater.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/rtt.hpp>
 #include <components/sceneutil/shadow.hpp>
+#include <components/sceneutil/sharedcull.hpp>
+#include <components/sceneutil/skeleton.hpp>
 #include <components/sceneutil/statesetupdater.hpp>
+#include <components/sceneutil/uploadscheduler.hpp>
 #include <components/sceneutil/visitor.hpp>
 #include <components/sceneutil/workqueue.hpp>
 #include <components/sceneutil/writescene.hpp>
 
 #include <components/misc/constants.hpp>
 
+#include <components/terrain/compositemapcache.hpp>
 #include <components/terrain/quadtreeworld.hpp>
 #include <components/terrain/terraingrid.hpp>
 
@@ -304,10 +315,86 @@ namespace MWRender
         Resource::ResourceSystem* mResourceSystem;
     };
 
+    class PrecompileProgramsWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        explicit PrecompileProgramsWorkItem(Shader::ShaderManager& shaderManager)
+            : mShaderManager(shaderManager)
+        {
+        }
+
+        void doWork() override
+        {
+            Shader::ProgramCache& programCache = *mShaderManager.getProgramCache();
+            for (const Shader::ProgramPermutation& permutation : programCache.getManifest())
+            {
+                try
+                {
+                    programCache.precompile(mShaderManager.getProgram(permutation));
+                }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Warning) << "Failed to precompile program " << permutation.mTemplateName << ": "
+                                        << e.what();
+                }
+            }
+        }
+
+    private:
+        Shader::ShaderManager& mShaderManager;
+    };
+
+    class ProgramCacheDrawCallback : public osg::Camera::DrawCallback
+    {
+    public:
+        explicit ProgramCacheDrawCallback(Shader::ProgramCache& programCache)
+            : mProgramCache(programCache)
+        {
+        }
+
+        void operator()(osg::RenderInfo& renderInfo) const override { mProgramCache.compile(*renderInfo.getState()); }
+
+    private:
+        Shader::ProgramCache& mProgramCache;
+    };
+
+    class TextureStreamingCullCallback
+        : public SceneUtil::NodeCallback<TextureStreamingCullCallback, osg::Node*, osgUtil::CullVisitor*>
+    {
+    public:
+        explicit TextureStreamingCullCallback(Resource::TextureStreamer& textureStreamer)
+            : mTextureStreamer(textureStreamer)
+        {
+        }
+
+        void operator()(osg::Node* node, osgUtil::CullVisitor* cv)
+        {
+            traverse(node, cv);
+            mTextureStreamer.collect(*cv);
+        }
+
+    private:
+        Resource::TextureStreamer& mTextureStreamer;
+    };
+
+    class TextureStreamingDrawCallback : public osg::Camera::DrawCallback
+    {
+    public:
+        explicit TextureStreamingDrawCallback(Resource::TextureStreamer& textureStreamer)
+            : mTextureStreamer(textureStreamer)
+        {
+        }
+
+        void operator()(osg::RenderInfo& /*renderInfo*/) const override { mTextureStreamer.apply(); }
+
+    private:
+        Resource::TextureStreamer& mTextureStreamer;
+    };
+
     RenderingManager::RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode,
         Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
         DetourNavigator::Navigator& navigator, const MWWorld::GroundcoverStore& groundcoverStore,
-        SceneUtil::UnrefQueue& unrefQueue)
+        SceneUtil::UnrefQueue& unrefQueue, const std::filesystem::path& userDataPath)
         : mSkyBlending(Settings::fog().mSkyBlending)
         , mViewer(viewer)
         , mRootNode(rootNode)
@@ -400,6 +487,10 @@ namespace MWRender
             .mMaximumLightDistance = Settings::shaders().mMaximumLightDistance,
             .mLightFadeStart = Settings::shaders().mLightFadeStart,
             .mLightBoundsMultiplier = Settings::shaders().mLightBoundsMultiplier,
+            .mClusterTextureUnit = lightingMethod == SceneUtil::LightingMethod::Clustered
+                ? resourceSystem->getSceneManager()->getShaderManager().reserveGlobalTextureUnits(
+                    Shader::ShaderManager::Slot::LightClusters)
+                : -1,
         });
         resourceSystem->getSceneManager()->setLightingMethod(sceneRoot->getLightingMethod());
         resourceSystem->getSceneManager()->setSupportedLightingMethods(sceneRoot->getSupportedLightingMethods());
@@ -462,6 +553,16 @@ namespace MWRender
         // It is unnecessary to stop/start the viewer as no frames are being rendered yet.
         mResourceSystem->getSceneManager()->getShaderManager().setGlobalDefines(globalDefines);
 
+        // Programs of the previous sessions are precompiled once the global defines are known
+        if (Settings::shaders().mProgramCache)
+        {
+            Shader::ShaderManager& shaderManager = mResourceSystem->getSceneManager()->getShaderManager();
+            shaderManager.setProgramCache(std::make_unique<Shader::ProgramCache>(userDataPath / "shaders"));
+            mViewer->getCamera()->addInitialDrawCallback(
+                new ProgramCacheDrawCallback(*shaderManager.getProgramCache()));
+            mWorkQueue->addWorkItem(new PrecompileProgramsWorkItem(shaderManager));
+        }
+
         mNavMesh = std::make_unique<NavMesh>(mRootNode, mWorkQueue, Settings::navigator().mEnableNavMeshRender,
             Settings::navigator().mNavMeshRenderMode);
         mActorsPaths = std::make_unique<ActorsPaths>(mRootNode, Settings::navigator().mEnableAgentsPathsRender);
@@ -470,10 +571,16 @@ namespace MWRender
 
         mObjects = std::make_unique<Objects>(mResourceSystem, sceneRoot, unrefQueue);
 
+        mSharedCull = new SceneUtil::SharedCull(
+            [this](std::vector<SceneUtil::SharedCullFrustum>& frusta) { computeSharedCullFrusta(frusta); });
+        mSharedCullCallback = mSharedCull->createPassCallback(SceneUtil::CullPass::Main);
+        mViewer->getCamera()->addCullCallback(mSharedCullCallback);
+
         if (getenv("OPENMW_DONT_PRECOMPILE") == nullptr)
         {
-            mViewer->setIncrementalCompileOperation(new osgUtil::IncrementalCompileOperation);
-            mViewer->getIncrementalCompileOperation()->setTargetFrameRate(Settings::cells().mTargetFramerate);
+            mUploadScheduler = new SceneUtil::UploadScheduler;
+            mUploadScheduler->setTargetFrameRate(Settings::cells().mTargetFramerate);
+            mViewer->setIncrementalCompileOperation(mUploadScheduler);
         }
 
         mDebugDraw = new Debug::DebugDrawer(mResourceSystem->getSceneManager()->getShaderManager());
@@ -493,6 +600,21 @@ namespace MWRender
         mTerrainStorage = std::make_unique<TerrainStorage>(mResourceSystem, normalMapPattern, heightMapPattern,
             useTerrainNormalMaps, specularMapPattern, useTerrainSpecularMaps);
 
+        if (Settings::terrain().mObjectPaging && Settings::terrain().mObjectPagingDiskCache)
+            mObjectPagingCache = std::make_unique<Resource::SceneFileCache>(
+                mResourceSystem->getSceneManager(), mWorkQueue, userDataPath / "objectpaging", false);
+
+        if (Settings::terrain().mCompositeMapDiskCache)
+            mCompositeMapCache = new Terrain::CompositeMapCache(mWorkQueue, userDataPath / "compositemaps");
+
+        if (Settings::models().mTemplateDiskCache)
+            mResourceSystem->getSceneManager()->setTemplateDiskCache(std::make_unique<Resource::SceneFileCache>(
+                mResourceSystem->getSceneManager(), mWorkQueue, userDataPath / "templates", true));
+
+        // Parts of a chunk are built on their own queue, chunks themselves are already built on the preloading one
+        if (Settings::terrain().mObjectPaging && Settings::terrain().mObjectPagingBuildThreads > 0)
+            mObjectPagingWorkQueue = new SceneUtil::WorkQueue(Settings::terrain().mObjectPagingBuildThreads);
+
         WorldspaceChunkMgr& chunkMgr = getWorldspaceChunkMgr(ESM::Cell::sDefaultWorldspaceId);
         mTerrain = chunkMgr.mTerrain.get();
         mGroundcover = chunkMgr.mGroundcover.get();
@@ -501,12 +623,26 @@ namespace MWRender
         mStateUpdater = new StateUpdater;
         sceneRoot->addUpdateCallback(mStateUpdater);
 
+        // Runs before the rest of the scene is updated, the main thread takes part in the work
+        if (Settings::game().mAnimationUpdateThreads > 0)
+        {
+            mSkeletonUpdater = new SceneUtil::ParallelSkeletonUpdater(
+                new SceneUtil::WorkQueue(Settings::game().mAnimationUpdateThreads));
+            sceneRoot->addUpdateCallback(mSkeletonUpdater);
+        }
+
         mSharedUniformStateUpdater = new SharedUniformStateUpdater();
         rootNode->addUpdateCallback(mSharedUniformStateUpdater);
 
         mPerViewUniformStateUpdater = new PerViewUniformStateUpdater(mResourceSystem->getSceneManager());
         rootNode->addCullCallback(mPerViewUniformStateUpdater);
 
+        if (Resource::TextureStreamer* const textureStreamer = mResourceSystem->getImageManager()->getTextureStreamer())
+        {
+            rootNode->addCullCallback(new TextureStreamingCullCallback(*textureStreamer));
+            mViewer->getCamera()->addInitialDrawCallback(new TextureStreamingDrawCallback(*textureStreamer));
+        }
+
         mPostProcessor = new PostProcessor(*this, viewer, mRootNode, resourceSystem->getVFS());
         resourceSystem->getSceneManager()->setOpaqueDepthTex(
             mPostProcessor->getTexture(PostProcessor::Tex_OpaqueDepth, 0),
@@ -514,10 +650,11 @@ namespace MWRender
         resourceSystem->getSceneManager()->setSoftParticles(Settings::shaders().mSoftParticles);
         resourceSystem->getSceneManager()->setSupportsNormalsRT(mPostProcessor->getSupportsNormalsRT());
         resourceSystem->getSceneManager()->setWeatherParticleOcclusion(Settings::shaders().mWeatherParticleOcclusion);
+        resourceSystem->getSceneManager()->setGpuSkinning(Settings::shaders().mGpuSkinning);
 
         // water goes after terrain for correct waterculling order
-        mWater = std::make_unique<Water>(
-            sceneRoot->getParent(0), sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation());
+        mWater = std::make_unique<Water>(sceneRoot->getParent(0), sceneRoot, mResourceSystem,
+            mViewer->getIncrementalCompileOperation(), mSharedCull);
 
         mCamera = std::make_unique<Camera>(mViewer->getCamera());
 
@@ -612,6 +749,12 @@ namespace MWRender
     {
         // let background loading thread finish before we delete anything else
         mWorkQueue = nullptr;
+
+        mViewer->getCamera()->removeCullCallback(mSharedCullCallback);
+
+        if (const Shader::ProgramCache* programCache
+            = mResourceSystem->getSceneManager()->getShaderManager().getProgramCache())
+            programCache->save();
     }
 
     osgUtil::IncrementalCompileOperation* RenderingManager::getIncrementalCompileOperation()
@@ -897,6 +1040,9 @@ namespace MWRender
 
         mResourceSystem->getSceneManager()->getShaderManager().update(*mViewer);
 
+        if (Resource::TextureStreamer* const textureStreamer = mResourceSystem->getImageManager()->getTextureStreamer())
+            textureStreamer->update(mViewer->getFrameStamp()->getFrameNumber());
+
         float rainIntensity = mSky->getPrecipitationAlpha();
         mWater->setRainIntensity(rainIntensity);
         mWater->setRainRipplesEnabled(mSky->getRainRipplesEnabled());
@@ -918,6 +1064,15 @@ namespace MWRender
         updateNavMesh();
         updateRecastMesh();
 
+        if (mSkeletonUpdater)
+        {
+            std::vector<osg::ref_ptr<SceneUtil::Skeleton>> skeletons;
+            mObjects->collectSkeletons(skeletons);
+            if (SceneUtil::Skeleton* skeleton = mPlayerAnimation.get() ? mPlayerAnimation->getSkeleton() : nullptr)
+                skeletons.emplace_back(skeleton);
+            mSkeletonUpdater->setSkeletons(std::move(skeletons));
+        }
+
         if (mUpdateProjectionMatrix)
         {
             mUpdateProjectionMatrix = false;
@@ -1469,8 +1624,9 @@ namespace MWRender
                 lodFactor, vertexLodMod, maxCompGeometrySize, debugChunks, worldspace, expiryDelay);
             if (Settings::terrain().mObjectPaging)
             {
-                newChunkMgr.mObjectPaging
-                    = std::make_unique<ObjectPaging>(mResourceSystem->getSceneManager(), worldspace);
+                newChunkMgr.mObjectPaging = std::make_unique<ObjectPaging>(
+                    mResourceSystem->getSceneManager(), worldspace, mObjectPagingCache.get(),
+                    mObjectPagingWorkQueue.get());
                 quadTreeWorld->addChunkManager(newChunkMgr.mObjectPaging.get());
                 mResourceSystem->addResourceManager(newChunkMgr.mObjectPaging.get());
             }
@@ -1491,6 +1647,13 @@ namespace MWRender
                 mTerrainStorage.get(), Mask_Terrain, worldspace, expiryDelay, Mask_PreCompile, Mask_Debug);
 
         newChunkMgr.mTerrain->setTargetFrameRate(Settings::cells().mTargetFramerate);
+        newChunkMgr.mTerrain->setUploadScheduler(mUploadScheduler);
+        if (Settings::camera().mSharedCulling)
+            newChunkMgr.mTerrain->setSharedCull(mSharedCull);
+        newChunkMgr.mTerrain->setCompositeMapCache(mCompositeMapCache.get());
+        // The shadow casting program does not decode them
+        newChunkMgr.mTerrain->setCompactVertices(Settings::terrain().mCompactVertices
+            && !(Settings::shadows().mEnableShadows && Settings::shadows().mTerrainShadows));
         float distanceMult = std::cos(osg::DegreesToRadians(std::min(mFieldOfView, 140.f)) / 2.f);
         newChunkMgr.mTerrain->setViewDistance(mViewDistance * (distanceMult ? 1.f / distanceMult : 1.f));
 
@@ -1504,9 +1667,38 @@ namespace MWRender
         if (stats->collectStats("resource"))
         {
             mTerrain->reportStats(frameNumber, stats);
+            mShadowManager->reportStats(frameNumber, *stats);
+            if (mSkeletonUpdater)
+                mSkeletonUpdater->reportStats(frameNumber, *stats);
+            SceneUtil::RigGeometry::reportStats(frameNumber, *stats);
+            if (mUploadScheduler)
+                mUploadScheduler->reportStats(frameNumber, *stats);
+            mSharedCull->reportStats(frameNumber, *stats);
+            if (const Shader::ProgramCache* programCache
+                = mResourceSystem->getSceneManager()->getShaderManager().getProgramCache())
+                programCache->reportStats(frameNumber, *stats);
         }
     }
 
+    void RenderingManager::computeSharedCullFrusta(std::vector<SceneUtil::SharedCullFrustum>& frusta) const
+    {
+        const osg::Camera& camera = *mViewer->getCamera();
+        const auto addView = [&](const osg::Matrixd& view, const osg::Matrixd& projection) {
+            frusta.push_back(SceneUtil::SharedCullFrustum{ .mViewProjection = view * projection });
+            mWater->addSharedCullFrusta(view, projection, frusta);
+        };
+        if (Stereo::getStereo())
+        {
+            // Both eyes are culled by the main camera with a frustum covering them, refined here per eye
+            const Stereo::Manager& manager = Stereo::Manager::instance();
+            for (int i = 0; i < 2; ++i)
+                addView(camera.getViewMatrix() * manager.computeEyeViewOffset(i),
+                    manager.computeEyeProjection(i, false));
+        }
+        else
+            addView(camera.getViewMatrix(), camera.getProjectionMatrix());
+    }
+
     void RenderingManager::processChangedSettings(const Settings::CategorySettingVector& changed)
     {
         // Only perform a projection matrix update once if a relevant setting is changed.
@@ -15,11 +15,14 @@
 #include "rendermode.hpp"
 
 #include <deque>
+#include <filesystem>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace osg
 {
+    class Callback;
     class Group;
     class PositionAttitudeTransform;
 }
@@ -33,6 +36,7 @@ namespace osgUtil
 namespace Resource
 {
     class ResourceSystem;
+    class SceneFileCache;
 }
 
 namespace osgViewer
@@ -49,6 +53,7 @@ namespace ESM
 
 namespace Terrain
 {
+    class CompositeMapCache;
     class World;
 }
 
@@ -59,10 +64,14 @@ namespace Fallback
 
 namespace SceneUtil
 {
+    class ParallelSkeletonUpdater;
     class ShadowManager;
+    class SharedCull;
+    struct SharedCullFrustum;
     class WorkQueue;
     class LightManager;
     class UnrefQueue;
+    class UploadScheduler;
 }
 
 namespace DetourNavigator
@@ -113,7 +122,7 @@ namespace MWRender
         RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode,
             Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
             DetourNavigator::Navigator& navigator, const MWWorld::GroundcoverStore& groundcoverStore,
-            SceneUtil::UnrefQueue& unrefQueue);
+            SceneUtil::UnrefQueue& unrefQueue, const std::filesystem::path& userDataPath);
         ~RenderingManager();
 
         osgUtil::IncrementalCompileOperation* getIncrementalCompileOperation();
@@ -294,6 +303,8 @@ namespace MWRender
 
         void reportStats() const;
 
+        void computeSharedCullFrusta(std::vector<SceneUtil::SharedCullFrustum>& frusta) const;
+
         void updateNavMesh();
 
         void updateRecastMesh();
@@ -322,6 +333,13 @@ namespace MWRender
         std::unique_ptr<Pathgrid> mPathgrid;
         std::unique_ptr<Objects> mObjects;
         std::unique_ptr<Water> mWater;
+        std::unique_ptr<Resource::SceneFileCache> mObjectPagingCache;
+        osg::ref_ptr<Terrain::CompositeMapCache> mCompositeMapCache;
+        osg::ref_ptr<SceneUtil::WorkQueue> mObjectPagingWorkQueue;
+        osg::ref_ptr<SceneUtil::ParallelSkeletonUpdater> mSkeletonUpdater;
+        osg::ref_ptr<SceneUtil::UploadScheduler> mUploadScheduler;
+        osg::ref_ptr<SceneUtil::SharedCull> mSharedCull;
+        osg::ref_ptr<osg::Callback> mSharedCullCallback;
         std::unordered_map<ESM::RefId, WorldspaceChunkMgr> mWorldspaceChunks;
         Terrain::World* mTerrain;
         std::unique_ptr<TerrainStorage> mTerrainStorage;
@@ -1,5 +1,6 @@
 #include "water.hpp"
 
+#include <cmath>
 #include <sstream>
 
 #include <osg/ClipNode>
@@ -22,6 +23,7 @@
 #include <components/sceneutil/depth.hpp>
 #include <components/sceneutil/rtt.hpp>
 #include <components/sceneutil/shadow.hpp>
+#include <components/sceneutil/sharedcull.hpp>
 #include <components/sceneutil/waterutil.hpp>
 
 #include <components/misc/constants.hpp>
@@ -47,6 +49,18 @@
 
 namespace MWRender
 {
+    namespace
+    {
+        /// Offset of the clip plane along its normal preventing bleeding at the water shore, growing with the distance
+        /// of the eye point to the plane.
+        float computeClipFudge(const osg::Plane& plane, double eyeZ)
+        {
+            float fov = Settings::camera().mFieldOfView;
+            const float clipFudgeMin = 2.5; // minimum offset of clip plane
+            const float clipFudgeScale = -15000.0;
+            return abs(abs(plane[3]) - eyeZ) * fov / clipFudgeScale - clipFudgeMin;
+        }
+    }
 
     // --------------------------------------------------------------------------------------------------------------------------------
 
@@ -114,10 +128,7 @@ namespace MWRender
                 }
 
                 // move the plane back along its normal a little bit to prevent bleeding at the water shore
-                float fov = Settings::camera().mFieldOfView;
-                const float clipFudgeMin = 2.5; // minimum offset of clip plane
-                const float clipFudgeScale = -15000.0;
-                float clipFudge = abs(abs((*mCullPlane)[3]) - eyePoint.z()) * fov / clipFudgeScale - clipFudgeMin;
+                float clipFudge = computeClipFudge(*mCullPlane, eyePoint.z());
                 modelViewMatrix->preMultTranslate(mCullPlane->getNormal() * clipFudge);
 
                 cv->pushModelViewMatrix(modelViewMatrix, osg::Transform::RELATIVE_RF);
@@ -156,6 +167,8 @@ namespace MWRender
             mClipNode->setCullingActive(false);
         }
 
+        const osg::Plane& getPlane() const { return mPlane; }
+
     private:
         osg::ref_ptr<osg::Group> mClipNodeTransform;
         osg::ref_ptr<osg::ClipNode> mClipNode;
@@ -247,8 +260,9 @@ namespace MWRender
     class Refraction : public SceneUtil::RTTNode
     {
     public:
-        Refraction(uint32_t rttSize)
+        Refraction(uint32_t rttSize, SceneUtil::SharedCull* sharedCull)
             : RTTNode(rttSize, rttSize, 0, false, 1, StereoAwareness::Aware, shouldAddMSAAIntermediateTarget())
+            , mSharedCull(sharedCull)
             , mNodeMask(Refraction::sDefaultCullMask)
         {
             setDepthBufferInternalFormat(GL_DEPTH24_STENCIL8);
@@ -261,6 +275,8 @@ namespace MWRender
             camera->setSmallFeatureCullingPixelSize(Settings::water().mSmallFeatureCullingPixelSize);
             camera->setName("RefractionCamera");
             camera->addCullCallback(new InheritViewPointCallback);
+            if (mSharedCull)
+                camera->addCullCallback(mSharedCull->createPassCallback(SceneUtil::CullPass::Refraction));
             camera->setComputeNearFarMode(osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR);
 
             // No need for fog here, we are already applying fog on the water surface itself as well as underwater fog
@@ -303,6 +319,10 @@ namespace MWRender
             mClipCullNode->setPlane(osg::Plane(osg::Vec3d(0, 0, -1), osg::Vec3d(0, 0, waterLevel)));
         }
 
+        const osg::Matrix& getViewMatrix() const { return mViewMatrix; }
+
+        const osg::Plane& getPlane() const { return mClipCullNode->getPlane(); }
+
         void showWorld(bool show)
         {
             if (show)
@@ -314,6 +334,7 @@ namespace MWRender
     private:
         osg::ref_ptr<ClipCullNode> mClipCullNode;
         osg::ref_ptr<osg::Node> mScene;
+        osg::ref_ptr<SceneUtil::SharedCull> mSharedCull;
         osg::Matrix mViewMatrix{ osg::Matrix::identity() };
 
         unsigned int mNodeMask;
@@ -326,8 +347,9 @@ namespace MWRender
     class Reflection : public SceneUtil::RTTNode
     {
     public:
-        Reflection(uint32_t rttSize, bool isInterior)
+        Reflection(uint32_t rttSize, bool isInterior, SceneUtil::SharedCull* sharedCull)
             : RTTNode(rttSize, rttSize, 0, false, 0, StereoAwareness::Aware, shouldAddMSAAIntermediateTarget())
+            , mSharedCull(sharedCull)
         {
             setInterior(isInterior);
             setDepthBufferInternalFormat(GL_DEPTH24_STENCIL8);
@@ -340,6 +362,8 @@ namespace MWRender
             camera->setSmallFeatureCullingPixelSize(Settings::water().mSmallFeatureCullingPixelSize);
             camera->setName("ReflectionCamera");
             camera->addCullCallback(new InheritViewPointCallback);
+            if (mSharedCull)
+                camera->addCullCallback(mSharedCull->createPassCallback(SceneUtil::CullPass::Reflection));
 
             // Inform the shader that we're in a reflection
             camera->getOrCreateStateSet()->addUniform(new osg::Uniform("isReflection", true));
@@ -373,6 +397,10 @@ namespace MWRender
             mClipCullNode->setPlane(osg::Plane(osg::Vec3d(0, 0, 1), osg::Vec3d(0, 0, waterLevel)));
         }
 
+        const osg::Matrix& getViewMatrix() const { return mViewMatrix; }
+
+        const osg::Plane& getPlane() const { return mClipCullNode->getPlane(); }
+
         void setScene(osg::Node* scene)
         {
             if (mScene)
@@ -410,6 +438,7 @@ namespace MWRender
 
         osg::ref_ptr<ClipCullNode> mClipCullNode;
         osg::ref_ptr<osg::Node> mScene;
+        osg::ref_ptr<SceneUtil::SharedCull> mSharedCull;
         osg::Node::NodeMask mNodeMask;
         osg::Matrix mViewMatrix{ osg::Matrix::identity() };
         bool mInterior;
@@ -439,11 +468,12 @@ namespace MWRender
     };
 
     Water::Water(osg::Group* parent, osg::Group* sceneRoot, Resource::ResourceSystem* resourceSystem,
-        osgUtil::IncrementalCompileOperation* ico)
+        osgUtil::IncrementalCompileOperation* ico, SceneUtil::SharedCull* sharedCull)
         : mRainSettingsUpdater(nullptr)
         , mParent(parent)
         , mSceneRoot(sceneRoot)
         , mResourceSystem(resourceSystem)
+        , mSharedCull(sharedCull)
         , mEnabled(true)
         , mToggled(true)
         , mTop(0)
@@ -505,6 +535,25 @@ namespace MWRender
         }
     }
 
+    void Water::addSharedCullFrusta(const osg::Matrixd& view, const osg::Matrixd& projection,
+        std::vector<SceneUtil::SharedCullFrustum>& frusta) const
+    {
+        // The cameras are relative to the main one and the clip fudge moves the scene along the plane's normal
+        const auto addFrustum = [&](const osg::Matrix& passView, const osg::Plane& plane) {
+            const osg::Matrixd viewMatrix = passView * view;
+            const osg::Vec3d eyePoint = osg::Matrixd::inverse(viewMatrix).getTrans();
+            frusta.push_back(SceneUtil::SharedCullFrustum{
+                .mViewProjection = viewMatrix * projection,
+                .mMargin = std::abs(computeClipFudge(plane, eyePoint.z())),
+            });
+        };
+
+        if (mReflection)
+            addFrustum(mReflection->getViewMatrix(), mReflection->getPlane());
+        if (mRefraction)
+            addFrustum(mRefraction->getViewMatrix(), mRefraction->getPlane());
+    }
+
     void Water::updateWaterMaterial()
     {
         if (mShaderWaterStateSetUpdater)
@@ -537,7 +586,7 @@ namespace MWRender
         {
             const unsigned int rttSize = Settings::water().mRttSize;
 
-            mReflection = new Reflection(rttSize, mInterior);
+            mReflection = new Reflection(rttSize, mInterior, mSharedCull);
             mReflection->setWaterLevel(mTop);
             mReflection->setScene(mSceneRoot);
             if (mCullCallback)
@@ -546,7 +595,7 @@ namespace MWRender
 
             if (Settings::water().mRefraction)
             {
-                mRefraction = new Refraction(rttSize);
+                mRefraction = new Refraction(rttSize, mSharedCull);
                 mRefraction->setWaterLevel(mTop);
                 mRefraction->setScene(mSceneRoot);
                 if (mCullCallback)
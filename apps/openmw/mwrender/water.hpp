@@ -17,6 +17,7 @@ namespace osg
     class Geometry;
     class Node;
     class Callback;
+    class Matrixd;
 }
 
 namespace osgUtil
@@ -24,6 +25,12 @@ namespace osgUtil
     class IncrementalCompileOperation;
 }
 
+namespace SceneUtil
+{
+    class SharedCull;
+    struct SharedCullFrustum;
+}
+
 namespace Resource
 {
     class ResourceSystem;
@@ -60,6 +67,7 @@ namespace MWRender
         osg::ref_ptr<osg::Geometry> mWaterGeom;
         Resource::ResourceSystem* mResourceSystem;
         osg::ref_ptr<osgUtil::IncrementalCompileOperation> mIncrementalCompileOperation;
+        osg::ref_ptr<SceneUtil::SharedCull> mSharedCull;
 
         std::unique_ptr<RippleSimulation> mSimulation;
 
@@ -87,11 +95,15 @@ namespace MWRender
 
     public:
         Water(osg::Group* parent, osg::Group* sceneRoot, Resource::ResourceSystem* resourceSystem,
-            osgUtil::IncrementalCompileOperation* ico);
+            osgUtil::IncrementalCompileOperation* ico, SceneUtil::SharedCull* sharedCull);
         ~Water();
 
         void setCullCallback(osg::Callback* callback);
 
+        /// Add the frusta of the reflection and refraction views for the main view of the given matrices.
+        void addSharedCullFrusta(const osg::Matrixd& view, const osg::Matrixd& projection,
+            std::vector<SceneUtil::SharedCullFrustum>& frusta) const;
+
         void listAssetsToPreload(std::vector<std::string>& textures);
 
         void setEnabled(bool enabled);
@@ -60,6 +60,17 @@
 
 namespace
 {
+    // gravity constant - must be way lower than the gravity affecting actors, since we're not
+    // simulating aerodynamics at all
+    constexpr float projectileGravity = Constants::GravityConst * Constants::UnitsPerMeter * 0.1f;
+
+    // Velocity and gravity are integrated by the physics simulation from now on
+    void launchBallisticProjectile(MWPhysics::Projectile& projectile, const osg::Vec3f& velocity)
+    {
+        projectile.setVelocity(velocity);
+        projectile.setGravity(projectileGravity);
+    }
+
     ESM::EffectList getMagicBoltData(std::vector<ESM::RefId>& projectileIDs, std::set<ESM::RefId>& sounds, float& speed,
         std::string& texture, std::string& sourceName, const ESM::RefId& id)
     {
@@ -360,6 +371,7 @@ namespace MWWorld
 
         state.mProjectileId = mPhysics->addProjectile(actor, pos, model, false);
         state.mToDelete = false;
+        launchBallisticProjectile(*mPhysics->getProjectile(state.mProjectileId), state.mVelocity);
         mProjectiles.push_back(state);
     }
 
@@ -479,21 +491,6 @@ namespace MWWorld
             auto* projectile = mPhysics->getProjectile(projectileState.mProjectileId);
             if (!projectile->isActive())
                 continue;
-            // gravity constant - must be way lower than the gravity affecting actors, since we're not
-            // simulating aerodynamics at all
-            projectileState.mVelocity
-                -= osg::Vec3f(0, 0, Constants::GravityConst * Constants::UnitsPerMeter * 0.1f) * duration;
-
-            projectile->setVelocity(projectileState.mVelocity);
-
-            // rotation does not work well for throwing projectiles - their roll angle will depend on shooting
-            // direction.
-            if (!projectileState.mThrown)
-            {
-                osg::Quat orient;
-                orient.makeRotate(osg::Vec3f(0, 1, 0), projectileState.mVelocity);
-                projectileState.mNode->setAttitude(orient);
-            }
 
             update(projectileState, duration);
 
@@ -521,7 +518,19 @@ namespace MWWorld
             projectileState.mNode->setPosition(pos);
 
             if (projectile->isActive())
+            {
+                projectileState.mVelocity = projectile->getVelocity();
+
+                // rotation does not work well for throwing projectiles - their roll angle will depend on shooting
+                // direction.
+                if (!projectileState.mThrown)
+                {
+                    osg::Quat orient;
+                    orient.makeRotate(osg::Vec3f(0, 1, 0), projectileState.mVelocity);
+                    projectileState.mNode->setAttitude(orient);
+                }
                 continue;
+            }
 
             const auto target = projectile->getTarget();
             auto caster = projectileState.getCaster();
@@ -704,6 +713,7 @@ namespace MWWorld
 
                 state.mProjectileId
                     = mPhysics->addProjectile(state.getCaster(), osg::Vec3f(esm.mPosition), model, false);
+                launchBallisticProjectile(*mPhysics->getProjectile(state.mProjectileId), state.mVelocity);
             }
             catch (const std::exception& e)
             {
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <limits>
+#include <memory>
 
 #include <BulletCollision/CollisionDispatch/btCollisionObject.h>
 
@@ -445,8 +446,9 @@ namespace MWWorld
 
             if (data)
             {
+                // The navigator references the land heights, keeping them resident even when physics compresses them
                 mPhysics->addHeightField(data->getHeights().data(), cellX, cellY, worldsize, verts,
-                    data->getMinHeight(), data->getMaxHeight(), land.get());
+                    data->getMinHeight(), data->getMaxHeight(), land.get(), Settings::navigator().mEnable);
             }
             else if (!ESM::isEsm4Ext(worldspace))
             {
@@ -469,6 +471,9 @@ namespace MWWorld
                     {
                         DetourNavigator::HeightfieldSurface heights;
                         heights.mHeights = data->getHeights().data();
+                        // Physics doesn't hold the land when compressing heightfields
+                        if (Settings::physics().mCompressHeightfields)
+                            heights.mHeightsHolder = std::shared_ptr<const void>(land.get(), [land](const void*) {});
                         heights.mSize = static_cast<std::size_t>(data->getLandSize());
                         heights.mMinHeight = data->getMinHeight();
                         heights.mMaxHeight = data->getMaxHeight();
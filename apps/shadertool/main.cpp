@@ -0,0 +1,236 @@
+#include "permutations.hpp"
+
+#include <components/debug/debugging.hpp>
+#include <components/debug/debuglog.hpp>
+#include <components/files/collections.hpp>
+#include <components/files/configurationmanager.hpp>
+#include <components/files/conversion.hpp>
+#include <components/files/multidircollection.hpp>
+#include <components/platform/platform.hpp>
+#include <components/resource/bgsmfilemanager.hpp>
+#include <components/resource/imagemanager.hpp>
+#include <components/resource/niffilemanager.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/lightingmethod.hpp>
+#include <components/settings/settings.hpp>
+#include <components/settings/values.hpp>
+#include <components/shader/programcache.hpp>
+#include <components/shader/shadermanager.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+#include <components/version/version.hpp>
+#include <components/vfs/manager.hpp>
+#include <components/vfs/registerarchives.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    namespace bpo = boost::program_options;
+
+    using StringsVector = std::vector<std::string>;
+
+    constexpr std::string_view applicationName = "ShaderTool";
+
+    bpo::options_description makeOptionsDescription()
+    {
+        bpo::options_description result;
+        auto addOption = result.add_options();
+        addOption("help", "print help message");
+
+        addOption("version", "print version information and quit");
+
+        addOption("data",
+            bpo::value<Files::MaybeQuotedPathContainer>()
+                ->default_value(Files::MaybeQuotedPathContainer(), "data")
+                ->multitoken()
+                ->composing(),
+            "set data directories (later directories have higher priority)");
+
+        addOption("data-local",
+            bpo::value<Files::MaybeQuotedPathContainer::value_type>()->default_value(
+                Files::MaybeQuotedPathContainer::value_type(), ""),
+            "set local data directory (highest priority)");
+
+        addOption("fallback-archive",
+            bpo::value<StringsVector>()->default_value(StringsVector(), "fallback-archive")->multitoken()->composing(),
+            "set fallback BSA archives (later archives have higher priority)");
+
+        addOption("encoding", bpo::value<std::string>()->default_value("win1252"),
+            "Character encoding used in OpenMW game messages:\n"
+            "\n\twin1250 - Central and Eastern European such as Polish, Czech, Slovak, Hungarian, Slovene, Bosnian, "
+            "Croatian, Serbian (Latin script), Romanian and Albanian languages\n"
+            "\n\twin1251 - Cyrillic alphabet such as Russian, Bulgarian, Serbian Cyrillic and other languages\n"
+            "\n\twin1252 - Western European (Latin) alphabet, used by default");
+
+        addOption("output", bpo::value<Files::MaybeQuotedPath>(),
+            "directory to write the manifest of the shader programs to, use the shaders directory of the user data "
+            "with the program cache setting to compile them at startup");
+
+        Files::ConfigurationManager::addCommonOptions(result);
+
+        return result;
+    }
+
+    // Mirrors the scene manager setup of the engine, the programs depend on it
+    void configureSceneManager(Resource::SceneManager& sceneManager)
+    {
+        const SceneUtil::LightingMethod lightingMethod = Settings::shaders().mLightingMethod;
+        const bool forceShaders = Settings::shaders().mForceShaders || Settings::fog().mRadialFog
+            || Settings::fog().mExponentialFog || Settings::fog().mSkyBlending || Settings::shaders().mSoftParticles
+            || Settings::shadows().mEnableShadows || lightingMethod != SceneUtil::LightingMethod::FFP
+            || Settings::camera().mReverseZ;
+
+        sceneManager.setForceShaders(forceShaders);
+        sceneManager.setClampLighting(Settings::shaders().mClampLighting);
+        sceneManager.setAutoUseNormalMaps(Settings::shaders().mAutoUseObjectNormalMaps);
+        sceneManager.setNormalMapPattern(Settings::shaders().mNormalMapPattern);
+        sceneManager.setNormalHeightMapPattern(Settings::shaders().mNormalHeightMapPattern);
+        sceneManager.setAutoUseSpecularMaps(Settings::shaders().mAutoUseObjectSpecularMaps);
+        sceneManager.setSpecularMapPattern(Settings::shaders().mSpecularMapPattern);
+        sceneManager.setApplyLightingToEnvMaps(Settings::shaders().mApplyLightingToEnvironmentMaps);
+        sceneManager.setConvertAlphaTestToAlphaToCoverage(
+            Settings::shaders().mAntialiasAlphaTest && Settings::video().mAntialiasing > 1);
+        sceneManager.setAdjustCoverageForAlphaTest(Settings::shaders().mAdjustCoverageForAlphaTest);
+        sceneManager.setLightingMethod(lightingMethod);
+        sceneManager.setSoftParticles(Settings::shaders().mSoftParticles);
+        sceneManager.setWeatherParticleOcclusion(Settings::shaders().mWeatherParticleOcclusion);
+        sceneManager.setGpuSkinning(Settings::shaders().mGpuSkinning);
+    }
+
+    int runShaderTool(int argc, char* argv[])
+    {
+        Platform::init();
+
+        bpo::options_description desc = makeOptionsDescription();
+
+        bpo::parsed_options options = bpo::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+        bpo::variables_map variables;
+
+        bpo::store(options, variables);
+        bpo::notify(variables);
+
+        if (variables.find("help") != variables.end())
+        {
+            Debug::getRawStdout() << desc << std::endl;
+            return 0;
+        }
+
+        if (variables.find("output") == variables.end())
+        {
+            std::cerr << "Missing output directory" << std::endl;
+            return -1;
+        }
+
+        Files::ConfigurationManager config;
+        config.readConfiguration(variables, desc);
+
+        Debug::setupLogging(config.getLogPath(), applicationName);
+
+        const std::string encoding(variables["encoding"].as<std::string>());
+        Log(Debug::Info) << ToUTF8::encodingUsingMessage(encoding);
+        ToUTF8::Utf8Encoder encoder(ToUTF8::calculateEncoding(encoding));
+
+        Files::PathContainer dataDirs(asPathContainer(variables["data"].as<Files::MaybeQuotedPathContainer>()));
+
+        auto local = variables["data-local"].as<Files::MaybeQuotedPathContainer::value_type>();
+        if (!local.empty())
+            dataDirs.push_back(std::move(local));
+
+        config.filterOutNonExistingPaths(dataDirs);
+
+        const auto& resDir = variables["resources"].as<Files::MaybeQuotedPath>();
+        Log(Debug::Info) << Version::getOpenmwVersionDescription();
+        dataDirs.insert(dataDirs.begin(), resDir / "vfs");
+        const Files::Collections fileCollections(dataDirs);
+        const auto& archives = variables["fallback-archive"].as<StringsVector>();
+
+        const std::filesystem::path output = variables["output"].as<Files::MaybeQuotedPath>();
+
+        VFS::Manager vfs;
+
+        VFS::registerArchives(&vfs, fileCollections, archives, true);
+
+        Settings::Manager::load(config);
+
+        constexpr double expiryDelay = 0;
+        Resource::ImageManager imageManager(&vfs, expiryDelay);
+        Resource::NifFileManager nifFileManager(&vfs, &encoder.getStatelessEncoder());
+        Resource::BgsmFileManager bgsmFileManager(&vfs, expiryDelay);
+        Resource::SceneManager sceneManager(&vfs, &imageManager, &nifFileManager, &bgsmFileManager, expiryDelay);
+
+        const std::filesystem::path shaderPath = resDir / "shaders";
+        sceneManager.setShaderPath(shaderPath);
+        configureSceneManager(sceneManager);
+
+        // The global defines only change the sources of the programs and need a graphics context to be known, any
+        // value lets the templates be parsed
+        Shader::ShaderManager& shaderManager = sceneManager.getShaderManager();
+        Shader::ShaderManager::DefineMap globalDefines;
+        for (const std::string& name : ShaderTool::collectDefineNames(shaderPath))
+            globalDefines.emplace(name, "0");
+        shaderManager.setGlobalDefines(globalDefines);
+
+        shaderManager.setProgramCache(std::make_unique<Shader::ProgramCache>(output));
+        const Shader::ProgramCache& programCache = *shaderManager.getProgramCache();
+
+        const std::vector<VFS::Path::Normalized> meshes = ShaderTool::collectMeshes(vfs);
+
+        Log(Debug::Info) << "Collecting shader programs of " << meshes.size() << " meshes";
+
+        std::map<const osg::Program*, std::size_t> programUses;
+        for (std::size_t i = 0; i < meshes.size(); ++i)
+        {
+            try
+            {
+                const osg::ref_ptr<const osg::Node> mesh = sceneManager.getTemplate(meshes[i].value(), false);
+                for (const osg::Program* program : ShaderTool::collectPrograms(*mesh))
+                    ++programUses[program];
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Warning) << "Failed to load \"" << meshes[i] << "\": " << e.what();
+            }
+
+            // Templates are only needed once, the programs are kept by the shader manager
+            sceneManager.clearCache();
+            imageManager.clearCache();
+            nifFileManager.clearCache();
+
+            if ((i + 1) % 1000 == 0)
+                Log(Debug::Info) << "Processed " << (i + 1) << " of " << meshes.size() << " meshes";
+        }
+
+        std::map<Shader::ProgramPermutation, std::size_t> uses;
+        std::set<std::string> templateNames;
+        for (const Shader::ProgramPermutation& permutation : programCache.getPermutations())
+        {
+            const auto it = programUses.find(shaderManager.getProgram(permutation).get());
+            uses.emplace(permutation, it == programUses.end() ? 0 : it->second);
+            templateNames.insert(permutation.mTemplateName);
+        }
+
+        programCache.saveManifest(uses);
+
+        Log(Debug::Info) << "Done, found " << uses.size() << " permutations of " << templateNames.size()
+                         << " shader templates, written to " << Files::pathToUnicodeString(output);
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    return Debug::wrapApplication(runShaderTool, argc, argv, applicationName);
+}
@@ -0,0 +1,93 @@
+#include "permutations.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+#include <osg/NodeVisitor>
+#include <osg/Program>
+#include <osg/StateSet>
+
+#include <components/misc/pathhelpers.hpp>
+#include <components/vfs/manager.hpp>
+#include <components/vfs/recursivedirectoryiterator.hpp>
+
+namespace ShaderTool
+{
+    namespace
+    {
+        constexpr std::array<std::string_view, 3> directives{ "foreach", "endforeach", "link" };
+
+        constexpr std::array<std::string_view, 7> meshExtensions{ "nif", "osg", "osgt", "osgb", "osgx", "osg2",
+            "dae" };
+
+        bool isIdentifierCharacter(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        class CollectProgramsVisitor : public osg::NodeVisitor
+        {
+        public:
+            CollectProgramsVisitor()
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            {
+            }
+
+            void apply(osg::Node& node) override
+            {
+                if (const osg::StateSet* stateSet = node.getStateSet())
+                    if (const osg::StateAttribute* program = stateSet->getAttribute(osg::StateAttribute::PROGRAM))
+                        mPrograms.insert(static_cast<const osg::Program*>(program));
+                traverse(node);
+            }
+
+            std::set<const osg::Program*> mPrograms;
+        };
+    }
+
+    std::set<std::string> collectDefineNames(const std::filesystem::path& shaderPath)
+    {
+        std::set<std::string> result;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(shaderPath))
+        {
+            if (!entry.is_regular_file())
+                continue;
+            std::ifstream stream(entry.path(), std::ios_base::in | std::ios_base::binary);
+            const std::string source{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+            for (std::size_t pos = source.find('@'); pos != std::string::npos; pos = source.find('@', pos))
+            {
+                const std::size_t begin = ++pos;
+                while (pos < source.size() && isIdentifierCharacter(source[pos]))
+                    ++pos;
+                const std::string_view name = std::string_view(source).substr(begin, pos - begin);
+                if (!name.empty() && std::find(directives.begin(), directives.end(), name) == directives.end())
+                    result.emplace(name);
+            }
+        }
+        return result;
+    }
+
+    std::vector<VFS::Path::Normalized> collectMeshes(const VFS::Manager& vfs)
+    {
+        constexpr VFS::Path::NormalizedView meshes("meshes/");
+        std::vector<VFS::Path::Normalized> result;
+        for (const VFS::Path::Normalized& path : vfs.getRecursiveDirectoryIterator(meshes))
+        {
+            const std::string_view extension = Misc::getFileExtension(path.value());
+            if (std::find(meshExtensions.begin(), meshExtensions.end(), extension) != meshExtensions.end())
+                result.push_back(path);
+        }
+        return result;
+    }
+
+    std::set<const osg::Program*> collectPrograms(const osg::Node& node)
+    {
+        CollectProgramsVisitor visitor;
+        // The visitor doesn't modify the node
+        const_cast<osg::Node&>(node).accept(visitor);
+        return std::move(visitor.mPrograms);
+    }
+}
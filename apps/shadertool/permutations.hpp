@@ -0,0 +1,34 @@
+#ifndef OPENMW_SHADERTOOL_PERMUTATIONS_H
+#define OPENMW_SHADERTOOL_PERMUTATIONS_H
+
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <components/vfs/pathutil.hpp>
+
+namespace osg
+{
+    class Node;
+    class Program;
+}
+
+namespace VFS
+{
+    class Manager;
+}
+
+namespace ShaderTool
+{
+    /// @return Names of all the defines the shader templates in the directory refer to, without the directives.
+    std::set<std::string> collectDefineNames(const std::filesystem::path& shaderPath);
+
+    /// @return Paths of all the meshes the scene manager can load from the data directories.
+    std::vector<VFS::Path::Normalized> collectMeshes(const VFS::Manager& vfs);
+
+    /// @return Programs set by the state sets of the node and its children.
+    std::set<const osg::Program*> collectPrograms(const osg::Node& node);
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <osg/Vec2i>
 
 #include <cstddef>
+#include <memory>
 #include <variant>
 
 namespace DetourNavigator
@@ -21,6 +22,8 @@ namespace DetourNavigator
         std::size_t mSize;
         float mMinHeight;
         float mMaxHeight;
+        // Keeps mHeights alive for as long as the navigator references them when the caller does not own them
+        std::shared_ptr<const void> mHeightsHolder;
     };
 
     using HeightfieldShape = std::variant<HeightfieldPlane, HeightfieldSurface>;
@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -127,6 +128,54 @@ namespace ESMTerrain
         }
     }
 
+    struct CellRow
+    {
+        std::size_t mCellX;
+        std::size_t mCellY;
+        std::size_t mLocalX;
+        std::size_t mLocalY;
+        std::size_t mVertexX;
+        std::size_t mVertexY;
+        // Samples are mLocalX + i * sampleSize of the cell for vertices mVertexX + i
+        std::size_t mCount;
+    };
+
+    /// Same samples as sampleCellGrid, consecutive samples of the same row of a cell are passed as a single CellRow.
+    template <class F>
+    void sampleCellGridRows(std::size_t cellSize, std::size_t sampleSize, std::size_t beginX, std::size_t beginY,
+        std::size_t distance, F&& f)
+    {
+        std::optional<CellRow> row;
+
+        sampleCellGrid(cellSize, sampleSize, beginX, beginY, distance,
+            [&](std::size_t cellX, std::size_t cellY, std::size_t x, std::size_t y, std::size_t vertX,
+                std::size_t vertY) {
+                if (row.has_value() && row->mCellX == cellX && row->mCellY == cellY && row->mLocalY == y
+                    && row->mVertexY == vertY && row->mLocalX + row->mCount * sampleSize == x
+                    && row->mVertexX + row->mCount == vertX)
+                {
+                    ++row->mCount;
+                    return;
+                }
+
+                if (row.has_value())
+                    f(*row);
+
+                row = CellRow{
+                    .mCellX = cellX,
+                    .mCellY = cellY,
+                    .mLocalX = x,
+                    .mLocalY = y,
+                    .mVertexX = vertX,
+                    .mVertexY = vertY,
+                    .mCount = 1,
+                };
+            });
+
+        if (row.has_value())
+            f(*row);
+    }
+
     inline int getBlendmapSize(float size, int textureSize)
     {
         return static_cast<int>(textureSize * size) + 1;
@@ -14,6 +14,7 @@
 #include <components/esm4/loadland.hpp>
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/strings/algorithm.hpp>
+#include <components/sceneutil/simd.hpp>
 #include <components/vfs/manager.hpp>
 
 #include "gridsampling.hpp"
@@ -40,6 +41,81 @@ namespace ESMTerrain
 
             return { tex, land->getPlugin() };
         }
+
+        // Reads count normals every step vertices of the land data starting at the index begin, into every dstStride-th
+        // element of dst. The normalization is done for 4 normals at once, with the same results as osg::Vec3f.
+        void readNormals(const ESM::LandData* data, std::size_t begin, std::size_t step, std::size_t count,
+            osg::Vec3f* dst, std::size_t dstStride)
+        {
+            if (data == nullptr)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                    dst[i * dstStride] = osg::Vec3f(0, 0, 1);
+                return;
+            }
+
+            const std::int8_t* src = data->getNormals().data() + begin * 3;
+            std::size_t i = 0;
+
+#if defined(OPENMW_SCENEUTIL_SIMD)
+            using namespace SceneUtil::Simd;
+
+            for (; i + 4 <= count; i += 4)
+            {
+                float x[4];
+                float y[4];
+                float z[4];
+                for (std::size_t j = 0; j < 4; ++j)
+                {
+                    const std::int8_t* value = src + (i + j) * step * 3;
+                    x[j] = value[0];
+                    y[j] = value[1];
+                    z[j] = value[2];
+                }
+
+                const Float4 vx = load(x);
+                const Float4 vy = load(y);
+                const Float4 vz = load(z);
+                const Float4 length = sqrt(add(add(mul(vx, vx), mul(vy, vy)), mul(vz, vz)));
+                const Float4 inverse = div(splat(1), length);
+
+                float lengths[4];
+                store(lengths, length);
+                store(x, mul(vx, inverse));
+                store(y, mul(vy, inverse));
+                store(z, mul(vz, inverse));
+
+                // osg::Vec3f::normalize leaves null vectors unchanged
+                for (std::size_t j = 0; j < 4; ++j)
+                    dst[(i + j) * dstStride] = lengths[j] > 0 ? osg::Vec3f(x[j], y[j], z[j]) : osg::Vec3f();
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                const std::int8_t* value = src + i * step * 3;
+                osg::Vec3f normal(value[0], value[1], value[2]);
+                normal.normalize();
+                dst[i * dstStride] = normal;
+            }
+        }
+
+        // Same as readNormals for the RGB of colours, the alpha is left unchanged
+        void readColours(const ESM::LandData* data, std::size_t begin, std::size_t step, std::size_t count,
+            osg::Vec4ub* dst, std::size_t dstStride)
+        {
+            const std::uint8_t white[3] = { 255, 255, 255 };
+            const std::uint8_t* src = data != nullptr ? data->getColors().data() + begin * 3 : white;
+            const std::size_t srcStride = data != nullptr ? step * 3 : 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const std::uint8_t* value = src + i * srcStride;
+                osg::Vec4ub& colour = dst[i * dstStride];
+                colour.r() = value[0];
+                colour.g() = value[1];
+                colour.b() = value[2];
+            }
+        }
     }
 
     class LandCache
@@ -277,10 +353,9 @@ namespace ESMTerrain
             validHeightDataExists = true;
         }
 
-        const auto handleSample = [&](std::size_t cellShiftX, std::size_t cellShiftY, std::size_t row, std::size_t col,
-                                      std::size_t vertX, std::size_t vertY) {
-            const int cellX = startCellX + cellShiftX;
-            const int cellY = startCellY + cellShiftY;
+        const auto handleRow = [&](const CellRow& row) {
+            const int cellX = startCellX + static_cast<int>(row.mCellX);
+            const int cellY = startCellY + static_cast<int>(row.mCellY);
             const std::pair cell{ cellX, cellY };
             const ESM::ExteriorCellLocation cellLocation(cellX, cellY, worldspace);
 
@@ -303,64 +378,69 @@ namespace ESMTerrain
                 lastCell = cell;
             }
 
-            float height = defaultHeight;
-            if (heightData != nullptr)
-                height = heightData->getHeights()[col * cellSize + row];
-            if (alteration)
-                height += getAlteredHeight(col, row);
-
-            const std::size_t vertIndex = vertX * numVerts + vertY;
-
-            positions[vertIndex]
-                = osg::Vec3f((vertX / static_cast<float>(numVerts - 1) - 0.5f) * size * landSizeInUnits,
-                    (vertY / static_cast<float>(numVerts - 1) - 0.5f) * size * landSizeInUnits, height);
-
-            const std::size_t srcArrayIndex = col * cellSize * 3 + row * 3;
-
-            osg::Vec3f normal(0, 0, 1);
+            // Vertices of a row of the land data are consecutive columns of the vertex buffers
+            const std::size_t col = row.mLocalY;
+            const std::size_t lastRow = row.mLocalX + (row.mCount - 1) * sampleSize;
+            const std::size_t srcIndex = col * cellSize + row.mLocalX;
+            const std::size_t dstIndex = row.mVertexX * numVerts + row.mVertexY;
+            const float y = (row.mVertexY / static_cast<float>(numVerts - 1) - 0.5f) * size * landSizeInUnits;
 
-            if (normalData != nullptr)
+            for (std::size_t i = 0; i < row.mCount; ++i)
             {
-                for (std::size_t i = 0; i < 3; ++i)
-                    normal[i] = normalData->getNormals()[srcArrayIndex + i];
-
-                normal.normalize();
+                float height = defaultHeight;
+                if (heightData != nullptr)
+                    height = heightData->getHeights()[srcIndex + i * sampleSize];
+                if (alteration)
+                    height += getAlteredHeight(col, row.mLocalX + i * sampleSize);
+
+                const std::size_t vertX = row.mVertexX + i;
+                positions[dstIndex + i * numVerts]
+                    = osg::Vec3f((vertX / static_cast<float>(numVerts - 1) - 0.5f) * size * landSizeInUnits, y, height);
+                colours[dstIndex + i * numVerts].a() = 255;
             }
 
-            // Normals apparently don't connect seamlessly between cells
-            if (col == cellSize - 1 || row == cellSize - 1)
-                fixNormal(normal, cellLocation, col, row, cache);
-
-            // some corner normals appear to be complete garbage (z < 0)
-            if ((row == 0 || row == cellSize - 1) && (col == 0 || col == cellSize - 1))
-                averageNormal(normal, cellLocation, col, row, cache);
-
-            assert(normal.z() > 0);
-
-            normals[vertIndex] = normal;
-
-            osg::Vec4ub color(255, 255, 255, 255);
-
-            if (colourData != nullptr)
-                for (std::size_t i = 0; i < 3; ++i)
-                    color[i] = colourData->getColors()[srcArrayIndex + i];
+            readNormals(normalData, srcIndex, sampleSize, row.mCount, &normals[dstIndex], numVerts);
+            readColours(colourData, srcIndex, sampleSize, row.mCount, &colours[dstIndex], numVerts);
 
             // Does nothing by default, override in OpenMW-CS
             if (alteration)
-                adjustColor(col, row, heightData, color);
+                for (std::size_t i = 0; i < row.mCount; ++i)
+                    adjustColor(col, row.mLocalX + i * sampleSize, heightData, colours[dstIndex + i * numVerts]);
 
-            // Unlike normals, colors mostly connect seamlessly between cells, but not always...
-            if (col == cellSize - 1 || row == cellSize - 1)
-                fixColour(color, cellLocation, col, row, cache);
+            // Normals apparently don't connect seamlessly between cells and colors mostly do, but not always. The last
+            // row and column of a cell take them from the first ones of the next cell.
+            if (col == cellSize - 1)
+            {
+                const LandObject* next = getLand(ESM::ExteriorCellLocation(cellX, cellY + 1, worldspace), cache);
+                const std::size_t count = lastRow == cellSize - 1 ? row.mCount - 1 : row.mCount;
+                readNormals(next != nullptr ? next->getData(ESM::Land::DATA_VNML) : nullptr, row.mLocalX, sampleSize,
+                    count, &normals[dstIndex], numVerts);
+                readColours(next != nullptr ? next->getData(ESM::Land::DATA_VCLR) : nullptr, row.mLocalX, sampleSize,
+                    count, &colours[dstIndex], numVerts);
+            }
 
-            colours[vertIndex] = color;
+            const std::size_t lastIndex = dstIndex + (row.mCount - 1) * numVerts;
+            if (lastRow == cellSize - 1)
+            {
+                fixNormal(normals[lastIndex], cellLocation, col, lastRow, cache);
+                fixColour(colours[lastIndex], cellLocation, col, lastRow, cache);
+            }
+
+            // some corner normals appear to be complete garbage (z < 0)
+            if (col == 0 || col == cellSize - 1)
+            {
+                if (row.mLocalX == 0)
+                    averageNormal(normals[dstIndex], cellLocation, col, 0, cache);
+                if (lastRow == cellSize - 1)
+                    averageNormal(normals[lastIndex], cellLocation, col, lastRow, cache);
+            }
         };
 
         const std::size_t beginX = static_cast<std::size_t>((origin.x() - startCellX) * cellSize);
         const std::size_t beginY = static_cast<std::size_t>((origin.y() - startCellY) * cellSize);
         const std::size_t distance = static_cast<std::size_t>(size * (cellSize - 1)) + 1;
 
-        sampleCellGrid(cellSize, sampleSize, beginX, beginY, distance, handleSample);
+        sampleCellGridRows(cellSize, sampleSize, beginX, beginY, distance, handleRow);
 
         if (!validHeightDataExists && ESM::isEsm4Ext(worldspace))
             std::fill(positions.begin(), positions.end(), osg::Vec3f());
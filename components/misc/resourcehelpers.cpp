@@ -237,8 +237,16 @@ namespace
 
     std::string getBestLODMeshName(std::string const& resPath, const VFS::Manager* vfs, std::string_view pattern)
     {
-        if (const auto& result = getLODMeshNameImpl(resPath, vfs, pattern); vfs->exists(result))
+        std::string result = getLODMeshNameImpl(resPath, vfs, pattern);
+        if (vfs->exists(result))
             return result;
+        // Meshes generated by openmw-lodtool are stored in the native OpenSceneGraph format
+        if (const auto w = Misc::findExtension(result); w != std::string::npos)
+        {
+            result.replace(w + 1, std::string::npos, "osgb");
+            if (vfs->exists(result))
+                return result;
+        }
         return resPath;
     }
 }
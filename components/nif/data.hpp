@@ -6,6 +6,8 @@
 #include "node.hpp"
 #include "recordptr.hpp"
 
+#include <map>
+
 namespace Nif
 {
 
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <array>
+#include <istream>
 #include <limits>
 #include <map>
 #include <sstream>
@@ -30,6 +31,7 @@ namespace Nif
         , mBethVersion(file.mBethVersion)
         , mFilename(file.mPath)
         , mHash(file.mHash)
+        , mArena(file.mArena)
         , mRecords(file.mRecords)
         , mRoots(file.mRoots)
         , mUseSkinning(file.mUseSkinning)
@@ -38,14 +40,14 @@ namespace Nif
     }
 
     template <typename NodeType, RecordType recordType>
-    static std::unique_ptr<Record> construct()
+    static Record* construct(RecordArena& arena)
     {
-        auto result = std::make_unique<NodeType>();
+        NodeType* const result = arena.create<NodeType>();
         result->recType = recordType;
         return result;
     }
 
-    using CreateRecord = std::unique_ptr<Record> (*)();
+    using CreateRecord = Record* (*)(RecordArena&);
 
     /// These are all the record types we know how to read.
     static std::map<std::string, CreateRecord> makeFactory()
@@ -527,16 +529,38 @@ namespace Nif
         return stream.str();
     }
 
+    std::vector<char> Reader::readAll(std::istream& stream) const
+    {
+        std::vector<char> result(std::size_t{ 1 } << 16);
+        std::size_t size = 0;
+        while (true)
+        {
+            stream.read(result.data() + size, static_cast<std::streamsize>(result.size() - size));
+            size += static_cast<std::size_t>(stream.gcount());
+            if (!stream)
+                break;
+            result.resize(result.size() * 2);
+        }
+        if (stream.bad())
+            throw Nif::Exception("Failed to read file", mFilename);
+        result.resize(size);
+        return result;
+    }
+
     void Reader::parse(Files::IStreamPtr&& stream)
     {
         const bool writeDebug = sWriteNifDebugLog;
         if (writeDebug)
             Log(Debug::Verbose) << "NIF Debug: Reading file: '" << mFilename << "'";
 
-        const std::array<std::uint64_t, 2> fileHash = Files::getHash(mFilename, *stream);
+        // Reading from memory avoids going through the stream for every value
+        const std::vector<char> data = readAll(*stream);
+        stream.reset();
+
+        const std::array<std::uint64_t, 2> fileHash = Files::getHash(data);
         mHash.append(reinterpret_cast<const char*>(fileHash.data()), fileHash.size() * sizeof(std::uint64_t));
 
-        NIFStream nif(*this, std::move(stream), mEncoder);
+        NIFStream nif(*this, data, mEncoder);
 
         // Check the header string
         std::string head = nif.getVersionString();
@@ -663,7 +687,7 @@ namespace Nif
 
         for (std::size_t i = 0; i < mRecords.size(); i++)
         {
-            std::unique_ptr<Record> r;
+            Record* r = nullptr;
 
             std::string rec = hasRecTypeListings ? recTypes[recTypeIndices[i]] : nif.get<std::string>();
             if (rec.empty())
@@ -682,7 +706,7 @@ namespace Nif
             if (entry == factories.end())
                 throw Nif::Exception("Unknown record type " + rec, mFilename);
 
-            r = entry->second();
+            r = entry->second(mArena);
 
             if (writeDebug)
                 Log(Debug::Verbose) << "NIF Debug: Reading record of type " << rec << ", index " << i;
@@ -692,7 +716,7 @@ namespace Nif
             r->recName = std::move(rec);
             r->recIndex = i;
             r->read(&nif);
-            mRecords[i] = std::move(r);
+            mRecords[i] = r;
         }
 
         // Determine which records are roots
@@ -703,7 +727,7 @@ namespace Nif
             nif.read(idx);
             if (idx >= 0 && static_cast<std::size_t>(idx) < mRecords.size())
             {
-                mRoots[i] = mRecords[idx].get();
+                mRoots[i] = mRecords[idx];
             }
             else
             {
@@ -714,7 +738,7 @@ namespace Nif
         }
 
         // Once parsing is done, do post-processing.
-        for (const auto& record : mRecords)
+        for (Record* record : mRecords)
             record->post(*this);
     }
 
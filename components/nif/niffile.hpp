@@ -10,6 +10,7 @@
 #include <components/files/istreamptr.hpp>
 
 #include "record.hpp"
+#include "recordarena.hpp"
 
 namespace ToUTF8
 {
@@ -48,8 +49,11 @@ namespace Nif
         std::string mPath;
         std::string mHash;
 
+        /// Owns the records
+        RecordArena mArena;
+
         /// Record list
-        std::vector<std::unique_ptr<Record>> mRecords;
+        std::vector<Record*> mRecords;
 
         /// Root list.  This is a select portion of the pointers from records
         std::vector<Record*> mRoots;
@@ -76,6 +80,12 @@ namespace Nif
         /// Number of roots
         std::size_t numRoots() const { return mFile->mRoots.size(); }
 
+        /// Get a given record
+        const Record* getRecord(std::size_t index) const { return mFile->mRecords.at(index); }
+
+        /// Number of records
+        std::size_t numRecords() const { return mFile->mRecords.size(); }
+
         /// Get the name of the file
         const std::string& getFilename() const { return mFile->mPath; }
 
@@ -107,8 +117,10 @@ namespace Nif
         std::string_view mFilename;
         std::string& mHash;
 
+        RecordArena& mArena;
+
         /// Record list
-        std::vector<std::unique_ptr<Record>>& mRecords;
+        std::vector<Record*>& mRecords;
 
         /// Root list.  This is a select portion of the pointers from records
         std::vector<Record*>& mRoots;
@@ -126,6 +138,8 @@ namespace Nif
         ///\returns A string containing a human readable NIF version number
         std::string versionToString(std::uint32_t version);
 
+        std::vector<char> readAll(std::istream& stream) const;
+
     public:
         /// Open a NIF stream. The name is used for error messages.
         explicit Reader(NIFFile& file, const ToUTF8::StatelessUtf8Encoder* encoder);
@@ -134,7 +148,7 @@ namespace Nif
         void parse(Files::IStreamPtr&& stream);
 
         /// Get a given record
-        Record* getRecord(size_t index) const { return mRecords.at(index).get(); }
+        Record* getRecord(size_t index) const { return mRecords.at(index); }
 
         /// Get a given string from the file's string table
         std::string getString(std::uint32_t index) const;
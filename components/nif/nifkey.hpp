@@ -3,7 +3,11 @@
 #ifndef OPENMW_COMPONENTS_NIF_NIFKEY_HPP
 #define OPENMW_COMPONENTS_NIF_NIFKEY_HPP
 
-#include <map>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <vector>
 
 #include "exception.hpp"
 #include "niffile.hpp"
@@ -44,15 +48,55 @@ namespace Nif
     template <typename T, T (NIFStream::*getValue)()>
     struct KeyMapT
     {
-        using MapType = std::map<float, KeyT<T>>;
-
         using ValueType = T;
         using KeyType = KeyT<T>;
 
         std::string mFrameName;
         float mLegacyWeight;
         uint32_t mInterpolationType = InterpolationType_Unknown;
-        MapType mKeys;
+        // Strictly increasing, mKeys holds the key of every time at the same index
+        std::vector<float> mTimes;
+        std::vector<KeyType> mKeys;
+
+        bool empty() const { return mTimes.empty(); }
+
+        std::size_t size() const { return mTimes.size(); }
+
+        /// Keys may be added in any order, as long as sortKeys() is called afterwards.
+        void addKey(float time, const KeyType& key)
+        {
+            mTimes.push_back(time);
+            mKeys.push_back(key);
+        }
+
+        /// Sorts the keys by time. Of keys with the same time only the one added last is kept.
+        void sortKeys()
+        {
+            if (std::adjacent_find(mTimes.begin(), mTimes.end(), std::greater_equal<float>()) == mTimes.end())
+                return;
+
+            std::vector<std::size_t> order(mTimes.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(
+                order.begin(), order.end(), [&](std::size_t l, std::size_t r) { return mTimes[l] < mTimes[r]; });
+
+            std::vector<float> times;
+            std::vector<KeyType> keys;
+            times.reserve(order.size());
+            keys.reserve(order.size());
+            for (std::size_t index : order)
+            {
+                if (!times.empty() && times.back() == mTimes[index])
+                {
+                    keys.back() = mKeys[index];
+                    continue;
+                }
+                times.push_back(mTimes[index]);
+                keys.push_back(mKeys[index]);
+            }
+            mTimes = std::move(times);
+            mKeys = std::move(keys);
+        }
 
         // Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
         void read(NIFStream* nif, bool morph = false)
@@ -88,7 +132,7 @@ namespace Nif
                     float time;
                     nif->read(time);
                     readValue(*nif, key);
-                    mKeys[time] = key;
+                    addKey(time, key);
                 }
             }
             else if (mInterpolationType == InterpolationType_Quadratic)
@@ -98,7 +142,7 @@ namespace Nif
                     float time;
                     nif->read(time);
                     readQuadratic(*nif, key);
-                    mKeys[time] = key;
+                    addKey(time, key);
                 }
             }
             else if (mInterpolationType == InterpolationType_TBC)
@@ -108,7 +152,7 @@ namespace Nif
                     float time;
                     nif->read(time);
                     readTBC(*nif, key);
-                    mKeys[time] = key;
+                    addKey(time, key);
                 }
             }
             else if (mInterpolationType == InterpolationType_XYZ)
@@ -125,6 +169,8 @@ namespace Nif
                 throw Nif::Exception("Unhandled interpolation type: " + std::to_string(mInterpolationType),
                     nif->getFile().getFilename());
             }
+
+            sortKeys();
         }
 
     private:
@@ -1,6 +1,9 @@
 #include "nifstream.hpp"
 
+#include <algorithm>
+#include <iterator>
 #include <span>
+#include <string>
 
 #include "niffile.hpp"
 
@@ -23,12 +26,12 @@ namespace
     // This one should be used if the type can be read contiguously as an array of a different type
     // (e.g. osg::VecXf can be read as a float array of X elements)
     template <class elementType, size_t numElements, class T>
-    void readAlignedRange(Files::IStreamPtr& stream, T* dest, size_t size)
+    void readAlignedRange(Nif::NIFStream& stream, T* dest, size_t size)
     {
         static_assert(std::is_standard_layout_v<T>);
         static_assert(std::alignment_of_v<T> == std::alignment_of_v<elementType>);
         static_assert(sizeof(T) == sizeof(elementType) * numElements);
-        Nif::readDynamicBufferOfType(stream, reinterpret_cast<elementType*>(dest), size * numElements);
+        stream.read(reinterpret_cast<elementType*>(dest), size * numElements);
     }
 
 }
@@ -51,15 +54,16 @@ namespace Nif
         return mReader.getBethVersion();
     }
 
+    void NIFStream::failToRead(std::size_t size) const
+    {
+        throw std::runtime_error("Failed to read " + std::to_string(size) + " bytes at offset "
+            + std::to_string(mPosition - mBegin) + ", only " + std::to_string(mEnd - mPosition) + " left");
+    }
+
     std::string NIFStream::getSizedString(size_t length)
     {
-        std::string str(length, '\0');
-        mStream->read(str.data(), length);
-        if (mStream->bad())
-            throw std::runtime_error("Failed to read sized string of " + std::to_string(length) + " chars");
-        size_t end = str.find('\0');
-        if (end != std::string::npos)
-            str.erase(end);
+        const char* const data = advance(length);
+        std::string str(data, std::find(data, data + length, '\0'));
         if (mEncoder)
             str = mEncoder->getUtf8(str, ToUTF8::BufferAllocationPolicy::UseGrowFactor, mBuffer);
         return str;
@@ -74,45 +78,40 @@ namespace Nif
 
     std::string NIFStream::getVersionString()
     {
-        std::string result;
-        std::getline(*mStream, result);
-        if (mStream->bad())
-            throw std::runtime_error("Failed to read version string");
+        const char* const end = std::find(mPosition, mEnd, '\n');
+        std::string result(mPosition, end);
+        mPosition = end == mEnd ? mEnd : end + 1;
         return result;
     }
 
     std::string NIFStream::getStringPalette()
     {
         size_t size = get<uint32_t>();
-        std::string str(size, '\0');
-        mStream->read(str.data(), size);
-        if (mStream->bad())
-            throw std::runtime_error("Failed to read string palette of " + std::to_string(size) + " chars");
-        return str;
+        return std::string(advance(size), size);
     }
 
     template <>
     void NIFStream::read<osg::Vec2f>(osg::Vec2f& vec)
     {
-        readBufferOfType(mStream, vec._v);
+        read(vec._v, std::size(vec._v));
     }
 
     template <>
     void NIFStream::read<osg::Vec3f>(osg::Vec3f& vec)
     {
-        readBufferOfType(mStream, vec._v);
+        read(vec._v, std::size(vec._v));
     }
 
     template <>
     void NIFStream::read<osg::Vec4f>(osg::Vec4f& vec)
     {
-        readBufferOfType(mStream, vec._v);
+        read(vec._v, std::size(vec._v));
     }
 
     template <>
     void NIFStream::read<Matrix3>(Matrix3& mat)
     {
-        readBufferOfType<9>(mStream, reinterpret_cast<float*>(&mat.mValues));
+        read(reinterpret_cast<float*>(&mat.mValues), 9);
     }
 
     template <>
@@ -178,25 +177,25 @@ namespace Nif
     template <>
     void NIFStream::read<osg::Vec2f>(osg::Vec2f* dest, size_t size)
     {
-        readAlignedRange<float, 2>(mStream, dest, size);
+        readAlignedRange<float, 2>(*this, dest, size);
     }
 
     template <>
     void NIFStream::read<osg::Vec3f>(osg::Vec3f* dest, size_t size)
     {
-        readAlignedRange<float, 3>(mStream, dest, size);
+        readAlignedRange<float, 3>(*this, dest, size);
     }
 
     template <>
     void NIFStream::read<osg::Vec4f>(osg::Vec4f* dest, size_t size)
     {
-        readAlignedRange<float, 4>(mStream, dest, size);
+        readAlignedRange<float, 4>(*this, dest, size);
     }
 
     template <>
     void NIFStream::read<Matrix3>(Matrix3* dest, size_t size)
     {
-        readAlignedRange<float, 9>(mStream, dest, size);
+        readAlignedRange<float, 9>(*this, dest, size);
     }
 
     template <>
@@ -681,7 +681,13 @@ namespace Nif
         uint32_t numVisKeys;
         nif->read(numVisKeys);
         for (size_t i = 0; i < numVisKeys; i++)
-            mVisKeyList->mKeys[nif->get<float>()].mValue = nif->get<uint8_t>() != 0;
+        {
+            const float time = nif->get<float>();
+            BoolKeyMap::KeyType key{};
+            key.mValue = nif->get<uint8_t>() != 0;
+            mVisKeyList->addKey(time, key);
+        }
+        mVisKeyList->sortKeys();
     }
 
     void NiPSysCollider::read(NIFStream* nif)
@@ -0,0 +1,35 @@
+#include "recordarena.hpp"
+
+#include <algorithm>
+
+namespace Nif
+{
+    namespace
+    {
+        // Most Morrowind files fit in the first block, bigger files use a few larger blocks
+        constexpr std::size_t minBlockSize = 4096;
+        constexpr std::size_t maxBlockSize = 65536;
+    }
+
+    RecordArena::~RecordArena()
+    {
+        for (auto it = mRecords.rbegin(); it != mRecords.rend(); ++it)
+            if (*it != nullptr)
+                (*it)->~Record();
+    }
+
+    void* RecordArena::allocate(std::size_t size, std::size_t alignment)
+    {
+        std::size_t offset = (mBlockUsed + alignment - 1) / alignment * alignment;
+        if (mBlocks.empty() || offset + size > mBlockSize)
+        {
+            const std::size_t nextBlockSize = std::clamp(mBlockSize * 2, minBlockSize, maxBlockSize);
+            mBlockSize = std::max(size, nextBlockSize);
+            mBlocks.emplace_back(new char[mBlockSize]);
+            offset = 0;
+        }
+        mBlockUsed = offset + size;
+        return mBlocks.back().get() + offset;
+    }
+
+}
@@ -0,0 +1,54 @@
+#ifndef OPENMW_COMPONENTS_NIF_RECORDARENA_HPP
+#define OPENMW_COMPONENTS_NIF_RECORDARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "record.hpp"
+
+namespace Nif
+{
+
+    /// Allocates the records of a file from a few large blocks instead of one by one and destroys them together with
+    /// the file.
+    class RecordArena
+    {
+    public:
+        RecordArena() = default;
+
+        RecordArena(const RecordArena&) = delete;
+
+        RecordArena& operator=(const RecordArena&) = delete;
+
+        ~RecordArena();
+
+        /// Construct a record that lives as long as the arena
+        template <class T>
+        T* create()
+        {
+            static_assert(std::is_base_of_v<Record, T>);
+            static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+            mRecords.push_back(nullptr);
+            T* const result = new (allocate(sizeof(T), alignof(T))) T();
+            mRecords.back() = result;
+            return result;
+        }
+
+        /// Number of records created
+        std::size_t size() const { return mRecords.size(); }
+
+    private:
+        std::vector<std::unique_ptr<char[]>> mBlocks;
+        std::size_t mBlockSize = 0;
+        std::size_t mBlockUsed = 0;
+        std::vector<Record*> mRecords;
+
+        void* allocate(std::size_t size, std::size_t alignment);
+    };
+
+}
+
+#endif
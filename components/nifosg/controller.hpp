@@ -1,6 +1,9 @@
 #ifndef COMPONENTS_NIFOSG_CONTROLLER_H
 #define COMPONENTS_NIFOSG_CONTROLLER_H
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
 #include <set>
 #include <type_traits>
 
@@ -38,23 +41,21 @@ namespace NifOsg
     template <typename MapT>
     class ValueInterpolator
     {
-        typename MapT::MapType::const_iterator retrieveKey(float time) const
+        // Index of the first key at or after the time, which must be after the first key and before the last one
+        std::size_t retrieveKey(float time) const
         {
-            // retrieve the current position in the map, optimized for the most common case
-            // where time moves linearly along the keyframe track
-            if (mLastHighKey != mKeys->mKeys.end())
+            // optimized for the most common case where time moves linearly along the keyframe track,
+            // so that playback only needs to look at the last key and the one following it
+            const std::vector<float>& times = mKeys->mTimes;
+            for (std::size_t key = mLastHighKey; key > 0 && key < times.size() && key <= mLastHighKey + 1; ++key)
             {
-                if (time > mLastHighKey->first)
-                {
-                    // try if we're there by incrementing one
-                    ++mLastLowKey;
-                    ++mLastHighKey;
-                }
-                if (mLastHighKey != mKeys->mKeys.end() && time >= mLastLowKey->first && time <= mLastHighKey->first)
-                    return mLastHighKey;
+                if (time <= times[key - 1])
+                    break;
+                if (time <= times[key])
+                    return key;
             }
 
-            return mKeys->mKeys.lower_bound(time);
+            return static_cast<std::size_t>(std::lower_bound(times.begin() + 1, times.end(), time) - times.begin());
         }
 
     public:
@@ -74,22 +75,12 @@ namespace NifOsg
             if (interpolator->mData.empty())
                 return;
             mKeys = interpolator->mData->mKeyList;
-            if (mKeys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueInterpolator(std::shared_ptr<const MapT> keys, ValueT defaultVal = ValueT())
             : mKeys(keys)
             , mDefaultVal(defaultVal)
         {
-            if (keys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueT interpKey(float time) const
@@ -97,29 +88,27 @@ namespace NifOsg
             if (empty())
                 return mDefaultVal;
 
-            const typename MapT::MapType& keys = mKeys->mKeys;
+            const std::vector<float>& times = mKeys->mTimes;
+            const std::vector<typename MapT::KeyType>& keys = mKeys->mKeys;
 
-            if (time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if (time <= times.front())
+                return keys.front().mValue;
 
-            typename MapT::MapType::const_iterator it = retrieveKey(time);
+            if (time > times.back())
+                return keys.back().mValue;
 
-            // now do the actual interpolation
-            if (it != keys.end())
-            {
-                // cache for next time
-                mLastHighKey = it;
-                mLastLowKey = --it;
-
-                float a = (time - mLastLowKey->first) / (mLastHighKey->first - mLastLowKey->first);
+            // cache for next time
+            const std::size_t high = retrieveKey(time);
+            mLastHighKey = high;
 
-                return interpolate(mLastLowKey->second, mLastHighKey->second, a, mKeys->mInterpolationType);
-            }
+            // now do the actual interpolation
+            const std::size_t low = high - 1;
+            const float a = (time - times[low]) / (times[high] - times[low]);
 
-            return keys.rbegin()->second.mValue;
+            return interpolate(keys[low], keys[high], a, mKeys->mInterpolationType);
         }
 
-        bool empty() const { return !mKeys || mKeys->mKeys.empty(); }
+        bool empty() const { return !mKeys || mKeys->empty(); }
 
     private:
         template <typename ValueType>
@@ -169,8 +158,8 @@ namespace NifOsg
             }
         }
 
-        mutable typename MapT::MapType::const_iterator mLastLowKey;
-        mutable typename MapT::MapType::const_iterator mLastHighKey;
+        // 0 until the first interpolation between two keys
+        mutable std::size_t mLastHighKey = 0;
 
         std::shared_ptr<const MapT> mKeys;
 
@@ -2,6 +2,7 @@
 
 #include <mutex>
 #include <string_view>
+#include <unordered_set>
 
 #include <osg/Array>
 #include <osg/Geometry>
@@ -353,8 +354,43 @@ namespace NifOsg
             osg::Node* mRootNode = nullptr;
         };
 
+        // Decode the external textures in the background while the nodes are converted
+        void prefetchTextures(Nif::FileView nif) const
+        {
+            if (!mImageManager)
+                return;
+
+            // Bump maps are retrieved as data, decode them the same way
+            std::unordered_set<const Nif::Record*> bumpTextures;
+            for (std::size_t i = 0; i < nif.numRecords(); ++i)
+            {
+                const Nif::Record* record = nif.getRecord(i);
+                if (record == nullptr || record->recType != Nif::RC_NiTexturingProperty)
+                    continue;
+                const auto& textures = static_cast<const Nif::NiTexturingProperty*>(record)->mTextures;
+                if (textures.size() > Nif::NiTexturingProperty::BumpTexture
+                    && !textures[Nif::NiTexturingProperty::BumpTexture].mSourceTexture.empty())
+                    bumpTextures.insert(textures[Nif::NiTexturingProperty::BumpTexture].mSourceTexture.getPtr());
+            }
+
+            for (std::size_t i = 0; i < nif.numRecords(); ++i)
+            {
+                const Nif::Record* record = nif.getRecord(i);
+                if (record == nullptr || record->recType != Nif::RC_NiSourceTexture)
+                    continue;
+                const Nif::NiSourceTexture* texture = static_cast<const Nif::NiSourceTexture*>(record);
+                if (texture->mExternal && !texture->mFile.empty())
+                    mImageManager->prefetchImage(
+                        Misc::ResourceHelpers::correctTexturePath(texture->mFile, mImageManager->getVFS()),
+                        bumpTextures.contains(record) ? Resource::ImageUsage::SceneData
+                                                      : Resource::ImageUsage::SceneColor);
+            }
+        }
+
         osg::ref_ptr<osg::Node> load(Nif::FileView nif)
         {
+            prefetchTextures(nif);
+
             const size_t numRoots = nif.numRoots();
             std::vector<const Nif::NiAVObject*> roots;
             for (size_t i = 0; i < numRoots; ++i)
@@ -521,12 +557,13 @@ namespace NifOsg
             sequenceNode->setMode(osg::Sequence::START);
         }
 
-        osg::ref_ptr<osg::Image> handleSourceTexture(const Nif::NiSourceTexture* st) const
+        osg::ref_ptr<osg::Image> handleSourceTexture(
+            const Nif::NiSourceTexture* st, Resource::ImageUsage usage = Resource::ImageUsage::SceneColor) const
         {
             if (st)
             {
                 if (st->mExternal)
-                    return getTextureImage(st->mFile);
+                    return getTextureImage(st->mFile, usage);
 
                 if (!st->mData.empty())
                     return handleInternalTexture(st->mData.getPtr());
@@ -1017,13 +1054,21 @@ namespace NifOsg
             }
         }
 
-        osg::ref_ptr<osg::Image> getTextureImage(std::string_view path) const
+        osg::ref_ptr<osg::Image> getTextureImage(std::string_view path, Resource::ImageUsage usage) const
         {
             if (!mImageManager)
                 return nullptr;
 
             std::string filename = Misc::ResourceHelpers::correctTexturePath(path, mImageManager->getVFS());
-            return mImageManager->getImage(filename);
+            return mImageManager->getStreamedImage(filename, usage);
+        }
+
+        static Resource::ImageUsage getImageUsage(std::string_view textureName)
+        {
+            // Lossy compression would distort the directions these maps hold
+            if (textureName == "bumpMap" || textureName == "normalMap")
+                return Resource::ImageUsage::SceneData;
+            return Resource::ImageUsage::SceneColor;
         }
 
         osg::ref_ptr<osg::Texture2D> attachTexture(const std::string& name, osg::ref_ptr<osg::Image> image, bool wrapS,
@@ -1048,14 +1093,16 @@ namespace NifOsg
         osg::ref_ptr<osg::Texture2D> attachExternalTexture(const std::string& name, const std::string& path, bool wrapS,
             bool wrapT, unsigned int uvSet, osg::StateSet* stateset, std::vector<unsigned int>& boundTextures) const
         {
-            return attachTexture(name, getTextureImage(path), wrapS, wrapT, uvSet, stateset, boundTextures);
+            return attachTexture(
+                name, getTextureImage(path, getImageUsage(name)), wrapS, wrapT, uvSet, stateset, boundTextures);
         }
 
         osg::ref_ptr<osg::Texture2D> attachNiSourceTexture(const std::string& name, const Nif::NiSourceTexture* st,
             bool wrapS, bool wrapT, unsigned int uvSet, osg::StateSet* stateset,
             std::vector<unsigned int>& boundTextures) const
         {
-            return attachTexture(name, handleSourceTexture(st), wrapS, wrapT, uvSet, stateset, boundTextures);
+            return attachTexture(
+                name, handleSourceTexture(st, getImageUsage(name)), wrapS, wrapT, uvSet, stateset, boundTextures);
         }
 
         static void clearBoundTextures(osg::StateSet* stateset, std::vector<unsigned int>& boundTextures)
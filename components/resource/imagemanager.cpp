@@ -1,15 +1,20 @@
 #include "imagemanager.hpp"
 
 #include <cassert>
+#include <chrono>
+#include <exception>
 #include <osgDB/Registry>
 
 #include <components/debug/debuglog.hpp>
 #include <components/misc/pathhelpers.hpp>
 #include <components/sceneutil/glextensions.hpp>
+#include <components/sceneutil/workqueue.hpp>
 #include <components/vfs/manager.hpp>
 #include <components/vfs/pathutil.hpp>
 
+#include "imageprocessing.hpp"
 #include "objectcache.hpp"
+#include "texturestreamer.hpp"
 
 #ifdef OSG_LIBRARY_STATIC
 // This list of plugins should match with the list in the top-level CMakelists.txt.
@@ -42,11 +47,57 @@ namespace
         return warningImage;
     }
 
+    // Only known once there is a context
+    bool isS3TCSupported()
+    {
+        if (!SceneUtil::glExtensionsReady())
+            return false;
+        osg::GLExtensions& exts = SceneUtil::getGLExtensions();
+        // This one works too. Should it be included in isTextureCompressionS3TCSupported()? Submitted as a patch to
+        // OSG.
+        return exts.isTextureCompressionS3TCSupported || osg::isGLExtensionSupported(exts.contextID, "GL_S3_s3tc");
+    }
+
+    // The images processed differently are cached apart, the unprocessed ones under their name
+    std::string getCacheKey(const std::string& normalized, bool generateMipmaps, bool transcode)
+    {
+        if (!generateMipmaps && !transcode)
+            return normalized;
+        std::string result = normalized;
+        result += '\0';
+        result += generateMipmaps ? 'm' : '-';
+        result += transcode ? 't' : '-';
+        return result;
+    }
+
 }
 
 namespace Resource
 {
 
+    class ImageManager::DecodeWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        DecodeWorkItem(ImageManager& manager, std::string key, std::shared_ptr<PendingImage> pending)
+            : mManager(manager)
+            , mKey(std::move(key))
+            , mPending(std::move(pending))
+        {
+        }
+
+        void doWork() override
+        {
+            // getImage may have needed the image before this item was started and decoded it itself
+            if (!mPending->mStarted.exchange(true))
+                mManager.decodePending(mKey, *mPending);
+        }
+
+    private:
+        ImageManager& mManager;
+        std::string mKey;
+        std::shared_ptr<PendingImage> mPending;
+    };
+
     ImageManager::ImageManager(const VFS::Manager* vfs, double expiryDelay)
         : ResourceManager(vfs, expiryDelay)
         , mWarningImage(createWarningImage())
@@ -55,7 +106,23 @@ namespace Resource
     {
     }
 
-    ImageManager::~ImageManager() {}
+    ImageManager::~ImageManager()
+    {
+        mTextureStreamer = nullptr;
+
+        // Queued work items must not decode anything once the manager is gone, wait for the ones already running
+        std::map<std::string, std::shared_ptr<PendingImage>, std::less<>> pending;
+        {
+            std::lock_guard lock(mPendingMutex);
+            pending = mPending;
+        }
+        for (const auto& [name, image] : pending)
+        {
+            if (!image->mStarted.exchange(true))
+                image->mPromise.set_value(mWarningImage);
+            image->mResult.wait();
+        }
+    }
 
     bool checkSupported(osg::Image* image)
     {
@@ -68,14 +135,8 @@ namespace Resource
             {
                 if (!SceneUtil::glExtensionsReady())
                     return true; // hashtag yolo (CS might not have context when loading assets)
-                osg::GLExtensions& exts = SceneUtil::getGLExtensions();
-                if (!exts.isTextureCompressionS3TCSupported
-                    // This one works too. Should it be included in isTextureCompressionS3TCSupported()? Submitted as a
-                    // patch to OSG.
-                    && !osg::isGLExtensionSupported(exts.contextID, "GL_S3_s3tc"))
-                {
+                if (!isS3TCSupported())
                     return false;
-                }
                 break;
             }
             // not bothering with checks for other compression formats right now
@@ -85,113 +146,245 @@ namespace Resource
         return true;
     }
 
-    osg::ref_ptr<osg::Image> ImageManager::getImage(std::string_view filename, bool disableFlip)
+    osg::ref_ptr<osg::Image> ImageManager::getImage(std::string_view filename, bool disableFlip, ImageUsage usage)
     {
         const std::string normalized = VFS::Path::normalizeFilename(filename);
+        const Processing processing = getProcessing(usage);
+        const std::string key = getCacheKey(normalized, processing.mGenerateMipmaps, processing.mTranscode);
 
-        osg::ref_ptr<osg::Object> obj = mCache->getRefFromObjectCache(normalized);
+        osg::ref_ptr<osg::Object> obj = mCache->getRefFromObjectCache(key);
         if (obj)
             return osg::ref_ptr<osg::Image>(static_cast<osg::Image*>(obj.get()));
+
+        std::shared_ptr<PendingImage> pending;
+        {
+            std::lock_guard lock(mPendingMutex);
+            const auto it = mPending.find(key);
+            if (it != mPending.end())
+                pending = it->second;
+        }
+
+        if (pending != nullptr)
+        {
+            // Decoding it here is faster than waiting for the work queue to get to it
+            if (!pending->mStarted.exchange(true))
+                decodePending(key, *pending);
+            return pending->mResult.get();
+        }
+
+        osg::ref_ptr<osg::Image> image = decodeImage(normalized, filename, disableFlip, processing);
+        mCache->addEntryToObjectCache(key, image);
+        return image;
+    }
+
+    osg::ref_ptr<osg::Image> ImageManager::getStreamedImage(std::string_view filename, ImageUsage usage)
+    {
+        if (mTextureStreamer == nullptr)
+            return getImage(filename, false, usage);
+        return mTextureStreamer->getImage(VFS::Path::normalizeFilename(filename), usage);
+    }
+
+    osg::ref_ptr<osg::Image> ImageManager::readImage(std::string_view filename, ImageUsage usage)
+    {
+        return decodeImage(VFS::Path::normalizeFilename(filename), filename, false, getProcessing(usage));
+    }
+
+    void ImageManager::setTextureStreaming(std::size_t budget, unsigned int initialSize)
+    {
+        mTextureStreamer = std::make_unique<TextureStreamer>(*this, budget, initialSize);
+    }
+
+    void ImageManager::prefetchImage(std::string_view filename, ImageUsage usage)
+    {
+        // The streamed images are decoded without their largest mipmaps, prefetching would cache them all
+        if (mWorkQueue == nullptr || mTextureStreamer != nullptr)
+            return;
+
+        auto pending = std::make_shared<PendingImage>();
+        pending->mNormalized = VFS::Path::normalizeFilename(filename);
+        pending->mProcessing = getProcessing(usage);
+        std::string key = getCacheKey(
+            pending->mNormalized, pending->mProcessing.mGenerateMipmaps, pending->mProcessing.mTranscode);
+        if (mCache->getRefFromObjectCacheOrNone(key).has_value())
+            return;
+
+        {
+            std::lock_guard lock(mPendingMutex);
+            if (!mPending.emplace(key, pending).second)
+                return;
+        }
+
+        // The image is usually needed as soon as the model referencing it is converted
+        mWorkQueue->addWorkItem(new DecodeWorkItem(*this, std::move(key), std::move(pending)), true);
+    }
+
+    void ImageManager::decodePending(const std::string& key, PendingImage& pending)
+    {
+        osg::ref_ptr<osg::Image> image;
+        std::exception_ptr exception;
+        try
+        {
+            image = decodeImage(pending.mNormalized, pending.mNormalized, false, pending.mProcessing);
+            mCache->addEntryToObjectCache(key, image);
+        }
+        catch (...)
+        {
+            // Rethrown to the callers waiting for the image, the next getImage decodes it again
+            exception = std::current_exception();
+        }
+        {
+            std::lock_guard lock(mPendingMutex);
+            mPending.erase(key);
+        }
+        if (exception)
+            pending.mPromise.set_exception(std::move(exception));
         else
+            pending.mPromise.set_value(std::move(image));
+    }
+
+    ImageManager::Processing ImageManager::getProcessing(ImageUsage usage) const
+    {
+        Processing result;
+        if (usage == ImageUsage::Interface)
+            return result;
+        result.mGenerateMipmaps = mGenerateMipmaps;
+        result.mTranscode = mTranscode && usage == ImageUsage::SceneColor;
+        return result;
+    }
+
+    osg::ref_ptr<osg::Image> ImageManager::decodeImage(
+        const std::string& normalized, std::string_view filename, bool disableFlip, Processing processing)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        osg::ref_ptr<osg::Image> image = loadImage(normalized, filename, disableFlip);
+        if (image != mWarningImage)
         {
-            Files::IStreamPtr stream;
-            try
-            {
-                stream = mVFS->get(normalized);
-            }
-            catch (std::exception& e)
-            {
-                Log(Debug::Error) << "Failed to open image: " << e.what();
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
-                return mWarningImage;
-            }
+            if (image->isCompressed())
+                mDecodedBytesCompressed += image->getTotalSizeInBytesIncludingMipmaps();
+            else
+                mDecodedBytesUncompressed += image->getTotalSizeInBytesIncludingMipmaps();
+            image = processImage(std::move(image), processing);
+        }
 
-            const std::string ext(Misc::getFileExtension(normalized));
-            osgDB::ReaderWriter* reader = osgDB::Registry::instance()->getReaderWriterForExtension(ext);
-            if (!reader)
-            {
-                Log(Debug::Error) << "Error loading " << filename << ": no readerwriter for '" << ext << "' found";
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
-                return mWarningImage;
-            }
+        mDecodeTime += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
 
-            bool killAlpha = false;
-            if (reader->supportedExtensions().count("tga"))
-            {
-                // Morrowind ignores the alpha channel of 16bpp TGA files even when the header says not to
-                unsigned char header[18];
-                stream->read((char*)header, 18);
-                if (stream->gcount() != 18)
-                {
-                    Log(Debug::Error) << "Error loading " << filename << ": couldn't read TGA header";
-                    mCache->addEntryToObjectCache(normalized, mWarningImage);
-                    return mWarningImage;
-                }
-                int type = header[2];
-                int depth;
-                if (type == 1 || type == 9)
-                    depth = header[7];
-                else
-                    depth = header[16];
-                int alphaBPP = header[17] & 0x0F;
-                killAlpha = depth == 16 && alphaBPP == 1;
-                stream->seekg(0);
-            }
+        return image;
+    }
+
+    osg::ref_ptr<osg::Image> ImageManager::loadImage(
+        const std::string& normalized, std::string_view filename, bool disableFlip)
+    {
+        Files::IStreamPtr stream;
+        try
+        {
+            stream = mVFS->get(normalized);
+        }
+        catch (std::exception& e)
+        {
+            Log(Debug::Error) << "Failed to open image: " << e.what();
+            return mWarningImage;
+        }
 
-            osgDB::ReaderWriter::ReadResult result
-                = reader->readImage(*stream, disableFlip ? mOptionsNoFlip : mOptions);
-            if (!result.success())
+        const std::string ext(Misc::getFileExtension(normalized));
+        osgDB::ReaderWriter* reader = osgDB::Registry::instance()->getReaderWriterForExtension(ext);
+        if (!reader)
+        {
+            Log(Debug::Error) << "Error loading " << filename << ": no readerwriter for '" << ext << "' found";
+            return mWarningImage;
+        }
+
+        bool killAlpha = false;
+        if (reader->supportedExtensions().count("tga"))
+        {
+            // Morrowind ignores the alpha channel of 16bpp TGA files even when the header says not to
+            unsigned char header[18];
+            stream->read((char*)header, 18);
+            if (stream->gcount() != 18)
             {
-                Log(Debug::Error) << "Error loading " << filename << ": " << result.message() << " code "
-                                  << result.status();
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
+                Log(Debug::Error) << "Error loading " << filename << ": couldn't read TGA header";
                 return mWarningImage;
             }
+            int type = header[2];
+            int depth;
+            if (type == 1 || type == 9)
+                depth = header[7];
+            else
+                depth = header[16];
+            int alphaBPP = header[17] & 0x0F;
+            killAlpha = depth == 16 && alphaBPP == 1;
+            stream->seekg(0);
+        }
+
+        osgDB::ReaderWriter::ReadResult result = reader->readImage(*stream, disableFlip ? mOptionsNoFlip : mOptions);
+        if (!result.success())
+        {
+            Log(Debug::Error) << "Error loading " << filename << ": " << result.message() << " code "
+                              << result.status();
+            return mWarningImage;
+        }
 
-            osg::ref_ptr<osg::Image> image = result.getImage();
+        osg::ref_ptr<osg::Image> image = result.getImage();
 
-            image->setFileName(normalized);
-            if (!checkSupported(image))
+        image->setFileName(normalized);
+        if (!checkSupported(image))
+        {
+            static bool uncompress = (getenv("OPENMW_DECOMPRESS_TEXTURES") != nullptr);
+            if (!uncompress)
             {
-                static bool uncompress = (getenv("OPENMW_DECOMPRESS_TEXTURES") != nullptr);
-                if (!uncompress)
-                {
-                    Log(Debug::Error) << "Error loading " << filename
-                                      << ": no S3TC texture compression support installed";
-                    mCache->addEntryToObjectCache(normalized, mWarningImage);
-                    return mWarningImage;
-                }
-                else
-                {
-                    // decompress texture in software if not supported by GPU
-                    // requires update to getColor() to be released with OSG 3.6
-                    osg::ref_ptr<osg::Image> newImage = new osg::Image;
-                    newImage->setFileName(image->getFileName());
-                    newImage->allocateImage(image->s(), image->t(), image->r(),
-                        image->isImageTranslucent() ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE);
-                    for (int s = 0; s < image->s(); ++s)
-                        for (int t = 0; t < image->t(); ++t)
-                            for (int r = 0; r < image->r(); ++r)
-                                newImage->setColor(image->getColor(s, t, r), s, t, r);
-                    image = newImage;
-                }
+                Log(Debug::Error) << "Error loading " << filename << ": no S3TC texture compression support installed";
+                return mWarningImage;
             }
-            else if (killAlpha)
+            else
             {
+                // decompress texture in software if not supported by GPU
+                // requires update to getColor() to be released with OSG 3.6
                 osg::ref_ptr<osg::Image> newImage = new osg::Image;
                 newImage->setFileName(image->getFileName());
-                newImage->allocateImage(image->s(), image->t(), image->r(), GL_RGB, GL_UNSIGNED_BYTE);
-                // OSG just won't write the alpha as there's nowhere to put it.
+                newImage->allocateImage(image->s(), image->t(), image->r(),
+                    image->isImageTranslucent() ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE);
                 for (int s = 0; s < image->s(); ++s)
                     for (int t = 0; t < image->t(); ++t)
                         for (int r = 0; r < image->r(); ++r)
                             newImage->setColor(image->getColor(s, t, r), s, t, r);
                 image = newImage;
             }
+        }
+        else if (killAlpha)
+        {
+            osg::ref_ptr<osg::Image> newImage = new osg::Image;
+            newImage->setFileName(image->getFileName());
+            newImage->allocateImage(image->s(), image->t(), image->r(), GL_RGB, GL_UNSIGNED_BYTE);
+            // OSG just won't write the alpha as there's nowhere to put it.
+            for (int s = 0; s < image->s(); ++s)
+                for (int t = 0; t < image->t(); ++t)
+                    for (int r = 0; r < image->r(); ++r)
+                        newImage->setColor(image->getColor(s, t, r), s, t, r);
+            image = newImage;
+        }
 
-            mCache->addEntryToObjectCache(normalized, image);
+        return image;
+    }
+
+    osg::ref_ptr<osg::Image> ImageManager::processImage(osg::ref_ptr<osg::Image> image, Processing processing)
+    {
+        if (image->isCompressed())
             return image;
+
+        if (processing.mGenerateMipmaps)
+            generateMipmaps(*image);
+
+        if (processing.mTranscode && isS3TCSupported())
+        {
+            if (osg::ref_ptr<osg::Image> compressed = compressImageS3TC(*image))
+            {
+                mTranscodedBytes += compressed->getTotalSizeInBytesIncludingMipmaps();
+                return compressed;
+            }
         }
+
+        return image;
     }
 
     osg::Image* ImageManager::getWarningImage()
@@ -202,6 +395,12 @@ namespace Resource
     void ImageManager::reportStats(unsigned int frameNumber, osg::Stats* stats) const
     {
         Resource::reportStats("Image", frameNumber, mCache->getStats(), *stats);
+        stats->setAttribute(frameNumber, "Image Decode Time", mDecodeTime.exchange(0) / 1000.0);
+        stats->setAttribute(frameNumber, "Image Decoded Bytes Compressed", mDecodedBytesCompressed);
+        stats->setAttribute(frameNumber, "Image Decoded Bytes Uncompressed", mDecodedBytesUncompressed);
+        stats->setAttribute(frameNumber, "Image Transcoded Bytes", mTranscodedBytes);
+        if (mTextureStreamer != nullptr)
+            mTextureStreamer->reportStats(frameNumber, *stats);
     }
 
 }
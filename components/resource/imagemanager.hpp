@@ -1,13 +1,19 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_IMAGEMANAGER_H
 #define OPENMW_COMPONENTS_RESOURCE_IMAGEMANAGER_H
 
+#include <atomic>
+#include <cstdint>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include <osg/Image>
 #include <osg/Texture2D>
 #include <osg/ref_ptr>
 
+#include "imageusage.hpp"
 #include "resourcemanager.hpp"
 
 namespace osgDB
@@ -15,8 +21,14 @@ namespace osgDB
     class Options;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace Resource
 {
+    class TextureStreamer;
 
     /// @brief Handles loading/caching of Images.
     /// @note May be used from any thread.
@@ -28,16 +40,93 @@ namespace Resource
 
         /// Create or retrieve an Image
         /// Returns the dummy image if the given image is not found.
-        osg::ref_ptr<osg::Image> getImage(std::string_view filename, bool disableFlip = false);
+        /// @param usage Decides how the image is processed, the images processed differently are cached apart.
+        osg::ref_ptr<osg::Image> getImage(
+            std::string_view filename, bool disableFlip = false, ImageUsage usage = ImageUsage::Interface);
+
+        /// Retrieve an Image of the scene from the texture streamer, without its largest mipmaps unless they are
+        /// needed. Same as getImage when streaming is disabled.
+        osg::ref_ptr<osg::Image> getStreamedImage(std::string_view filename, ImageUsage usage = ImageUsage::SceneColor);
+
+        /// Decode an Image without caching it.
+        osg::ref_ptr<osg::Image> readImage(std::string_view filename, ImageUsage usage = ImageUsage::Interface);
+
+        /// Start decoding an Image on the work queue, a later getImage call with the same usage returns it without
+        /// decoding it again. Does nothing without a work queue, with texture streaming or if the image is already
+        /// cached or being decoded.
+        void prefetchImage(std::string_view filename, ImageUsage usage = ImageUsage::SceneColor);
+
+        /// Decode prefetched images on this queue, nullptr disables prefetching.
+        /// @note The queue has to outlive the manager or to be reset before it is destroyed.
+        void setWorkQueue(SceneUtil::WorkQueue* workQueue) { mWorkQueue = workQueue; }
+
+        SceneUtil::WorkQueue* getWorkQueue() const { return mWorkQueue; }
+
+        /// Generate missing mipmaps of uncompressed images of the scene when they are decoded, instead of during the
+        /// upload.
+        void setGenerateMipmaps(bool value) { mGenerateMipmaps = value; }
+
+        /// Compress uncompressed colour images of the scene to S3TC when they are decoded, if the GPU supports it.
+        void setTranscode(bool value) { mTranscode = value; }
+
+        /// Stream the mipmaps of the images retrieved with getStreamedImage within the given budget in bytes.
+        /// @note To be called before any image is retrieved.
+        void setTextureStreaming(std::size_t budget, unsigned int initialSize);
+
+        /// nullptr unless texture streaming is enabled.
+        TextureStreamer* getTextureStreamer() { return mTextureStreamer.get(); }
 
         osg::Image* getWarningImage();
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
 
     private:
+        struct Processing
+        {
+            bool mGenerateMipmaps = false;
+            bool mTranscode = false;
+        };
+
+        struct PendingImage
+        {
+            std::string mNormalized;
+            Processing mProcessing;
+            std::atomic_bool mStarted{ false };
+            std::promise<osg::ref_ptr<osg::Image>> mPromise;
+            std::shared_future<osg::ref_ptr<osg::Image>> mResult = mPromise.get_future().share();
+        };
+
+        class DecodeWorkItem;
+
+        Processing getProcessing(ImageUsage usage) const;
+
+        osg::ref_ptr<osg::Image> decodeImage(
+            const std::string& normalized, std::string_view filename, bool disableFlip, Processing processing);
+
+        osg::ref_ptr<osg::Image> loadImage(const std::string& normalized, std::string_view filename, bool disableFlip);
+
+        osg::ref_ptr<osg::Image> processImage(osg::ref_ptr<osg::Image> image, Processing processing);
+
+        void decodePending(const std::string& key, PendingImage& pending);
+
         osg::ref_ptr<osg::Image> mWarningImage;
         osg::ref_ptr<osgDB::Options> mOptions;
         osg::ref_ptr<osgDB::Options> mOptionsNoFlip;
+        SceneUtil::WorkQueue* mWorkQueue = nullptr;
+        bool mGenerateMipmaps = false;
+        bool mTranscode = false;
+
+        std::mutex mPendingMutex;
+        // By cache key
+        std::map<std::string, std::shared_ptr<PendingImage>, std::less<>> mPending;
+
+        // Nanoseconds spent decoding images since the last report
+        mutable std::atomic<std::uint64_t> mDecodeTime{ 0 };
+        std::atomic<std::uint64_t> mDecodedBytesCompressed{ 0 };
+        std::atomic<std::uint64_t> mDecodedBytesUncompressed{ 0 };
+        std::atomic<std::uint64_t> mTranscodedBytes{ 0 };
+
+        std::unique_ptr<TextureStreamer> mTextureStreamer;
 
         ImageManager(const ImageManager&);
         void operator=(const ImageManager&);
@@ -0,0 +1,364 @@
+#include "imageprocessing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace Resource
+{
+    namespace
+    {
+        struct Level
+        {
+            unsigned int mWidth;
+            unsigned int mHeight;
+        };
+
+        Level getLevel(const osg::Image& image, unsigned int level)
+        {
+            return Level{
+                .mWidth = std::max(1u, static_cast<unsigned int>(image.s()) >> level),
+                .mHeight = std::max(1u, static_cast<unsigned int>(image.t()) >> level),
+            };
+        }
+
+        unsigned int countMipmapLevels(const osg::Image& image)
+        {
+            unsigned int result = 1;
+            for (int size = std::max(image.s(), image.t()); size > 1; size /= 2)
+                ++result;
+            return result;
+        }
+
+        // Offsets of the channels in the pixels of the formats supported by compressImageS3TC
+        struct Channels
+        {
+            std::size_t mSize;
+            std::size_t mRed;
+            std::size_t mGreen;
+            std::size_t mBlue;
+            std::size_t mAlpha;
+        };
+
+        bool getChannels(GLenum pixelFormat, Channels& channels)
+        {
+            constexpr std::size_t noAlpha = std::numeric_limits<std::size_t>::max();
+            switch (pixelFormat)
+            {
+                case GL_RGB:
+                    channels = Channels{ 3, 0, 1, 2, noAlpha };
+                    return true;
+                case GL_RGBA:
+                    channels = Channels{ 4, 0, 1, 2, 3 };
+                    return true;
+                case GL_BGR:
+                    channels = Channels{ 3, 2, 1, 0, noAlpha };
+                    return true;
+                case GL_BGRA:
+                    channels = Channels{ 4, 2, 1, 0, 3 };
+                    return true;
+            }
+            return false;
+        }
+
+        using Rgb = std::array<int, 3>;
+
+        std::uint16_t toRgb565(const Rgb& value)
+        {
+            const auto quantize = [](int channel, int max) { return (channel * max + 127) / 255; };
+            return static_cast<std::uint16_t>(
+                (quantize(value[0], 31) << 11) | (quantize(value[1], 63) << 5) | quantize(value[2], 31));
+        }
+
+        Rgb fromRgb565(std::uint16_t value)
+        {
+            const int r = (value >> 11) & 31;
+            const int g = (value >> 5) & 63;
+            const int b = value & 31;
+            return Rgb{ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+        }
+
+        int squaredDistance(const Rgb& l, const Rgb& r)
+        {
+            int result = 0;
+            for (std::size_t i = 0; i < 3; ++i)
+                result += (l[i] - r[i]) * (l[i] - r[i]);
+            return result;
+        }
+
+        void writeLittleEndian(std::uint64_t value, std::size_t size, unsigned char* dst)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                dst[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+
+        // Endpoints at the corners of the bounding box of the block inset by 1/16 of its size, every pixel takes the
+        // closest of the 4 interpolated colours.
+        void encodeColourBlock(const std::array<Rgb, 16>& pixels, unsigned char* dst)
+        {
+            Rgb min{ 255, 255, 255 };
+            Rgb max{ 0, 0, 0 };
+            for (const Rgb& pixel : pixels)
+            {
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    min[i] = std::min(min[i], pixel[i]);
+                    max[i] = std::max(max[i], pixel[i]);
+                }
+            }
+
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const int inset = (max[i] - min[i]) / 16;
+                min[i] += inset;
+                max[i] -= inset;
+            }
+
+            // Use the diagonal of the bounding box along which the colours vary, channels decreasing when the one with
+            // the largest range increases swap their endpoints
+            std::size_t reference = 0;
+            for (std::size_t i = 1; i < 3; ++i)
+                if (max[i] - min[i] > max[reference] - min[reference])
+                    reference = i;
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                int covariance = 0;
+                for (const Rgb& pixel : pixels)
+                    covariance += (2 * pixel[reference] - min[reference] - max[reference])
+                        * (2 * pixel[i] - min[i] - max[i]);
+                if (covariance < 0)
+                    std::swap(min[i], max[i]);
+            }
+
+            std::uint16_t colour0 = toRgb565(max);
+            std::uint16_t colour1 = toRgb565(min);
+            // The 4 colour mode requires colour0 > colour1, otherwise the block has a single colour
+            if (colour0 < colour1)
+                std::swap(colour0, colour1);
+
+            std::uint32_t indices = 0;
+            if (colour0 != colour1)
+            {
+                const Rgb endpoint0 = fromRgb565(colour0);
+                const Rgb endpoint1 = fromRgb565(colour1);
+                std::array<Rgb, 4> palette{ endpoint0, endpoint1, Rgb{}, Rgb{} };
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    palette[2][i] = (2 * endpoint0[i] + endpoint1[i]) / 3;
+                    palette[3][i] = (endpoint0[i] + 2 * endpoint1[i]) / 3;
+                }
+
+                for (std::size_t i = 0; i < pixels.size(); ++i)
+                {
+                    std::uint32_t best = 0;
+                    for (std::uint32_t j = 1; j < palette.size(); ++j)
+                        if (squaredDistance(pixels[i], palette[j]) < squaredDistance(pixels[i], palette[best]))
+                            best = j;
+                    indices |= best << (2 * i);
+                }
+            }
+
+            writeLittleEndian(colour0, 2, dst);
+            writeLittleEndian(colour1, 2, dst + 2);
+            writeLittleEndian(indices, 4, dst + 4);
+        }
+
+        void encodeAlphaBlock(const std::array<int, 16>& alphas, unsigned char* dst)
+        {
+            const auto [minIt, maxIt] = std::minmax_element(alphas.begin(), alphas.end());
+            const int alpha0 = *maxIt;
+            const int alpha1 = *minIt;
+
+            // The 8 alpha mode requires alpha0 > alpha1, otherwise the block has a single alpha
+            std::uint64_t indices = 0;
+            if (alpha0 != alpha1)
+            {
+                std::array<int, 8> palette{ alpha0, alpha1 };
+                for (int i = 1; i < 7; ++i)
+                    palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+
+                for (std::size_t i = 0; i < alphas.size(); ++i)
+                {
+                    std::uint64_t best = 0;
+                    for (std::uint64_t j = 1; j < palette.size(); ++j)
+                        if (std::abs(alphas[i] - palette[j]) < std::abs(alphas[i] - palette[best]))
+                            best = j;
+                    indices |= best << (3 * i);
+                }
+            }
+
+            dst[0] = static_cast<unsigned char>(alpha0);
+            dst[1] = static_cast<unsigned char>(alpha1);
+            writeLittleEndian(indices, 6, dst + 2);
+        }
+    }
+
+    bool generateMipmaps(osg::Image& image)
+    {
+        if (image.getDataType() != GL_UNSIGNED_BYTE || image.r() != 1 || image.isCompressed() || image.isMipmap()
+            || image.data() == nullptr || !image.isDataContiguous())
+            return false;
+
+        const std::size_t pixelSize = osg::Image::computeNumComponents(image.getPixelFormat());
+        if (pixelSize == 0 || image.getRowSizeInBytes() != image.s() * pixelSize)
+            return false;
+
+        const unsigned int levels = countMipmapLevels(image);
+        if (levels == 1)
+            return false;
+
+        osg::Image::MipmapDataType offsets;
+        std::size_t size = 0;
+        for (unsigned int level = 0; level < levels; ++level)
+        {
+            if (level != 0)
+                offsets.push_back(static_cast<unsigned int>(size));
+            const Level dimensions = getLevel(image, level);
+            size += dimensions.mWidth * dimensions.mHeight * pixelSize;
+        }
+
+        unsigned char* const data = new unsigned char[size];
+        std::memcpy(data, image.data(), image.getImageSizeInBytes());
+
+        for (unsigned int level = 1; level < levels; ++level)
+        {
+            const Level src = getLevel(image, level - 1);
+            const Level dst = getLevel(image, level);
+            const unsigned char* const srcData = level == 1 ? data : data + offsets[level - 2];
+            unsigned char* const dstData = data + offsets[level - 1];
+
+            for (unsigned int y = 0; y < dst.mHeight; ++y)
+            {
+                // Odd sizes repeat the last row or column of the larger level
+                const unsigned int y0 = std::min(2 * y, src.mHeight - 1);
+                const unsigned int y1 = std::min(2 * y + 1, src.mHeight - 1);
+                for (unsigned int x = 0; x < dst.mWidth; ++x)
+                {
+                    const unsigned int x0 = std::min(2 * x, src.mWidth - 1);
+                    const unsigned int x1 = std::min(2 * x + 1, src.mWidth - 1);
+                    for (std::size_t c = 0; c < pixelSize; ++c)
+                    {
+                        const auto at = [&](unsigned int sx, unsigned int sy) -> unsigned int {
+                            return srcData[(sy * src.mWidth + sx) * pixelSize + c];
+                        };
+                        dstData[(y * dst.mWidth + x) * pixelSize + c]
+                            = static_cast<unsigned char>((at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1) + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        image.setImage(image.s(), image.t(), 1, image.getInternalTextureFormat(), image.getPixelFormat(),
+            GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE, 1);
+        image.setMipmapLevels(offsets);
+        return true;
+    }
+
+    osg::ref_ptr<osg::Image> compressImageS3TC(const osg::Image& image)
+    {
+        Channels channels;
+        if (image.getDataType() != GL_UNSIGNED_BYTE || image.r() != 1 || !getChannels(image.getPixelFormat(), channels)
+            || image.s() % 4 != 0 || image.t() % 4 != 0 || image.data() == nullptr || !image.isDataContiguous()
+            || image.getRowSizeInBytes() != image.s() * channels.mSize)
+            return nullptr;
+
+        const unsigned int levels = image.getNumMipmapLevels();
+
+        bool opaque = true;
+        if (channels.mSize == 4)
+        {
+            const std::size_t size = image.getTotalSizeInBytesIncludingMipmaps();
+            for (std::size_t i = channels.mAlpha; i < size && opaque; i += channels.mSize)
+                opaque = image.data()[i] == 255;
+        }
+
+        const std::size_t blockSize = opaque ? 8 : 16;
+        osg::Image::MipmapDataType offsets;
+        std::size_t size = 0;
+        for (unsigned int level = 0; level < levels; ++level)
+        {
+            if (level != 0)
+                offsets.push_back(static_cast<unsigned int>(size));
+            const Level dimensions = getLevel(image, level);
+            size += ((dimensions.mWidth + 3) / 4) * ((dimensions.mHeight + 3) / 4) * blockSize;
+        }
+
+        unsigned char* const data = new unsigned char[size];
+        unsigned char* dst = data;
+
+        for (unsigned int level = 0; level < levels; ++level)
+        {
+            const Level src = getLevel(image, level);
+            const unsigned char* const srcData = image.getMipmapData(level);
+
+            for (unsigned int blockY = 0; blockY < src.mHeight; blockY += 4)
+            {
+                for (unsigned int blockX = 0; blockX < src.mWidth; blockX += 4)
+                {
+                    std::array<Rgb, 16> pixels;
+                    std::array<int, 16> alphas;
+                    for (unsigned int y = 0; y < 4; ++y)
+                    {
+                        for (unsigned int x = 0; x < 4; ++x)
+                        {
+                            // Levels smaller than a block repeat their last row and column
+                            const unsigned int sx = std::min(blockX + x, src.mWidth - 1);
+                            const unsigned int sy = std::min(blockY + y, src.mHeight - 1);
+                            const unsigned char* const pixel = srcData + (sy * src.mWidth + sx) * channels.mSize;
+                            pixels[y * 4 + x]
+                                = Rgb{ pixel[channels.mRed], pixel[channels.mGreen], pixel[channels.mBlue] };
+                            alphas[y * 4 + x] = opaque ? 255 : pixel[channels.mAlpha];
+                        }
+                    }
+
+                    if (!opaque)
+                    {
+                        encodeAlphaBlock(alphas, dst);
+                        dst += 8;
+                    }
+                    encodeColourBlock(pixels, dst);
+                    dst += 8;
+                }
+            }
+        }
+
+        const GLenum format = opaque ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        osg::ref_ptr<osg::Image> result = new osg::Image;
+        result->setImage(
+            image.s(), image.t(), 1, format, format, GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE, 1);
+        result->setMipmapLevels(offsets);
+        result->setFileName(image.getFileName());
+        return result;
+    }
+
+    osg::ref_ptr<osg::Image> dropMipmaps(const osg::Image& image, unsigned int levels)
+    {
+        const unsigned int numLevels = image.getNumMipmapLevels();
+        if (levels == 0 || levels >= numLevels || image.r() != 1 || image.data() == nullptr
+            || !image.isDataContiguous())
+            return nullptr;
+
+        const std::size_t begin = static_cast<std::size_t>(image.getMipmapData(levels) - image.data());
+        const std::size_t size = image.getTotalSizeInBytesIncludingMipmaps() - begin;
+
+        osg::Image::MipmapDataType offsets;
+        for (unsigned int level = levels + 1; level < numLevels; ++level)
+            offsets.push_back(static_cast<unsigned int>(image.getMipmapData(level) - image.data() - begin));
+
+        unsigned char* const data = new unsigned char[size];
+        std::memcpy(data, image.data() + begin, size);
+
+        const Level dimensions = getLevel(image, levels);
+        osg::ref_ptr<osg::Image> result = new osg::Image;
+        result->setImage(dimensions.mWidth, dimensions.mHeight, 1, image.getInternalTextureFormat(),
+            image.getPixelFormat(), image.getDataType(), data, osg::Image::USE_NEW_DELETE, image.getPacking());
+        result->setMipmapLevels(offsets);
+        result->setFileName(image.getFileName());
+        return result;
+    }
+
+}
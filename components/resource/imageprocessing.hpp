@@ -0,0 +1,26 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_IMAGEPROCESSING_H
+#define OPENMW_COMPONENTS_RESOURCE_IMAGEPROCESSING_H
+
+#include <osg/Image>
+#include <osg/ref_ptr>
+
+namespace Resource
+{
+
+    /// Replace the data of a 2D image of unsigned bytes without mipmaps by the same data followed by box filtered
+    /// mipmaps down to 1x1, so that the driver doesn't have to generate them when the texture is uploaded.
+    /// @return false if the image is not supported, it is left unchanged.
+    bool generateMipmaps(osg::Image& image);
+
+    /// Encode a 2D image of RGB(A) or BGR(A) unsigned bytes and its mipmaps as BC1 (DXT1) if it is opaque, BC3 (DXT5)
+    /// otherwise. The width and the height of the image have to be multiples of 4.
+    /// @return nullptr if the image is not supported.
+    osg::ref_ptr<osg::Image> compressImageS3TC(const osg::Image& image);
+
+    /// Copy of a 2D image with mipmaps without its given number of largest mipmaps, the next one becoming the image.
+    /// @return nullptr if the image doesn't have more mipmaps than the ones to drop.
+    osg::ref_ptr<osg::Image> dropMipmaps(const osg::Image& image, unsigned int levels);
+
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_IMAGEUSAGE_H
+#define OPENMW_COMPONENTS_RESOURCE_IMAGEUSAGE_H
+
+namespace Resource
+{
+    /// What an image is used for, deciding how it is processed once decoded.
+    enum class ImageUsage
+    {
+        /// Shown as is, like the user interface. Never processed.
+        Interface,
+        /// Colours of models and terrain. May get mipmaps generated and be transcoded.
+        SceneColor,
+        /// Normal, bump and other maps of models and terrain holding data. May get mipmaps generated, never
+        /// transcoded as lossy compression would distort the data.
+        SceneData,
+    };
+}
+
+#endif
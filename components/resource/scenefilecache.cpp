@@ -0,0 +1,528 @@
+#include "scenefilecache.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <typeinfo>
+
+#include <osg/Geometry>
+#include <osg/LOD>
+#include <osg/MatrixTransform>
+#include <osg/Switch>
+#include <osg/Texture>
+#include <osg/ValueObject>
+#include <osgDB/ObjectWrapper>
+#include <osgDB/Registry>
+
+#include <components/debug/debuglog.hpp>
+#include <components/files/conversion.hpp>
+#include <components/files/hash.hpp>
+#include <components/nifosg/matrixtransform.hpp>
+#include <components/sceneutil/depth.hpp>
+#include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/serialize.hpp>
+#include <components/sceneutil/workqueue.hpp>
+#include <components/shader/removedalphafunc.hpp>
+#include <components/shader/shadervisitor.hpp>
+
+#include "imagemanager.hpp"
+#include "scenemanager.hpp"
+
+namespace Resource
+{
+    namespace
+    {
+        constexpr char sMagic[8] = { 'O', 'M', 'W', 'S', 'C', 'N', 'E', '\0' };
+        constexpr std::uint32_t sFormatVersion = 1;
+
+        /// osg::Geometry whose vertex data is serialized. SceneUtil::registerSerializers() replaces the osg::Geometry
+        /// wrapper with one that only writes the structure, so the cached scenes use their own class.
+        class CachedGeometry : public osg::Geometry
+        {
+        public:
+            CachedGeometry() = default;
+            CachedGeometry(const osg::Geometry& copy, const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY)
+                : osg::Geometry(copy, copyop)
+            {
+            }
+
+            META_Node(Resource, CachedGeometry)
+        };
+
+        void writeArray(osgDB::OutputStream& os, const osg::Array* array)
+        {
+            os << (array != nullptr);
+            if (array)
+                os.writeObject(array);
+        }
+
+        osg::ref_ptr<osg::Array> readArray(osgDB::InputStream& is)
+        {
+            bool hasArray = false;
+            is >> hasArray;
+            if (!hasArray)
+                return nullptr;
+            return is.readObjectOfType<osg::Array>();
+        }
+
+        bool checkArrays(const CachedGeometry&)
+        {
+            return true;
+        }
+
+        bool writeArrays(osgDB::OutputStream& os, const CachedGeometry& geometry)
+        {
+            os << os.BEGIN_BRACKET << std::endl;
+            writeArray(os, geometry.getVertexArray());
+            writeArray(os, geometry.getNormalArray());
+            writeArray(os, geometry.getColorArray());
+            writeArray(os, geometry.getSecondaryColorArray());
+            writeArray(os, geometry.getFogCoordArray());
+            for (const osg::Geometry::ArrayList* list :
+                { &geometry.getTexCoordArrayList(), &geometry.getVertexAttribArrayList() })
+            {
+                os << static_cast<unsigned int>(list->size());
+                for (const osg::ref_ptr<osg::Array>& array : *list)
+                    writeArray(os, array.get());
+            }
+            os << os.END_BRACKET << std::endl;
+            return true;
+        }
+
+        bool readArrays(osgDB::InputStream& is, CachedGeometry& geometry)
+        {
+            is >> is.BEGIN_BRACKET;
+            geometry.setVertexArray(readArray(is));
+            geometry.setNormalArray(readArray(is));
+            geometry.setColorArray(readArray(is));
+            geometry.setSecondaryColorArray(readArray(is));
+            geometry.setFogCoordArray(readArray(is));
+            unsigned int size = 0;
+            is >> size;
+            for (unsigned int i = 0; i < size; ++i)
+                geometry.setTexCoordArray(i, readArray(is));
+            is >> size;
+            for (unsigned int i = 0; i < size; ++i)
+                geometry.setVertexAttribArray(i, readArray(is));
+            is >> is.END_BRACKET;
+            return true;
+        }
+
+        bool checkPrimitiveSets(const CachedGeometry& geometry)
+        {
+            return geometry.getNumPrimitiveSets() > 0;
+        }
+
+        bool writePrimitiveSets(osgDB::OutputStream& os, const CachedGeometry& geometry)
+        {
+            os << geometry.getNumPrimitiveSets() << os.BEGIN_BRACKET << std::endl;
+            for (unsigned int i = 0; i < geometry.getNumPrimitiveSets(); ++i)
+                os.writeObject(geometry.getPrimitiveSet(i));
+            os << os.END_BRACKET << std::endl;
+            return true;
+        }
+
+        bool readPrimitiveSets(osgDB::InputStream& is, CachedGeometry& geometry)
+        {
+            unsigned int size = is.readSize();
+            is >> is.BEGIN_BRACKET;
+            for (unsigned int i = 0; i < size; ++i)
+            {
+                if (osg::ref_ptr<osg::PrimitiveSet> primitiveSet = is.readObjectOfType<osg::PrimitiveSet>())
+                    geometry.addPrimitiveSet(primitiveSet);
+            }
+            is >> is.END_BRACKET;
+            return true;
+        }
+
+        osg::Object* createCachedGeometry()
+        {
+            return new CachedGeometry;
+        }
+
+        class CachedGeometrySerializer : public osgDB::ObjectWrapper
+        {
+        public:
+            CachedGeometrySerializer()
+                : osgDB::ObjectWrapper(createCachedGeometry, "Resource::CachedGeometry",
+                    "osg::Object osg::Node osg::Drawable Resource::CachedGeometry")
+            {
+                addSerializer(new osgDB::UserSerializer<CachedGeometry>("Arrays", checkArrays, readArrays, writeArrays),
+                    osgDB::BaseSerializer::RW_USER);
+                addSerializer(new osgDB::UserSerializer<CachedGeometry>(
+                                  "PrimitiveSets", checkPrimitiveSets, readPrimitiveSets, writePrimitiveSets),
+                    osgDB::BaseSerializer::RW_USER);
+            }
+        };
+
+        void registerCacheSerializers()
+        {
+            static std::once_flag registered;
+            std::call_once(registered, [] {
+                SceneUtil::registerSerializers();
+                osgDB::Registry::instance()->getObjectWrapperManager()->addWrapper(new CachedGeometrySerializer);
+            });
+        }
+
+        /// Copies a scene into classes that can be written and read back. Anything else makes the scene unsupported.
+        class SerializeCopyOp : public osg::CopyOp
+        {
+        public:
+            explicit SerializeCopyOp(bool keepUserValues)
+                : osg::CopyOp(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES)
+                , mKeepUserValues(keepUserValues)
+            {
+            }
+
+            mutable bool mSupported = true;
+
+            osg::Node* operator()(const osg::Node* node) const override
+            {
+                if (const osg::Drawable* drawable = node->asDrawable())
+                    return operator()(drawable);
+
+                if (node->getCullCallback() || node->getUpdateCallback())
+                    return unsupported();
+
+                const std::type_info& type = typeid(*node);
+                if (type != typeid(osg::Group) && type != typeid(osg::LOD) && type != typeid(osg::Switch)
+                    && type != typeid(osg::MatrixTransform) && type != typeid(NifOsg::MatrixTransform)
+                    && type != typeid(SceneUtil::PositionAttitudeTransform))
+                    return unsupported();
+
+                osg::Node* cloned = static_cast<osg::Node*>(node->clone(*this));
+                prepareUserData(*cloned);
+                return cloned;
+            }
+
+            osg::Drawable* operator()(const osg::Drawable* drawable) const override
+            {
+                if (typeid(*drawable) != typeid(osg::Geometry) || drawable->getCullCallback()
+                    || drawable->getUpdateCallback() || drawable->getDrawCallback())
+                {
+                    unsupported();
+                    return nullptr;
+                }
+
+                osg::ref_ptr<CachedGeometry> geometry
+                    = new CachedGeometry(*static_cast<const osg::Geometry*>(drawable));
+                prepareUserData(*geometry);
+                geometry->setComputeBoundingBoxCallback(nullptr);
+                return geometry.release();
+            }
+
+            osg::Callback* operator()(const osg::Callback*) const override { return nullptr; }
+
+        private:
+            osg::Node* unsupported() const
+            {
+                mSupported = false;
+                return nullptr;
+            }
+
+            // The copy shares the user data container of the original, which is only read while writing
+            void prepareUserData(osg::Object& object) const
+            {
+                const osg::UserDataContainer* userData = object.getUserDataContainer();
+                if (!userData)
+                    return;
+
+                if (!mKeepUserValues)
+                {
+                    object.setUserDataContainer(nullptr);
+                    return;
+                }
+
+                if (userData->getUserData() != nullptr)
+                    mSupported = false;
+                for (unsigned int i = 0; i < userData->getNumUserObjects(); ++i)
+                    if (dynamic_cast<const osg::ValueObject*>(userData->getUserObject(i)) == nullptr)
+                        mSupported = false;
+            }
+
+            bool mKeepUserValues;
+        };
+
+        /// Strips the state added by the ShaderVisitor, which is created again after loading.
+        class PrepareStateSetsVisitor : public osg::NodeVisitor
+        {
+        public:
+            PrepareStateSetsVisitor()
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            {
+            }
+
+            bool mSupported = true;
+
+            void apply(osg::Node& node) override
+            {
+                if (const osg::StateSet* stateSet = node.getStateSet())
+                    node.setStateSet(prepare(*stateSet));
+                traverse(node);
+            }
+
+        private:
+            osg::ref_ptr<osg::StateSet> prepare(const osg::StateSet& stateSet)
+            {
+                osg::ref_ptr<osg::StateSet> prepared = new osg::StateSet(stateSet, osg::CopyOp::SHALLOW_COPY);
+                prepared->setUpdateCallback(nullptr);
+                prepared->setEventCallback(nullptr);
+                prepared->removeAttribute(osg::StateAttribute::PROGRAM);
+                const osg::StateAttribute* alphaFunc = prepared->getAttribute(osg::StateAttribute::ALPHAFUNC);
+                if (dynamic_cast<const Shader::RemovedAlphaFunc*>(alphaFunc))
+                    prepared->removeAttribute(osg::StateAttribute::ALPHAFUNC);
+
+                if (const osg::UserDataContainer* userData = prepared->getUserDataContainer())
+                {
+                    osg::ref_ptr<osg::UserDataContainer> copy = osg::clone(userData, osg::CopyOp::SHALLOW_COPY);
+                    copy->removeUserObject(copy->getUserObjectIndex("addedState"));
+                    prepared->setUserDataContainer(copy);
+                }
+
+                for (const osg::StateSet::AttributeList& attributes : prepared->getTextureAttributeList())
+                {
+                    for (const auto& [type, attribute] : attributes)
+                    {
+                        const osg::Texture* texture = attribute.first->asTexture();
+                        if (!texture)
+                            continue;
+                        if (texture->getNumImages() == 0)
+                            mSupported = false;
+                        for (unsigned int i = 0; i < texture->getNumImages(); ++i)
+                        {
+                            // Images are referenced by their VFS path rather than embedded
+                            const osg::Image* image = texture->getImage(i);
+                            if (!image || image->getFileName().empty())
+                                mSupported = false;
+                        }
+                    }
+                }
+
+                return prepared;
+            }
+        };
+
+        class ApplyFilterSettingsVisitor : public osg::NodeVisitor
+        {
+        public:
+            explicit ApplyFilterSettingsVisitor(SceneManager& sceneManager)
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+                , mSceneManager(sceneManager)
+            {
+            }
+
+            void apply(osg::Node& node) override
+            {
+                if (osg::StateSet* stateSet = node.getStateSet())
+                {
+                    for (const osg::StateSet::AttributeList& attributes : stateSet->getTextureAttributeList())
+                    {
+                        for (const auto& [type, attribute] : attributes)
+                        {
+                            if (osg::Texture* texture = attribute.first->asTexture())
+                                mSceneManager.applyFilterSettings(texture);
+                        }
+                    }
+                }
+                traverse(node);
+            }
+
+        private:
+            SceneManager& mSceneManager;
+        };
+
+        class CachedImageReadCallback : public osgDB::ReadFileCallback
+        {
+        public:
+            explicit CachedImageReadCallback(ImageManager* imageManager)
+                : mImageManager(imageManager)
+            {
+            }
+
+            osgDB::ReaderWriter::ReadResult readImage(
+                const std::string& filename, const osgDB::Options* /*options*/) override
+            {
+                try
+                {
+                    return osgDB::ReaderWriter::ReadResult(
+                        mImageManager->getStreamedImage(filename), osgDB::ReaderWriter::ReadResult::FILE_LOADED);
+                }
+                catch (const std::exception& e)
+                {
+                    return osgDB::ReaderWriter::ReadResult(e.what());
+                }
+            }
+
+        private:
+            ImageManager* mImageManager;
+        };
+
+        class WriteSceneItem : public SceneUtil::WorkItem
+        {
+        public:
+            WriteSceneItem(std::filesystem::path path, const SceneFileCache::Hash& contents,
+                osg::ref_ptr<const osg::Node> node, bool keepUserValues)
+                : mPath(std::move(path))
+                , mContents(contents)
+                , mNode(std::move(node))
+                , mKeepUserValues(keepUserValues)
+            {
+            }
+
+            void doWork() override
+            {
+                try
+                {
+                    write();
+                }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Warning) << "Failed to write cached scene " << mPath << ": " << e.what();
+                }
+            }
+
+        private:
+            void write()
+            {
+                SerializeCopyOp copyOp(mKeepUserValues);
+                osg::ref_ptr<osg::Node> copy = copyOp(mNode.get());
+                if (!copyOp.mSupported || !copy)
+                    return;
+
+                Shader::ReinstateRemovedStateVisitor reinstateRemovedStateVisitor(false);
+                copy->accept(reinstateRemovedStateVisitor);
+                PrepareStateSetsVisitor prepareStateSetsVisitor;
+                copy->accept(prepareStateSetsVisitor);
+                if (!prepareStateSetsVisitor.mSupported)
+                    return;
+
+                osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+                if (!rw)
+                    throw std::runtime_error("osgb plugin not found");
+
+                osg::ref_ptr<osgDB::Options> options = new osgDB::Options;
+                options->setOptionString("WriteImageHint=UseExternal");
+
+                std::ostringstream payload(std::ios_base::out | std::ios_base::binary);
+                const osgDB::ReaderWriter::WriteResult result = rw->writeNode(*copy, payload, options);
+                if (!result.success())
+                    throw std::runtime_error(result.message());
+
+                // Write to a temporary file first so a scene being read never sees a partially written file
+                std::filesystem::path temporary = mPath;
+                temporary += '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+                {
+                    std::ofstream stream(temporary, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+                    if (!stream)
+                        throw std::runtime_error("failed to open " + Files::pathToUnicodeString(temporary));
+                    stream.write(sMagic, sizeof(sMagic));
+                    stream.write(reinterpret_cast<const char*>(&sFormatVersion), sizeof(sFormatVersion));
+                    stream.write(reinterpret_cast<const char*>(mContents.data()), sizeof(mContents));
+                    const std::string data = std::move(payload).str();
+                    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+                    if (!stream)
+                        throw std::runtime_error("failed to write " + Files::pathToUnicodeString(temporary));
+                }
+                std::filesystem::rename(temporary, mPath);
+            }
+
+            std::filesystem::path mPath;
+            SceneFileCache::Hash mContents;
+            osg::ref_ptr<const osg::Node> mNode;
+            bool mKeepUserValues;
+        };
+    }
+
+    SceneFileCache::SceneFileCache(
+        SceneManager* sceneManager, SceneUtil::WorkQueue* workQueue, std::filesystem::path path, bool keepUserValues)
+        : mSceneManager(sceneManager)
+        , mWorkQueue(workQueue)
+        , mPath(std::move(path))
+        , mKeepUserValues(keepUserValues)
+    {
+        registerCacheSerializers();
+
+        std::error_code ec;
+        std::filesystem::create_directories(mPath, ec);
+        if (ec)
+            Log(Debug::Warning) << "Failed to create scene cache directory " << mPath << ": " << ec.message();
+    }
+
+    SceneFileCache::Hash SceneFileCache::makeHash(std::string_view data)
+    {
+        std::istringstream stream{ std::string(data) };
+        return Files::getHash("scene file cache", stream);
+    }
+
+    std::filesystem::path SceneFileCache::getFilePath(const Hash& entry) const
+    {
+        std::ostringstream name;
+        name << std::hex << std::setfill('0') << std::setw(16) << entry[0] << std::setw(16) << entry[1] << ".osgb";
+        return mPath / name.str();
+    }
+
+    osg::ref_ptr<osg::Node> SceneFileCache::read(const Hash& entry, const Hash& contents) const
+    {
+        const std::filesystem::path path = getFilePath(entry);
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+        if (!stream)
+            return nullptr;
+
+        char magic[sizeof(sMagic)];
+        std::uint32_t version = 0;
+        Hash storedContents{ 0, 0 };
+        stream.read(magic, sizeof(magic));
+        stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+        stream.read(reinterpret_cast<char*>(storedContents.data()), sizeof(storedContents));
+        if (!stream || !std::equal(std::begin(magic), std::end(magic), std::begin(sMagic)) || version != sFormatVersion
+            || storedContents != contents)
+            return nullptr;
+
+        // The osgb reader expects its header at the start of the stream
+        std::istringstream payload(
+            std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()),
+            std::ios_base::in | std::ios_base::binary);
+        stream.close();
+
+        try
+        {
+            osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+            if (!rw)
+                throw std::runtime_error("osgb plugin not found");
+
+            osg::ref_ptr<osgDB::Options> options = new osgDB::Options;
+            options->setReadFileCallback(new CachedImageReadCallback(mSceneManager->getImageManager()));
+            osgDB::ReaderWriter::ReadResult result = rw->readNode(payload, options);
+            if (!result.success())
+                throw std::runtime_error(result.message());
+
+            osg::ref_ptr<osg::Node> node = result.getNode();
+
+            // Redo what SceneManager::getTemplate does to freshly loaded meshes
+            ApplyFilterSettingsVisitor applyFilterSettingsVisitor(*mSceneManager);
+            node->accept(applyFilterSettingsVisitor);
+            SceneUtil::ReplaceDepthVisitor replaceDepthVisitor;
+            node->accept(replaceDepthVisitor);
+            mSceneManager->recreateShaders(node);
+            mSceneManager->shareState(node);
+
+            return node;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to read cached scene " << path << ": " << e.what();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return nullptr;
+        }
+    }
+
+    void SceneFileCache::write(const Hash& entry, const Hash& contents, osg::ref_ptr<const osg::Node> node) const
+    {
+        mWorkQueue->addWorkItem(new WriteSceneItem(getFilePath(entry), contents, std::move(node), mKeepUserValues));
+    }
+
+}
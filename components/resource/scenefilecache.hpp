@@ -0,0 +1,60 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_SCENEFILECACHE_H
+#define OPENMW_COMPONENTS_RESOURCE_SCENEFILECACHE_H
+
+#include <osg/ref_ptr>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace osg
+{
+    class Node;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
+namespace Resource
+{
+    class SceneManager;
+
+    /// @brief Stores processed scene graphs on disk, so that later sessions don't have to build them again.
+    /// @note Each entry has a single file which is overwritten whenever the entry's contents change.
+    class SceneFileCache
+    {
+    public:
+        using Hash = std::array<std::uint64_t, 2>;
+
+        /// @param keepUserValues Keep the user values of the nodes, any other user object makes a scene unsupported.
+        /// Otherwise all user data is discarded.
+        SceneFileCache(SceneManager* sceneManager, SceneUtil::WorkQueue* workQueue, std::filesystem::path path,
+            bool keepUserValues);
+
+        static Hash makeHash(std::string_view data);
+
+        /// @param entry Identifies the file of the entry.
+        /// @param contents Identifies everything the scene was built from.
+        /// @return nullptr if there is no up-to-date entry.
+        /// @note Thread safe.
+        osg::ref_ptr<osg::Node> read(const Hash& entry, const Hash& contents) const;
+
+        /// Serialize the scene in the background. Does nothing if the scene contains state that can not be restored.
+        /// @note Thread safe.
+        void write(const Hash& entry, const Hash& contents, osg::ref_ptr<const osg::Node> node) const;
+
+    private:
+        std::filesystem::path getFilePath(const Hash& entry) const;
+
+        SceneManager* mSceneManager;
+        osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+        std::filesystem::path mPath;
+        bool mKeepUserValues;
+    };
+
+}
+
+#endif
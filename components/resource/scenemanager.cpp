@@ -1,7 +1,9 @@
 #include "scenemanager.hpp"
 
+#include <chrono>
 #include <cstdlib>
 #include <filesystem>
+#include <type_traits>
 
 #include <osg/AlphaFunc>
 #include <osg/ColorMaski>
@@ -45,6 +47,7 @@
 #include <components/sceneutil/lightmanager.hpp>
 #include <components/sceneutil/optimizer.hpp>
 #include <components/sceneutil/riggeometryosgaextension.hpp>
+#include <components/sceneutil/uploadscheduler.hpp>
 #include <components/sceneutil/util.hpp>
 #include <components/sceneutil/visitor.hpp>
 
@@ -55,11 +58,14 @@
 #include <components/files/hash.hpp>
 #include <components/files/memorystream.hpp>
 
+#include <components/version/version.hpp>
+
 #include "bgsmfilemanager.hpp"
 #include "errormarker.hpp"
 #include "imagemanager.hpp"
 #include "niffilemanager.hpp"
 #include "objectcache.hpp"
+#include "scenefilecache.hpp"
 
 namespace
 {
@@ -549,7 +555,8 @@ namespace Resource
     {
         mLightingMethod = method;
 
-        if (mLightingMethod == SceneUtil::LightingMethod::SingleUBO)
+        if (mLightingMethod == SceneUtil::LightingMethod::SingleUBO
+            || mLightingMethod == SceneUtil::LightingMethod::Clustered)
         {
             osg::ref_ptr<osg::Program> program = new osg::Program;
             program->addBindUniformBlock("LightBufferBinding", static_cast<int>(UBOBinding::LightBuffer));
@@ -978,6 +985,46 @@ namespace Resource
         return static_cast<osg::Node*>(mErrorMarker->clone(osg::CopyOp::DEEP_COPY_ALL));
     }
 
+    namespace
+    {
+        template <class T>
+        void appendToKey(std::string& key, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void appendStringToKey(std::string& key, std::string_view value)
+        {
+            appendToKey(key, value.size());
+            key.append(value);
+        }
+    }
+
+    std::string SceneManager::makeTemplateDiskCacheContents(VFS::Path::NormalizedView name) const
+    {
+        // The converted template depends on the NIF file, the code converting it and the settings of the shader
+        // visitor and the optimizer
+        std::string contents;
+        appendToKey(contents, Files::getHash(name.value(), *mVFS->get(name)));
+        appendStringToKey(contents, Version::getCommitHash());
+        appendToKey(contents, getOptimizationOptions());
+        appendToKey(contents, canOptimize(name.value()));
+        appendToKey(contents, mForceShaders);
+        appendToKey(contents, mAutoUseNormalMaps);
+        appendStringToKey(contents, mNormalMapPattern);
+        appendStringToKey(contents, mNormalHeightMapPattern);
+        appendToKey(contents, mAutoUseSpecularMaps);
+        appendStringToKey(contents, mSpecularMapPattern);
+        appendToKey(contents, mApplyLightingToEnvMaps);
+        appendToKey(contents, mConvertAlphaTestToAlphaToCoverage);
+        appendToKey(contents, mAdjustCoverageForAlphaTest);
+        appendToKey(contents, mSupportsNormalsRT);
+        appendToKey(contents, mWeatherParticleOcclusion);
+        appendToKey(contents, mGpuSkinning);
+        return contents;
+    }
+
     osg::ref_ptr<const osg::Node> SceneManager::getTemplate(std::string_view name, bool compile)
     {
         const VFS::Path::Normalized normalized(name);
@@ -988,48 +1035,87 @@ namespace Resource
         else
         {
             osg::ref_ptr<osg::Node> loaded;
-            try
+
+            SceneFileCache::Hash diskCacheEntry{ 0, 0 };
+            SceneFileCache::Hash diskCacheContents{ 0, 0 };
+            bool useDiskCache
+                = mTemplateDiskCache != nullptr && Misc::getFileExtension(normalized.value()) == "nif";
+            if (useDiskCache)
             {
-                loaded = load(normalized, mVFS, mImageManager, mNifFileManager, mBgsmFileManager);
+                try
+                {
+                    diskCacheEntry = SceneFileCache::makeHash(normalized.value());
+                    diskCacheContents = SceneFileCache::makeHash(makeTemplateDiskCacheContents(normalized));
+                    loaded = mTemplateDiskCache->read(diskCacheEntry, diskCacheContents);
+                }
+                catch (const std::exception&)
+                {
+                    // Missing files are reported below
+                    useDiskCache = false;
+                }
 
-                SceneUtil::ProcessExtraDataVisitor extraDataVisitor(this);
-                loaded->accept(extraDataVisitor);
+                if (loaded)
+                    ++mNumTemplateDiskCacheHits;
+                else
+                    ++mNumTemplateDiskCacheMisses;
             }
-            catch (const std::exception& e)
+
+            if (!loaded)
             {
-                Log(Debug::Error) << "Failed to load '" << name << "': " << e.what() << ", using marker_error instead";
-                loaded = cloneErrorMarker();
-            }
+                const auto start = std::chrono::steady_clock::now();
+
+                try
+                {
+                    loaded = load(normalized, mVFS, mImageManager, mNifFileManager, mBgsmFileManager);
+
+                    SceneUtil::ProcessExtraDataVisitor extraDataVisitor(this);
+                    loaded->accept(extraDataVisitor);
+                }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Error) << "Failed to load '" << name << "': " << e.what()
+                                      << ", using marker_error instead";
+                    loaded = cloneErrorMarker();
+                    useDiskCache = false;
+                }
 
-            // set filtering settings
-            SetFilterSettingsVisitor setFilterSettingsVisitor(mMinFilter, mMagFilter, mMaxAnisotropy);
-            loaded->accept(setFilterSettingsVisitor);
-            SetFilterSettingsControllerVisitor setFilterSettingsControllerVisitor(
-                mMinFilter, mMagFilter, mMaxAnisotropy);
-            loaded->accept(setFilterSettingsControllerVisitor);
+                // set filtering settings
+                SetFilterSettingsVisitor setFilterSettingsVisitor(mMinFilter, mMagFilter, mMaxAnisotropy);
+                loaded->accept(setFilterSettingsVisitor);
+                SetFilterSettingsControllerVisitor setFilterSettingsControllerVisitor(
+                    mMinFilter, mMagFilter, mMaxAnisotropy);
+                loaded->accept(setFilterSettingsControllerVisitor);
 
-            SceneUtil::ReplaceDepthVisitor replaceDepthVisitor;
-            loaded->accept(replaceDepthVisitor);
+                SceneUtil::ReplaceDepthVisitor replaceDepthVisitor;
+                loaded->accept(replaceDepthVisitor);
 
-            osg::ref_ptr<Shader::ShaderVisitor> shaderVisitor(createShaderVisitor());
-            loaded->accept(*shaderVisitor);
+                osg::ref_ptr<Shader::ShaderVisitor> shaderVisitor(createShaderVisitor());
+                loaded->accept(*shaderVisitor);
 
-            if (canOptimize(normalized))
-            {
-                SceneUtil::Optimizer optimizer;
-                optimizer.setSharedStateManager(mSharedStateManager, &mSharedStateMutex);
-                optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+                if (canOptimize(normalized))
+                {
+                    SceneUtil::Optimizer optimizer;
+                    optimizer.setSharedStateManager(mSharedStateManager, &mSharedStateMutex);
+                    optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+
+                    static const unsigned int options
+                        = getOptimizationOptions() | SceneUtil::Optimizer::SHARE_DUPLICATE_STATE;
 
-                static const unsigned int options
-                    = getOptimizationOptions() | SceneUtil::Optimizer::SHARE_DUPLICATE_STATE;
+                    optimizer.optimize(loaded, options);
+                }
+                else
+                    shareState(loaded);
+
+                mTemplateConversionTime += static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                        .count());
 
-                optimizer.optimize(loaded, options);
+                if (useDiskCache)
+                    mTemplateDiskCache->write(diskCacheEntry, diskCacheContents, loaded);
             }
-            else
-                shareState(loaded);
 
             if (compile && mIncrementalCompileOperation)
-                mIncrementalCompileOperation->add(loaded);
+                SceneUtil::addToCompile(*mIncrementalCompileOperation, *loaded, SceneUtil::UploadSubsystem::Objects);
             else
                 loaded->getBound();
 
@@ -1228,6 +1314,18 @@ namespace Resource
         }
 
         Resource::reportStats("Node", frameNumber, mCache->getStats(), *stats);
+
+        stats->setAttribute(frameNumber, "Node Conversion Time", mTemplateConversionTime.exchange(0) / 1000.0);
+        if (mTemplateDiskCache)
+        {
+            stats->setAttribute(frameNumber, "Node Disk Cache Hit", mNumTemplateDiskCacheHits);
+            stats->setAttribute(frameNumber, "Node Disk Cache Miss", mNumTemplateDiskCacheMisses);
+        }
+    }
+
+    void SceneManager::setTemplateDiskCache(std::unique_ptr<SceneFileCache>&& cache)
+    {
+        mTemplateDiskCache = std::move(cache);
     }
 
     osg::ref_ptr<Shader::ShaderVisitor> SceneManager::createShaderVisitor(const std::string& shaderPrefix)
@@ -1245,6 +1343,7 @@ namespace Resource
         shaderVisitor->setAdjustCoverageForAlphaTest(mAdjustCoverageForAlphaTest);
         shaderVisitor->setSupportsNormalsRT(mSupportsNormalsRT);
         shaderVisitor->setWeatherParticleOcclusion(mWeatherParticleOcclusion);
+        shaderVisitor->setGpuSkinning(mGpuSkinning);
         return shaderVisitor;
     }
 }
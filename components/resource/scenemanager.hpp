@@ -2,6 +2,8 @@
 #define OPENMW_COMPONENTS_RESOURCE_SCENEMANAGER_H
 
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -33,6 +35,7 @@ namespace Resource
     class ImageManager;
     class NifFileManager;
     class BgsmFileManager;
+    class SceneFileCache;
     class SharedStateManager;
 }
 
@@ -232,10 +235,18 @@ namespace Resource
 
         void setWeatherParticleOcclusion(bool value) { mWeatherParticleOcclusion = value; }
 
+        void setGpuSkinning(bool enabled) { mGpuSkinning = enabled; }
+
+        /// Store processed NIF templates on disk and load them from there in later sessions, instead of converting
+        /// the NIF file again. Only templates without animation and with known node classes are stored.
+        /// @note Not thread safe, must be called before any template is loaded.
+        void setTemplateDiskCache(std::unique_ptr<SceneFileCache>&& cache);
+
     private:
         osg::ref_ptr<Shader::ShaderVisitor> createShaderVisitor(const std::string& shaderPrefix = "objects");
         osg::ref_ptr<osg::Node> loadErrorMarker();
         osg::ref_ptr<osg::Node> cloneErrorMarker();
+        std::string makeTemplateDiskCacheContents(VFS::Path::NormalizedView name) const;
 
         std::unique_ptr<Shader::ShaderManager> mShaderManager;
         bool mForceShaders;
@@ -254,6 +265,7 @@ namespace Resource
         std::array<osg::ref_ptr<osg::Texture>, 2> mOpaqueDepthTex;
         bool mSoftParticles = false;
         bool mWeatherParticleOcclusion = false;
+        bool mGpuSkinning = false;
 
         osg::ref_ptr<Resource::SharedStateManager> mSharedStateManager;
         mutable std::mutex mSharedStateMutex;
@@ -272,6 +284,12 @@ namespace Resource
         unsigned int mParticleSystemMask;
         mutable osg::ref_ptr<osg::Node> mErrorMarker;
 
+        std::unique_ptr<SceneFileCache> mTemplateDiskCache;
+        std::atomic<std::size_t> mNumTemplateDiskCacheHits{ 0 };
+        std::atomic<std::size_t> mNumTemplateDiskCacheMisses{ 0 };
+        // Nanoseconds spent converting templates since the last report
+        mutable std::atomic<std::uint64_t> mTemplateConversionTime{ 0 };
+
         SceneManager(const SceneManager&);
         void operator=(const SceneManager&);
     };
@@ -71,11 +71,11 @@ namespace Resource
                 "Physics Objects",
                 "Physics Projectiles",
                 "Physics HeightFields",
+                "Physics HeightFields Memory",
+                "Physics HeightFields Shared",
                 "",
                 "Lua UsedMemory",
                 "",
-                "",
-                "",
             };
 
             static_assert(std::size(firstPage) == itemsPerPage);
@@ -104,6 +104,21 @@ namespace Resource
                 "CellPreloader Expired",
             };
 
+            constexpr std::string_view objectPaging[] = {
+                "Object Chunk Merged",
+                "Object Chunk Instanced",
+                "Object Chunk Plain",
+            };
+
+            constexpr std::string_view objectChunkBuild[] = {
+                "Object Chunk Build <1ms",
+                "Object Chunk Build <4ms",
+                "Object Chunk Build <16ms",
+                "Object Chunk Build <64ms",
+                "Object Chunk Build <256ms",
+                "Object Chunk Build >=256ms",
+            };
+
             constexpr std::string_view navMesh[] = {
                 "NavMesh Jobs",
                 "NavMesh Removing",
@@ -126,6 +141,81 @@ namespace Resource
                 "NavMesh Recast Water",
             };
 
+            constexpr std::string_view physics[] = {
+                "Physics Projectiles Time",
+            };
+
+            constexpr std::string_view animation[] = {
+                "Animation Actors",
+                "Animation Prepare Time",
+                "Animation Update Time",
+            };
+
+            constexpr std::string_view skinning[] = {
+                "Skinning CPU Meshes",
+                "Skinning CPU Time",
+                "Skinning GPU Meshes",
+                "Skinning GPU Time",
+                "Skinning Upload",
+                "Skinning Upload Saved",
+            };
+
+            constexpr std::string_view templates[] = {
+                "Node Conversion Time",
+                "Node Disk Cache Hit",
+                "Node Disk Cache Miss",
+            };
+
+            constexpr std::string_view terrain[] = {
+                "Terrain Vertex Memory",
+                "Terrain Vertex Memory Uncompacted",
+            };
+
+            constexpr std::string_view images[] = {
+                "Image Decode Time",
+                "Image Decoded Bytes Compressed",
+                "Image Decoded Bytes Uncompressed",
+                "Image Transcoded Bytes",
+            };
+
+            constexpr std::string_view textureStreaming[] = {
+                "Texture Streaming Images",
+                "Texture Streaming Reduced Images",
+                "Texture Streaming Resident Bytes",
+                "Texture Streaming Wanted Bytes",
+                "Texture Streaming Upgrades",
+                "Texture Streaming Downgrades",
+            };
+
+            constexpr std::string_view programCache[] = {
+                "Program Cache Loaded",
+                "Program Cache Stored",
+                "Program Cache Rejected",
+                "Program Cache Precompiled",
+                "Program Cache Precompile Time",
+            };
+
+            constexpr std::string_view upload[] = {
+                "Upload Objects Queued",
+                "Upload Objects Queued Bytes",
+                "Upload Objects Time",
+                "Upload Object Paging Queued",
+                "Upload Object Paging Queued Bytes",
+                "Upload Object Paging Time",
+                "Upload Terrain Queued",
+                "Upload Terrain Queued Bytes",
+                "Upload Terrain Time",
+            };
+
+            constexpr std::string_view sharedCull[] = {
+                "Cull Main Time",
+                "Cull Reflection Time",
+                "Cull Refraction Time",
+                "Shared Cull Items",
+                "Shared Cull Tested",
+                "Shared Cull Visible",
+            };
+
             std::vector<std::string> statNames;
 
             for (std::string_view name : firstPage)
@@ -141,12 +231,78 @@ namespace Resource
             for (std::string_view name : cellPreloader)
                 statNames.emplace_back(name);
 
+            statNames.emplace_back();
+
+            for (std::string_view name : objectPaging)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : objectChunkBuild)
+                statNames.emplace_back(name);
+
             while (statNames.size() % itemsPerPage != 0)
                 statNames.emplace_back();
 
             for (std::string_view name : navMesh)
                 statNames.emplace_back(name);
 
+            statNames.emplace_back();
+
+            for (std::string_view name : physics)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            // Matches the maximum number of shadow maps
+            for (int i = 0; i < 8; ++i)
+                statNames.push_back("Shadow Map " + std::to_string(i) + " Cull");
+
+            statNames.emplace_back();
+
+            for (std::string_view name : animation)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : skinning)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : templates)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : terrain)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : images)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : textureStreaming)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : programCache)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : upload)
+                statNames.emplace_back(name);
+
+            statNames.emplace_back();
+
+            for (std::string_view name : sharedCull)
+                statNames.emplace_back(name);
+
             return statNames;
         }
 
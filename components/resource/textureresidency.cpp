@@ -0,0 +1,118 @@
+#include "textureresidency.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Resource
+{
+
+    std::size_t getResidentSize(std::span<const std::size_t> levelSizes, unsigned int level)
+    {
+        if (level >= levelSizes.size())
+            return 0;
+        return std::accumulate(levelSizes.begin() + level, levelSizes.end(), std::size_t{ 0 });
+    }
+
+    unsigned int getWantedLevel(float textureSize, float screenSize, unsigned int numLevels)
+    {
+        if (numLevels == 0)
+            return 0;
+        if (!(screenSize > 0))
+            return numLevels - 1;
+        if (screenSize >= textureSize)
+            return 0;
+        const float level = std::floor(std::log2(textureSize / screenSize));
+        return std::min(static_cast<unsigned int>(level), numLevels - 1);
+    }
+
+    std::vector<TextureResidencyChange> planTextureResidency(std::span<const TextureResidency> textures,
+        std::size_t budget, unsigned int frameNumber, unsigned int releaseDelay)
+    {
+        std::vector<unsigned int> levels(textures.size());
+        std::vector<unsigned int> targets(textures.size());
+        std::vector<bool> changed(textures.size(), false);
+        std::size_t total = 0;
+
+        for (std::size_t i = 0; i < textures.size(); ++i)
+        {
+            const TextureResidency& texture = textures[i];
+            levels[i] = texture.mLevel;
+            total += getResidentSize(texture.mLevelSizes, texture.mLevel);
+            const bool visible
+                = frameNumber <= texture.mLastVisibleFrame || frameNumber - texture.mLastVisibleFrame <= releaseDelay;
+            targets[i] = visible ? std::min(texture.mWantedLevel, texture.mInitialLevel) : texture.mInitialLevel;
+        }
+
+        const auto setLevel = [&](std::size_t index, unsigned int level) {
+            const std::span<const std::size_t> sizes = textures[index].mLevelSizes;
+            total = total - getResidentSize(sizes, levels[index]) + getResidentSize(sizes, level);
+            levels[index] = level;
+            changed[index] = true;
+        };
+
+        std::vector<std::size_t> candidates;
+
+        for (std::size_t i = 0; i < textures.size(); ++i)
+            if (!textures[i].mPending && targets[i] > levels[i])
+                setLevel(i, targets[i]);
+
+        if (total > budget)
+        {
+            for (std::size_t i = 0; i < textures.size(); ++i)
+                if (!textures[i].mPending && levels[i] < textures[i].mInitialLevel)
+                    candidates.push_back(i);
+
+            std::stable_sort(candidates.begin(), candidates.end(), [&](std::size_t l, std::size_t r) {
+                return textures[l].mLastVisibleFrame < textures[r].mLastVisibleFrame;
+            });
+
+            for (std::size_t i : candidates)
+            {
+                if (total <= budget)
+                    break;
+                unsigned int level = levels[i];
+                while (level < textures[i].mInitialLevel
+                    && total - getResidentSize(textures[i].mLevelSizes, levels[i])
+                            + getResidentSize(textures[i].mLevelSizes, level)
+                        > budget)
+                    ++level;
+                setLevel(i, level);
+            }
+        }
+
+        candidates.clear();
+        for (std::size_t i = 0; i < textures.size(); ++i)
+            if (!textures[i].mPending && !changed[i] && targets[i] < levels[i])
+                candidates.push_back(i);
+
+        std::stable_sort(candidates.begin(), candidates.end(), [&](std::size_t l, std::size_t r) {
+            const unsigned int lMissing = levels[l] - targets[l];
+            const unsigned int rMissing = levels[r] - targets[r];
+            if (lMissing != rMissing)
+                return lMissing > rMissing;
+            return textures[l].mLastVisibleFrame > textures[r].mLastVisibleFrame;
+        });
+
+        for (std::size_t i : candidates)
+        {
+            const std::span<const std::size_t> sizes = textures[i].mLevelSizes;
+            const std::size_t current = getResidentSize(sizes, levels[i]);
+            for (unsigned int level = targets[i]; level < levels[i]; ++level)
+            {
+                if (total - current + getResidentSize(sizes, level) <= budget)
+                {
+                    setLevel(i, level);
+                    break;
+                }
+            }
+        }
+
+        std::vector<TextureResidencyChange> result;
+        for (std::size_t i = 0; i < textures.size(); ++i)
+            if (levels[i] != textures[i].mLevel)
+                result.push_back(TextureResidencyChange{ .mIndex = i, .mLevel = levels[i] });
+        return result;
+    }
+
+}
@@ -0,0 +1,51 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_TEXTURERESIDENCY_H
+#define OPENMW_COMPONENTS_RESOURCE_TEXTURERESIDENCY_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Resource
+{
+
+    /// State of a streamed texture as seen by planTextureResidency. Levels are mipmap levels, 0 being the largest.
+    struct TextureResidency
+    {
+        /// Sizes in bytes of every mipmap of the full texture, from the largest one.
+        std::span<const std::size_t> mLevelSizes;
+        /// Largest resident mipmap, or the one being loaded.
+        unsigned int mLevel = 0;
+        /// Largest mipmap the texture is first loaded with, smaller ones are always resident.
+        unsigned int mInitialLevel = 0;
+        /// Largest mipmap worth having for the screen size of the texture the last time it was visible.
+        unsigned int mWantedLevel = 0;
+        unsigned int mLastVisibleFrame = 0;
+        /// A previous change of the resident mipmaps isn't done yet.
+        bool mPending = false;
+    };
+
+    struct TextureResidencyChange
+    {
+        std::size_t mIndex;
+        unsigned int mLevel;
+
+        friend bool operator==(const TextureResidencyChange& lhs, const TextureResidencyChange& rhs) = default;
+    };
+
+    /// Size in bytes of the given mipmap and all the smaller ones.
+    std::size_t getResidentSize(std::span<const std::size_t> levelSizes, unsigned int level);
+
+    /// Largest mipmap of a texture of the given size in texels worth having when it covers the given number of
+    /// pixels, clamped to the smallest one.
+    unsigned int getWantedLevel(float textureSize, float screenSize, unsigned int numLevels);
+
+    /// Changes of the resident mipmaps bringing the textures to their wanted level within the budget in bytes.
+    /// Textures not visible for more than releaseDelay frames go back to their initial level. When the textures are
+    /// over budget, the least recently visible ones are reduced first. Upgrades are granted by decreasing number of
+    /// missing mipmaps and never get the textures over budget, the finest level that fits is used.
+    std::vector<TextureResidencyChange> planTextureResidency(std::span<const TextureResidency> textures,
+        std::size_t budget, unsigned int frameNumber, unsigned int releaseDelay);
+
+}
+
+#endif
@@ -0,0 +1,389 @@
+#include "texturestreamer.hpp"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+
+#include <osg/Stats>
+#include <osgUtil/CullVisitor>
+#include <osgUtil/RenderLeaf>
+#include <osgUtil/StateGraph>
+
+#include <components/sceneutil/workqueue.hpp>
+
+#include "imagemanager.hpp"
+#include "imageprocessing.hpp"
+#include "textureresidency.hpp"
+
+namespace Resource
+{
+    namespace
+    {
+        // About 5 seconds at 60 frames per second
+        constexpr unsigned int releaseDelayFrames = 300;
+
+        // Textures may repeat over their drawables, ask for a mipmap twice as large as the bounds suggest
+        constexpr float screenSizeFactor = 2;
+
+        std::vector<std::size_t> getLevelSizes(const osg::Image& image)
+        {
+            const unsigned int levels = image.getNumMipmapLevels();
+            const std::size_t total = image.getTotalSizeInBytesIncludingMipmaps();
+            std::vector<std::size_t> result;
+            result.reserve(levels);
+            for (unsigned int level = 0; level < levels; ++level)
+            {
+                const std::size_t begin = static_cast<std::size_t>(image.getMipmapData(level) - image.data());
+                const std::size_t end = level + 1 < levels
+                    ? static_cast<std::size_t>(image.getMipmapData(level + 1) - image.data())
+                    : total;
+                result.push_back(end - begin);
+            }
+            return result;
+        }
+
+        // Approximate height in pixels of the drawable of the leaf
+        float getScreenSize(const osgUtil::RenderLeaf& leaf, float viewportHeight)
+        {
+            const osg::RefMatrix* const projection = leaf._projection.get();
+            const osg::RefMatrix* const modelView = leaf._modelview.get();
+            // Orthographic projections are used for shadow maps, they don't need more texels than the main view
+            if (projection == nullptr || modelView == nullptr || (*projection)(3, 3) != 0)
+                return 0;
+
+            const osg::BoundingSphere& bound = leaf.getDrawable()->getBound();
+            if (!bound.valid())
+                return 0;
+
+            const osg::Vec3d scale = modelView->getScale();
+            const float radius = bound.radius() * static_cast<float>(std::max({ scale.x(), scale.y(), scale.z() }));
+            const float depth = -static_cast<float>((osg::Vec3d(bound.center()) * *modelView).z());
+            if (depth <= radius)
+                return std::numeric_limits<float>::max();
+
+            return radius * static_cast<float>((*projection)(1, 1)) * viewportHeight / depth;
+        }
+    }
+
+    struct TextureStreamer::Load
+    {
+        std::atomic_bool mStarted{ false };
+        std::promise<void> mPromise;
+        std::shared_future<void> mDone = mPromise.get_future().share();
+    };
+
+    class TextureStreamer::LoadWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        LoadWorkItem(TextureStreamer& streamer, std::string normalized, ImageUsage usage, unsigned int level,
+            std::shared_ptr<Load> load)
+            : mStreamer(streamer)
+            , mNormalized(std::move(normalized))
+            , mUsage(usage)
+            , mLevel(level)
+            , mLoad(std::move(load))
+        {
+        }
+
+        void doWork() override
+        {
+            // The streamer claims the loads not started yet when it is destroyed
+            if (mLoad->mStarted.exchange(true))
+                return;
+            mStreamer.load(mNormalized, mUsage, mLevel);
+            mLoad->mPromise.set_value();
+        }
+
+    private:
+        TextureStreamer& mStreamer;
+        std::string mNormalized;
+        ImageUsage mUsage;
+        unsigned int mLevel;
+        std::shared_ptr<Load> mLoad;
+    };
+
+    TextureStreamer::TextureStreamer(ImageManager& imageManager, std::size_t budget, unsigned int initialSize)
+        : mImageManager(imageManager)
+        , mBudget(budget)
+        , mInitialSize(initialSize)
+    {
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        std::vector<std::shared_ptr<Load>> loads;
+        {
+            std::lock_guard lock(mMutex);
+            for (const auto& [name, entry] : mEntries)
+                if (entry.mLoad != nullptr)
+                    loads.push_back(entry.mLoad);
+        }
+        for (const std::shared_ptr<Load>& load : loads)
+        {
+            if (!load->mStarted.exchange(true))
+                load->mPromise.set_value();
+            load->mDone.wait();
+        }
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::getImage(const std::string& normalized, ImageUsage usage)
+    {
+        {
+            std::lock_guard lock(mMutex);
+            const auto it = mEntries.find(normalized);
+            if (it != mEntries.end())
+                return it->second.mImage;
+        }
+
+        osg::ref_ptr<osg::Image> image = mImageManager.readImage(normalized, usage);
+
+        Entry entry;
+        entry.mUsage = usage;
+        entry.mLevelSizes = getLevelSizes(*image);
+        const unsigned int size = static_cast<unsigned int>(std::max(image->s(), image->t()));
+        entry.mSize = static_cast<float>(size);
+
+        unsigned int level = 0;
+        while (level + 1 < entry.mLevelSizes.size() && (size >> level) > mInitialSize)
+            ++level;
+        if (level != 0)
+        {
+            if (osg::ref_ptr<osg::Image> reduced = dropMipmaps(*image, level))
+                image = std::move(reduced);
+            else
+                level = 0;
+        }
+
+        entry.mImage = std::move(image);
+        entry.mResidentLevel = level;
+        entry.mLevel = level;
+        entry.mInitialLevel = level;
+        entry.mWantedLevel = level;
+
+        std::lock_guard lock(mMutex);
+        // Another thread may have decoded the same image meanwhile
+        return mEntries.emplace(normalized, std::move(entry)).first->second.mImage;
+    }
+
+    void TextureStreamer::collect(osgUtil::CullVisitor& cv)
+    {
+        const osg::Viewport* const viewport = cv.getViewport();
+        const osgUtil::StateGraph* const graph = cv.getRootStateGraph();
+        if (viewport == nullptr || graph == nullptr || cv.getFrameStamp() == nullptr)
+            return;
+
+        std::lock_guard lock(mMutex);
+        collect(*graph, static_cast<float>(viewport->height()), cv.getFrameStamp()->getFrameNumber());
+    }
+
+    float TextureStreamer::collect(const osgUtil::StateGraph& graph, float viewportHeight, unsigned int frameNumber)
+    {
+        float screenSize = 0;
+        for (const osg::ref_ptr<osgUtil::RenderLeaf>& leaf : graph._leaves)
+            screenSize = std::max(screenSize, getScreenSize(*leaf, viewportHeight));
+        for (const auto& [key, child] : graph._children)
+            screenSize = std::max(screenSize, collect(*child, viewportHeight, frameNumber));
+
+        const osg::StateSet* const stateSet = graph._stateset;
+        if (stateSet == nullptr || screenSize <= 0)
+            return screenSize;
+
+        for (unsigned int unit = 0; unit < stateSet->getTextureAttributeList().size(); ++unit)
+        {
+            const osg::StateAttribute* const attribute
+                = stateSet->getTextureAttribute(unit, osg::StateAttribute::TEXTURE);
+            if (attribute == nullptr)
+                continue;
+
+            // Textures are only modified by apply, under the same lock
+            osg::Texture* const texture = const_cast<osg::Texture*>(static_cast<const osg::Texture*>(attribute));
+            const osg::Image* const image = texture->getNumImages() == 1 ? texture->getImage(0) : nullptr;
+            if (image == nullptr)
+                continue;
+
+            const auto it = mEntries.find(image->getFileName());
+            if (it == mEntries.end())
+                continue;
+
+            Entry& entry = it->second;
+            entry.mScreenSize = std::max(entry.mScreenSize, screenSize);
+            entry.mLastVisibleFrame = frameNumber;
+            if (std::find(entry.mTextures.begin(), entry.mTextures.end(), texture) == entry.mTextures.end())
+                entry.mTextures.emplace_back(texture);
+
+            // The texture was created before the last change of the resident mipmaps
+            if (image != entry.mImage && entry.mReadyImage == nullptr)
+            {
+                entry.mReadyImage = entry.mImage;
+                entry.mReadyLevel = entry.mResidentLevel;
+                mReady.push_back(&entry);
+            }
+        }
+
+        return screenSize;
+    }
+
+    void TextureStreamer::update(unsigned int frameNumber)
+    {
+        std::vector<osg::ref_ptr<osg::Image>> replaced;
+        std::vector<osg::ref_ptr<LoadWorkItem>> loads;
+
+        {
+            std::lock_guard lock(mMutex);
+
+            replaced.swap(mReplaced);
+
+            std::vector<std::map<std::string, Entry, std::less<>>::iterator> entries;
+            std::vector<TextureResidency> textures;
+
+            for (auto it = mEntries.begin(); it != mEntries.end();)
+            {
+                Entry& entry = it->second;
+                const bool pending = entry.mLoad != nullptr || entry.mReadyImage != nullptr;
+
+                // Nothing uses the image anymore
+                if (!pending && entry.mImage->referenceCount() == 1)
+                {
+                    it = mEntries.erase(it);
+                    continue;
+                }
+
+                if (entry.mScreenSize > 0)
+                    entry.mWantedLevel = getWantedLevel(entry.mSize, entry.mScreenSize * screenSizeFactor,
+                        static_cast<unsigned int>(entry.mLevelSizes.size()));
+                entry.mScreenSize = 0;
+
+                entry.mTextures.erase(std::remove_if(entry.mTextures.begin(), entry.mTextures.end(),
+                                          [](const osg::observer_ptr<osg::Texture>& v) { return !v.valid(); }),
+                    entry.mTextures.end());
+
+                entries.push_back(it);
+                textures.push_back(TextureResidency{
+                    .mLevelSizes = entry.mLevelSizes,
+                    .mLevel = entry.mLevel,
+                    .mInitialLevel = entry.mInitialLevel,
+                    .mWantedLevel = entry.mWantedLevel,
+                    .mLastVisibleFrame = entry.mLastVisibleFrame,
+                    .mPending = pending,
+                });
+
+                ++it;
+            }
+
+            for (const TextureResidencyChange& change :
+                planTextureResidency(textures, mBudget, frameNumber, releaseDelayFrames))
+            {
+                auto& [name, entry] = *entries[change.mIndex];
+
+                if (change.mLevel > entry.mResidentLevel)
+                {
+                    // The smaller mipmaps are already there, no need to decode anything
+                    osg::ref_ptr<osg::Image> image = dropMipmaps(*entry.mImage, change.mLevel - entry.mResidentLevel);
+                    if (image == nullptr)
+                        continue;
+                    entry.mLevel = change.mLevel;
+                    entry.mReadyImage = std::move(image);
+                    entry.mReadyLevel = change.mLevel;
+                    mReady.push_back(&entry);
+                    ++mDowngrades;
+                    continue;
+                }
+
+                entry.mLevel = change.mLevel;
+                entry.mLoad = std::make_shared<Load>();
+                loads.push_back(new LoadWorkItem(*this, name, entry.mUsage, change.mLevel, entry.mLoad));
+            }
+        }
+
+        SceneUtil::WorkQueue* const workQueue = mImageManager.getWorkQueue();
+        for (osg::ref_ptr<LoadWorkItem>& load : loads)
+        {
+            if (workQueue != nullptr)
+                workQueue->addWorkItem(std::move(load));
+            else
+                load->doWork();
+        }
+    }
+
+    void TextureStreamer::load(const std::string& normalized, ImageUsage usage, unsigned int level)
+    {
+        osg::ref_ptr<osg::Image> image = mImageManager.readImage(normalized, usage);
+        if (level != 0)
+            image = dropMipmaps(*image, level);
+
+        std::lock_guard lock(mMutex);
+
+        Entry& entry = mEntries.find(normalized)->second;
+        entry.mLoad = nullptr;
+
+        // The file may have changed since it was first decoded
+        if (image == nullptr || image->getNumMipmapLevels() + level != entry.mLevelSizes.size())
+        {
+            entry.mLevel = entry.mResidentLevel;
+            return;
+        }
+
+        if (entry.mReadyImage == nullptr)
+            mReady.push_back(&entry);
+        entry.mReadyImage = std::move(image);
+        entry.mReadyLevel = level;
+        ++mUpgrades;
+    }
+
+    void TextureStreamer::apply()
+    {
+        std::lock_guard lock(mMutex);
+
+        for (Entry* entry : mReady)
+        {
+            if (entry->mReadyImage == nullptr)
+                continue;
+
+            for (const osg::observer_ptr<osg::Texture>& texture : entry->mTextures)
+            {
+                osg::ref_ptr<osg::Texture> ref;
+                if (!texture.lock(ref) || ref->getImage(0) == entry->mReadyImage)
+                    continue;
+                ref->setImage(0, entry->mReadyImage);
+                // The size and the number of mipmaps of the texture object change
+                ref->dirtyTextureObject();
+            }
+
+            if (entry->mImage != entry->mReadyImage)
+                mReplaced.push_back(std::move(entry->mImage));
+            entry->mImage = std::move(entry->mReadyImage);
+            entry->mResidentLevel = entry->mReadyLevel;
+        }
+
+        mReady.clear();
+    }
+
+    void TextureStreamer::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        std::size_t images = 0;
+        std::size_t reducedImages = 0;
+        std::size_t residentBytes = 0;
+        std::size_t wantedBytes = 0;
+
+        {
+            std::lock_guard lock(mMutex);
+            for (const auto& [name, entry] : mEntries)
+            {
+                const unsigned int wantedLevel = std::min(entry.mWantedLevel, entry.mInitialLevel);
+                ++images;
+                if (entry.mResidentLevel > wantedLevel)
+                    ++reducedImages;
+                residentBytes += getResidentSize(entry.mLevelSizes, entry.mResidentLevel);
+                wantedBytes += getResidentSize(entry.mLevelSizes, wantedLevel);
+            }
+        }
+
+        stats.setAttribute(frameNumber, "Texture Streaming Images", images);
+        stats.setAttribute(frameNumber, "Texture Streaming Reduced Images", reducedImages);
+        stats.setAttribute(frameNumber, "Texture Streaming Resident Bytes", residentBytes);
+        stats.setAttribute(frameNumber, "Texture Streaming Wanted Bytes", wantedBytes);
+        stats.setAttribute(frameNumber, "Texture Streaming Upgrades", mUpgrades.exchange(0));
+        stats.setAttribute(frameNumber, "Texture Streaming Downgrades", mDowngrades.exchange(0));
+    }
+
+}
@@ -0,0 +1,110 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_TEXTURESTREAMER_H
+#define OPENMW_COMPONENTS_RESOURCE_TEXTURESTREAMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <osg/Image>
+#include <osg/Texture>
+#include <osg/observer_ptr>
+#include <osg/ref_ptr>
+
+#include "imageusage.hpp"
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace osgUtil
+{
+    class CullVisitor;
+    class StateGraph;
+}
+
+namespace Resource
+{
+    class ImageManager;
+
+    /// @brief Keeps the largest mipmaps of the streamed images resident only while their textures are big enough on
+    /// the screen, within a budget of memory.
+    /// @par Images are first decoded without their mipmaps larger than the initial size. The screen size of their
+    /// textures is gathered during the cull traversal, the images with more mipmaps are decoded again on the work
+    /// queue and set to the textures at the start of the draw traversal.
+    class TextureStreamer
+    {
+    public:
+        TextureStreamer(ImageManager& imageManager, std::size_t budget, unsigned int initialSize);
+        ~TextureStreamer();
+
+        /// Image of the given file with its resident mipmaps, decoding it if needed.
+        /// @note May be used from any thread.
+        /// @note A file is streamed with the usage it is first retrieved with.
+        osg::ref_ptr<osg::Image> getImage(const std::string& normalized, ImageUsage usage);
+
+        /// Record the screen size of the streamed textures drawn by the leaves of the visitor.
+        /// @note To be called from the cull thread once the scene is traversed.
+        void collect(osgUtil::CullVisitor& cv);
+
+        /// Choose the resident mipmaps according to the last collected screen sizes and start the needed decoding.
+        /// @note To be called once per frame from the update thread.
+        void update(unsigned int frameNumber);
+
+        /// Set the images with new resident mipmaps to their textures.
+        /// @note To be called from the draw thread before anything is drawn.
+        void apply();
+
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
+    private:
+        struct Load;
+
+        struct Entry
+        {
+            osg::ref_ptr<osg::Image> mImage;
+            ImageUsage mUsage = ImageUsage::SceneColor;
+            // Sizes of the mipmaps of the full image
+            std::vector<std::size_t> mLevelSizes;
+            float mSize = 0;
+            unsigned int mResidentLevel = 0;
+            // Differs from the resident level while the image is being decoded or waits to be applied
+            unsigned int mLevel = 0;
+            unsigned int mInitialLevel = 0;
+            unsigned int mWantedLevel = 0;
+            unsigned int mLastVisibleFrame = 0;
+            // Largest screen size since the last update
+            float mScreenSize = 0;
+            std::vector<osg::observer_ptr<osg::Texture>> mTextures;
+            std::shared_ptr<Load> mLoad;
+            osg::ref_ptr<osg::Image> mReadyImage;
+            unsigned int mReadyLevel = 0;
+        };
+
+        class LoadWorkItem;
+
+        float collect(const osgUtil::StateGraph& graph, float viewportHeight, unsigned int frameNumber);
+
+        void load(const std::string& normalized, ImageUsage usage, unsigned int level);
+
+        ImageManager& mImageManager;
+        const std::size_t mBudget;
+        const unsigned int mInitialSize;
+
+        mutable std::mutex mMutex;
+        std::map<std::string, Entry, std::less<>> mEntries;
+        std::vector<Entry*> mReady;
+        // Replaced images are kept until the next update for the threads still reading them from the textures
+        std::vector<osg::ref_ptr<osg::Image>> mReplaced;
+
+        mutable std::atomic<std::size_t> mUpgrades{ 0 };
+        mutable std::atomic<std::size_t> mDowngrades{ 0 };
+    };
+
+}
+
+#endif
@@ -2,12 +2,16 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstring>
 #include <iterator>
+#include <mutex>
 
 #include <osg/BufferIndexBinding>
 #include <osg/BufferObject>
 #include <osg/Endian>
+#include <osg/Image>
+#include <osg/Texture2D>
 #include <osg/ValueObject>
 
 #include <osgUtil/CullVisitor>
@@ -72,6 +76,7 @@ namespace SceneUtil
             { "legacy", LightingMethod::FFP },
             { "shaders compatibility", LightingMethod::PerObjectUniform },
             { "shaders", LightingMethod::SingleUBO },
+            { "shaders clustered", LightingMethod::Clustered },
         };
     }
 
@@ -234,6 +239,136 @@ namespace SceneUtil
         osg::Vec4 mCachedSunPos;
     };
 
+    // Assigns lights to a view space grid of clusters, tiled in screen space and sliced exponentially in depth.
+    // Row N of the grid texture holds the light count of cluster N followed by the light buffer indices of its lights.
+    class LightClusterGrid : public osg::Referenced
+    {
+    public:
+        static constexpr int sTilesX = 16;
+        static constexpr int sTilesY = 8;
+        static constexpr int sSlices = 16;
+        static constexpr int sClusterCount = sTilesX * sTilesY * sSlices;
+        // Everything closer than this is assigned to the first slice
+        static constexpr float sNearDepth = 16.f;
+
+        LightClusterGrid()
+            : mImage(new osg::Image)
+            , mTexture(new osg::Texture2D)
+        {
+            mTexture->setInternalFormat(GL_R32F);
+            mTexture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::NEAREST);
+            mTexture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::NEAREST);
+            mTexture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+            mTexture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+            mTexture->setResizeNonPowerOfTwoHint(false);
+        }
+
+        LightClusterGrid(const LightClusterGrid&) = delete;
+
+        void clear(const osg::Matrix& projection, float farDepth, int maxLightsPerCluster)
+        {
+            const int width = maxLightsPerCluster + 1;
+            if (mImage->s() != width)
+            {
+                mImage->allocateImage(width, sClusterCount, 1, GL_RED, GL_FLOAT);
+                mTexture->setImage(mImage);
+            }
+
+            float* data = reinterpret_cast<float*>(mImage->data());
+            for (int i = 0; i < sClusterCount; ++i)
+                data[i * width] = 0;
+
+            mProjection = projection;
+            mDepthScale = sSlices / std::log(std::max(farDepth, sNearDepth * 2) / sNearDepth);
+        }
+
+        void addLight(int index, const osg::BoundingSphere& viewBound)
+        {
+            const osg::Vec3f& center = viewBound.center();
+            const float radius = viewBound.radius();
+
+            // view space looks down the negative z axis
+            const float minDepth = -center.z() - radius;
+            const float maxDepth = -center.z() + radius;
+            if (maxDepth <= 0)
+                return;
+
+            int minTileX = 0;
+            int maxTileX = sTilesX - 1;
+            int minTileY = 0;
+            int maxTileY = sTilesY - 1;
+
+            // Lights crossing the camera plane can not be projected, they cover the whole screen
+            if (minDepth > 0)
+            {
+                osg::Vec2f minNdc(1, 1);
+                osg::Vec2f maxNdc(-1, -1);
+                for (int i = 0; i < 8; ++i)
+                {
+                    const osg::Vec3f corner = center
+                        + osg::Vec3f(i & 1 ? radius : -radius, i & 2 ? radius : -radius, i & 4 ? radius : -radius);
+                    const osg::Vec4f clip = osg::Vec4f(corner, 1.f) * mProjection;
+                    const osg::Vec2f ndc(clip.x() / clip.w(), clip.y() / clip.w());
+                    minNdc.x() = std::min(minNdc.x(), ndc.x());
+                    minNdc.y() = std::min(minNdc.y(), ndc.y());
+                    maxNdc.x() = std::max(maxNdc.x(), ndc.x());
+                    maxNdc.y() = std::max(maxNdc.y(), ndc.y());
+                }
+
+                if (minNdc.x() > 1 || minNdc.y() > 1 || maxNdc.x() < -1 || maxNdc.y() < -1)
+                    return;
+
+                minTileX = getTile(minNdc.x(), sTilesX);
+                maxTileX = getTile(maxNdc.x(), sTilesX);
+                minTileY = getTile(minNdc.y(), sTilesY);
+                maxTileY = getTile(maxNdc.y(), sTilesY);
+            }
+
+            const int width = mImage->s();
+            float* data = reinterpret_cast<float*>(mImage->data());
+
+            for (int slice = getSlice(minDepth); slice <= getSlice(maxDepth); ++slice)
+            {
+                for (int y = minTileY; y <= maxTileY; ++y)
+                {
+                    for (int x = minTileX; x <= maxTileX; ++x)
+                    {
+                        float* cluster = data + ((slice * sTilesY + y) * sTilesX + x) * width;
+                        const int count = static_cast<int>(cluster[0]);
+                        if (count >= width - 1)
+                            continue;
+                        cluster[count + 1] = static_cast<float>(index);
+                        cluster[0] = static_cast<float>(count + 1);
+                    }
+                }
+            }
+        }
+
+        void dirty() { mImage->dirty(); }
+
+        osg::Texture2D* getTexture() { return mTexture; }
+
+        osg::Vec2f getDepthParams() const { return osg::Vec2f(sNearDepth, mDepthScale); }
+
+    private:
+        static int getTile(float ndc, int tiles)
+        {
+            return std::clamp(static_cast<int>((ndc * 0.5f + 0.5f) * tiles), 0, tiles - 1);
+        }
+
+        int getSlice(float depth) const
+        {
+            if (depth <= sNearDepth)
+                return 0;
+            return std::clamp(static_cast<int>(std::log(depth / sNearDepth) * mDepthScale), 0, sSlices - 1);
+        }
+
+        osg::ref_ptr<osg::Image> mImage;
+        osg::ref_ptr<osg::Texture2D> mTexture;
+        osg::Matrix mProjection;
+        float mDepthScale = 0;
+    };
+
     struct LightStateCache
     {
         std::vector<osg::Light*> lastAppliedLight;
@@ -270,6 +405,7 @@ namespace SceneUtil
                 break;
             }
             case LightingMethod::SingleUBO:
+            case LightingMethod::Clustered:
             {
                 osg::ref_ptr<LightBuffer> buffer = new LightBuffer(lightManager->getMaxLightsInScene());
 
@@ -627,7 +763,11 @@ namespace SceneUtil
         {
             osg::ref_ptr<osg::StateSet> stateset = new osg::StateSet;
 
-            if (node->getLightingMethod() == LightingMethod::SingleUBO)
+            // Shadow casters may be culled on several threads at once, and they share the light buffers
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            if (node->getLightingMethod() == LightingMethod::SingleUBO
+                || node->getLightingMethod() == LightingMethod::Clustered)
             {
                 const size_t frameId = cv->getTraversalNumber() % 2;
                 stateset->setAttributeAndModes(mUBBs[frameId], osg::StateAttribute::ON);
@@ -641,6 +781,10 @@ namespace SceneUtil
                     buffer->setDiffuse(0, sun->getDiffuse());
                     buffer->setSpecular(0, sun->getSpecular());
                 }
+
+                if (node->getLightingMethod() == LightingMethod::Clustered
+                    && (cv->getTraversalMask() & node->getLightingMask()))
+                    node->updateClusters(cv, stateset);
             }
             else if (node->getLightingMethod() == LightingMethod::PerObjectUniform)
             {
@@ -657,6 +801,8 @@ namespace SceneUtil
                 }
             }
 
+            lock.unlock();
+
             cv->pushStateSet(stateset);
             traverse(node, cv);
             cv->popStateSet();
@@ -666,6 +812,7 @@ namespace SceneUtil
         }
 
         std::array<osg::ref_ptr<osg::UniformBufferBinding>, 2> mUBBs;
+        std::mutex mMutex;
     };
 
     UBOManager::UBOManager(int lightCount)
@@ -813,17 +960,19 @@ namespace SceneUtil
         : mStartLight(0)
         , mLightingMask(~0u)
         , mSun(nullptr)
+        , mClusterTextureUnit(-1)
         , mPointLightRadiusMultiplier(1.f)
         , mPointLightFadeEnd(0.f)
         , mPointLightFadeStart(0.f)
     {
         osg::GLExtensions* exts = SceneUtil::glExtensionsReady() ? &SceneUtil::getGLExtensions() : nullptr;
-        bool supportsUBO = exts && exts->isUniformBufferObjectSupported;
-        bool supportsGPU4 = exts && exts->isGpuShader4Supported;
+        bool supportsUBO = settings.mWithoutGraphicsContext || (exts && exts->isUniformBufferObjectSupported);
+        bool supportsGPU4 = settings.mWithoutGraphicsContext || (exts && exts->isGpuShader4Supported);
 
         mSupported[static_cast<int>(LightingMethod::FFP)] = true;
         mSupported[static_cast<int>(LightingMethod::PerObjectUniform)] = true;
         mSupported[static_cast<int>(LightingMethod::SingleUBO)] = supportsUBO && supportsGPU4;
+        mSupported[static_cast<int>(LightingMethod::Clustered)] = supportsUBO && supportsGPU4;
 
         setUpdateCallback(new LightManagerUpdateCallback);
 
@@ -835,7 +984,10 @@ namespace SceneUtil
         {
             static bool hasLoggedWarnings = false;
 
-            if (settings.mLightingMethod == LightingMethod::SingleUBO && !hasLoggedWarnings)
+            const bool requestsUBO = settings.mLightingMethod == LightingMethod::SingleUBO
+                || settings.mLightingMethod == LightingMethod::Clustered;
+
+            if (requestsUBO && !hasLoggedWarnings)
             {
                 if (!supportsUBO)
                     Log(Debug::Warning) << "GL_ARB_uniform_buffer_object not supported: switching to shader "
@@ -848,6 +1000,8 @@ namespace SceneUtil
 
             if (!supportsUBO || !supportsGPU4 || settings.mLightingMethod == LightingMethod::PerObjectUniform)
                 initPerObjectUniform(settings.mMaxLights);
+            else if (settings.mLightingMethod == LightingMethod::Clustered && settings.mClusterTextureUnit >= 0)
+                initClustered(settings.mMaxLights, settings.mClusterTextureUnit);
             else
                 initSingleUBO(settings.mMaxLights);
 
@@ -864,6 +1018,7 @@ namespace SceneUtil
         , mStartLight(copy.mStartLight)
         , mLightingMask(copy.mLightingMask)
         , mSun(copy.mSun)
+        , mClusterTextureUnit(copy.mClusterTextureUnit)
         , mLightingMethod(copy.mLightingMethod)
         , mPointLightRadiusMultiplier(copy.mPointLightRadiusMultiplier)
         , mPointLightFadeEnd(copy.mPointLightFadeEnd)
@@ -903,17 +1058,29 @@ namespace SceneUtil
     {
         Shader::ShaderManager::DefineMap defines;
 
+        const bool useUBO = getLightingMethod() == LightingMethod::SingleUBO
+            || getLightingMethod() == LightingMethod::Clustered;
+
         defines["maxLights"] = std::to_string(getMaxLights());
         defines["maxLightsInScene"] = std::to_string(getMaxLightsInScene());
         defines["lightingMethodFFP"] = getLightingMethod() == LightingMethod::FFP ? "1" : "0";
         defines["lightingMethodPerObjectUniform"] = getLightingMethod() == LightingMethod::PerObjectUniform ? "1" : "0";
         defines["lightingMethodUBO"] = getLightingMethod() == LightingMethod::SingleUBO ? "1" : "0";
-        defines["useUBO"] = std::to_string(getLightingMethod() == LightingMethod::SingleUBO);
-        // exposes bitwise operators
-        defines["useGPUShader4"] = std::to_string(getLightingMethod() == LightingMethod::SingleUBO);
+        defines["lightingMethodClustered"] = getLightingMethod() == LightingMethod::Clustered ? "1" : "0";
+        defines["useUBO"] = std::to_string(useUBO);
+        // exposes bitwise operators and texelFetch
+        defines["useGPUShader4"] = std::to_string(useUBO);
         defines["getLight"] = getLightingMethod() == LightingMethod::FFP ? "gl_LightSource" : "LightBuffer";
-        defines["startLight"] = getLightingMethod() == LightingMethod::SingleUBO ? "0" : "1";
-        defines["endLight"] = getLightingMethod() == LightingMethod::FFP ? defines["maxLights"] : "PointLightCount";
+        defines["startLight"] = useUBO ? "0" : "1";
+        if (getLightingMethod() == LightingMethod::FFP)
+            defines["endLight"] = defines["maxLights"];
+        else if (getLightingMethod() == LightingMethod::Clustered)
+            defines["endLight"] = "clusterLightCount";
+        else
+            defines["endLight"] = "PointLightCount";
+        defines["clusterTilesX"] = std::to_string(LightClusterGrid::sTilesX);
+        defines["clusterTilesY"] = std::to_string(LightClusterGrid::sTilesY);
+        defines["clusterSlices"] = std::to_string(LightClusterGrid::sSlices);
 
         return defines;
     }
@@ -975,6 +1142,17 @@ namespace SceneUtil
         getOrCreateStateSet()->setAttributeAndModes(mUBOManager);
     }
 
+    void LightManager::initClustered(int targetLights, int textureUnit)
+    {
+        setLightingMethod(LightingMethod::Clustered);
+        setMaxLights(targetLights);
+
+        mClusterTextureUnit = textureUnit;
+        mUBOManager = new UBOManager(getMaxLightsInScene());
+        getOrCreateStateSet()->setAttributeAndModes(mUBOManager);
+        getOrCreateStateSet()->addUniform(new osg::Uniform("ClusterIgnoredLights", osg::Vec4i(0, 0, 0, 0)));
+    }
+
     void LightManager::setLightingMethod(LightingMethod method)
     {
         mLightingMethod = method;
@@ -989,6 +1167,10 @@ namespace SceneUtil
             case LightingMethod::PerObjectUniform:
                 mStateSetGenerator = std::make_unique<StateSetGeneratorPerObjectUniform>();
                 break;
+            case LightingMethod::Clustered:
+                // Lights are assigned to clusters once per camera instead of generating light list statesets
+                mStateSetGenerator = nullptr;
+                return;
         }
         mStateSetGenerator->mLightManager = this;
     }
@@ -1034,6 +1216,8 @@ namespace SceneUtil
         mLights.clear();
         mLightsInViewSpace.clear();
 
+        std::erase_if(mClusterGrids, [](const auto& v) { return !v.first.valid(); });
+
         // Do an occasional cleanup for orphaned lights.
         for (int i = 0; i < 2; ++i)
         {
@@ -1161,10 +1345,12 @@ namespace SceneUtil
             }
 
             const bool fillPPLights = mPPLightBuffer && it->first->getName() == Constants::SceneCamera;
-            const bool sceneLimitReached = getLightingMethod() == LightingMethod::SingleUBO
+            const bool clustered = getLightingMethod() == LightingMethod::Clustered;
+            const bool sceneLimitReached = (getLightingMethod() == LightingMethod::SingleUBO || clustered)
                 && it->second.size() > static_cast<size_t>(getMaxLightsInScene() - 1);
 
-            if (fillPPLights || sceneLimitReached)
+            // Clusters are filled closest lights first, so the light limit of a cluster drops the farthest ones
+            if (fillPPLights || sceneLimitReached || clustered)
             {
                 auto sorter = [](const LightSourceViewBound& left, const LightSourceViewBound& right) {
                     return left.mViewBound.center().length2() - left.mViewBound.radius2()
@@ -1213,7 +1399,52 @@ namespace SceneUtil
         buf->setAttenuationRadius(index,
             osg::Vec4(light->getConstantAttenuation(), light->getLinearAttenuation(), light->getQuadraticAttenuation(),
                 lightSource->getRadius()));
-        buf->setPosition(index, light->getPosition() * (*viewMatrix));
+        // Clustered lighting shares the buffer between cameras and keeps world space positions, the shaders
+        // transform them by the view matrix of the camera.
+        if (viewMatrix)
+            buf->setPosition(index, light->getPosition() * (*viewMatrix));
+        else
+            buf->setPosition(index, light->getPosition());
+    }
+
+    void LightManager::updateClusters(osgUtil::CullVisitor* cv, osg::StateSet* stateset)
+    {
+        const size_t frameNum = cv->getTraversalNumber();
+
+        // Don't use Camera::getViewMatrix, that one might be relative to another camera!
+        const osg::RefMatrix* viewMatrix = cv->getCurrentRenderStage()->getInitialViewMatrix();
+        const std::vector<LightSourceViewBound>& lights = getLightsInViewSpace(cv, viewMatrix, frameNum);
+
+        osg::ref_ptr<LightClusterGrid>& grid
+            = mClusterGrids[osg::observer_ptr<osg::Camera>(cv->getCurrentCamera())][frameNum % 2];
+        if (!grid)
+            grid = new LightClusterGrid;
+
+        const float farDepth = mPointLightFadeEnd > 0 ? mPointLightFadeEnd : Constants::CellSizeInUnits * 4.f;
+        grid->clear(*cv->getProjectionMatrix(), farDepth, getMaxLights());
+
+        LightIndexMap& indexMap = getLightIndexMap(frameNum);
+
+        for (const LightSourceViewBound& light : lights)
+        {
+            const int nextIndex = static_cast<int>(indexMap.size()) + 1;
+            if (nextIndex >= getMaxLightsInScene())
+                break;
+
+            const auto [it, inserted] = indexMap.try_emplace(light.mLightSource->getId(), nextIndex);
+            if (inserted)
+                updateGPUPointLight(nextIndex, light.mLightSource, frameNum, nullptr);
+
+            grid->addLight(it->second, light.mViewBound);
+        }
+
+        grid->dirty();
+
+        stateset->setTextureAttribute(mClusterTextureUnit, grid->getTexture(), osg::StateAttribute::ON);
+        stateset->addUniform(new osg::Uniform("ClusterLightGrid", mClusterTextureUnit));
+        stateset->addUniform(new osg::Uniform("ClusterViewMatrix", osg::Matrixf(*viewMatrix)));
+        stateset->addUniform(new osg::Uniform("ClusterProjectionMatrix", osg::Matrixf(*cv->getProjectionMatrix())));
+        stateset->addUniform(new osg::Uniform("ClusterDepthParams", grid->getDepthParams()));
     }
 
     osg::ref_ptr<osg::Uniform> LightManager::generateLightBufferUniform(const osg::Matrixf& sun)
@@ -1273,6 +1504,15 @@ namespace SceneUtil
         if (!(cv->getTraversalMask() & mLightManager->getLightingMask()))
             return false;
 
+        // Lights are assigned to clusters by the LightManager itself, only the ignored ones are left to the node
+        if (mLightManager->getLightingMethod() == LightingMethod::Clustered)
+        {
+            if (mIgnoredLightSources.empty())
+                return false;
+            cv->pushStateSet(getClusterIgnoredLightsStateSet(cv->getTraversalNumber()));
+            return true;
+        }
+
         // Possible optimizations:
         // - organize lights in a quad tree
 
@@ -1338,4 +1578,30 @@ namespace SceneUtil
         return false;
     }
 
+    osg::StateSet* LightListCallback::getClusterIgnoredLightsStateSet(size_t frameNum)
+    {
+        osg::ref_ptr<osg::StateSet>& stateset = mClusterIgnoredLightsStateSets[frameNum % 2];
+        if (!stateset)
+        {
+            stateset = new osg::StateSet;
+            stateset->addUniform(new osg::Uniform("ClusterIgnoredLights", osg::Vec4i(0, 0, 0, 0)));
+        }
+
+        // Index 0 is the sun, which is never part of a cluster
+        osg::Vec4i indices(0, 0, 0, 0);
+        int count = 0;
+        const auto& indexMap = mLightManager->getLightIndexMap(frameNum);
+        for (const LightSource* lightSource : mIgnoredLightSources)
+        {
+            if (count == 4)
+                break;
+            const auto it = indexMap.find(lightSource->getId());
+            if (it != indexMap.end())
+                indices[count++] = it->second;
+        }
+        stateset->getUniform("ClusterIgnoredLights")->set(indices);
+
+        return stateset;
+    }
+
 }
@@ -2,6 +2,7 @@
 #define OPENMW_COMPONENTS_SCENEUTIL_LIGHTMANAGER_H
 
 #include <array>
+#include <map>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -18,6 +19,7 @@
 namespace SceneUtil
 {
     class LightBuffer;
+    class LightClusterGrid;
     struct StateSetGenerator;
 
     class PPLightBuffer
@@ -187,6 +189,11 @@ namespace SceneUtil
         float mMaximumLightDistance = 0;
         float mLightFadeStart = 0;
         float mLightBoundsMultiplier = 0;
+        /// Texture unit of the light cluster grid, required by LightingMethod::Clustered.
+        int mClusterTextureUnit = -1;
+        /// Use the requested lighting method without checking the extensions of the graphics context, for tools
+        /// culling the scene without one.
+        bool mWithoutGraphicsContext = false;
     };
 
     /// @brief Decorator node implementing the rendering of any number of LightSources that can be anywhere in the
@@ -211,7 +218,7 @@ namespace SceneUtil
         };
 
         using LightList = std::vector<const LightSourceViewBound*>;
-        using SupportedMethods = std::array<bool, 3>;
+        using SupportedMethods = std::array<bool, 4>;
 
         META_Node(SceneUtil, LightManager)
 
@@ -237,6 +244,10 @@ namespace SceneUtil
         /// Internal use only, called automatically by the LightSource's UpdateCallback
         void addLight(LightSource* lightSource, const osg::Matrixf& worldMat, size_t frameNum);
 
+        /// Internal use only, called automatically by the LightManager's CullCallback when using clustered lighting.
+        /// Assigns the lights visible from the current camera to its cluster grid and adds the grid to \a stateset.
+        void updateClusters(osgUtil::CullVisitor* cv, osg::StateSet* stateset);
+
         const std::vector<LightSourceViewBound>& getLightsInViewSpace(
             osgUtil::CullVisitor* cv, const osg::RefMatrix* viewMatrix, size_t frameNum);
 
@@ -283,6 +294,7 @@ namespace SceneUtil
         void initFFP(int targetLights);
         void initPerObjectUniform(int targetLights);
         void initSingleUBO(int targetLights);
+        void initClustered(int targetLights, int textureUnit);
 
         void updateSettings(float lightBoundsMultiplier, float maximumLightDistance, float lightFadeStart);
 
@@ -319,6 +331,12 @@ namespace SceneUtil
         using LightIndexMap = std::unordered_map<int, int>;
         LightIndexMap mLightIndexMaps[2];
 
+        // double buffered cluster grids of each camera, since one of them may be in use by the draw thread
+        using LightClusterGrids = std::array<osg::ref_ptr<LightClusterGrid>, 2>;
+        std::map<osg::observer_ptr<osg::Camera>, LightClusterGrids> mClusterGrids;
+
+        int mClusterTextureUnit;
+
         std::unique_ptr<StateSetGenerator> mStateSetGenerator;
 
         osg::ref_ptr<UBOManager> mUBOManager;
@@ -371,10 +389,14 @@ namespace SceneUtil
         std::set<SceneUtil::LightSource*>& getIgnoredLightSources() { return mIgnoredLightSources; }
 
     private:
+        /// State set telling the clustered lighting shaders the buffer indices of up to 4 ignored light sources.
+        osg::StateSet* getClusterIgnoredLightsStateSet(size_t frameNum);
+
         LightManager* mLightManager;
         size_t mLastFrameNumber;
         LightManager::LightList mLightList;
         std::set<SceneUtil::LightSource*> mIgnoredLightSources;
+        osg::ref_ptr<osg::StateSet> mClusterIgnoredLightsStateSets[2];
     };
 
     void configureStateSetSunOverride(LightManager* lightManager, const osg::Light* light, osg::StateSet* stateset,
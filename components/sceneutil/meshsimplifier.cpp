@@ -0,0 +1,330 @@
+#include "meshsimplifier.hpp"
+
+#include <osg/Vec3d>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        // Open edges are kept by planes through them, perpendicular to their triangle, this much heavier than faces
+        constexpr double boundaryWeight = 10;
+
+        // Smallest allowed cosine between the normals of a triangle before and after a collapse
+        constexpr double minNormalCosine = 0.2;
+
+        /// Symmetric 4x4 matrix giving the weighted sum of the squared distances of a point to a set of planes.
+        struct Quadric
+        {
+            std::array<double, 10> mValues{};
+            // Sum of the weights of faces only, so that open edges add to the error without diluting it
+            double mWeight = 0;
+
+            static Quadric fromPlane(const osg::Vec3d& normal, double distance, double weight)
+            {
+                const double a = normal.x();
+                const double b = normal.y();
+                const double c = normal.z();
+                const double d = distance;
+                Quadric result;
+                result.mValues = { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d };
+                for (double& value : result.mValues)
+                    value *= weight;
+                return result;
+            }
+
+            Quadric& operator+=(const Quadric& other)
+            {
+                for (std::size_t i = 0; i < mValues.size(); ++i)
+                    mValues[i] += other.mValues[i];
+                mWeight += other.mWeight;
+                return *this;
+            }
+
+            /// @return The weighted mean of the squared distances of the point to the planes.
+            double evaluate(const osg::Vec3d& point) const
+            {
+                if (mWeight <= 0)
+                    return 0;
+                const std::array<double, 10>& q = mValues;
+                const double x = point.x();
+                const double y = point.y();
+                const double z = point.z();
+                const double sum = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x + q[4] * y * y
+                    + 2 * q[5] * y * z + 2 * q[6] * y + q[7] * z * z + 2 * q[8] * z + q[9];
+                return std::max(0.0, sum) / mWeight;
+            }
+        };
+
+        Quadric operator+(Quadric lhs, const Quadric& rhs)
+        {
+            return lhs += rhs;
+        }
+
+        struct Collapse
+        {
+            double mCost;
+            unsigned int mFrom;
+            unsigned int mTo;
+            unsigned int mFromVersion;
+            unsigned int mToVersion;
+
+            // Ordered by cost first, then by vertices so that equal costs give the same result everywhere
+            friend bool operator>(const Collapse& lhs, const Collapse& rhs)
+            {
+                return std::tie(lhs.mCost, lhs.mFrom, lhs.mTo) > std::tie(rhs.mCost, rhs.mFrom, rhs.mTo);
+            }
+        };
+
+        class Simplifier
+        {
+        public:
+            Simplifier(const std::vector<osg::Vec3f>& vertices, const std::vector<unsigned int>& triangles)
+                : mVertices(vertices)
+                , mQuadrics(vertices.size())
+                , mVertexTriangles(vertices.size())
+                , mVersions(vertices.size(), 0)
+                , mRemovedVertices(vertices.size(), false)
+            {
+                const std::size_t numTriangles = triangles.size() / 3;
+                mTriangles.reserve(numTriangles);
+                for (std::size_t i = 0; i < numTriangles; ++i)
+                {
+                    const std::array<unsigned int, 3> triangle{ triangles[i * 3], triangles[i * 3 + 1],
+                        triangles[i * 3 + 2] };
+                    if (triangle[0] >= vertices.size() || triangle[1] >= vertices.size()
+                        || triangle[2] >= vertices.size())
+                        continue;
+                    if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+                        continue;
+                    for (unsigned int vertex : triangle)
+                        mVertexTriangles[vertex].push_back(static_cast<unsigned int>(mTriangles.size()));
+                    mTriangles.push_back(triangle);
+                }
+                mRemovedTriangles.assign(mTriangles.size(), false);
+                mNumTriangles = mTriangles.size();
+
+                addFaceQuadrics();
+                addBoundaryQuadrics();
+
+                for (const std::array<unsigned int, 3>& triangle : mTriangles)
+                {
+                    for (std::size_t i = 0; i < 3; ++i)
+                    {
+                        pushCollapse(triangle[i], triangle[(i + 1) % 3]);
+                        pushCollapse(triangle[(i + 1) % 3], triangle[i]);
+                    }
+                }
+            }
+
+            void run(std::size_t targetTriangles, double maxError)
+            {
+                const double maxCost = maxError * maxError;
+                while (mNumTriangles > targetTriangles && !mQueue.empty())
+                {
+                    const Collapse collapse = mQueue.top();
+                    mQueue.pop();
+                    if (mRemovedVertices[collapse.mFrom] || mRemovedVertices[collapse.mTo]
+                        || mVersions[collapse.mFrom] != collapse.mFromVersion
+                        || mVersions[collapse.mTo] != collapse.mToVersion)
+                        continue;
+                    if (collapse.mCost > maxCost)
+                        break;
+                    if (!canCollapse(collapse.mFrom, collapse.mTo))
+                        continue;
+                    apply(collapse.mFrom, collapse.mTo);
+                }
+            }
+
+            std::vector<unsigned int> getTriangles() const
+            {
+                std::vector<unsigned int> result;
+                result.reserve(mNumTriangles * 3);
+                for (std::size_t i = 0; i < mTriangles.size(); ++i)
+                    if (!mRemovedTriangles[i])
+                        result.insert(result.end(), mTriangles[i].begin(), mTriangles[i].end());
+                return result;
+            }
+
+        private:
+            const std::vector<osg::Vec3f>& mVertices;
+            std::vector<std::array<unsigned int, 3>> mTriangles;
+            std::vector<bool> mRemovedTriangles;
+            std::size_t mNumTriangles = 0;
+            std::vector<Quadric> mQuadrics;
+            std::vector<std::vector<unsigned int>> mVertexTriangles;
+            std::vector<unsigned int> mVersions;
+            std::vector<bool> mRemovedVertices;
+            std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mQueue;
+
+            osg::Vec3d getPosition(unsigned int vertex) const { return osg::Vec3d(mVertices[vertex]); }
+
+            osg::Vec3d getNormal(const std::array<unsigned int, 3>& triangle) const
+            {
+                const osg::Vec3d a = getPosition(triangle[0]);
+                return (getPosition(triangle[1]) - a) ^ (getPosition(triangle[2]) - a);
+            }
+
+            void addFaceQuadrics()
+            {
+                for (const std::array<unsigned int, 3>& triangle : mTriangles)
+                {
+                    osg::Vec3d normal = getNormal(triangle);
+                    const double area = normal.normalize() / 2;
+                    if (area <= 0)
+                        continue;
+                    Quadric quadric = Quadric::fromPlane(normal, -(normal * getPosition(triangle[0])), area);
+                    quadric.mWeight = area;
+                    for (unsigned int vertex : triangle)
+                        mQuadrics[vertex] += quadric;
+                }
+            }
+
+            void addBoundaryQuadrics()
+            {
+                // An edge used by a single triangle in either direction is open
+                std::map<std::pair<unsigned int, unsigned int>, std::size_t> edgeUses;
+                for (const std::array<unsigned int, 3>& triangle : mTriangles)
+                    for (std::size_t i = 0; i < 3; ++i)
+                        ++edgeUses[std::minmax(triangle[i], triangle[(i + 1) % 3])];
+
+                for (const std::array<unsigned int, 3>& triangle : mTriangles)
+                {
+                    osg::Vec3d normal = getNormal(triangle);
+                    if (normal.normalize() <= 0)
+                        continue;
+                    for (std::size_t i = 0; i < 3; ++i)
+                    {
+                        const unsigned int from = triangle[i];
+                        const unsigned int to = triangle[(i + 1) % 3];
+                        if (edgeUses[std::minmax(from, to)] != 1)
+                            continue;
+                        const osg::Vec3d edge = getPosition(to) - getPosition(from);
+                        osg::Vec3d edgeNormal = edge ^ normal;
+                        if (edgeNormal.normalize() <= 0)
+                            continue;
+                        const Quadric quadric = Quadric::fromPlane(
+                            edgeNormal, -(edgeNormal * getPosition(from)), boundaryWeight * edge.length2());
+                        mQuadrics[from] += quadric;
+                        mQuadrics[to] += quadric;
+                    }
+                }
+            }
+
+            void pushCollapse(unsigned int from, unsigned int to)
+            {
+                const double cost = (mQuadrics[from] + mQuadrics[to]).evaluate(getPosition(to));
+                mQueue.push(Collapse{ cost, from, to, mVersions[from], mVersions[to] });
+            }
+
+            bool canCollapse(unsigned int from, unsigned int to) const
+            {
+                // The vertices may only share the neighbours opposite of their common edge, otherwise the collapse
+                // would make the surface non-manifold
+                std::vector<unsigned int> fromNeighbours;
+                std::vector<unsigned int> toNeighbours;
+                std::size_t numShared = 0;
+                for (unsigned int triangle : mVertexTriangles[from])
+                {
+                    if (mRemovedTriangles[triangle])
+                        continue;
+                    const std::array<unsigned int, 3>& vertices = mTriangles[triangle];
+                    const bool shared = std::find(vertices.begin(), vertices.end(), to) != vertices.end();
+                    if (shared)
+                        ++numShared;
+                    for (unsigned int vertex : vertices)
+                        if (vertex != from && vertex != to)
+                            fromNeighbours.push_back(vertex);
+
+                    if (shared)
+                        continue;
+                    // Reject triangles that would flip or degenerate
+                    std::array<unsigned int, 3> collapsed = vertices;
+                    std::replace(collapsed.begin(), collapsed.end(), from, to);
+                    osg::Vec3d before = getNormal(vertices);
+                    osg::Vec3d after = getNormal(collapsed);
+                    if (before.normalize() <= 0)
+                        continue;
+                    if (after.normalize() <= 0 || before * after < minNormalCosine)
+                        return false;
+                }
+                if (numShared == 0)
+                    return false;
+
+                for (unsigned int triangle : mVertexTriangles[to])
+                {
+                    if (mRemovedTriangles[triangle])
+                        continue;
+                    for (unsigned int vertex : mTriangles[triangle])
+                        if (vertex != from && vertex != to)
+                            toNeighbours.push_back(vertex);
+                }
+
+                std::sort(fromNeighbours.begin(), fromNeighbours.end());
+                fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+                std::sort(toNeighbours.begin(), toNeighbours.end());
+                toNeighbours.erase(std::unique(toNeighbours.begin(), toNeighbours.end()), toNeighbours.end());
+                std::vector<unsigned int> common;
+                std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(), toNeighbours.begin(),
+                    toNeighbours.end(), std::back_inserter(common));
+                return common.size() <= numShared;
+            }
+
+            void apply(unsigned int from, unsigned int to)
+            {
+                for (unsigned int triangle : mVertexTriangles[from])
+                {
+                    if (mRemovedTriangles[triangle])
+                        continue;
+                    std::array<unsigned int, 3>& vertices = mTriangles[triangle];
+                    if (std::find(vertices.begin(), vertices.end(), to) != vertices.end())
+                    {
+                        mRemovedTriangles[triangle] = true;
+                        --mNumTriangles;
+                        continue;
+                    }
+                    std::replace(vertices.begin(), vertices.end(), from, to);
+                    mVertexTriangles[to].push_back(triangle);
+                }
+                mVertexTriangles[from].clear();
+                mRemovedVertices[from] = true;
+                mQuadrics[to] += mQuadrics[from];
+
+                std::vector<unsigned int>& toTriangles = mVertexTriangles[to];
+                toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+                                      [&](unsigned int triangle) { return mRemovedTriangles[triangle]; }),
+                    toTriangles.end());
+
+                // Every collapse involving the remaining vertex has a new cost
+                ++mVersions[to];
+                for (unsigned int triangle : toTriangles)
+                {
+                    for (unsigned int vertex : mTriangles[triangle])
+                    {
+                        if (vertex == to)
+                            continue;
+                        pushCollapse(to, vertex);
+                        pushCollapse(vertex, to);
+                    }
+                }
+            }
+        };
+    }
+
+    std::vector<unsigned int> simplifyMesh(const std::vector<osg::Vec3f>& vertices,
+        const std::vector<unsigned int>& triangles, std::size_t targetTriangles, float maxError)
+    {
+        Simplifier simplifier(vertices, triangles);
+        simplifier.run(targetTriangles, maxError);
+        return simplifier.getTriangles();
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_MESHSIMPLIFIER_H
+#define OPENMW_COMPONENTS_SCENEUTIL_MESHSIMPLIFIER_H
+
+#include <osg/Vec3f>
+
+#include <cstddef>
+#include <vector>
+
+namespace SceneUtil
+{
+    /// @brief Reduces the number of triangles of an indexed triangle mesh by collapsing edges into one of their
+    /// vertices, cheapest first according to the quadric error metric (Garland & Heckbert).
+    /// @note Vertices are never moved, so normals, texture coordinates and colors stay valid for the result. Open
+    /// edges, including the seams between vertices with different attributes, are preserved where possible.
+    /// @param vertices Positions of the vertices.
+    /// @param triangles Three vertex indices per triangle.
+    /// @param targetTriangles Number of triangles to stop at.
+    /// @param maxError Largest allowed deviation from the original surface, in the units of the vertices.
+    /// @return Three vertex indices per remaining triangle, a subset of the input vertices.
+    std::vector<unsigned int> simplifyMesh(const std::vector<osg::Vec3f>& vertices,
+        const std::vector<unsigned int>& triangles, std::size_t targetTriangles, float maxError);
+}
+
+#endif
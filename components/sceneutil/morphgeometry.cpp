@@ -2,7 +2,9 @@
 
 #include <osgUtil/CullVisitor>
 
+#include <algorithm>
 #include <cassert>
+
 #include <components/resource/scenemanager.hpp>
 
 namespace SceneUtil
@@ -18,6 +20,7 @@ namespace SceneUtil
     MorphGeometry::MorphGeometry(const MorphGeometry& copy, const osg::CopyOp& copyop)
         : osg::Drawable(copy, copyop)
         , mMorphTargets(copy.mMorphTargets)
+        , mBlendTargets(copy.mBlendTargets)
         , mLastFrameNumber(0)
         , mDirty(true)
         , mMorphedBoundingBox(false)
@@ -31,6 +34,7 @@ namespace SceneUtil
             mGeometry[i] = nullptr;
 
         mSourceGeometry = sourceGeom;
+        mBlendedWeights.clear();
 
         for (unsigned int i = 0; i < 2; ++i)
         {
@@ -67,6 +71,9 @@ namespace SceneUtil
     void MorphGeometry::addMorphTarget(osg::Vec3Array* offsets, float weight)
     {
         mMorphTargets.push_back(MorphTarget(offsets, weight));
+        // Prepare the offsets now, so copies of this geometry share them
+        if (mMorphTargets.size() > 1)
+            getBlendOffsets(static_cast<unsigned int>(mMorphTargets.size() - 1));
         mMorphedBoundingBox = false;
         dirty();
     }
@@ -172,42 +179,88 @@ namespace SceneUtil
 
     void MorphGeometry::cull(osg::NodeVisitor* nv)
     {
-        if (mLastFrameNumber == nv->getTraversalNumber() || !mDirty || mMorphTargets.size() == 0)
-        {
+        const auto traverseGeometry = [&] {
             osg::Geometry& geom = *getGeometry(mLastFrameNumber);
             nv->pushOntoNodePath(&geom);
             nv->apply(geom);
             nv->popFromNodePath();
+        };
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mLastFrameNumber == nv->getTraversalNumber() || !mDirty || mMorphTargets.size() == 0)
+        {
+            traverseGeometry();
             return;
         }
 
         mDirty = false;
+
+        // The last blended vertices are still valid
+        if (!updateBlendedWeights())
+        {
+            traverseGeometry();
+            return;
+        }
+
         mLastFrameNumber = nv->getTraversalNumber();
         osg::Geometry& geom = *getGeometry(mLastFrameNumber);
 
         const osg::Vec3Array* positionSrc = mMorphTargets[0].getOffsets();
         osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
         assert(positionSrc->size() == positionDst->size());
-        for (unsigned int vertex = 0; vertex < positionSrc->size(); ++vertex)
-            (*positionDst)[vertex] = (*positionSrc)[vertex];
+        std::copy(positionSrc->begin(), positionSrc->end(), positionDst->begin());
 
         for (unsigned int i = 1; i < mMorphTargets.size(); ++i)
         {
-            float weight = mMorphTargets[i].getWeight();
+            const float weight = mBlendedWeights[i];
             if (weight == 0.f)
                 continue;
-            const osg::Vec3Array* offsets = mMorphTargets[i].getOffsets();
-            for (unsigned int vertex = 0; vertex < positionSrc->size(); ++vertex)
-                (*positionDst)[vertex] += (*offsets)[vertex] * weight;
+            const MorphTargetOffsets& offsets = getBlendOffsets(i);
+            assert(offsets.mSparse || offsets.mOffsets.size() == positionDst->size());
+            addMorphOffsets(offsets, weight, positionDst->asVector().data());
         }
 
         positionDst->dirty();
 
         geom.osg::Drawable::dirtyGLObjects();
 
-        nv->pushOntoNodePath(&geom);
-        nv->apply(geom);
-        nv->popFromNodePath();
+        traverseGeometry();
+    }
+
+    const MorphTargetOffsets& MorphGeometry::getBlendOffsets(unsigned int i)
+    {
+        if (mBlendTargets.size() < mMorphTargets.size())
+            mBlendTargets.resize(mMorphTargets.size());
+
+        // The offsets of a morph target may have been replaced since they were prepared
+        const osg::Vec3Array* source = mMorphTargets[i].getOffsets();
+        if (mBlendTargets[i] == nullptr || mBlendTargets[i]->mSource != source)
+        {
+            auto blendTarget = std::make_shared<BlendTarget>();
+            blendTarget->mSource = source;
+            blendTarget->mOffsets = makeMorphTargetOffsets(source->asVector());
+            mBlendTargets[i] = std::move(blendTarget);
+        }
+
+        return mBlendTargets[i]->mOffsets;
+    }
+
+    bool MorphGeometry::updateBlendedWeights()
+    {
+        // The weights may be the same as when the vertices were last blended even though the geometry is dirty, e.g.
+        // once a morph has been blended out completely or when a change is reverted in the same frame
+        bool changed = mBlendedWeights.size() != mMorphTargets.size();
+        mBlendedWeights.resize(mMorphTargets.size());
+        for (std::size_t i = 0; i < mMorphTargets.size(); ++i)
+        {
+            const float weight = mMorphTargets[i].getWeight();
+            if (mBlendedWeights[i] != weight)
+            {
+                mBlendedWeights[i] = weight;
+                changed = true;
+            }
+        }
+        return changed;
     }
 
     osg::Geometry* MorphGeometry::getGeometry(unsigned int frame) const
@@ -1,8 +1,14 @@
 #ifndef OPENMW_COMPONENTS_MORPHGEOMETRY_H
 #define OPENMW_COMPONENTS_MORPHGEOMETRY_H
 
+#include "morphing.hpp"
+
 #include <osg/Geometry>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace SceneUtil
 {
 
@@ -74,9 +80,24 @@ namespace SceneUtil
         osg::BoundingBox computeBoundingBox() const override;
 
     private:
+        /// Offsets of a morph target prepared for blending, shared between the copies of the geometry.
+        struct BlendTarget
+        {
+            osg::ref_ptr<const osg::Vec3Array> mSource;
+            MorphTargetOffsets mOffsets;
+        };
+
         void cull(osg::NodeVisitor* nv);
 
+        const MorphTargetOffsets& getBlendOffsets(unsigned int i);
+
+        /// @return true if any weight has changed since the vertices were last blended.
+        bool updateBlendedWeights();
+
         MorphTargetList mMorphTargets;
+        // The first morph target holds the source positions and has no entry
+        std::vector<std::shared_ptr<const BlendTarget>> mBlendTargets;
+        std::vector<float> mBlendedWeights;
 
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
 
@@ -85,6 +106,7 @@ namespace SceneUtil
 
         unsigned int mLastFrameNumber;
         bool mDirty; // Have any morph targets changed?
+        std::mutex mMutex;
 
         mutable bool mMorphedBoundingBox;
     };
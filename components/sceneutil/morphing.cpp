@@ -0,0 +1,103 @@
+#include "morphing.hpp"
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        void addDenseOffsetsScalar(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions)
+        {
+            for (std::size_t i = 0; i < target.mOffsets.size(); ++i)
+                positions[i] += target.mOffsets[i] * weight;
+        }
+
+        void addSparseOffsetsScalar(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions)
+        {
+            for (std::size_t i = 0; i < target.mOffsets.size(); ++i)
+                positions[target.mVertices[i]] += target.mOffsets[i] * weight;
+        }
+
+#if defined(OPENMW_SCENEUTIL_SIMD)
+        // Positions and offsets of dense targets are both contiguous arrays of floats, so four components are blended
+        // at once regardless of the vertex they belong to.
+        void addDenseOffsetsVectorized(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions)
+        {
+            using namespace Simd;
+
+            const std::size_t size = target.mOffsets.size() * 3;
+            const float* offsets = reinterpret_cast<const float*>(target.mOffsets.data());
+            float* destination = reinterpret_cast<float*>(positions);
+            const Float4 weights = splat(weight);
+
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4)
+                store(destination + i, add(load(destination + i), mul(load(offsets + i), weights)));
+            for (; i < size; ++i)
+                destination[i] += offsets[i] * weight;
+        }
+#endif
+    }
+
+    MorphTargetOffsets makeMorphTargetOffsets(std::span<const osg::Vec3f> offsets)
+    {
+        const osg::Vec3f zero;
+        const std::size_t moved
+            = offsets.size() - static_cast<std::size_t>(std::count(offsets.begin(), offsets.end(), zero));
+
+        MorphTargetOffsets result;
+        result.mSparse = moved * 2 <= offsets.size();
+
+        if (!result.mSparse)
+        {
+            result.mOffsets.assign(offsets.begin(), offsets.end());
+            return result;
+        }
+
+        result.mVertices.reserve(moved);
+        result.mOffsets.reserve(moved);
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+        {
+            if (offsets[i] == zero)
+                continue;
+            result.mVertices.push_back(static_cast<unsigned int>(i));
+            result.mOffsets.push_back(offsets[i]);
+        }
+
+        return result;
+    }
+
+    bool isMorphingVectorized()
+    {
+#if defined(OPENMW_SCENEUTIL_SIMD)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void addMorphOffsets(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions)
+    {
+#if defined(OPENMW_SCENEUTIL_SIMD)
+        // Sparse offsets are scattered across the positions one vertex at a time. Blending the three components of a
+        // vertex with one SIMD register needs extra shuffles and turns out to be slower than the scalar loop.
+        if (target.mSparse)
+            addSparseOffsetsScalar(target, weight, positions);
+        else
+            addDenseOffsetsVectorized(target, weight, positions);
+#else
+        addMorphOffsetsScalar(target, weight, positions);
+#endif
+    }
+
+    void addMorphOffsetsScalar(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions)
+    {
+        if (target.mSparse)
+            addSparseOffsetsScalar(target, weight, positions);
+        else
+            addDenseOffsetsScalar(target, weight, positions);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_MORPHING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_MORPHING_H
+
+#include <osg/Vec3f>
+
+#include <span>
+#include <vector>
+
+namespace SceneUtil
+{
+    /// @brief Vertex offsets of a morph target prepared for blending. Targets moving only a part of the vertices, like
+    /// most facial expressions, are stored sparsely as the indices of the moved vertices and their offsets.
+    struct MorphTargetOffsets
+    {
+        bool mSparse = false;
+        /// Index of the moved vertex, per offset. Empty for dense targets.
+        std::vector<unsigned int> mVertices;
+        /// Offset of every vertex for dense targets, of the vertices in mVertices for sparse ones.
+        std::vector<osg::Vec3f> mOffsets;
+    };
+
+    /// Choose the representation that is the fastest to blend: sparse if at most half of the offsets are non-zero.
+    MorphTargetOffsets makeMorphTargetOffsets(std::span<const osg::Vec3f> offsets);
+
+    /// @return true if addMorphOffsets uses SIMD instructions for dense targets in this build.
+    bool isMorphingVectorized();
+
+    /// Add the offsets of the target multiplied by weight to the positions.
+    /// @param positions Must have an element for every vertex of the geometry of the target.
+    void addMorphOffsets(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions);
+
+    /// Same as addMorphOffsets, one vertex at a time without SIMD instructions.
+    void addMorphOffsetsScalar(const MorphTargetOffsets& target, float weight, osg::Vec3f* positions);
+}
+
+#endif
@@ -25,12 +25,14 @@
 #include <osg/io_utils>
 #include <osg/Depth>
 #include <osg/ClipControl>
+#include <osg/Timer>
 
 #include <sstream>
 #include <deque>
 #include <vector>
 
 #include "glextensions.hpp"
+#include "riggeometry.hpp"
 #include "shadowsbin.hpp"
 
 namespace {
@@ -346,6 +348,105 @@ void VDSMCameraCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
     _projectionMatrix = cv->getProjectionMatrix();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Shadow caster culling
+//
+struct ShadowMapCull
+{
+    osg::ref_ptr<MWShadowTechnique::ShadowData> _shadowData;
+    osg::ref_ptr<VDSMCameraCullCallback>        _vdsmCallback;
+    double                                      _cascadeNear;
+    double                                      _cascadeFar;
+    double                                      _cullTime;
+};
+
+class CullShadowCastingSceneWorkItem : public SceneUtil::WorkItem
+{
+    public:
+
+        CullShadowCastingSceneWorkItem(const MWShadowTechnique* vdsm, osgUtil::CullVisitor* cv, osg::Camera* camera):
+            _vdsm(vdsm),
+            _cv(cv),
+            _camera(camera),
+            _cullTime(0.0)
+        {
+        }
+
+        void doWork() override
+        {
+            const osg::Timer* timer = osg::Timer::instance();
+            osg::Timer_t start = timer->tick();
+            _vdsm->cullShadowCastingScene(_cv, _camera);
+            _cullTime = timer->delta_s(start, timer->tick());
+        }
+
+        double getCullTime() const { return _cullTime; }
+
+    protected:
+
+        const MWShadowTechnique*    _vdsm;
+        osgUtil::CullVisitor*       _cv;
+        osg::Camera*                _camera;
+        double                      _cullTime;
+};
+
+// Prepare a worker cull visitor so that culling a shadow camera with it produces the same render stage as culling it with cv would.
+unsigned int beginCasterCull(osgUtil::CullVisitor& cv, MWShadowTechnique::ViewDependentData::CasterCullVisitor& caster, const osg::StateSet* shadowCastingStateSet)
+{
+    if (!caster._cullVisitor)
+    {
+        caster._cullVisitor = cv.clone();
+        caster._stateGraph = new osgUtil::StateGraph;
+        caster._renderStage = new osgUtil::RenderStage;
+    }
+
+    osgUtil::CullVisitor* casterCv = caster._cullVisitor.get();
+    casterCv->reset();
+    casterCv->setCullSettings(cv);
+    casterCv->setTraversalMask(cv.getTraversalMask());
+    casterCv->setFrameStamp(const_cast<osg::FrameStamp*>(cv.getFrameStamp()));
+    casterCv->setTraversalNumber(cv.getTraversalNumber());
+    casterCv->setRenderInfo(cv.getRenderInfo());
+
+    caster._stateGraph->clean();
+    caster._renderStage->reset();
+    caster._renderStage->setViewport(cv.getViewport());
+    casterCv->setStateGraph(caster._stateGraph.get());
+    casterCv->setRenderStage(caster._renderStage.get());
+
+    casterCv->pushViewport(cv.getViewport());
+    casterCv->pushProjectionMatrix(cv.getProjectionMatrix());
+    casterCv->pushModelViewMatrix(cv.getModelViewMatrix(), osg::Transform::ABSOLUTE_RF);
+
+    // replicate the state inherited from above the shadowed scene
+    std::vector<const osg::StateSet*> statesets;
+    for (osgUtil::StateGraph* stateGraph = cv.getCurrentStateGraph(); stateGraph; stateGraph = stateGraph->_parent)
+    {
+        if (stateGraph->getStateSet())
+            statesets.push_back(stateGraph->getStateSet());
+    }
+    for (auto itr = statesets.rbegin(); itr != statesets.rend(); ++itr)
+        casterCv->pushStateSet(*itr);
+
+    casterCv->pushStateSet(shadowCastingStateSet);
+
+    return statesets.size() + 1;
+}
+
+void endCasterCull(MWShadowTechnique::ViewDependentData::CasterCullVisitor& caster, unsigned int numStateSets)
+{
+    osgUtil::CullVisitor* casterCv = caster._cullVisitor.get();
+    for (unsigned int i = 0; i < numStateSets; ++i)
+        casterCv->popStateSet();
+
+    casterCv->popModelViewMatrix();
+    casterCv->popProjectionMatrix();
+    casterCv->popViewport();
+
+    caster._stateGraph->prune();
+}
+
 } // namespace
 
 MWShadowTechnique::ComputeLightSpaceBounds::ComputeLightSpaceBounds() :
@@ -925,6 +1026,10 @@ void SceneUtil::MWShadowTechnique::setupCastingShader(Shader::ShaderManager & sh
         auto& program = _castingPrograms[alphaFunc - GL_NEVER];
         program = new osg::Program();
         program->addShader(castingVertexShader);
+        program->addBindAttribLocation("aOffset", 6);
+        program->addBindAttribLocation("aRotation", 7);
+        program->addBindAttribLocation("aBoneIndices", RigGeometry::sBoneIndicesAttribute);
+        program->addBindAttribLocation("aBoneWeights", RigGeometry::sBoneWeightsAttribute);
         program->addShader(shaderManager.getShader("shadowcasting.frag", { {"alphaFunc", std::to_string(alphaFunc)},
                                                                                     {"alphaToCoverage", "0"},
                                                                                     {"adjustCoverage", "1"},
@@ -933,6 +1038,28 @@ void SceneUtil::MWShadowTechnique::setupCastingShader(Shader::ShaderManager & sh
     }
 }
 
+void SceneUtil::MWShadowTechnique::setParallelCasterCulling(bool enable)
+{
+    if (!enable)
+    {
+        _casterCullWorkQueue = nullptr;
+        return;
+    }
+
+    if (_casterCullWorkQueue)
+        return;
+
+    // the main thread culls the first shadow map itself
+    unsigned int numShadowMaps = getShadowedScene() ? getShadowedScene()->getShadowSettings()->getNumShadowMapsPerLight() : 2;
+    _casterCullWorkQueue = new WorkQueue(numShadowMaps > 1 ? numShadowMaps - 1 : 1);
+}
+
+std::vector<double> SceneUtil::MWShadowTechnique::getShadowMapCullTimes() const
+{
+    std::lock_guard<std::mutex> lock(_shadowMapCullTimesMutex);
+    return _lastShadowMapCullTimes;
+}
+
 MWShadowTechnique::ViewDependentData* MWShadowTechnique::createViewDependentData(osgUtil::CullVisitor* /*cv*/)
 {
     return new ViewDependentData(this);
@@ -1188,6 +1315,16 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
 
     unsigned int numShadowMapsPerLight = settings->getNumShadowMapsPerLight();
 
+    {
+        std::lock_guard<std::mutex> lock(_shadowMapCullTimesMutex);
+        if (cv.getTraversalNumber() != _shadowMapCullTimesFrame)
+        {
+            _shadowMapCullTimesFrame = cv.getTraversalNumber();
+            _lastShadowMapCullTimes.swap(_shadowMapCullTimes);
+            _shadowMapCullTimes.assign(numShadowMapsPerLight, 0.0);
+        }
+    }
+
     LightDataList& pll = vdd->getLightDataList();
     for(LightDataList::iterator itr = pll.begin();
         itr != pll.end();
@@ -1332,6 +1469,8 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
 #endif
 
         // 4. For each light/shadow map
+        std::vector<ShadowMapCull> shadowMapCulls;
+        shadowMapCulls.reserve(numShadowMapsPerLight);
         for (unsigned int sm_i=0; sm_i<numShadowMapsPerLight; ++sm_i)
         {
             osg::ref_ptr<ShadowData> sd;
@@ -1489,15 +1628,77 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
             osg::ref_ptr<VDSMCameraCullCallback> vdsmCallback = new VDSMCameraCullCallback(this, local_polytope);
             camera->setCullCallback(vdsmCallback.get());
 
-            // 4.3 traverse RTT camera
-            //
+            shadowMapCulls.push_back({ sd, vdsmCallback, cascaseNear, cascadeFar, 0.0 });
+        }
+
+        // 4.3 traverse RTT cameras
+        //
+        // The light space bounds above are shared by all the shadow maps of the light, so only the caster culling
+        // differs between them. When enabled, the shadow maps after the first are culled on worker threads,
+        // each with its own cull visitor, while this thread culls the first one.
+        std::vector<ViewDependentData::CasterCullVisitor>& casterCullVisitors = vdd->_casterCullVisitors[cv.getTraversalNumber() % 2];
+        std::vector<osg::ref_ptr<CullShadowCastingSceneWorkItem>> workItems;
+        std::vector<unsigned int> numCasterStateSets;
+        if (_casterCullWorkQueue && shadowMapCulls.size() > 1)
+        {
+            // created on first use by the camera cull callbacks, so make sure that doesn't happen on several threads at once
+            getOrCreateShadowsBinStateSet();
+
+            if (casterCullVisitors.size() < shadowMapCulls.size() - 1)
+                casterCullVisitors.resize(shadowMapCulls.size() - 1);
+
+            for (unsigned int sm_i=1; sm_i<shadowMapCulls.size(); ++sm_i)
+            {
+                ViewDependentData::CasterCullVisitor& caster = casterCullVisitors[sm_i - 1];
+                numCasterStateSets.push_back(beginCasterCull(cv, caster, _shadowCastingStateSet.get()));
+
+                osg::ref_ptr<CullShadowCastingSceneWorkItem> workItem = new CullShadowCastingSceneWorkItem(this, caster._cullVisitor.get(), shadowMapCulls[sm_i]._shadowData->_camera.get());
+                _casterCullWorkQueue->addWorkItem(workItem);
+                workItems.push_back(workItem);
+            }
+        }
+
+        const osg::Timer* timer = osg::Timer::instance();
+        for (unsigned int sm_i=0; sm_i<shadowMapCulls.size() - workItems.size(); ++sm_i)
+        {
+            osg::Timer_t start = timer->tick();
 
             cv.pushStateSet(_shadowCastingStateSet.get());
 
-            cullShadowCastingScene(&cv, camera.get());
+            cullShadowCastingScene(&cv, shadowMapCulls[sm_i]._shadowData->_camera.get());
 
             cv.popStateSet();
 
+            shadowMapCulls[sm_i]._cullTime = timer->delta_s(start, timer->tick());
+        }
+
+        for (unsigned int i=0; i<workItems.size(); ++i)
+        {
+            workItems[i]->waitTillDone();
+            endCasterCull(casterCullVisitors[i], numCasterStateSets[i]);
+
+            ShadowMapCull& shadowMapCull = shadowMapCulls[i + 1];
+            shadowMapCull._cullTime = workItems[i]->getCullTime();
+
+            // the worker attached the shadow map's render stage to its own placeholder stage rather than ours
+            if (shadowMapCull._vdsmCallback->getRenderStage())
+                cv.getCurrentRenderBin()->getStage()->addPreRenderStage(shadowMapCull._vdsmCallback->getRenderStage(), shadowMapCull._shadowData->_camera->getRenderOrderNum());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_shadowMapCullTimesMutex);
+            for (unsigned int sm_i=0; sm_i<shadowMapCulls.size() && sm_i<_shadowMapCullTimes.size(); ++sm_i)
+                _shadowMapCullTimes[sm_i] += shadowMapCulls[sm_i]._cullTime;
+        }
+
+        for (unsigned int sm_i=0; sm_i<shadowMapCulls.size(); ++sm_i)
+        {
+            osg::ref_ptr<ShadowData> sd = shadowMapCulls[sm_i]._shadowData;
+            osg::ref_ptr<osg::Camera> camera = sd->_camera;
+            VDSMCameraCullCallback* vdsmCallback = shadowMapCulls[sm_i]._vdsmCallback.get();
+            double cascaseNear = shadowMapCulls[sm_i]._cascadeNear;
+            double cascadeFar = shadowMapCulls[sm_i]._cascadeFar;
+
             if (!orthographicViewFrustum && settings->getShadowMapProjectionHint()==ShadowSettings::PERSPECTIVE_SHADOW_MAP)
             {
                 {
@@ -1766,6 +1967,8 @@ void MWShadowTechnique::createShaders()
     _shadowCastingStateSet->setTextureAttribute(0, _fallbackBaseTexture.get(), osg::StateAttribute::ON);
     _shadowCastingStateSet->addUniform(new osg::Uniform("useDiffuseMapForShadowAlpha", true));
     _shadowCastingStateSet->addUniform(new osg::Uniform("alphaTestShadows", false));
+    _shadowCastingStateSet->addUniform(new osg::Uniform("useInstancing", false));
+    _shadowCastingStateSet->addUniform(new osg::Uniform("useSkinning", false));
     osg::ref_ptr<osg::Depth> depth = new osg::Depth;
     depth->setWriteMask(true);
     osg::ref_ptr<osg::ClipControl> clipcontrol = new osg::ClipControl(osg::ClipControl::LOWER_LEFT, osg::ClipControl::NEGATIVE_ONE_TO_ONE);
@@ -23,6 +23,7 @@
 #include <array>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <osg/Camera>
 #include <osg/Material>
@@ -33,6 +34,7 @@
 #include <osgShadow/ShadowTechnique>
 
 #include <components/shader/shadermanager.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 namespace SceneUtil {
 
@@ -88,6 +90,12 @@ namespace SceneUtil {
 
         virtual void setupCastingShader(Shader::ShaderManager &shaderManager);
 
+        /** Cull the shadow casters of each shadow map after the first on a pool of worker threads.*/
+        virtual void setParallelCasterCulling(bool enable);
+
+        /** Get the time in seconds spent culling the shadow casters of each shadow map during the last complete frame.*/
+        std::vector<double> getShadowMapCullTimes() const;
+
         class ComputeLightSpaceBounds : public osg::NodeVisitor, public osg::CullStack
         {
         public:
@@ -218,6 +226,13 @@ namespace SceneUtil {
 
             void setNumValidShadows(unsigned int numValidShadows) { _numValidShadows = numValidShadows; }
 
+            struct CasterCullVisitor
+            {
+                osg::ref_ptr<osgUtil::CullVisitor>  _cullVisitor;
+                osg::ref_ptr<osgUtil::StateGraph>   _stateGraph;
+                osg::ref_ptr<osgUtil::RenderStage>  _renderStage;
+            };
+
         protected:
             friend class MWShadowTechnique;
             virtual ~ViewDependentData() {}
@@ -229,6 +244,9 @@ namespace SceneUtil {
             LightDataList               _lightDataList;
             ShadowDataList              _shadowDataList;
 
+            // the render leaves these produce are drawn in the following frame, so they are double buffered like _stateset
+            std::array<std::vector<CasterCullVisitor>, 2> _casterCullVisitors;
+
             unsigned int _numValidShadows;
         };
 
@@ -299,6 +317,13 @@ namespace SceneUtil {
 
         unsigned int                            _worldMask = ~0u;
 
+        osg::ref_ptr<WorkQueue>                 _casterCullWorkQueue;
+
+        mutable std::mutex                      _shadowMapCullTimesMutex;
+        unsigned int                            _shadowMapCullTimesFrame = 0;
+        std::vector<double>                     _shadowMapCullTimes;
+        std::vector<double>                     _lastShadowMapCullTimes;
+
         class DebugHUD final : public osg::Referenced
         {
         public:
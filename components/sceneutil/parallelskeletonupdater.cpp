@@ -0,0 +1,117 @@
+#include "parallelskeletonupdater.hpp"
+
+#include "skeleton.hpp"
+#include "workqueue.hpp"
+
+#include <osg/FrameStamp>
+#include <osg/Stats>
+#include <osgUtil/UpdateVisitor>
+
+#include <algorithm>
+#include <chrono>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        double toSeconds(std::chrono::steady_clock::duration value)
+        {
+            return std::chrono::duration<double>(value).count();
+        }
+
+        /// Appends the nodes between root and skeleton, excluding root, as long as the update traversal of root would
+        /// reach the skeleton exactly once and not as part of another skeleton.
+        bool appendPath(Skeleton& skeleton, const osg::Node& root, const osg::NodeVisitor& nv, osg::NodePath& path)
+        {
+            const std::size_t begin = path.size();
+            osg::Node* node = &skeleton;
+            while (node != &root)
+            {
+                if (!nv.validNodeMask(*node) || node->getNumParents() != 1
+                    || (node != &skeleton && dynamic_cast<Skeleton*>(node) != nullptr))
+                {
+                    path.resize(begin);
+                    return false;
+                }
+                path.push_back(node);
+                node = node->getParent(0);
+            }
+            std::reverse(path.begin() + begin, path.end());
+            return true;
+        }
+    }
+
+    ParallelSkeletonUpdater::ParallelSkeletonUpdater(WorkQueue* workQueue)
+        : mWorkQueue(workQueue)
+    {
+    }
+
+    void ParallelSkeletonUpdater::setSkeletons(std::vector<osg::ref_ptr<Skeleton>>&& skeletons)
+    {
+        mSkeletons = std::move(skeletons);
+    }
+
+    void ParallelSkeletonUpdater::operator()(osg::Node* node, osg::NodeVisitor* nv)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const unsigned int traversalNumber = nv->getTraversalNumber();
+
+        mUpdating.clear();
+        mPathOffsets.clear();
+        mPaths.clear();
+
+        for (const osg::ref_ptr<Skeleton>& skeleton : mSkeletons)
+        {
+            if (!skeleton->needsUpdate(traversalNumber))
+                continue;
+            const std::size_t offset = mPaths.size();
+            if (!appendPath(*skeleton, *node, *nv, mPaths))
+                continue;
+            mUpdating.push_back(skeleton.get());
+            mPathOffsets.push_back(offset);
+        }
+        mPathOffsets.push_back(mPaths.size());
+
+        // Stops the propagation of bounds dirtied by the traversal of a skeleton at the skeleton itself
+        for (Skeleton* skeleton : mUpdating)
+            skeleton->dirtyBound();
+
+        osg::ref_ptr<osg::FrameStamp> frameStamp;
+        if (nv->getFrameStamp() != nullptr)
+            frameStamp = new osg::FrameStamp(*nv->getFrameStamp());
+        const osg::NodePath& rootPath = nv->getNodePath();
+
+        const auto prepared = std::chrono::steady_clock::now();
+
+        runTasks(mWorkQueue.get(), mUpdating.size(), [&](std::size_t index) {
+            osg::ref_ptr<osgUtil::UpdateVisitor> visitor = new osgUtil::UpdateVisitor;
+            visitor->setFrameStamp(frameStamp);
+            visitor->setTraversalNumber(traversalNumber);
+            visitor->setTraversalMask(nv->getTraversalMask());
+            visitor->setNodeMaskOverride(nv->getNodeMaskOverride());
+            for (osg::Node* pathNode : rootPath)
+                visitor->pushOntoNodePath(pathNode);
+            for (std::size_t i = mPathOffsets[index]; i < mPathOffsets[index + 1]; ++i)
+                visitor->pushOntoNodePath(mPaths[i]);
+            mUpdating[index]->updateInAdvance(*visitor);
+        });
+
+        const auto updated = std::chrono::steady_clock::now();
+
+        mNumUpdated = mUpdating.size();
+        mPrepareTime = toSeconds(prepared - start);
+        mUpdateTime = toSeconds(updated - prepared);
+
+        // Only used for one frame, the caller provides a new set for every frame
+        mSkeletons.clear();
+
+        traverse(node, nv);
+    }
+
+    void ParallelSkeletonUpdater::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        stats.setAttribute(frameNumber, "Animation Actors", mNumUpdated);
+        stats.setAttribute(frameNumber, "Animation Prepare Time", mPrepareTime * 1000000.0);
+        stats.setAttribute(frameNumber, "Animation Update Time", mUpdateTime * 1000000.0);
+    }
+}
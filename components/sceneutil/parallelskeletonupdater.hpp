@@ -0,0 +1,50 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_PARALLELSKELETONUPDATER_H
+#define OPENMW_COMPONENTS_SCENEUTIL_PARALLELSKELETONUPDATER_H
+
+#include "nodecallback.hpp"
+
+#include <osg/ref_ptr>
+
+#include <cstddef>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace SceneUtil
+{
+    class Skeleton;
+    class WorkQueue;
+
+    /// @brief Update callback for a root of the scene graph running the update traversal of a set of skeletons, i.e.
+    /// the sampling of their animations and the update of their bone matrices, on a work queue before the rest of the
+    /// scene graph. The regular update traversal then skips these skeletons.
+    /// @note Bounds above the skeletons are dirtied on the calling thread first, so the traversal of a skeleton only
+    /// writes to its own subgraph. Skeletons the regular update traversal would not reach are left to it.
+    class ParallelSkeletonUpdater : public SceneUtil::NodeCallback<ParallelSkeletonUpdater>
+    {
+    public:
+        explicit ParallelSkeletonUpdater(WorkQueue* workQueue);
+
+        /// Set the skeletons to update in the next update traversal.
+        void setSkeletons(std::vector<osg::ref_ptr<Skeleton>>&& skeletons);
+
+        void operator()(osg::Node* node, osg::NodeVisitor* nv);
+
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
+    private:
+        osg::ref_ptr<WorkQueue> mWorkQueue;
+        std::vector<osg::ref_ptr<Skeleton>> mSkeletons;
+        std::vector<Skeleton*> mUpdating;
+        std::vector<std::size_t> mPathOffsets;
+        std::vector<osg::Node*> mPaths;
+        std::size_t mNumUpdated = 0;
+        double mPrepareTime = 0;
+        double mUpdateTime = 0;
+    };
+}
+
+#endif
@@ -1,8 +1,13 @@
 #include "riggeometry.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <unordered_map>
 
+#include <osg/GLExtensions>
 #include <osg/MatrixTransform>
+#include <osg/Stats>
 
 #include <osgUtil/CullVisitor>
 
@@ -10,10 +15,70 @@
 #include <components/resource/scenemanager.hpp>
 
 #include "skeleton.hpp"
+#include "skinning.hpp"
 #include "util.hpp"
 
 namespace SceneUtil
 {
+    namespace
+    {
+        // Accumulated over all RigGeometries and cull threads until reported
+        struct SkinningStats
+        {
+            std::atomic<std::uint64_t> mCpuMeshes{ 0 };
+            std::atomic<std::uint64_t> mGpuMeshes{ 0 };
+            std::atomic<std::uint64_t> mCpuTime{ 0 };
+            std::atomic<std::uint64_t> mGpuTime{ 0 };
+            std::atomic<std::uint64_t> mUploadBytes{ 0 };
+            std::atomic<std::uint64_t> mUploadBytesSaved{ 0 };
+        };
+
+        SkinningStats sSkinningStats;
+
+        void addTime(std::atomic<std::uint64_t>& total, std::chrono::steady_clock::time_point start)
+        {
+            const auto duration
+                = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            total.fetch_add(static_cast<std::uint64_t>(duration.count()), std::memory_order_relaxed);
+        }
+
+        std::size_t getSkinnedVertexSize(const osg::Geometry& geom)
+        {
+            std::size_t result = sizeof(osg::Vec3f);
+            if (geom.getNormalArray() != nullptr)
+                result += sizeof(osg::Vec3f);
+            if (geom.getTexCoordArray(7) != nullptr)
+                result += sizeof(osg::Vec4f);
+            return result;
+        }
+
+        bool isGpuSkinningSupported(osg::State* state)
+        {
+            const osg::GLExtensions* extensions = state != nullptr ? state->get<osg::GLExtensions>() : nullptr;
+            // Without any graphics context, e.g. in tools that only cull the scene, trust the requested mode
+            if (extensions == nullptr)
+                return true;
+            return extensions->isGlslSupported && extensions->glslLanguageVersion >= 1.2f;
+        }
+
+        // DO NOT COPY AND PASTE THIS CODE. Cloning osg::Geometry without also cloning its contained Arrays is generally
+        // unsafe. In this specific case the operation is safe under the following two assumptions:
+        // - When Arrays are removed or replaced in the cloned geometry, the original Arrays in their place must outlive
+        // the cloned geometry regardless. (ensured by the TemplateRef)
+        // - Arrays that we add or replace in the cloned geometry must be explicitely forbidden from reusing
+        // BufferObjects of the original geometry. (ensured by the callers)
+        osg::ref_ptr<osg::Geometry> copySourceGeometry(const osg::ref_ptr<osg::Geometry>& sourceGeometry)
+        {
+            osg::ref_ptr<osg::Geometry> result = new osg::Geometry(*sourceGeometry, osg::CopyOp::SHALLOW_COPY);
+            result->getOrCreateUserDataContainer()->addUserObject(new Resource::TemplateRef(sourceGeometry));
+            result->setSupportsDisplayList(false);
+            result->setUseVertexBufferObjects(true);
+            result->setCullingActive(false); // make sure to disable culling since that's handled by RigGeometry
+            result->setComputeBoundingBoxCallback(new RigGeometry::CopyBoundingBoxCallback());
+            result->setComputeBoundingSphereCallback(new RigGeometry::CopyBoundingSphereCallback());
+            return result;
+        }
+    }
 
     RigGeometry::RigGeometry()
     {
@@ -23,6 +88,7 @@ namespace SceneUtil
 
     RigGeometry::RigGeometry(const RigGeometry& copy, const osg::CopyOp& copyop)
         : Drawable(copy, copyop)
+        , mGpuSkinning(copy.mGpuSkinning)
         , mData(copy.mData)
     {
         setSourceGeometry(copy.mSourceGeometry);
@@ -32,7 +98,11 @@ namespace SceneUtil
     void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
     {
         for (unsigned int i = 0; i < 2; ++i)
+        {
             mGeometry[i] = nullptr;
+            mGpuGeometry[i] = nullptr;
+            mBonePalette[i] = nullptr;
+        }
 
         mSourceGeometry = sourceGeometry;
 
@@ -40,21 +110,8 @@ namespace SceneUtil
         {
             const osg::Geometry& from = *sourceGeometry;
 
-            // DO NOT COPY AND PASTE THIS CODE. Cloning osg::Geometry without also cloning its contained Arrays is
-            // generally unsafe. In this specific case the operation is safe under the following two assumptions:
-            // - When Arrays are removed or replaced in the cloned geometry, the original Arrays in their place must
-            // outlive the cloned geometry regardless. (ensured by mSourceGeometry)
-            // - Arrays that we add or replace in the cloned geometry must be explicitely forbidden from reusing
-            // BufferObjects of the original geometry. (ensured by vbo below)
-            mGeometry[i] = new osg::Geometry(from, osg::CopyOp::SHALLOW_COPY);
-            mGeometry[i]->getOrCreateUserDataContainer()->addUserObject(new Resource::TemplateRef(mSourceGeometry));
-
+            mGeometry[i] = copySourceGeometry(mSourceGeometry);
             osg::Geometry& to = *mGeometry[i];
-            to.setSupportsDisplayList(false);
-            to.setUseVertexBufferObjects(true);
-            to.setCullingActive(false); // make sure to disable culling since that's handled by this class
-            to.setComputeBoundingBoxCallback(new CopyBoundingBoxCallback());
-            to.setComputeBoundingSphereCallback(new CopyBoundingSphereCallback());
 
             // vertices and normals are modified every frame, so we need to deep copy them.
             // assign a dedicated VBO to make sure that modifications don't interfere with source geometry's VBO.
@@ -138,6 +195,8 @@ namespace SceneUtil
 
     void RigGeometry::cull(osg::NodeVisitor* nv)
     {
+        std::lock_guard<std::mutex> lock(mMutex);
+
         if (!mSkeleton)
         {
             Log(Debug::Error)
@@ -147,34 +206,49 @@ namespace SceneUtil
                 return;
         }
 
-        unsigned int traversalNumber = nv->getTraversalNumber();
-        if (mLastFrameNumber == traversalNumber || (mLastFrameNumber != 0 && !mSkeleton->getActive()))
+        // Several views may be culled with different graphics contexts, each of them is skinned where it can be
+        bool gpuSkinning = mGpuSkinning && isGpuSkinningSupported(static_cast<osgUtil::CullVisitor*>(nv)->getState());
+        if (gpuSkinning && mGpuGeometry[0] == nullptr)
+            gpuSkinning = createGpuGeometries();
+
+        unsigned int& lastFrameNumber = gpuSkinning ? mLastGpuFrameNumber : mLastFrameNumber;
+        const unsigned int traversalNumber = nv->getTraversalNumber();
+        if (lastFrameNumber != traversalNumber && (lastFrameNumber == 0 || mSkeleton->getActive()))
         {
-            osg::Geometry& geom = *getGeometry(mLastFrameNumber);
-            nv->pushOntoNodePath(&geom);
-            nv->apply(geom);
-            nv->popFromNodePath();
-            return;
-        }
-        mLastFrameNumber = traversalNumber;
-        osg::Geometry& geom = *getGeometry(mLastFrameNumber);
+            lastFrameNumber = traversalNumber;
 
-        mSkeleton->updateBoneMatrices(traversalNumber);
+            mSkeleton->updateBoneMatrices(traversalNumber);
 
-        // skinning
-        const osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
-        const osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
-        const osg::Vec4Array* tangentSrc = mSourceTangents;
+            const auto start = std::chrono::steady_clock::now();
+            if (gpuSkinning)
+            {
+                updateBonePalette(*mBonePalette[traversalNumber % 2]);
+                addTime(sSkinningStats.mGpuTime, start);
+                sSkinningStats.mGpuMeshes.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                updateCpuGeometry(*getGeometry(traversalNumber));
+                addTime(sSkinningStats.mCpuTime, start);
+                sSkinningStats.mCpuMeshes.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
 
-        osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
-        osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(geom.getNormalArray());
-        osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(geom.getTexCoordArray(7));
+        osg::Geometry& geom = gpuSkinning ? *mGpuGeometry[lastFrameNumber % 2] : *getGeometry(lastFrameNumber);
+        nv->pushOntoNodePath(&geom);
+        nv->apply(geom);
+        nv->popFromNodePath();
+    }
 
-        for (const auto& [influences, vertices] : mData->mInfluences)
+    void RigGeometry::updateCpuGeometry(osg::Geometry& geom)
+    {
+        mInfluenceMatrices.resize(mData->mInfluences.size());
+        for (std::size_t group = 0; group < mData->mInfluences.size(); ++group)
         {
-            osg::Matrixf resultMat(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
+            osg::Matrixf& resultMat = mInfluenceMatrices[group];
+            resultMat.set(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
 
-            for (const auto& [index, weight] : influences)
+            for (const auto& [index, weight] : mData->mInfluences[group].first)
             {
                 const Bone* bone = mNodes[index];
                 if (bone == nullptr)
@@ -190,22 +264,16 @@ namespace SceneUtil
 
             if (mGeomToSkelMatrix)
                 resultMat *= (*mGeomToSkelMatrix);
+        }
 
-            for (unsigned short vertex : vertices)
-            {
-                (*positionDst)[vertex] = resultMat.preMult((*positionSrc)[vertex]);
-                if (normalDst)
-                    (*normalDst)[vertex] = osg::Matrixf::transform3x3((*normalSrc)[vertex], resultMat);
+        const std::shared_ptr<const SkinningLayout> layout = mData->getLayout(*mSourceGeometry, mSourceTangents);
 
-                if (tangentDst)
-                {
-                    const osg::Vec4f& srcTangent = (*tangentSrc)[vertex];
-                    osg::Vec3f transformedTangent = osg::Matrixf::transform3x3(
-                        osg::Vec3f(srcTangent.x(), srcTangent.y(), srcTangent.z()), resultMat);
-                    (*tangentDst)[vertex] = osg::Vec4f(transformedTangent, srcTangent.w());
-                }
-            }
-        }
+        osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
+        osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(geom.getNormalArray());
+        osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(geom.getTexCoordArray(7));
+
+        skinVertices(*layout, mInfluenceMatrices, positionDst->asVector().data(),
+            normalDst ? normalDst->asVector().data() : nullptr, tangentDst ? tangentDst->asVector().data() : nullptr);
 
         positionDst->dirty();
         if (normalDst)
@@ -215,9 +283,68 @@ namespace SceneUtil
 
         geom.osg::Drawable::dirtyGLObjects();
 
-        nv->pushOntoNodePath(&geom);
-        nv->apply(geom);
-        nv->popFromNodePath();
+        sSkinningStats.mUploadBytes.fetch_add(
+            positionDst->getNumElements() * getSkinnedVertexSize(geom), std::memory_order_relaxed);
+    }
+
+    void RigGeometry::updateBonePalette(osg::Uniform& palette)
+    {
+        for (std::size_t index = 0; index < mData->mBones.size(); ++index)
+        {
+            // Missing bones contribute nothing, like on the CPU
+            osg::Matrixf matrix(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            if (const Bone* bone = mNodes[index])
+            {
+                matrix = mData->mBones[index].mInvBindMatrix * bone->mMatrixInSkeletonSpace;
+                if (mGeomToSkelMatrix)
+                    matrix *= (*mGeomToSkelMatrix);
+            }
+
+            // The vertex shader transforms with dot products with the first three columns
+            for (unsigned int column = 0; column < 3; ++column)
+                palette.setElement(static_cast<unsigned int>(index * 3 + column),
+                    osg::Vec4f(matrix(0, column), matrix(1, column), matrix(2, column), matrix(3, column)));
+        }
+
+        sSkinningStats.mUploadBytes.fetch_add(
+            mData->mBones.size() * 3 * sizeof(osg::Vec4f), std::memory_order_relaxed);
+        sSkinningStats.mUploadBytesSaved.fetch_add(
+            mSourceGeometry->getVertexArray()->getNumElements() * getSkinnedVertexSize(*mSourceGeometry),
+            std::memory_order_relaxed);
+    }
+
+    bool RigGeometry::createGpuGeometries()
+    {
+        const InfluenceData::GpuInfluences influences
+            = mData->getGpuInfluences(mSourceGeometry->getVertexArray()->getNumElements());
+        if (influences.mBoneIndices == nullptr)
+            return false;
+
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            mGpuGeometry[i] = copySourceGeometry(mSourceGeometry);
+            osg::Geometry& geom = *mGpuGeometry[i];
+            // The bone attributes have a VBO of their own, see getGpuInfluences
+            geom.setVertexAttribArray(sBoneIndicesAttribute, influences.mBoneIndices, osg::Array::BIND_PER_VERTEX);
+            geom.setVertexAttribArray(sBoneWeightsAttribute, influences.mBoneWeights, osg::Array::BIND_PER_VERTEX);
+
+            static_cast<CopyBoundingBoxCallback*>(geom.getComputeBoundingBoxCallback())->boundingBox = _boundingBox;
+            static_cast<CopyBoundingSphereCallback*>(geom.getComputeBoundingSphereCallback())->boundingSphere
+                = _boundingSphere;
+
+            // Double buffered like the geometries skinned on the CPU as the draw thread may still read the other one
+            mBonePalette[i] = new osg::Uniform(osg::Uniform::FLOAT_VEC4, "boneMatrices",
+                static_cast<int>(mData->mBones.size() * 3));
+            // The state set may be shared with the source geometry
+            osg::ref_ptr<osg::StateSet> stateSet = geom.getStateSet() != nullptr
+                ? new osg::StateSet(*geom.getStateSet(), osg::CopyOp::SHALLOW_COPY)
+                : new osg::StateSet;
+            stateSet->addUniform(mBonePalette[i]);
+            stateSet->addUniform(new osg::Uniform("useSkinning", true));
+            geom.setStateSet(stateSet);
+        }
+
+        return true;
     }
 
     void RigGeometry::updateBounds(osg::NodeVisitor* nv)
@@ -261,13 +388,16 @@ namespace SceneUtil
             for (unsigned int i = 0; i < getNumParents(); ++i)
                 getParent(i)->dirtyBound();
 
-            for (unsigned int i = 0; i < 2; ++i)
+            for (const osg::ref_ptr<osg::Geometry>& geom :
+                { mGeometry[0], mGeometry[1], mGpuGeometry[0], mGpuGeometry[1] })
             {
-                osg::Geometry& geom = *mGeometry[i];
-                static_cast<CopyBoundingBoxCallback*>(geom.getComputeBoundingBoxCallback())->boundingBox = _boundingBox;
-                static_cast<CopyBoundingSphereCallback*>(geom.getComputeBoundingSphereCallback())->boundingSphere
+                if (geom == nullptr)
+                    continue;
+                static_cast<CopyBoundingBoxCallback*>(geom->getComputeBoundingBoxCallback())->boundingBox
+                    = _boundingBox;
+                static_cast<CopyBoundingSphereCallback*>(geom->getComputeBoundingSphereCallback())->boundingSphere
                     = _boundingSphere;
-                geom.dirtyBound();
+                geom->dirtyBound();
             }
         }
     }
@@ -329,6 +459,8 @@ namespace SceneUtil
 
         mData->mInfluences.reserve(influencesToVertices.size());
         mData->mInfluences.assign(influencesToVertices.begin(), influencesToVertices.end());
+        mData->mLayout = nullptr;
+        mData->mGpuInfluences.reset();
     }
 
     void RigGeometry::setInfluences(const std::vector<BoneWeights>& influences)
@@ -342,6 +474,77 @@ namespace SceneUtil
 
         mData->mInfluences.reserve(influencesToVertices.size());
         mData->mInfluences.assign(influencesToVertices.begin(), influencesToVertices.end());
+        mData->mLayout = nullptr;
+        mData->mGpuInfluences.reset();
+    }
+
+    std::shared_ptr<const SkinningLayout> RigGeometry::InfluenceData::getLayout(
+        const osg::Geometry& sourceGeometry, const osg::Vec4Array* sourceTangents)
+    {
+        std::lock_guard<std::mutex> lock(mLayoutMutex);
+        if (mLayout != nullptr && mLayoutSourceGeometry == &sourceGeometry)
+            return mLayout;
+
+        const osg::Vec3Array* positions = static_cast<const osg::Vec3Array*>(sourceGeometry.getVertexArray());
+        const osg::Vec3Array* normals = static_cast<const osg::Vec3Array*>(sourceGeometry.getNormalArray());
+
+        auto layout = std::make_shared<SkinningLayout>();
+        for (const auto& [weights, vertices] : mInfluences)
+            layout->addGroup(vertices, positions->asVector().data(), normals ? normals->asVector().data() : nullptr,
+                sourceTangents ? sourceTangents->asVector().data() : nullptr);
+
+        mLayout = std::move(layout);
+        mLayoutSourceGeometry = &sourceGeometry;
+        return mLayout;
+    }
+
+    RigGeometry::InfluenceData::GpuInfluences RigGeometry::InfluenceData::getGpuInfluences(std::size_t numVertices)
+    {
+        std::lock_guard<std::mutex> lock(mLayoutMutex);
+        if (mGpuInfluences.has_value() && mGpuInfluencesVertices == numVertices)
+            return *mGpuInfluences;
+
+        mGpuInfluences = GpuInfluences();
+        mGpuInfluencesVertices = numVertices;
+
+        if (mBones.size() > maxGpuSkinningBones)
+            return *mGpuInfluences;
+
+        std::optional<GpuSkinningInfluences> influences = makeGpuSkinningInfluences(numVertices, mInfluences);
+        if (!influences.has_value())
+            return *mGpuInfluences;
+
+        // Shared by all copies of the geometry, so they must not end up in the VBO of any of them
+        osg::ref_ptr<osg::VertexBufferObject> vbo = new osg::VertexBufferObject;
+        mGpuInfluences->mBoneIndices
+            = new osg::Vec4Array(influences->mBoneIndices.begin(), influences->mBoneIndices.end());
+        mGpuInfluences->mBoneIndices->setVertexBufferObject(vbo);
+        mGpuInfluences->mBoneWeights
+            = new osg::Vec4Array(influences->mBoneWeights.begin(), influences->mBoneWeights.end());
+        mGpuInfluences->mBoneWeights->setVertexBufferObject(vbo);
+
+        return *mGpuInfluences;
+    }
+
+    bool RigGeometry::supportsGpuSkinning() const
+    {
+        if (!mData || !mSourceGeometry || !mSourceGeometry->getVertexArray())
+            return false;
+        return mData->getGpuInfluences(mSourceGeometry->getVertexArray()->getNumElements()).mBoneIndices != nullptr;
+    }
+
+    void RigGeometry::reportStats(unsigned int frameNumber, osg::Stats& stats)
+    {
+        const auto exchange = [](std::atomic<std::uint64_t>& value) {
+            return static_cast<double>(value.exchange(0, std::memory_order_relaxed));
+        };
+
+        stats.setAttribute(frameNumber, "Skinning CPU Meshes", exchange(sSkinningStats.mCpuMeshes));
+        stats.setAttribute(frameNumber, "Skinning GPU Meshes", exchange(sSkinningStats.mGpuMeshes));
+        stats.setAttribute(frameNumber, "Skinning CPU Time", exchange(sSkinningStats.mCpuTime) / 1000.0);
+        stats.setAttribute(frameNumber, "Skinning GPU Time", exchange(sSkinningStats.mGpuTime) / 1000.0);
+        stats.setAttribute(frameNumber, "Skinning Upload", exchange(sSkinningStats.mUploadBytes));
+        stats.setAttribute(frameNumber, "Skinning Upload Saved", exchange(sSkinningStats.mUploadBytesSaved));
     }
 
     void RigGeometry::accept(osg::NodeVisitor& nv)
@@ -4,10 +4,21 @@
 #include <osg/Geometry>
 #include <osg/Matrixf>
 
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
+
 namespace SceneUtil
 {
     class Skeleton;
     class Bone;
+    struct SkinningLayout;
 
     // TODO: This class has a lot of issues.
     // - We require too many workarounds to ensure safety.
@@ -60,6 +71,22 @@ namespace SceneUtil
 
         osg::ref_ptr<osg::Geometry> getSourceGeometry() const;
 
+        /// @return true if the influences of this geometry fit the vertex attributes and the bone palette of the
+        /// vertex shader.
+        bool supportsGpuSkinning() const;
+
+        /// Skin in the vertex shader instead of on the CPU. Only takes effect for osg::States supporting it, the
+        /// others keep skinning on the CPU. Set by the ShaderVisitor along with the shader doing the skinning.
+        void setGpuSkinning(bool enabled) { mGpuSkinning = enabled; }
+        bool getGpuSkinning() const { return mGpuSkinning; }
+
+        /// Vertex attribute locations of the bone indices and weights read by the vertex shader.
+        static constexpr unsigned int sBoneIndicesAttribute = 4;
+        static constexpr unsigned int sBoneWeightsAttribute = 5;
+
+        /// Report the skinning done by all RigGeometries since the previous report.
+        static void reportStats(unsigned int frameNumber, osg::Stats& stats);
+
         void accept(osg::NodeVisitor& nv) override;
         bool supports(const osg::PrimitiveFunctor&) const override { return true; }
         void accept(osg::PrimitiveFunctor&) const override;
@@ -82,9 +109,18 @@ namespace SceneUtil
         void cull(osg::NodeVisitor* nv);
         void updateBounds(osg::NodeVisitor* nv);
 
+        void updateCpuGeometry(osg::Geometry& geom);
+        void updateBonePalette(osg::Uniform& palette);
+        bool createGpuGeometries();
+
         osg::ref_ptr<osg::Geometry> mGeometry[2];
         osg::Geometry* getGeometry(unsigned int frame) const;
 
+        // Share the source vertices and only get a new bone palette every frame
+        osg::ref_ptr<osg::Geometry> mGpuGeometry[2];
+        osg::ref_ptr<osg::Uniform> mBonePalette[2];
+        bool mGpuSkinning{ false };
+
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
         osg::ref_ptr<const osg::Vec4Array> mSourceTangents;
         Skeleton* mSkeleton{ nullptr };
@@ -96,13 +132,38 @@ namespace SceneUtil
         {
             std::vector<BoneInfo> mBones;
             std::vector<std::pair<BoneWeights, VertexList>> mInfluences;
+
+            // Source vertices of mInfluences in the layout used for skinning, shared by all copies of the geometry
+            std::mutex mLayoutMutex;
+            std::shared_ptr<const SkinningLayout> mLayout;
+            osg::ref_ptr<const osg::Geometry> mLayoutSourceGeometry;
+
+            std::shared_ptr<const SkinningLayout> getLayout(
+                const osg::Geometry& sourceGeometry, const osg::Vec4Array* sourceTangents);
+
+            // Vertex attributes for skinning on the GPU, null if the influences do not fit
+            struct GpuInfluences
+            {
+                osg::ref_ptr<osg::Vec4Array> mBoneIndices;
+                osg::ref_ptr<osg::Vec4Array> mBoneWeights;
+            };
+            std::optional<GpuInfluences> mGpuInfluences;
+            std::size_t mGpuInfluencesVertices{ 0 };
+
+            GpuInfluences getGpuInfluences(std::size_t numVertices);
         };
         osg::ref_ptr<InfluenceData> mData;
         std::vector<Bone*> mNodes;
+        // Skinning matrix of every element of mData->mInfluences
+        std::vector<osg::Matrixf> mInfluenceMatrices;
 
         unsigned int mLastFrameNumber{ 0 };
+        unsigned int mLastGpuFrameNumber{ 0 };
         bool mBoundsFirstFrame{ true };
 
+        // Shadow casters may be culled on several threads at once
+        std::mutex mMutex;
+
         bool initFromParentSkeleton(osg::NodeVisitor* nv);
 
         void updateGeomToSkelMatrix(const osg::NodePath& nodePath);
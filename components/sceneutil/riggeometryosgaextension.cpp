@@ -245,6 +245,7 @@ namespace SceneUtil
             if (stateset)
                 cv->pushStateSet(stateset);
 
+            std::lock_guard<std::mutex> lock(mMutex);
             unsigned int traversalNumber = nv.getTraversalNumber();
             if (mLastFrameNumber == traversalNumber)
             {
@@ -2,6 +2,7 @@
 #define OPENMW_COMPONENTS_OSGAEXTENSION_RIGGEOMETRY_H
 
 #include <array>
+#include <mutex>
 
 #include <osg/Drawable>
 #include <osgAnimation/RigGeometry>
@@ -62,6 +63,7 @@ namespace SceneUtil
 
         unsigned int mLastFrameNumber;
         bool mIsBodyPart;
+        std::mutex mMutex;
 
         void updateBackToOriginTransform(OsgaRigGeometry* geometry);
 
@@ -115,6 +115,29 @@ namespace SceneUtil
         }
     };
 
+    static bool checkMatrixTransformComponents(const NifOsg::MatrixTransform&)
+    {
+        return true;
+    }
+
+    // The scale and rotation are kept separately from the matrix for controllers, see NifOsg::MatrixTransform
+    static bool writeMatrixTransformComponents(osgDB::OutputStream& os, const NifOsg::MatrixTransform& transform)
+    {
+        os << transform.mScale;
+        for (const auto& row : transform.mRotationScale.mValues)
+            os << row[0] << row[1] << row[2];
+        os << std::endl;
+        return true;
+    }
+
+    static bool readMatrixTransformComponents(osgDB::InputStream& is, NifOsg::MatrixTransform& transform)
+    {
+        is >> transform.mScale;
+        for (auto& row : transform.mRotationScale.mValues)
+            is >> row[0] >> row[1] >> row[2];
+        return true;
+    }
+
     class MatrixTransformSerializer : public osgDB::ObjectWrapper
     {
     public:
@@ -122,6 +145,10 @@ namespace SceneUtil
             : osgDB::ObjectWrapper(createInstanceFunc<NifOsg::MatrixTransform>, "NifOsg::MatrixTransform",
                 "osg::Object osg::Node osg::Group osg::Transform osg::MatrixTransform NifOsg::MatrixTransform")
         {
+            addSerializer(new osgDB::UserSerializer<NifOsg::MatrixTransform>("Components",
+                              checkMatrixTransformComponents, readMatrixTransformComponents,
+                              writeMatrixTransformComponents),
+                osgDB::BaseSerializer::RW_USER);
         }
     };
 
@@ -1,5 +1,6 @@
 #include "shadow.hpp"
 
+#include <osg/Stats>
 #include <osgShadow/ShadowSettings>
 #include <osgShadow/ShadowedScene>
 
@@ -74,6 +75,8 @@ namespace SceneUtil
         else
             mShadowTechnique->disableFrontFaceCulling();
 
+        mShadowTechnique->setParallelCasterCulling(settings.mParallelCasterCulling);
+
         mShadowSettings->setMultipleShadowMapHint(osgShadow::ShadowSettings::CASCADED);
 
         if (settings.mEnableDebugHud)
@@ -82,6 +85,16 @@ namespace SceneUtil
             mShadowTechnique->disableDebugHUD();
     }
 
+    void ShadowManager::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        if (!mEnableShadows)
+            return;
+
+        const std::vector<double> cullTimes = mShadowTechnique->getShadowMapCullTimes();
+        for (std::size_t i = 0; i < cullTimes.size(); ++i)
+            stats.setAttribute(frameNumber, "Shadow Map " + std::to_string(i) + " Cull", cullTimes[i] * 1000000.0);
+    }
+
     void ShadowManager::disableShadowsForStateSet(osg::StateSet& stateset) const
     {
         if (!mEnableShadows)
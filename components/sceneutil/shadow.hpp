@@ -7,6 +7,7 @@ namespace osg
 {
     class StateSet;
     class Group;
+    class Stats;
 }
 
 namespace osgShadow
@@ -39,6 +40,8 @@ namespace SceneUtil
 
         void disableShadowsForStateSet(osg::StateSet& stateset) const;
 
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
         Shader::ShaderManager::DefineMap getShadowDefines(const Settings::ShadowsCategory& settings) const;
 
         void enableIndoorMode(const Settings::ShadowsCategory& settings);
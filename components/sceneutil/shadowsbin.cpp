@@ -106,6 +106,15 @@ namespace SceneUtil
                     state.mAlphaFuncOverride, rap.second);
             }
 
+            // Instanced drawables rely on their vertex attrib divisors and the useInstancing uniform
+            found = attributes.lower_bound(std::make_pair(osg::StateAttribute::VERTEXATTRIBDIVISOR, 0));
+            if (found != attributes.end() && found->first.first == osg::StateAttribute::VERTEXATTRIBDIVISOR)
+                state.mImportantState = true;
+
+            // Drawables skinned on the GPU rely on their bone palette and the useSkinning uniform
+            if (ss->getUniformList().count("useSkinning"))
+                state.mImportantState = true;
+
             if (!cullFaceOverridden)
             {
                 // osg::FrontFace specifies triangle winding, not front-face culling. We can't safely reparent anything
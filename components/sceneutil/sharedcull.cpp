@@ -0,0 +1,171 @@
+#include "sharedcull.hpp"
+
+#include "nodecallback.hpp"
+
+#include <osg/Camera>
+#include <osg/Node>
+#include <osg/Stats>
+
+#include <osgUtil/CullVisitor>
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        constexpr std::string_view cullPassNames[numCullPasses] = {
+            "Main",
+            "Reflection",
+            "Refraction",
+        };
+
+        struct ActiveCullPass
+        {
+            const osg::Node* mCamera;
+            // Time spent culling the passes nested in this one
+            std::chrono::steady_clock::duration mNested{};
+        };
+
+        // Passes being culled by the thread, the innermost one last
+        thread_local std::vector<ActiveCullPass> activeCullPasses;
+    }
+
+    class SharedCull::PassCullCallback
+        : public SceneUtil::NodeCallback<PassCullCallback, osg::Node*, osgUtil::CullVisitor*>
+    {
+    public:
+        PassCullCallback(SharedCull& sharedCull, CullPass pass)
+            : mSharedCull(&sharedCull)
+            , mPass(pass)
+        {
+        }
+
+        void operator()(osg::Node* node, osgUtil::CullVisitor* cv)
+        {
+            // The callback is on the camera of the pass
+            activeCullPasses.push_back(ActiveCullPass{ .mCamera = node });
+
+            const auto start = std::chrono::steady_clock::now();
+            traverse(node, cv);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            const ActiveCullPass active = activeCullPasses.back();
+            activeCullPasses.pop_back();
+            if (!activeCullPasses.empty())
+                activeCullPasses.back().mNested += elapsed;
+
+            mSharedCull->mPassTimes[static_cast<std::size_t>(mPass)] += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed - active.mNested).count());
+        }
+
+    private:
+        osg::ref_ptr<SharedCull> mSharedCull;
+        const CullPass mPass;
+    };
+
+    osg::Polytope makeSideFrustum(const osg::Matrixd& viewProjection)
+    {
+        osg::Polytope result;
+        result.setToUnitFrustum(false, false);
+        result.transformProvidingInverse(viewProjection);
+        return result;
+    }
+
+    SharedCullVolume::SharedCullVolume(const std::vector<SharedCullFrustum>& frusta)
+    {
+        mFrusta.reserve(frusta.size());
+        mMargins.reserve(frusta.size());
+        for (const SharedCullFrustum& frustum : frusta)
+        {
+            mFrusta.push_back(makeSideFrustum(frustum.mViewProjection));
+            mMargins.push_back(frustum.mMargin);
+        }
+    }
+
+    bool SharedCullVolume::contains(const osg::BoundingSphere& bound)
+    {
+        if (mFrusta.empty())
+            return true;
+        for (std::size_t i = 0; i < mFrusta.size(); ++i)
+            if (mFrusta[i].contains(osg::BoundingSphere(bound.center(), bound.radius() + mMargins[i])))
+                return true;
+        return false;
+    }
+
+    std::size_t selectSharedCullItems(
+        const std::vector<SharedCullTreeNode>& tree, SharedCullVolume& volume, std::vector<std::size_t>& items)
+    {
+        std::size_t tested = 0;
+        for (std::size_t i = 0; i < tree.size();)
+        {
+            const SharedCullTreeNode& node = tree[i];
+            // Nodes without a bound can't be told apart, keep them
+            if (node.mBound.valid())
+            {
+                ++tested;
+                if (!volume.contains(node.mBound))
+                {
+                    i = node.mEnd;
+                    continue;
+                }
+            }
+            if (node.mItem != SharedCullTreeNode::noItem)
+                items.push_back(node.mItem);
+            ++i;
+        }
+        return tested;
+    }
+
+    SharedCull::SharedCull(ComputeFrusta computeFrusta)
+        : mComputeFrusta(std::move(computeFrusta))
+    {
+    }
+
+    bool SharedCull::isPass(const osgUtil::CullVisitor& cv)
+    {
+        // Traversals of other cameras within a pass, e.g. the shadow maps, see what the pass doesn't
+        return !activeCullPasses.empty() && activeCullPasses.back().mCamera == cv.getCurrentCamera();
+    }
+
+    void SharedCull::select(
+        unsigned int frameNumber, const std::vector<SharedCullTreeNode>& tree, std::vector<std::size_t>& items)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (!mHasFrame || frameNumber != mFrameNumber)
+        {
+            mHasFrame = true;
+            mFrameNumber = frameNumber;
+            std::vector<SharedCullFrustum> frusta;
+            mComputeFrusta(frusta);
+            mVolume = SharedCullVolume(frusta);
+        }
+
+        const std::size_t selected = items.size();
+        mTested += selectSharedCullItems(tree, mVolume, items);
+        mVisible += items.size() - selected;
+        for (const SharedCullTreeNode& node : tree)
+            if (node.mItem != SharedCullTreeNode::noItem)
+                ++mItems;
+    }
+
+    osg::ref_ptr<osg::Callback> SharedCull::createPassCallback(CullPass pass)
+    {
+        return new PassCullCallback(*this, pass);
+    }
+
+    void SharedCull::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        for (std::size_t i = 0; i < numCullPasses; ++i)
+            stats.setAttribute(frameNumber, "Cull " + std::string(cullPassNames[i]) + " Time",
+                mPassTimes[i].exchange(0) / 1000.0);
+        stats.setAttribute(frameNumber, "Shared Cull Items", static_cast<double>(mItems.exchange(0)));
+        stats.setAttribute(frameNumber, "Shared Cull Tested", static_cast<double>(mTested.exchange(0)));
+        stats.setAttribute(frameNumber, "Shared Cull Visible", static_cast<double>(mVisible.exchange(0)));
+    }
+
+}
@@ -0,0 +1,133 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SHAREDCULL_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SHAREDCULL_H
+
+#include <osg/BoundingSphere>
+#include <osg/Callback>
+#include <osg/Matrixd>
+#include <osg/Polytope>
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace osgUtil
+{
+    class CullVisitor;
+}
+
+namespace SceneUtil
+{
+
+    /// Cull traversals of the scene sharing the selection of its large nodes.
+    enum class CullPass
+    {
+        Main,
+        Reflection,
+        Refraction,
+    };
+
+    constexpr std::size_t numCullPasses = 3;
+
+    struct SharedCullFrustum
+    {
+        /// Transforms world space to the clip space of the view.
+        osg::Matrixd mViewProjection;
+        /// Distance the bounds of the nodes are grown by when tested against the frustum.
+        double mMargin = 0;
+    };
+
+    /// Side planes of the frustum in world space. The near and far planes are left out, like the cull visitor does
+    /// by default.
+    osg::Polytope makeSideFrustum(const osg::Matrixd& viewProjection);
+
+    /// Union of the frusta of the passes.
+    class SharedCullVolume
+    {
+    public:
+        SharedCullVolume() = default;
+
+        explicit SharedCullVolume(const std::vector<SharedCullFrustum>& frusta);
+
+        /// Whether the bound is inside any of the frusta. Always true without frusta.
+        bool contains(const osg::BoundingSphere& bound);
+
+    private:
+        std::vector<osg::Polytope> mFrusta;
+        std::vector<double> mMargins;
+    };
+
+    /// Node of a hierarchy of bounds stored depth first.
+    struct SharedCullTreeNode
+    {
+        static constexpr std::size_t noItem = std::numeric_limits<std::size_t>::max();
+
+        /// In world space, enclosing the bounds of the whole subtree.
+        osg::BoundingSphere mBound;
+        /// Index following the last node of the subtree.
+        std::size_t mEnd = 0;
+        /// Item held by the node, noItem for the inner nodes.
+        std::size_t mItem = noItem;
+    };
+
+    /// Appends the items of the tree inside the volume, skipping the subtrees outside of it. Returns the number of
+    /// tested nodes.
+    std::size_t selectSharedCullItems(
+        const std::vector<SharedCullTreeNode>& tree, SharedCullVolume& volume, std::vector<std::size_t>& items);
+
+    /// @brief Selection of the large nodes of the scene computed once per frame for the union of the frusta of the
+    /// passes culling it, so that each pass only refines the nodes visible to any of them.
+    /// @par Passes are marked by a callback on their camera. The owners of the large nodes, like the terrain and
+    /// object paging, select them once per frame for all the passes and let the cull visitor of each pass refine the
+    /// selection. Other traversals, like the shadow maps and the local map, keep their own selection.
+    class SharedCull : public osg::Referenced
+    {
+    public:
+        /// Adds the frusta of the passes for the frame being culled.
+        using ComputeFrusta = std::function<void(std::vector<SharedCullFrustum>& frusta)>;
+
+        explicit SharedCull(ComputeFrusta computeFrusta);
+
+        /// Whether the visitor is culling one of the passes rather than a camera nested in it.
+        /// @note To be called from the cull thread.
+        static bool isPass(const osgUtil::CullVisitor& cv);
+
+        /// Appends the items of the tree inside the union of the frusta of the passes for the frame.
+        void select(unsigned int frameNumber, const std::vector<SharedCullTreeNode>& tree,
+            std::vector<std::size_t>& items);
+
+        /// Cull callback marking the traversal of the camera it is added to as the given pass and timing it.
+        osg::ref_ptr<osg::Callback> createPassCallback(CullPass pass);
+
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
+    private:
+        class PassCullCallback;
+
+        const ComputeFrusta mComputeFrusta;
+
+        std::mutex mMutex;
+        bool mHasFrame = false;
+        unsigned int mFrameNumber = 0;
+        SharedCullVolume mVolume;
+
+        mutable std::array<std::atomic<std::uint64_t>, numCullPasses> mPassTimes{};
+        mutable std::atomic<std::size_t> mItems{ 0 };
+        mutable std::atomic<std::size_t> mTested{ 0 };
+        mutable std::atomic<std::size_t> mVisible{ 0 };
+    };
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SIMD_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SIMD_H
+
+// Minimal set of 4-wide float operations shared by the vertex processing kernels. OPENMW_SCENEUTIL_SIMD is defined
+// only if the target supports them, the kernels must provide a scalar fallback otherwise.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OPENMW_SCENEUTIL_SIMD_SSE
+#define OPENMW_SCENEUTIL_SIMD
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#include <cmath>
+#define OPENMW_SCENEUTIL_SIMD_NEON
+#define OPENMW_SCENEUTIL_SIMD
+#endif
+
+#if defined(OPENMW_SCENEUTIL_SIMD)
+namespace SceneUtil::Simd
+{
+#if defined(OPENMW_SCENEUTIL_SIMD_SSE)
+    using Float4 = __m128;
+
+    inline Float4 load(const float* values)
+    {
+        return _mm_loadu_ps(values);
+    }
+
+    inline void store(float* values, Float4 value)
+    {
+        _mm_storeu_ps(values, value);
+    }
+
+    // Writes only the first three lanes, the fourth float may belong to the next vertex
+    inline void storeXyz(float* values, Float4 value)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(values), value);
+        _mm_store_ss(values + 2, _mm_movehl_ps(value, value));
+    }
+
+    inline Float4 splat(float value)
+    {
+        return _mm_set1_ps(value);
+    }
+
+    inline Float4 add(Float4 a, Float4 b)
+    {
+        return _mm_add_ps(a, b);
+    }
+
+    inline Float4 mul(Float4 a, Float4 b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+
+    inline Float4 div(Float4 a, Float4 b)
+    {
+        return _mm_div_ps(a, b);
+    }
+
+    inline Float4 sqrt(Float4 value)
+    {
+        return _mm_sqrt_ps(value);
+    }
+#else
+    using Float4 = float32x4_t;
+
+    inline Float4 load(const float* values)
+    {
+        return vld1q_f32(values);
+    }
+
+    inline void store(float* values, Float4 value)
+    {
+        vst1q_f32(values, value);
+    }
+
+    // Writes only the first three lanes, the fourth float may belong to the next vertex
+    inline void storeXyz(float* values, Float4 value)
+    {
+        vst1_f32(values, vget_low_f32(value));
+        vst1q_lane_f32(values + 2, value, 2);
+    }
+
+    inline Float4 splat(float value)
+    {
+        return vdupq_n_f32(value);
+    }
+
+    inline Float4 add(Float4 a, Float4 b)
+    {
+        return vaddq_f32(a, b);
+    }
+
+    inline Float4 mul(Float4 a, Float4 b)
+    {
+        return vmulq_f32(a, b);
+    }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    inline Float4 div(Float4 a, Float4 b)
+    {
+        return vdivq_f32(a, b);
+    }
+
+    inline Float4 sqrt(Float4 value)
+    {
+        return vsqrtq_f32(value);
+    }
+#else
+    // 32-bit NEON has only estimates, keep the results identical to the scalar code
+    inline Float4 div(Float4 a, Float4 b)
+    {
+        float values[4];
+        float divisors[4];
+        vst1q_f32(values, a);
+        vst1q_f32(divisors, b);
+        for (int i = 0; i < 4; ++i)
+            values[i] /= divisors[i];
+        return vld1q_f32(values);
+    }
+
+    inline Float4 sqrt(Float4 value)
+    {
+        float values[4];
+        vst1q_f32(values, value);
+        for (float& v : values)
+            v = std::sqrt(v);
+        return vld1q_f32(values);
+    }
+#endif
+#endif
+}
+#endif
+
+#endif
@@ -39,6 +39,7 @@ namespace SceneUtil
         , mActive(Active)
         , mLastFrameNumber(0)
         , mLastCullFrameNumber(0)
+        , mUpdatedInAdvanceFrameNumber(0)
     {
     }
 
@@ -49,6 +50,7 @@ namespace SceneUtil
         , mActive(copy.mActive)
         , mLastFrameNumber(0)
         , mLastCullFrameNumber(0)
+        , mUpdatedInAdvanceFrameNumber(0)
     {
     }
 
@@ -94,6 +96,7 @@ namespace SceneUtil
 
     void Skeleton::updateBoneMatrices(unsigned int traversalNumber)
     {
+        std::lock_guard<std::mutex> lock(mBoneMatricesMutex);
         if (traversalNumber != mLastFrameNumber)
             mNeedToUpdateBoneMatrices = true;
 
@@ -121,6 +124,21 @@ namespace SceneUtil
         return mActive != Inactive;
     }
 
+    bool Skeleton::needsUpdate(unsigned int traversalNumber) const
+    {
+        if (mActive == Inactive && mLastFrameNumber != 0)
+            return false;
+        if (mActive == SemiActive && mLastFrameNumber != 0 && mLastCullFrameNumber + 3 <= traversalNumber)
+            return false;
+        return true;
+    }
+
+    void Skeleton::updateInAdvance(osg::NodeVisitor& nv)
+    {
+        osg::Group::traverse(nv);
+        mUpdatedInAdvanceFrameNumber = nv.getTraversalNumber();
+    }
+
     void Skeleton::markDirty()
     {
         mLastFrameNumber = 0;
@@ -132,9 +150,9 @@ namespace SceneUtil
     {
         if (nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR)
         {
-            if (mActive == Inactive && mLastFrameNumber != 0)
+            if (!needsUpdate(nv.getTraversalNumber()))
                 return;
-            if (mActive == SemiActive && mLastFrameNumber != 0 && mLastCullFrameNumber + 3 <= nv.getTraversalNumber())
+            if (mUpdatedInAdvanceFrameNumber == nv.getTraversalNumber())
                 return;
         }
         else if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR)
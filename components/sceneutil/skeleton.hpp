@@ -4,6 +4,7 @@
 #include <osg/Group>
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace SceneUtil
@@ -56,6 +57,14 @@ namespace SceneUtil
 
         bool getActive() const;
 
+        /// @return true if the update traversal with the given number would traverse the child rigs.
+        bool needsUpdate(unsigned int traversalNumber) const;
+
+        /// Run the update traversal of the children ahead of the regular update traversal of the scene graph, which
+        /// then skips them in this frame. Safe to call for different skeletons from different threads.
+        /// @par The node path of the visitor must lead from the root of the scene graph to this skeleton.
+        void updateInAdvance(osg::NodeVisitor& nv);
+
         void traverse(osg::NodeVisitor& nv) override;
 
         void markDirty();
@@ -78,6 +87,8 @@ namespace SceneUtil
 
         unsigned int mLastFrameNumber;
         unsigned int mLastCullFrameNumber;
+        unsigned int mUpdatedInAdvanceFrameNumber;
+        std::mutex mBoneMatricesMutex;
     };
 
 }
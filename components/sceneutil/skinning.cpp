@@ -0,0 +1,195 @@
+#include "skinning.hpp"
+
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        void skinGroupScalar(const SkinningLayout& layout, std::size_t begin, std::size_t end,
+            const osg::Matrixf& matrix, osg::Vec3f* positions, osg::Vec3f* normals, osg::Vec4f* tangents)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const unsigned short vertex = layout.mVertices[i];
+
+                positions[vertex]
+                    = matrix.preMult(osg::Vec3f(layout.mPositionX[i], layout.mPositionY[i], layout.mPositionZ[i]));
+
+                if (normals != nullptr)
+                    normals[vertex] = osg::Matrixf::transform3x3(
+                        osg::Vec3f(layout.mNormalX[i], layout.mNormalY[i], layout.mNormalZ[i]), matrix);
+
+                if (tangents != nullptr)
+                {
+                    const osg::Vec3f tangent = osg::Matrixf::transform3x3(
+                        osg::Vec3f(layout.mTangentX[i], layout.mTangentY[i], layout.mTangentZ[i]), matrix);
+                    tangents[vertex] = osg::Vec4f(tangent, layout.mTangentW[i]);
+                }
+            }
+        }
+
+#if defined(OPENMW_SCENEUTIL_SIMD)
+        // Row vector times the rows of the matrix, in the same order of operations as osg::Matrixf::transform3x3 to
+        // get the same results as the scalar path
+        Simd::Float4 transformDirection(float x, float y, float z, const Simd::Float4* rows)
+        {
+            using namespace Simd;
+            return add(add(mul(splat(x), rows[0]), mul(splat(y), rows[1])), mul(splat(z), rows[2]));
+        }
+
+        // Same order of operations as osg::Matrixf::preMult for matrices without projection
+        Simd::Float4 transformPoint(float x, float y, float z, const Simd::Float4* rows)
+        {
+            return Simd::add(transformDirection(x, y, z, rows), rows[3]);
+        }
+
+        // Weight groups of real meshes are mostly too small to fill SIMD registers with several vertices, so every
+        // vertex is transformed with all components of a row at once instead.
+        void skinGroupVectorized(const SkinningLayout& layout, std::size_t begin, std::size_t end,
+            const osg::Matrixf& matrix, osg::Vec3f* positions, osg::Vec3f* normals, osg::Vec4f* tangents)
+        {
+            const Simd::Float4 rows[4] = {
+                Simd::load(matrix.ptr()),
+                Simd::load(matrix.ptr() + 4),
+                Simd::load(matrix.ptr() + 8),
+                Simd::load(matrix.ptr() + 12),
+            };
+
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const unsigned short vertex = layout.mVertices[i];
+
+                Simd::storeXyz(positions[vertex].ptr(),
+                    transformPoint(layout.mPositionX[i], layout.mPositionY[i], layout.mPositionZ[i], rows));
+
+                if (normals != nullptr)
+                    Simd::storeXyz(normals[vertex].ptr(),
+                        transformDirection(layout.mNormalX[i], layout.mNormalY[i], layout.mNormalZ[i], rows));
+
+                if (tangents != nullptr)
+                {
+                    Simd::storeXyz(tangents[vertex].ptr(),
+                        transformDirection(layout.mTangentX[i], layout.mTangentY[i], layout.mTangentZ[i], rows));
+                    tangents[vertex].w() = layout.mTangentW[i];
+                }
+            }
+        }
+#endif
+
+        template <class SkinGroup>
+        void skinGroups(const SkinningLayout& layout, std::span<const osg::Matrixf> matrices, osg::Vec3f* positions,
+            osg::Vec3f* normals, osg::Vec4f* tangents, SkinGroup&& skinGroup)
+        {
+            assert(matrices.size() == layout.getNumGroups());
+
+            if (layout.mNormalX.empty())
+                normals = nullptr;
+            if (layout.mTangentX.empty())
+                tangents = nullptr;
+
+            for (std::size_t group = 0; group < matrices.size(); ++group)
+                skinGroup(layout, layout.mGroupOffsets[group], layout.mGroupOffsets[group + 1], matrices[group],
+                    positions, normals, tangents);
+        }
+    }
+
+    void SkinningLayout::addGroup(std::span<const unsigned short> vertices, const osg::Vec3f* positions,
+        const osg::Vec3f* normals, const osg::Vec4f* tangents)
+    {
+        for (unsigned short vertex : vertices)
+        {
+            mVertices.push_back(vertex);
+
+            mPositionX.push_back(positions[vertex].x());
+            mPositionY.push_back(positions[vertex].y());
+            mPositionZ.push_back(positions[vertex].z());
+
+            if (normals != nullptr)
+            {
+                mNormalX.push_back(normals[vertex].x());
+                mNormalY.push_back(normals[vertex].y());
+                mNormalZ.push_back(normals[vertex].z());
+            }
+
+            if (tangents != nullptr)
+            {
+                mTangentX.push_back(tangents[vertex].x());
+                mTangentY.push_back(tangents[vertex].y());
+                mTangentZ.push_back(tangents[vertex].z());
+                mTangentW.push_back(tangents[vertex].w());
+            }
+        }
+
+        mGroupOffsets.push_back(mVertices.size());
+    }
+
+    bool isSkinningVectorized()
+    {
+#if defined(OPENMW_SCENEUTIL_SIMD)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void skinVertices(const SkinningLayout& layout, std::span<const osg::Matrixf> matrices, osg::Vec3f* positions,
+        osg::Vec3f* normals, osg::Vec4f* tangents)
+    {
+#if defined(OPENMW_SCENEUTIL_SIMD)
+        skinGroups(layout, matrices, positions, normals, tangents, skinGroupVectorized);
+#else
+        skinGroups(layout, matrices, positions, normals, tangents, skinGroupScalar);
+#endif
+    }
+
+    void skinVerticesScalar(const SkinningLayout& layout, std::span<const osg::Matrixf> matrices,
+        osg::Vec3f* positions, osg::Vec3f* normals, osg::Vec4f* tangents)
+    {
+        skinGroups(layout, matrices, positions, normals, tangents, skinGroupScalar);
+    }
+
+    std::optional<GpuSkinningInfluences> makeGpuSkinningInfluences(
+        std::size_t numVertices, std::span<const SkinningInfluenceGroup> groups)
+    {
+        GpuSkinningInfluences result;
+        result.mBoneIndices.resize(numVertices);
+        result.mBoneWeights.resize(numVertices);
+        std::vector<bool> influenced(numVertices, false);
+
+        for (const auto& [weights, vertices] : groups)
+        {
+            if (weights.empty() || weights.size() > maxGpuSkinningInfluences)
+                return std::nullopt;
+
+            osg::Vec4f boneIndices;
+            osg::Vec4f boneWeights;
+            for (std::size_t i = 0; i < weights.size(); ++i)
+            {
+                const auto& [index, weight] = weights[i];
+                if (index >= maxGpuSkinningBones)
+                    return std::nullopt;
+                boneIndices[i] = static_cast<float>(index);
+                boneWeights[i] = weight;
+            }
+
+            for (unsigned short vertex : vertices)
+            {
+                if (vertex >= numVertices)
+                    return std::nullopt;
+                result.mBoneIndices[vertex] = boneIndices;
+                result.mBoneWeights[vertex] = boneWeights;
+                influenced[vertex] = true;
+            }
+        }
+
+        // Such vertices keep their source position when skinned on the CPU
+        if (std::find(influenced.begin(), influenced.end(), false) != influenced.end())
+            return std::nullopt;
+
+        return result;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+
+#include <osg/Matrixf>
+#include <osg/Vec3f>
+#include <osg/Vec4f>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace SceneUtil
+{
+    /// @brief Source vertices of a skinned mesh reorganised for transforming several vertices with the same matrix at
+    /// once: vertices skinned with the same matrix are adjacent and every component is stored in its own array.
+    struct SkinningLayout
+    {
+        /// Index of the vertex in the source geometry, per element of the component arrays.
+        std::vector<unsigned short> mVertices;
+        /// Range of the elements of every group within the component arrays, mGroupOffsets[i] to mGroupOffsets[i + 1].
+        std::vector<std::size_t> mGroupOffsets{ 0 };
+
+        std::vector<float> mPositionX;
+        std::vector<float> mPositionY;
+        std::vector<float> mPositionZ;
+
+        // Empty if the mesh has no normals
+        std::vector<float> mNormalX;
+        std::vector<float> mNormalY;
+        std::vector<float> mNormalZ;
+
+        // Empty if the mesh has no tangents
+        std::vector<float> mTangentX;
+        std::vector<float> mTangentY;
+        std::vector<float> mTangentZ;
+        std::vector<float> mTangentW;
+
+        std::size_t getNumGroups() const { return mGroupOffsets.size() - 1; }
+
+        /// Append a group of vertices skinned with the same matrix. Groups are numbered in the order they are added.
+        /// @param normals May be nullptr, but must be nullptr for every group or for none.
+        /// @param tangents May be nullptr, but must be nullptr for every group or for none.
+        void addGroup(std::span<const unsigned short> vertices, const osg::Vec3f* positions, const osg::Vec3f* normals,
+            const osg::Vec4f* tangents);
+    };
+
+    /// @return true if skinVertices uses SIMD instructions in this build.
+    bool isSkinningVectorized();
+
+    /// Transform every vertex of the layout by the matrix of its group, writing the results to the destination arrays
+    /// at the index of the vertex in the source geometry. Positions are transformed as points, normals and the xyz
+    /// components of tangents as directions.
+    /// @param matrices One matrix per group of the layout, mapping the source geometry to its skinned pose.
+    /// @param normals Ignored if the layout has no normals.
+    /// @param tangents Ignored if the layout has no tangents.
+    void skinVertices(const SkinningLayout& layout, std::span<const osg::Matrixf> matrices, osg::Vec3f* positions,
+        osg::Vec3f* normals, osg::Vec4f* tangents);
+
+    /// Same as skinVertices, one vertex at a time without SIMD instructions.
+    void skinVerticesScalar(const SkinningLayout& layout, std::span<const osg::Matrixf> matrices,
+        osg::Vec3f* positions, osg::Vec3f* normals, osg::Vec4f* tangents);
+
+    /// Maximum number of bones affecting a vertex skinned on the GPU.
+    constexpr std::size_t maxGpuSkinningInfluences = 4;
+    /// Size of the bone palette of the vertex shader, must match lib/util/skinning.glsl.
+    constexpr std::size_t maxGpuSkinningBones = 64;
+
+    /// Bone indices and weights of every vertex as vertex attributes for skinning on the GPU. Unused slots have a
+    /// weight of zero.
+    struct GpuSkinningInfluences
+    {
+        std::vector<osg::Vec4f> mBoneIndices;
+        std::vector<osg::Vec4f> mBoneWeights;
+    };
+
+    /// Vertices sharing the same bone index and weight pairs.
+    using SkinningInfluenceGroup = std::pair<std::vector<std::pair<std::size_t, float>>, std::vector<unsigned short>>;
+
+    /// @return std::nullopt if the vertices can not be skinned on the GPU: a vertex is affected by no bone or more
+    /// than maxGpuSkinningInfluences bones, or a bone index does not fit in the palette.
+    std::optional<GpuSkinningInfluences> makeGpuSkinningInfluences(
+        std::size_t numVertices, std::span<const SkinningInfluenceGroup> groups);
+}
+
+#endif
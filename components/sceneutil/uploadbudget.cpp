@@ -0,0 +1,55 @@
+#include "uploadbudget.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace SceneUtil
+{
+
+    double getAvailableUploadTime(
+        double targetFrameRate, double frameTime, double conservativeRatio, double minimumTime)
+    {
+        if (!(targetFrameRate > 0))
+            return minimumTime;
+        return std::max((1.0 / targetFrameRate - frameTime) * conservativeRatio, minimumTime);
+    }
+
+    std::vector<double> planUploadBudget(std::span<const UploadQueue> queues, double availableTime)
+    {
+        std::vector<double> result(queues.size(), 0.0);
+
+        const std::vector<std::size_t> order = getUploadOrder(queues);
+        const auto first = std::find_if(order.begin(), order.end(), [&](std::size_t i) { return queues[i].mPending; });
+        if (first == order.end())
+            return result;
+
+        double shares = 0;
+        for (const UploadQueue& queue : queues)
+            if (queue.mPending)
+                shares += std::max(queue.mShare, 0.0);
+
+        const double scale = shares > 1 ? 1 / shares : 1;
+        double allocated = 0;
+        for (std::size_t i = 0; i < queues.size(); ++i)
+        {
+            if (!queues[i].mPending)
+                continue;
+            result[i] = std::max(queues[i].mShare, 0.0) * scale * availableTime;
+            allocated += result[i];
+        }
+
+        result[*first] += std::max(availableTime - allocated, 0.0);
+
+        return result;
+    }
+
+    std::vector<std::size_t> getUploadOrder(std::span<const UploadQueue> queues)
+    {
+        std::vector<std::size_t> result(queues.size());
+        std::iota(result.begin(), result.end(), std::size_t{ 0 });
+        std::stable_sort(result.begin(), result.end(),
+            [&](std::size_t l, std::size_t r) { return queues[l].mPriority < queues[r].mPriority; });
+        return result;
+    }
+
+}
@@ -0,0 +1,36 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_UPLOADBUDGET_H
+#define OPENMW_COMPONENTS_SCENEUTIL_UPLOADBUDGET_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace SceneUtil
+{
+
+    /// State of a queue of GL objects to upload as seen by planUploadBudget.
+    struct UploadQueue
+    {
+        /// Fraction of the available time the queue is guaranteed to get when it has work.
+        double mShare = 0;
+        /// Queues with a lower value are served first and get the time left by the others.
+        unsigned int mPriority = 0;
+        bool mPending = false;
+    };
+
+    /// Time in seconds left for uploads in a frame after the given frame time to keep the target frame rate, scaled
+    /// by the conservative ratio and never lower than the minimum time.
+    double getAvailableUploadTime(
+        double targetFrameRate, double frameTime, double conservativeRatio, double minimumTime);
+
+    /// Time allocated to each queue out of the available time. Queues with work get their share, scaled down when the
+    /// shares of those queues add up to more than 1. The rest goes to the queue with work with the lowest priority
+    /// value, queues without work get nothing.
+    std::vector<double> planUploadBudget(std::span<const UploadQueue> queues, double availableTime);
+
+    /// Indices of the queues in the order they should be served.
+    std::vector<std::size_t> getUploadOrder(std::span<const UploadQueue> queues);
+
+}
+
+#endif
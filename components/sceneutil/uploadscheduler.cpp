@@ -0,0 +1,190 @@
+#include "uploadscheduler.hpp"
+
+#include "uploadbudget.hpp"
+
+#include <osg/FrameStamp>
+#include <osg/GLObjects>
+#include <osg/Geometry>
+#include <osg/GraphicsContext>
+#include <osg/Image>
+#include <osg/Stats>
+#include <osg/Texture>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        constexpr std::string_view uploadSubsystemNames[numUploadSubsystems] = {
+            "Objects",
+            "Object Paging",
+            "Terrain",
+        };
+    }
+
+    std::size_t estimateUploadSize(const osgUtil::StateToCompile& stateToCompile)
+    {
+        std::size_t result = 0;
+
+        for (osg::Drawable* drawable : stateToCompile._drawables)
+        {
+            const osg::Geometry* geometry = drawable->asGeometry();
+            if (geometry == nullptr)
+                continue;
+            osg::Geometry::ArrayList arrays;
+            geometry->getArrayList(arrays);
+            for (const auto& array : arrays)
+                result += array->getTotalDataSize();
+            for (const osg::ref_ptr<osg::PrimitiveSet>& primitiveSet : geometry->getPrimitiveSetList())
+                result += primitiveSet->getTotalDataSize();
+        }
+
+        for (osg::Texture* texture : stateToCompile._textures)
+            for (unsigned int i = 0; i < texture->getNumImages(); ++i)
+                if (const osg::Image* image = texture->getImage(i))
+                    result += image->getTotalSizeInBytesIncludingMipmaps();
+
+        return result;
+    }
+
+    void addToCompile(osgUtil::IncrementalCompileOperation& ico, osg::Node& node,
+        const osgUtil::StateToCompile& stateToCompile, UploadSubsystem subsystem)
+    {
+        if (stateToCompile.empty())
+            return;
+        osg::ref_ptr<UploadCompileSet> compileSet
+            = new UploadCompileSet(&node, subsystem, estimateUploadSize(stateToCompile));
+        compileSet->buildCompileMap(ico.getContextSet(), stateToCompile);
+        ico.add(compileSet, false);
+    }
+
+    void addToCompile(osgUtil::IncrementalCompileOperation& ico, osg::Node& node, UploadSubsystem subsystem)
+    {
+        osgUtil::StateToCompile stateToCompile(
+            osgUtil::GLObjectsVisitor::COMPILE_DISPLAY_LISTS | osgUtil::GLObjectsVisitor::COMPILE_STATE_ATTRIBUTES,
+            nullptr);
+        node.accept(stateToCompile);
+        addToCompile(ico, node, stateToCompile, subsystem);
+    }
+
+    UploadScheduler::UploadScheduler()
+    {
+        // Objects close to the camera pop in the most noticeably, distant object paging chunks the least
+        setBudget(UploadSubsystem::Objects, UploadBudget{ .mShare = 0.5, .mPriority = 0 });
+        setBudget(UploadSubsystem::Terrain, UploadBudget{ .mShare = 0.25, .mPriority = 1 });
+        setBudget(UploadSubsystem::ObjectPaging, UploadBudget{ .mShare = 0.25, .mPriority = 2 });
+    }
+
+    void UploadScheduler::setBudget(UploadSubsystem subsystem, const UploadBudget& budget)
+    {
+        mQueues[static_cast<std::size_t>(subsystem)].mBudget = budget;
+    }
+
+    double UploadScheduler::getAllocatedTime(UploadSubsystem subsystem) const
+    {
+        return mQueues[static_cast<std::size_t>(subsystem)].mAllocatedTime.load();
+    }
+
+    void UploadScheduler::reportUpload(
+        UploadSubsystem subsystem, double time, std::size_t queued, std::size_t queuedBytes)
+    {
+        Queue& queue = mQueues[static_cast<std::size_t>(subsystem)];
+        queue.mTime += static_cast<std::uint64_t>(time * 1e9);
+        queue.mQueued = queued;
+        queue.mQueuedBytes = queuedBytes;
+    }
+
+    void UploadScheduler::operator()(osg::GraphicsContext* context)
+    {
+        osg::State& state = *context->getState();
+        const osg::FrameStamp* frameStamp = state.getFrameStamp();
+        const double currentTime = frameStamp != nullptr ? frameStamp->getReferenceTime() : 0.0;
+
+        // The time of the subsystems uploading during the draw traversal is already part of the frame time
+        const double availableTime = getAvailableUploadTime(getTargetFrameRate(), context->getTimeSinceLastClear(),
+            getConservativeTimeRatio(), getMinimumTimeAvailableForGLCompileAndDeletePerFrame());
+        double flushTime = availableTime * getFlushTimeRatio();
+        const double compileTime = availableTime - flushTime;
+
+        std::array<CompileSets, numUploadSubsystems> toCompile;
+        std::array<std::size_t, numUploadSubsystems> queuedBytes{};
+        {
+            std::lock_guard<OpenThreads::Mutex> lock(*getToCompiledMutex());
+            for (const osg::ref_ptr<CompileSet>& compileSet : getToCompile())
+            {
+                std::size_t index = static_cast<std::size_t>(UploadSubsystem::Objects);
+                if (const auto* uploadSet = dynamic_cast<const UploadCompileSet*>(compileSet.get()))
+                {
+                    index = static_cast<std::size_t>(uploadSet->getSubsystem());
+                    queuedBytes[index] += uploadSet->getSize();
+                }
+                toCompile[index].push_back(compileSet);
+            }
+        }
+
+        std::array<UploadQueue, numUploadSubsystems> queues;
+        for (std::size_t i = 0; i < numUploadSubsystems; ++i)
+        {
+            const bool selfUploading = i == static_cast<std::size_t>(UploadSubsystem::Terrain);
+            if (!selfUploading)
+            {
+                mQueues[i].mQueued = toCompile[i].size();
+                mQueues[i].mQueuedBytes = queuedBytes[i];
+            }
+            queues[i] = UploadQueue{
+                .mShare = mQueues[i].mBudget.mShare,
+                .mPriority = mQueues[i].mBudget.mPriority,
+                .mPending = selfUploading ? mQueues[i].mQueued > 0 : !toCompile[i].empty(),
+            };
+        }
+
+        const std::vector<double> allocated = planUploadBudget(queues, compileTime);
+
+        // Time not used by a subsystem running out of work goes to the next one
+        double carried = 0;
+        for (std::size_t i : getUploadOrder(queues))
+        {
+            if (i == static_cast<std::size_t>(UploadSubsystem::Terrain))
+            {
+                mQueues[i].mAllocatedTime = allocated[i];
+                continue;
+            }
+
+            if (toCompile[i].empty())
+                continue;
+
+            CompileInfo compileInfo(context, this);
+            compileInfo.maxNumObjectsToCompile = getMaximumNumOfObjectsToCompilePerFrame();
+            compileInfo.allocatedTime = allocated[i] + carried;
+            compileInfo.compileAll = _compileAllTillFrameNumber > _currentFrameNumber;
+
+            const auto start = std::chrono::steady_clock::now();
+            compileSets(toCompile[i], compileInfo);
+            const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start;
+
+            mQueues[i].mTime += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count());
+            carried = toCompile[i].empty() ? std::max(compileInfo.allocatedTime - spent.count(), 0.0) : 0.0;
+        }
+
+        osg::flushDeletedGLObjects(state.getContextID(), currentTime, flushTime);
+    }
+
+    void UploadScheduler::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        for (std::size_t i = 0; i < numUploadSubsystems; ++i)
+        {
+            const std::string prefix = "Upload " + std::string(uploadSubsystemNames[i]);
+            const Queue& queue = mQueues[i];
+            stats.setAttribute(frameNumber, prefix + " Queued", static_cast<double>(queue.mQueued.load()));
+            stats.setAttribute(frameNumber, prefix + " Queued Bytes", static_cast<double>(queue.mQueuedBytes.load()));
+            stats.setAttribute(frameNumber, prefix + " Time", queue.mTime.exchange(0) / 1000.0);
+        }
+    }
+
+}
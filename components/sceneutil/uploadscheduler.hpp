@@ -0,0 +1,108 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_UPLOADSCHEDULER_H
+#define OPENMW_COMPONENTS_SCENEUTIL_UPLOADSCHEDULER_H
+
+#include <osgUtil/IncrementalCompileOperation>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace SceneUtil
+{
+
+    /// Parts of the scene competing for the time spent uploading GL objects to the GPU.
+    enum class UploadSubsystem
+    {
+        /// Models loaded through the scene manager: actors, effects and other objects.
+        Objects,
+        ObjectPaging,
+        /// Composite maps, rendered by the terrain itself.
+        Terrain,
+    };
+
+    constexpr std::size_t numUploadSubsystems = 3;
+
+    struct UploadBudget
+    {
+        /// Fraction of the frame's upload time guaranteed to the subsystem when it has work.
+        double mShare = 0;
+        /// Subsystems with a lower value are served first and get the time left by the others.
+        unsigned int mPriority = 0;
+    };
+
+    /// Compile set tagged with the subsystem it is uploaded for and its estimated size in bytes.
+    class UploadCompileSet : public osgUtil::IncrementalCompileOperation::CompileSet
+    {
+    public:
+        UploadCompileSet(osg::Node* subgraph, UploadSubsystem subsystem, std::size_t size)
+            : osgUtil::IncrementalCompileOperation::CompileSet(subgraph)
+            , mSubsystem(subsystem)
+            , mSize(size)
+        {
+        }
+
+        UploadSubsystem getSubsystem() const { return mSubsystem; }
+
+        std::size_t getSize() const { return mSize; }
+
+    private:
+        const UploadSubsystem mSubsystem;
+        const std::size_t mSize;
+    };
+
+    /// Estimated size in bytes of the vertex data and texture images the state to compile uploads.
+    std::size_t estimateUploadSize(const osgUtil::StateToCompile& stateToCompile);
+
+    /// Queue the GL objects of the node gathered in the state to compile for compilation on behalf of the subsystem.
+    void addToCompile(osgUtil::IncrementalCompileOperation& ico, osg::Node& node,
+        const osgUtil::StateToCompile& stateToCompile, UploadSubsystem subsystem);
+
+    /// Queue all the GL objects of the node for compilation on behalf of the subsystem.
+    void addToCompile(osgUtil::IncrementalCompileOperation& ico, osg::Node& node, UploadSubsystem subsystem);
+
+    /// @brief Incremental compile operation sharing the upload time of each frame between subsystems.
+    /// @par The time available after the frame is drawn is derived from the target frame rate, like the base class
+    /// does, and split according to the budget of each subsystem with work. Compile sets are attributed to the
+    /// subsystem of their UploadCompileSet, other ones to the objects. Subsystems uploading on their own during the
+    /// draw traversal get the time allocated to them by the previous frame and report what they did.
+    class UploadScheduler : public osgUtil::IncrementalCompileOperation
+    {
+    public:
+        UploadScheduler();
+
+        /// @note To be called before the scheduler is given to the viewer.
+        void setBudget(UploadSubsystem subsystem, const UploadBudget& budget);
+
+        /// Time in seconds a subsystem uploading on its own may spend in the current frame.
+        double getAllocatedTime(UploadSubsystem subsystem) const;
+
+        /// Record the uploads of a subsystem uploading on its own and the work it has left.
+        /// @note To be called from the draw thread.
+        void reportUpload(UploadSubsystem subsystem, double time, std::size_t queued, std::size_t queuedBytes);
+
+        void operator()(osg::GraphicsContext* context) override;
+
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
+    private:
+        struct Queue
+        {
+            UploadBudget mBudget;
+            std::atomic<double> mAllocatedTime{ 0 };
+            std::atomic<std::size_t> mQueued{ 0 };
+            std::atomic<std::size_t> mQueuedBytes{ 0 };
+            mutable std::atomic<std::uint64_t> mTime{ 0 };
+        };
+
+        std::array<Queue, numUploadSubsystems> mQueues;
+    };
+
+}
+
+#endif
@@ -2,10 +2,62 @@
 
 #include <components/debug/debuglog.hpp>
 
+#include <exception>
 #include <numeric>
 
 namespace SceneUtil
 {
+    namespace
+    {
+        /// Runs a call of runTasks on the work queue or on the thread waiting for it, whichever comes first.
+        class Task : public WorkItem
+        {
+        public:
+            Task(const std::function<void(std::size_t)>& function, std::size_t index)
+                : mFunction(&function)
+                , mIndex(index)
+            {
+            }
+
+            void doWork() override { run(); }
+
+            void run()
+            {
+                if (mStarted.exchange(true))
+                    return;
+                std::exception_ptr exception;
+                try
+                {
+                    (*mFunction)(mIndex);
+                }
+                catch (...)
+                {
+                    exception = std::current_exception();
+                }
+                std::lock_guard lock(mMutex);
+                mException = exception;
+                mFinished = true;
+                mCondition.notify_all();
+            }
+
+            std::exception_ptr wait()
+            {
+                std::unique_lock lock(mMutex);
+                mCondition.wait(lock, [&] { return mFinished; });
+                return mException;
+            }
+
+        private:
+            // Not accessed once the task is started, so the work queue may outlive the caller's function
+            const std::function<void(std::size_t)>* mFunction;
+            std::size_t mIndex;
+            std::atomic_bool mStarted{ false };
+            std::mutex mMutex;
+            std::condition_variable mCondition;
+            bool mFinished = false;
+            std::exception_ptr mException;
+        };
+    }
 
     void WorkItem::waitTillDone()
     {
@@ -142,4 +194,34 @@ namespace SceneUtil
         return mActive;
     }
 
+    void runTasks(WorkQueue* workQueue, std::size_t count, const std::function<void(std::size_t)>& function)
+    {
+        if (workQueue == nullptr || count <= 1)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                function(i);
+            return;
+        }
+
+        std::vector<osg::ref_ptr<Task>> tasks;
+        tasks.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            tasks.push_back(new Task(function, i));
+            workQueue->addWorkItem(tasks.back());
+        }
+        for (const osg::ref_ptr<Task>& task : tasks)
+            task->run();
+
+        std::exception_ptr firstException;
+        for (const osg::ref_ptr<Task>& task : tasks)
+        {
+            std::exception_ptr exception = task->wait();
+            if (exception && !firstException)
+                firstException = exception;
+        }
+        if (firstException)
+            std::rethrow_exception(firstException);
+    }
+
 }
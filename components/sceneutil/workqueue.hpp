@@ -7,6 +7,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -94,6 +95,11 @@ namespace SceneUtil
         void run();
     };
 
+    /// Calls function for every index in [0, count) and returns when all calls are finished, rethrowing the first
+    /// exception thrown by any of them. Runs everything on the calling thread if workQueue is nullptr.
+    /// @note The calling thread runs the calls no worker has started yet, so it never waits for a busy queue.
+    void runTasks(WorkQueue* workQueue, std::size_t count, const std::function<void(std::size_t)>& function);
+
 }
 
 #endif
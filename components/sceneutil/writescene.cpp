@@ -16,7 +16,7 @@ void SceneUtil::writeScene(osg::Node* node, const std::filesystem::path& filenam
         throw std::runtime_error("can not find readerwriter for " + format);
 
     std::ofstream stream;
-    stream.open(filename);
+    stream.open(filename, std::ios::binary);
 
     osg::ref_ptr<osgDB::Options> options = new osgDB::Options;
     options->setPluginStringData("fileType", format);
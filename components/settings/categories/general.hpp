@@ -27,6 +27,13 @@ namespace Settings
             makeEnumSanitizerString({ "nearest", "linear" }) };
         SettingValue<std::string> mTextureMipmap{ mIndex, "General", "texture mipmap",
             makeEnumSanitizerString({ "none", "nearest", "linear" }) };
+        SettingValue<bool> mGenerateMipmaps{ mIndex, "General", "generate mipmaps" };
+        SettingValue<bool> mTranscodeTextures{ mIndex, "General", "transcode textures" };
+        SettingValue<bool> mTextureStreaming{ mIndex, "General", "texture streaming" };
+        SettingValue<std::size_t> mTextureStreamingBudget{ mIndex, "General", "texture streaming budget",
+            makeMaxSanitizerSize(1) };
+        SettingValue<int> mTextureStreamingInitialSize{ mIndex, "General", "texture streaming initial size",
+            makeMaxSanitizerInt(1) };
         SettingValue<bool> mNotifyOnSavedScreenshot{ mIndex, "General", "notify on saved screenshot" };
         SettingValue<std::vector<std::string>> mPreferredLocales{ mIndex, "General", "preferred locales" };
         SettingValue<bool> mGmstOverridesL10n{ mIndex, "General", "gmst overrides l10n" };
@@ -21,6 +21,7 @@ namespace Settings
         SettingValue<int> mAsyncNumThreads{ mIndex, "Physics", "async num threads", makeMaxSanitizerInt(0) };
         SettingValue<int> mLineofsightKeepInactiveCache{ mIndex, "Physics", "lineofsight keep inactive cache",
             makeMaxSanitizerInt(-1) };
+        SettingValue<bool> mCompressHeightfields{ mIndex, "Physics", "compress heightfields" };
     };
 }
 
@@ -46,6 +46,8 @@ namespace Settings
         SettingValue<bool> mWeatherParticleOcclusion{ mIndex, "Shaders", "weather particle occlusion" };
         SettingValue<float> mWeatherParticleOcclusionSmallFeatureCullingPixelSize{ mIndex, "Shaders",
             "weather particle occlusion small feature culling pixel size" };
+        SettingValue<bool> mGpuSkinning{ mIndex, "Shaders", "gpu skinning" };
+        SettingValue<bool> mProgramCache{ mIndex, "Shaders", "program cache" };
     };
 }
 
@@ -37,6 +37,7 @@ namespace Settings
         SettingValue<float> mPolygonOffsetUnits{ mIndex, "Shadows", "polygon offset units" };
         SettingValue<float> mNormalOffsetDistance{ mIndex, "Shadows", "normal offset distance" };
         SettingValue<bool> mUseFrontFaceCulling{ mIndex, "Shadows", "use front face culling" };
+        SettingValue<bool> mParallelCasterCulling{ mIndex, "Shadows", "parallel caster culling" };
         SettingValue<bool> mActorShadows{ mIndex, "Shadows", "actor shadows" };
         SettingValue<bool> mPlayerShadows{ mIndex, "Shadows", "player shadows" };
         SettingValue<bool> mTerrainShadows{ mIndex, "Shadows", "terrain shadows" };
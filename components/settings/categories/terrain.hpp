@@ -26,6 +26,8 @@ namespace Settings
             makeMaxSanitizerInt(1) };
         SettingValue<float> mMaxCompositeGeometrySize{ mIndex, "Terrain", "max composite geometry size",
             makeMaxSanitizerFloat(1) };
+        SettingValue<bool> mCompositeMapDiskCache{ mIndex, "Terrain", "composite map disk cache" };
+        SettingValue<bool> mCompactVertices{ mIndex, "Terrain", "compact vertices" };
         SettingValue<bool> mDebugChunks{ mIndex, "Terrain", "debug chunks" };
         SettingValue<bool> mObjectPaging{ mIndex, "Terrain", "object paging" };
         SettingValue<bool> mObjectPagingActiveGrid{ mIndex, "Terrain", "object paging active grid" };
@@ -37,6 +39,12 @@ namespace Settings
             makeMaxStrictSanitizerFloat(0) };
         SettingValue<float> mObjectPagingMinSizeCostMultiplier{ mIndex, "Terrain",
             "object paging min size cost multiplier", makeMaxStrictSanitizerFloat(0) };
+        SettingValue<bool> mObjectPagingDiskCache{ mIndex, "Terrain", "object paging disk cache" };
+        SettingValue<bool> mObjectPagingInstancing{ mIndex, "Terrain", "object paging instancing" };
+        SettingValue<int> mObjectPagingInstancingMinInstances{ mIndex, "Terrain",
+            "object paging instancing min instances", makeMaxSanitizerInt(2) };
+        SettingValue<int> mObjectPagingBuildThreads{ mIndex, "Terrain", "object paging build threads",
+            makeMaxSanitizerInt(0) };
     };
 }
 
@@ -0,0 +1,359 @@
+#include "programcache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+#include <osg/GL>
+#include <osg/GLExtensions>
+#include <osg/State>
+#include <osg/Stats>
+
+#include <components/debug/debuglog.hpp>
+#include <components/files/conversion.hpp>
+#include <components/files/hash.hpp>
+
+namespace Shader
+{
+    namespace
+    {
+        constexpr char sMagic[8] = { 'O', 'M', 'W', 'P', 'R', 'O', 'G', '\0' };
+        constexpr std::uint32_t sFormatVersion = 1;
+        constexpr std::string_view sManifestName = "manifest.txt";
+        constexpr std::string_view sBinariesName = "programs.bin";
+        // Draw thread time given to precompilation every frame
+        constexpr std::chrono::microseconds sPrecompileBudget(2000);
+        // Programs not used in that many sessions in a row are dropped from the manifest
+        constexpr unsigned int sMaxUnusedSessions = 5;
+
+        std::string getDriver()
+        {
+            std::string result;
+            for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+            {
+                if (const GLubyte* value = glGetString(name))
+                    result += reinterpret_cast<const char*>(value);
+                result += '\n';
+            }
+            return result;
+        }
+
+        void appendValue(std::string& key, std::string_view value)
+        {
+            key += value;
+            key += '\0';
+        }
+
+        // Covers everything glProgramBinary skips compared to linking from source
+        std::array<std::uint64_t, 2> getProgramHash(const osg::Program& program)
+        {
+            std::string key;
+            for (unsigned int i = 0; i < program.getNumShaders(); ++i)
+            {
+                const osg::Shader* shader = program.getShader(i);
+                appendValue(key, std::to_string(shader->getType()));
+                appendValue(key, shader->getShaderSource());
+            }
+            for (const auto& [name, index] : program.getAttribBindingList())
+                appendValue(key, "attrib " + name + ' ' + std::to_string(index));
+            for (const auto& [name, index] : program.getFragDataBindingList())
+                appendValue(key, "frag " + name + ' ' + std::to_string(index));
+            for (const auto& [name, index] : program.getUniformBlockBindingList())
+                appendValue(key, "block " + name + ' ' + std::to_string(index));
+            return Files::getHash(key);
+        }
+
+        template <class T>
+        void writeValue(std::ostream& stream, const T& value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <class T>
+        T readValue(std::istream& stream)
+        {
+            T value{};
+            if (!stream.read(reinterpret_cast<char*>(&value), sizeof(value)))
+                throw std::runtime_error("unexpected end of file");
+            return value;
+        }
+
+        // Write to a temporary file first so a crash never leaves a partially written file behind
+        template <class F>
+        void writeFile(const std::filesystem::path& path, F&& write)
+        {
+            std::filesystem::path temporary = path;
+            temporary += ".tmp";
+            {
+                std::ofstream stream(temporary, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+                if (!stream)
+                    throw std::runtime_error("failed to open " + Files::pathToUnicodeString(temporary));
+                write(stream);
+                if (!stream)
+                    throw std::runtime_error("failed to write " + Files::pathToUnicodeString(temporary));
+            }
+            std::filesystem::rename(temporary, path);
+        }
+
+        std::set<ProgramPermutation> readManifest(
+            const std::filesystem::path& path, std::map<ProgramPermutation, unsigned int>& unusedSessions)
+        {
+            std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+            if (!stream)
+                return {};
+            return readProgramManifest(stream, &unusedSessions);
+        }
+    }
+
+    ProgramCache::ProgramCache(std::filesystem::path path)
+        : mPath(std::move(path))
+        , mManifest(readManifest(mPath / sManifestName, mManifestUnusedSessions))
+    {
+        const std::filesystem::path binariesPath = mPath / sBinariesName;
+        std::ifstream stream(binariesPath, std::ios_base::in | std::ios_base::binary);
+        if (!stream)
+            return;
+
+        try
+        {
+            char magic[sizeof(sMagic)];
+            if (!stream.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), sMagic)
+                || readValue<std::uint32_t>(stream) != sFormatVersion)
+                throw std::runtime_error("unsupported format");
+
+            mDriver.resize(readValue<std::uint32_t>(stream));
+            if (!stream.read(mDriver.data(), static_cast<std::streamsize>(mDriver.size())))
+                throw std::runtime_error("unexpected end of file");
+
+            const std::uint32_t count = readValue<std::uint32_t>(stream);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                const Hash hash = readValue<Hash>(stream);
+                const GLenum format = readValue<std::uint32_t>(stream);
+                const std::uint32_t size = readValue<std::uint32_t>(stream);
+                osg::ref_ptr<osg::Program::ProgramBinary> binary = new osg::Program::ProgramBinary;
+                binary->allocate(size);
+                binary->setFormat(format);
+                if (!stream.read(reinterpret_cast<char*>(binary->getData()), size))
+                    throw std::runtime_error("unexpected end of file");
+                mBinaries.emplace(hash, std::move(binary));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to read program binaries " << Files::pathToUnicodeString(binariesPath)
+                                << ": " << e.what();
+            mDriver.clear();
+            mBinaries.clear();
+        }
+    }
+
+    void ProgramCache::addPermutation(ProgramPermutation&& permutation)
+    {
+        std::lock_guard lock(mMutex);
+        mPermutations.insert(std::move(permutation));
+    }
+
+    std::set<ProgramPermutation> ProgramCache::getPermutations() const
+    {
+        std::lock_guard lock(mMutex);
+        return mPermutations;
+    }
+
+    void ProgramCache::addProgram(osg::ref_ptr<osg::Program> program)
+    {
+        std::lock_guard lock(mMutex);
+        mAdded.push_back(std::move(program));
+    }
+
+    void ProgramCache::precompile(osg::ref_ptr<osg::Program> program)
+    {
+        std::lock_guard lock(mMutex);
+        mPrecompiled.push_back(std::move(program));
+    }
+
+    void ProgramCache::compile(osg::State& state)
+    {
+        if (!mInitialized)
+        {
+            mInitialized = true;
+            mSupported = state.get<osg::GLExtensions>()->isGetProgramBinarySupported;
+            const std::string driver = getDriver();
+            std::lock_guard lock(mMutex);
+            if (!mSupported || driver != mDriver)
+            {
+                if (!mBinaries.empty())
+                    Log(Debug::Info) << "Discarding " << mBinaries.size()
+                                     << " program binaries retrieved with another driver";
+                mBinaries.clear();
+            }
+            mDriver = driver;
+        }
+
+        std::vector<osg::ref_ptr<osg::Program>> added;
+        {
+            std::lock_guard lock(mMutex);
+            added.swap(mAdded);
+        }
+
+        if (mSupported)
+        {
+            for (osg::ref_ptr<osg::Program>& program : added)
+                if (!link(*program, state))
+                    mLinking.push_back(std::move(program));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < sPrecompileBudget)
+        {
+            osg::ref_ptr<osg::Program> program;
+            {
+                std::lock_guard lock(mMutex);
+                if (mPrecompiled.empty())
+                    break;
+                program = std::move(mPrecompiled.front());
+                mPrecompiled.pop_front();
+            }
+            if (program->getPCP(state)->needsLink())
+            {
+                program->compileGLObjects(state);
+                ++mPrecompiledCount;
+            }
+        }
+        mPrecompileTime += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+        std::erase_if(mLinking, [&](const osg::ref_ptr<osg::Program>& program) {
+            osg::Program::PerContextProgram* pcp = program->getPCP(state);
+            if (pcp->needsLink())
+                return false;
+            if (pcp->isLinked() && program->getProgramBinary() == nullptr)
+                retrieve(*program, state);
+            return true;
+        });
+    }
+
+    bool ProgramCache::link(osg::Program& program, osg::State& state)
+    {
+        osg::Program::PerContextProgram* pcp = program.getPCP(state);
+        if (!pcp->needsLink())
+            return false;
+
+        const Hash hash = getProgramHash(program);
+        osg::ref_ptr<osg::Program::ProgramBinary> binary;
+        {
+            std::lock_guard lock(mMutex);
+            const auto it = mBinaries.find(hash);
+            if (it == mBinaries.end())
+                return false;
+            binary = it->second;
+        }
+
+        program.setProgramBinary(binary);
+        pcp->linkProgram(state);
+        if (pcp->isLinked())
+        {
+            ++mLoaded;
+            std::lock_guard lock(mMutex);
+            mUsedBinaries.insert(hash);
+            return true;
+        }
+
+        Log(Debug::Verbose) << "Failed to link program binary, linking program from source";
+        program.setProgramBinary(nullptr);
+        program.dirtyProgram();
+        ++mRejected;
+        std::lock_guard lock(mMutex);
+        mBinaries.erase(hash);
+        return false;
+    }
+
+    void ProgramCache::retrieve(osg::Program& program, osg::State& state)
+    {
+        const osg::ref_ptr<osg::Program::ProgramBinary> binary = program.getPCP(state)->compileProgramBinary(state);
+        if (binary == nullptr || binary->getSize() == 0)
+            return;
+        const Hash hash = getProgramHash(program);
+        std::lock_guard lock(mMutex);
+        mUsedBinaries.insert(hash);
+        if (mBinaries.emplace(hash, binary).second)
+            ++mStored;
+    }
+
+    void ProgramCache::save() const
+    {
+        std::set<ProgramPermutation> permutations;
+        std::map<ProgramPermutation, unsigned int> unusedSessions;
+        std::string driver;
+        std::map<Hash, osg::ref_ptr<osg::Program::ProgramBinary>> binaries;
+        {
+            std::lock_guard lock(mMutex);
+            permutations = mPermutations;
+            for (const ProgramPermutation& permutation : mManifest)
+            {
+                if (mPermutations.contains(permutation))
+                    continue;
+                const auto it = mManifestUnusedSessions.find(permutation);
+                const unsigned int sessions = (it == mManifestUnusedSessions.end() ? 0 : it->second) + 1;
+                if (sessions >= sMaxUnusedSessions)
+                    continue;
+                permutations.insert(permutation);
+                unusedSessions.emplace(permutation, sessions);
+            }
+            driver = mDriver;
+            for (const auto& [hash, binary] : mBinaries)
+                if (mUsedBinaries.contains(hash))
+                    binaries.emplace(hash, binary);
+        }
+
+        try
+        {
+            std::filesystem::create_directories(mPath);
+
+            writeFile(mPath / sManifestName,
+                [&](std::ostream& stream) { writeProgramManifest(permutations, stream, {}, unusedSessions); });
+
+            writeFile(mPath / sBinariesName, [&](std::ostream& stream) {
+                stream.write(sMagic, sizeof(sMagic));
+                writeValue(stream, sFormatVersion);
+                writeValue(stream, static_cast<std::uint32_t>(driver.size()));
+                stream.write(driver.data(), static_cast<std::streamsize>(driver.size()));
+                writeValue(stream, static_cast<std::uint32_t>(binaries.size()));
+                for (const auto& [hash, binary] : binaries)
+                {
+                    writeValue(stream, hash);
+                    writeValue(stream, static_cast<std::uint32_t>(binary->getFormat()));
+                    writeValue(stream, static_cast<std::uint32_t>(binary->getSize()));
+                    stream.write(reinterpret_cast<const char*>(binary->getData()), binary->getSize());
+                }
+            });
+
+            Log(Debug::Verbose) << "Saved " << permutations.size() << " programs and " << binaries.size()
+                                << " program binaries to " << Files::pathToUnicodeString(mPath);
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to save program cache to " << Files::pathToUnicodeString(mPath) << ": "
+                                << e.what();
+        }
+    }
+
+    void ProgramCache::saveManifest(const std::map<ProgramPermutation, std::size_t>& uses) const
+    {
+        const std::set<ProgramPermutation> permutations = getPermutations();
+        std::filesystem::create_directories(mPath);
+        writeFile(mPath / sManifestName,
+            [&](std::ostream& stream) { writeProgramManifest(permutations, stream, uses); });
+    }
+
+    void ProgramCache::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        stats.setAttribute(frameNumber, "Program Cache Loaded", mLoaded);
+        stats.setAttribute(frameNumber, "Program Cache Stored", mStored);
+        stats.setAttribute(frameNumber, "Program Cache Rejected", mRejected);
+        stats.setAttribute(frameNumber, "Program Cache Precompiled", mPrecompiledCount);
+        stats.setAttribute(frameNumber, "Program Cache Precompile Time", mPrecompileTime.exchange(0) / 1000.0);
+    }
+
+}
@@ -0,0 +1,103 @@
+#ifndef OPENMW_COMPONENTS_SHADER_PROGRAMCACHE_H
+#define OPENMW_COMPONENTS_SHADER_PROGRAMCACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <osg/Program>
+#include <osg/ref_ptr>
+
+#include "programmanifest.hpp"
+
+namespace osg
+{
+    class State;
+    class Stats;
+}
+
+namespace Shader
+{
+
+    /// @brief Keeps the programs used in a session to compile them ahead of their first use in the next ones, and
+    /// their binaries when the driver can retrieve them so that they don't need to be compiled again.
+    /// @par The manifest of the used programs and the binaries are written to the given directory by save(). Binaries
+    /// retrieved with another driver or failing to link are discarded, their programs are linked from source instead.
+    /// Programs not used for a few sessions in a row are dropped from the manifest, binaries neither linked nor
+    /// retrieved in a session are not written again.
+    /// @note May be used from any thread unless stated otherwise.
+    class ProgramCache
+    {
+    public:
+        explicit ProgramCache(std::filesystem::path path);
+
+        /// Programs used in the previous sessions.
+        const std::set<ProgramPermutation>& getManifest() const { return mManifest; }
+
+        /// Record a program used in this session.
+        void addPermutation(ProgramPermutation&& permutation);
+
+        /// Programs used in this session.
+        std::set<ProgramPermutation> getPermutations() const;
+
+        /// Link the new program with its stored binary when there is one, or store its binary once it is linked.
+        void addProgram(osg::ref_ptr<osg::Program> program);
+
+        /// Compile the program ahead of its first use, a bit every frame.
+        void precompile(osg::ref_ptr<osg::Program> program);
+
+        /// @note To be called from the draw thread.
+        void compile(osg::State& state);
+
+        /// Write the manifest and the binaries.
+        void save() const;
+
+        /// Replace the manifest by the programs created in this session, with their number of uses.
+        void saveManifest(const std::map<ProgramPermutation, std::size_t>& uses) const;
+
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
+    private:
+        using Hash = std::array<std::uint64_t, 2>;
+
+        bool link(osg::Program& program, osg::State& state);
+
+        void retrieve(osg::Program& program, osg::State& state);
+
+        const std::filesystem::path mPath;
+        // Number of sessions in a row the programs of the manifest were not used in, filled along with mManifest
+        std::map<ProgramPermutation, unsigned int> mManifestUnusedSessions;
+        const std::set<ProgramPermutation> mManifest;
+
+        mutable std::mutex mMutex;
+        std::string mDriver;
+        std::map<Hash, osg::ref_ptr<osg::Program::ProgramBinary>> mBinaries;
+        std::set<Hash> mUsedBinaries;
+        std::set<ProgramPermutation> mPermutations;
+        std::vector<osg::ref_ptr<osg::Program>> mAdded;
+        std::deque<osg::ref_ptr<osg::Program>> mPrecompiled;
+
+        // Draw thread only
+        bool mInitialized = false;
+        bool mSupported = false;
+        std::vector<osg::ref_ptr<osg::Program>> mLinking;
+
+        std::atomic<std::size_t> mLoaded{ 0 };
+        std::atomic<std::size_t> mStored{ 0 };
+        std::atomic<std::size_t> mRejected{ 0 };
+        std::atomic<std::size_t> mPrecompiledCount{ 0 };
+        mutable std::atomic<std::uint64_t> mPrecompileTime{ 0 };
+    };
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "programmanifest.hpp"
+
+#include <charconv>
+#include <istream>
+#include <ostream>
+#include <string_view>
+
+namespace Shader
+{
+    namespace
+    {
+        constexpr std::string_view sProgram = "program";
+        constexpr std::string_view sDefine = "define";
+        constexpr std::string_view sAttrib = "attrib";
+        constexpr std::string_view sBlock = "block";
+        constexpr std::string_view sUnused = "unused";
+        constexpr std::string_view sEnd = "end";
+
+        bool isWritable(std::string_view value)
+        {
+            return value.find('\n') == std::string_view::npos && value.find('\r') == std::string_view::npos;
+        }
+
+        bool isWritableName(std::string_view name)
+        {
+            return !name.empty() && isWritable(name) && name.find(' ') == std::string_view::npos;
+        }
+
+        bool isWritable(const ProgramPermutation& permutation)
+        {
+            if (!isWritableName(permutation.mTemplateName))
+                return false;
+            for (const auto& [name, value] : permutation.mDefines)
+                if (!isWritableName(name) || !isWritable(value))
+                    return false;
+            for (const auto& [name, index] : permutation.mAttribLocations)
+                if (!isWritableName(name))
+                    return false;
+            for (const auto& [name, index] : permutation.mUniformBlockBindings)
+                if (!isWritableName(name))
+                    return false;
+            return true;
+        }
+
+        // Splits "keyword name value" where the value is the rest of the line and may contain spaces or be empty
+        bool splitLine(
+            std::string_view line, std::string_view& keyword, std::string_view& name, std::string_view& value)
+        {
+            const std::size_t keywordEnd = line.find(' ');
+            keyword = line.substr(0, keywordEnd);
+            if (keywordEnd == std::string_view::npos)
+            {
+                name = {};
+                value = {};
+                return true;
+            }
+            const std::size_t nameEnd = line.find(' ', keywordEnd + 1);
+            name = line.substr(keywordEnd + 1, nameEnd == std::string_view::npos ? nameEnd : nameEnd - keywordEnd - 1);
+            value = nameEnd == std::string_view::npos ? std::string_view() : line.substr(nameEnd + 1);
+            return !name.empty();
+        }
+
+        bool parseIndex(std::string_view value, unsigned int& index)
+        {
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), index);
+            return ec == std::errc() && end == value.data() + value.size();
+        }
+    }
+
+    void writeProgramManifest(const std::set<ProgramPermutation>& permutations, std::ostream& stream,
+        const std::map<ProgramPermutation, std::size_t>& uses,
+        const std::map<ProgramPermutation, unsigned int>& unusedSessions)
+    {
+        for (const ProgramPermutation& permutation : permutations)
+        {
+            if (!isWritable(permutation))
+                continue;
+            if (const auto it = uses.find(permutation); it != uses.end())
+                stream << "# uses " << it->second << '\n';
+            stream << sProgram << ' ' << permutation.mTemplateName << '\n';
+            for (const auto& [name, value] : permutation.mDefines)
+                stream << sDefine << ' ' << name << ' ' << value << '\n';
+            for (const auto& [name, index] : permutation.mAttribLocations)
+                stream << sAttrib << ' ' << name << ' ' << index << '\n';
+            for (const auto& [name, index] : permutation.mUniformBlockBindings)
+                stream << sBlock << ' ' << name << ' ' << index << '\n';
+            if (const auto it = unusedSessions.find(permutation); it != unusedSessions.end() && it->second > 0)
+                stream << sUnused << ' ' << it->second << '\n';
+            stream << sEnd << '\n';
+        }
+    }
+
+    std::set<ProgramPermutation> readProgramManifest(
+        std::istream& stream, std::map<ProgramPermutation, unsigned int>* unusedSessions)
+    {
+        std::set<ProgramPermutation> result;
+        ProgramPermutation permutation;
+        unsigned int unused = 0;
+        bool inProgram = false;
+        bool valid = false;
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line.front() == '#')
+                continue;
+
+            std::string_view keyword;
+            std::string_view name;
+            std::string_view value;
+            const bool split = splitLine(line, keyword, name, value);
+
+            if (keyword == sProgram)
+            {
+                permutation = ProgramPermutation{ .mTemplateName = std::string(name) };
+                unused = 0;
+                inProgram = true;
+                valid = split && value.empty();
+            }
+            else if (!inProgram)
+                continue;
+            else if (keyword == sEnd)
+            {
+                if (valid)
+                {
+                    if (unusedSessions != nullptr && unused > 0)
+                        unusedSessions->insert_or_assign(permutation, unused);
+                    result.insert(std::move(permutation));
+                }
+                inProgram = false;
+            }
+            else if (!split)
+                valid = false;
+            else if (keyword == sUnused)
+            {
+                if (!value.empty() || !parseIndex(name, unused))
+                    valid = false;
+            }
+            else if (keyword == sDefine)
+                permutation.mDefines.emplace(name, value);
+            else if (keyword == sAttrib || keyword == sBlock)
+            {
+                unsigned int index = 0;
+                if (!parseIndex(value, index))
+                    valid = false;
+                else if (keyword == sAttrib)
+                    permutation.mAttribLocations.emplace(name, index);
+                else
+                    permutation.mUniformBlockBindings.emplace(name, index);
+            }
+            else
+                valid = false;
+        }
+        return result;
+    }
+
+}
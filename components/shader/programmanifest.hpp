@@ -0,0 +1,40 @@
+#ifndef OPENMW_COMPONENTS_SHADER_PROGRAMMANIFEST_H
+#define OPENMW_COMPONENTS_SHADER_PROGRAMMANIFEST_H
+
+#include <compare>
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <string>
+
+namespace Shader
+{
+
+    /// A program as requested from ShaderManager::getProgram, enough to create it again in another session.
+    struct ProgramPermutation
+    {
+        std::string mTemplateName;
+        std::map<std::string, std::string> mDefines = {};
+        /// Bindings of the program template.
+        std::map<std::string, unsigned int> mAttribLocations = {};
+        std::map<std::string, unsigned int> mUniformBlockBindings = {};
+
+        friend auto operator<=>(const ProgramPermutation& lhs, const ProgramPermutation& rhs) = default;
+    };
+
+    /// Write the permutations as text, one line per template name, define and binding. Permutations with a number
+    /// of uses get it written in a comment before them, the ones with a number of sessions they were not used in get
+    /// it written in an "unused" line.
+    void writeProgramManifest(const std::set<ProgramPermutation>& permutations, std::ostream& stream,
+        const std::map<ProgramPermutation, std::size_t>& uses = {},
+        const std::map<ProgramPermutation, unsigned int>& unusedSessions = {});
+
+    /// Read the permutations written by writeProgramManifest, malformed ones are skipped as well as lines starting
+    /// with '#'. The permutations with a number of unused sessions are added to unusedSessions when it is given.
+    std::set<ProgramPermutation> readProgramManifest(
+        std::istream& stream, std::map<ProgramPermutation, unsigned int>* unusedSessions = nullptr);
+
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "shadermanager.hpp"
 
+#include "programcache.hpp"
+
 #include <algorithm>
 #include <cassert>
 #include <chrono>
@@ -456,6 +458,7 @@ namespace Shader
         void reloadTouchedShaders(ShaderManager& Manager, osgViewer::Viewer& viewer)
         {
             bool threadsRunningToStop = false;
+            bool reloaded = false;
             for (auto& [pathShaderToTest, shaderKeys] : mShaderFiles)
             {
 
@@ -512,9 +515,12 @@ namespace Shader
                             break;
                         }
                         shaderIt->second->setShaderSource(shaderSource);
+                        reloaded = true;
                     }
                 }
             }
+            if (reloaded)
+                Manager.resetProgramBinaries();
             if (threadsRunningToStop)
                 viewer.startThreading();
             mLastAutoRecompileTime = std::filesystem::file_time_type::clock::now();
@@ -590,6 +596,12 @@ namespace Shader
 
     osg::ref_ptr<osg::Program> ShaderManager::getProgram(
         const std::string& templateName, const DefineMap& defines, const osg::Program* programTemplate)
+    {
+        return getProgram(templateName, defines, programTemplate, true);
+    }
+
+    osg::ref_ptr<osg::Program> ShaderManager::getProgram(const std::string& templateName, const DefineMap& defines,
+        const osg::Program* programTemplate, bool recordPermutation)
     {
         auto vert = getShader(templateName + ".vert", defines);
         auto frag = getShader(templateName + ".frag", defines);
@@ -597,28 +609,65 @@ namespace Shader
         if (!vert || !frag)
             throw std::runtime_error("failed initializing shader: " + templateName);
 
-        return getProgram(std::move(vert), std::move(frag), programTemplate);
+        if (!programTemplate)
+            programTemplate = mProgramTemplate;
+        osg::ref_ptr<osg::Program> program
+            = getOrCreateProgram(std::move(vert), std::move(frag), programTemplate).first;
+        // Precompiled programs only count as used once the scene requests them
+        if (recordPermutation && mProgramCache)
+        {
+            ProgramPermutation permutation{ .mTemplateName = templateName, .mDefines = defines };
+            if (programTemplate)
+            {
+                permutation.mAttribLocations.insert(
+                    programTemplate->getAttribBindingList().begin(), programTemplate->getAttribBindingList().end());
+                permutation.mUniformBlockBindings.insert(programTemplate->getUniformBlockBindingList().begin(),
+                    programTemplate->getUniformBlockBindingList().end());
+            }
+            mProgramCache->addPermutation(std::move(permutation));
+        }
+        return program;
     }
 
     osg::ref_ptr<osg::Program> ShaderManager::getProgram(osg::ref_ptr<osg::Shader> vertexShader,
         osg::ref_ptr<osg::Shader> fragmentShader, const osg::Program* programTemplate)
+    {
+        return getOrCreateProgram(std::move(vertexShader), std::move(fragmentShader), programTemplate).first;
+    }
+
+    osg::ref_ptr<osg::Program> ShaderManager::getProgram(const ProgramPermutation& permutation)
+    {
+        osg::ref_ptr<osg::Program> programTemplate
+            = mProgramTemplate ? cloneProgram(mProgramTemplate) : osg::ref_ptr<osg::Program>(new osg::Program);
+        for (const auto& [name, index] : permutation.mAttribLocations)
+            programTemplate->addBindAttribLocation(name, index);
+        for (const auto& [name, index] : permutation.mUniformBlockBindings)
+            programTemplate->addBindUniformBlock(name, index);
+        return getProgram(permutation.mTemplateName, permutation.mDefines, programTemplate, false);
+    }
+
+    std::pair<osg::ref_ptr<osg::Program>, bool> ShaderManager::getOrCreateProgram(
+        osg::ref_ptr<osg::Shader> vertexShader, osg::ref_ptr<osg::Shader> fragmentShader,
+        const osg::Program* programTemplate)
     {
         std::lock_guard<std::mutex> lock(mMutex);
         ProgramMap::iterator found = mPrograms.find(std::make_pair(vertexShader, fragmentShader));
-        if (found == mPrograms.end())
-        {
-            if (!programTemplate)
-                programTemplate = mProgramTemplate;
-            osg::ref_ptr<osg::Program> program
-                = programTemplate ? cloneProgram(programTemplate) : osg::ref_ptr<osg::Program>(new osg::Program);
-            program->addShader(vertexShader);
-            program->addShader(fragmentShader);
-            addLinkedShaders(vertexShader, program);
-            addLinkedShaders(fragmentShader, program);
-
-            found = mPrograms.insert(std::make_pair(std::make_pair(vertexShader, fragmentShader), program)).first;
-        }
-        return found->second;
+        if (found != mPrograms.end())
+            return { found->second, false };
+
+        if (!programTemplate)
+            programTemplate = mProgramTemplate;
+        osg::ref_ptr<osg::Program> program
+            = programTemplate ? cloneProgram(programTemplate) : osg::ref_ptr<osg::Program>(new osg::Program);
+        program->addShader(vertexShader);
+        program->addShader(fragmentShader);
+        addLinkedShaders(vertexShader, program);
+        addLinkedShaders(fragmentShader, program);
+
+        mPrograms.insert(std::make_pair(std::make_pair(vertexShader, fragmentShader), program));
+        if (mProgramCache)
+            mProgramCache->addProgram(program);
+        return { program, true };
     }
 
     osg::ref_ptr<osg::Program> ShaderManager::cloneProgram(const osg::Program* src)
@@ -656,6 +705,29 @@ namespace Shader
 
             getLinkedShaders(shader, linkedShaderNames, defines);
         }
+        resetProgramBinaries();
+    }
+
+    void ShaderManager::setProgramCache(std::unique_ptr<ProgramCache> programCache)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mProgramCache = std::move(programCache);
+        if (mProgramCache)
+            for (const auto& [_, program] : mPrograms)
+                mProgramCache->addProgram(program);
+    }
+
+    void ShaderManager::resetProgramBinaries()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& [_, program] : mPrograms)
+        {
+            if (program->getProgramBinary() != nullptr)
+                program->setProgramBinary(nullptr);
+            // Stores the binary linked from the new source
+            if (mProgramCache)
+                mProgramCache->addProgram(program);
+        }
     }
 
     void ShaderManager::releaseGLObjects(osg::State* state)
@@ -733,6 +805,9 @@ namespace Shader
             case Slot::ShadowMaps:
                 slotDescr = "shadow maps";
                 break;
+            case Slot::LightClusters:
+                slotDescr = "light clusters";
+                break;
             default:
                 slotDescr = "UNKNOWN";
         }
@@ -7,6 +7,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <osg/ref_ptr>
@@ -23,6 +24,9 @@ namespace osgViewer
 namespace Shader
 {
     struct HotReloadManager;
+    class ProgramCache;
+    struct ProgramPermutation;
+
     /// @brief Reads shader template files and turns them into a concrete shader, based on a list of define's.
     /// @par Shader templates can get the value of a define with the syntax @define.
     class ShaderManager
@@ -51,6 +55,9 @@ namespace Shader
         osg::ref_ptr<osg::Program> getProgram(osg::ref_ptr<osg::Shader> vertexShader,
             osg::ref_ptr<osg::Shader> fragmentShader, const osg::Program* programTemplate = nullptr);
 
+        /// Create or retrieve the program of a permutation recorded by the program cache, without recording it as used.
+        osg::ref_ptr<osg::Program> getProgram(const ProgramPermutation& permutation);
+
         const osg::Program* getProgramTemplate() const { return mProgramTemplate; }
         void setProgramTemplate(const osg::Program* program) { mProgramTemplate = program; }
 
@@ -81,6 +88,7 @@ namespace Shader
             OpaqueDepthTexture,
             SkyTexture,
             ShadowMaps,
+            LightClusters,
             SLOT_COUNT
         };
 
@@ -90,7 +98,20 @@ namespace Shader
         void setHotReloadEnabled(bool value);
         void triggerShaderReload();
 
+        /// Record the created programs and the permutations they come from in the given cache.
+        void setProgramCache(std::unique_ptr<ProgramCache> programCache);
+        ProgramCache* getProgramCache() { return mProgramCache.get(); }
+
     private:
+        osg::ref_ptr<osg::Program> getProgram(const std::string& templateName, const DefineMap& defines,
+            const osg::Program* programTemplate, bool recordPermutation);
+
+        std::pair<osg::ref_ptr<osg::Program>, bool> getOrCreateProgram(osg::ref_ptr<osg::Shader> vertexShader,
+            osg::ref_ptr<osg::Shader> fragmentShader, const osg::Program* programTemplate);
+
+        /// Binaries of the programs are no longer valid once the source of their shaders changes.
+        void resetProgramBinaries();
+
         void getLinkedShaders(osg::ref_ptr<osg::Shader> shader, const std::vector<std::string>& linkedShaderNames,
             const DefineMap& defines);
         void addLinkedShaders(osg::ref_ptr<osg::Shader> shader, osg::ref_ptr<osg::Program> program);
@@ -122,6 +143,7 @@ namespace Shader
         int mMaxTextureUnits = 0;
         int mReservedTextureUnits = 0;
         std::unique_ptr<HotReloadManager> mHotReloadManager;
+        std::unique_ptr<ProgramCache> mProgramCache;
         struct ReservedTextureUnits
         {
             int index = -1;
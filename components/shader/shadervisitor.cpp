@@ -189,6 +189,8 @@ namespace Shader
         , mReconstructNormalZ(false)
         , mTexStageRequiringTangents(-1)
         , mSoftParticles(false)
+        , mInstancing(false)
+        , mSkinning(false)
         , mNode(nullptr)
     {
     }
@@ -406,7 +408,7 @@ namespace Shader
                 Misc::StringUtils::replaceLast(normalHeightMap, ".", mNormalHeightMapPattern + ".");
                 if (mImageManager.getVFS()->exists(normalHeightMap))
                 {
-                    image = mImageManager.getImage(normalHeightMap);
+                    image = mImageManager.getStreamedImage(normalHeightMap, Resource::ImageUsage::SceneData);
                     normalHeight = true;
                 }
                 else
@@ -414,7 +416,7 @@ namespace Shader
                     Misc::StringUtils::replaceLast(normalMapFileName, ".", mNormalMapPattern + ".");
                     if (mImageManager.getVFS()->exists(normalMapFileName))
                     {
-                        image = mImageManager.getImage(normalMapFileName);
+                        image = mImageManager.getStreamedImage(normalMapFileName, Resource::ImageUsage::SceneData);
                     }
                 }
                 // Avoid using the auto-detected normal map if it's already being used as a bump map.
@@ -466,7 +468,8 @@ namespace Shader
                 Misc::StringUtils::replaceLast(specularMapFileName, ".", mSpecularMapPattern + ".");
                 if (mImageManager.getVFS()->exists(specularMapFileName))
                 {
-                    osg::ref_ptr<osg::Image> image(mImageManager.getImage(specularMapFileName));
+                    osg::ref_ptr<osg::Image> image(
+                        mImageManager.getStreamedImage(specularMapFileName, Resource::ImageUsage::SceneData));
                     osg::ref_ptr<osg::Texture2D> specularMapTex(new osg::Texture2D(image));
                     specularMapTex->setTextureSize(image->s(), image->t());
                     specularMapTex->setWrap(osg::Texture::WRAP_S, diffuseMap->getWrap(osg::Texture::WRAP_S));
@@ -587,6 +590,7 @@ namespace Shader
         else
             mRequirements.push_back(mRequirements.back());
         mRequirements.back().mNode = &node;
+        node.getUserValue("instancing", mRequirements.back().mInstancing);
     }
 
     void ShaderVisitor::popRequirements()
@@ -716,6 +720,16 @@ namespace Shader
         node.getUserValue("particleOcclusion", particleOcclusion);
         defineMap["particleOcclusion"] = particleOcclusion && mWeatherParticleOcclusion ? "1" : "0";
 
+        defineMap["instancing"] = reqs.mInstancing ? "1" : "0";
+
+        defineMap["skinning"] = reqs.mSkinning ? "1" : "0";
+        if (reqs.mSkinning)
+        {
+            // Enabled by the geometries of the RigGeometry that are skinned in the vertex shader
+            writableStateSet->addUniform(new osg::Uniform("useSkinning", false));
+            addedState->addUniform("useSkinning");
+        }
+
         if (reqs.mAlphaBlend && mSupportsNormalsRT)
         {
             if (reqs.mSoftParticles)
@@ -756,11 +770,9 @@ namespace Shader
 
         Stereo::shaderStereoDefines(defineMap);
 
-        std::string shaderPrefix;
-        if (!node.getUserValue("shaderPrefix", shaderPrefix))
-            shaderPrefix = mDefaultShaderPrefix;
-
-        auto program = mShaderManager.getProgram(shaderPrefix, defineMap, mProgramTemplate);
+        const osg::Program* programTemplate
+            = reqs.mSkinning ? getSkinningProgramTemplate() : mProgramTemplate.get();
+        auto program = mShaderManager.getProgram(getShaderPrefix(node), defineMap, programTemplate);
         writableStateSet->setAttributeAndModes(program, osg::StateAttribute::ON);
         addedState->setAttributeAndModes(std::move(program));
 
@@ -783,6 +795,30 @@ namespace Shader
         }
     }
 
+    std::string ShaderVisitor::getShaderPrefix(const osg::Node& node) const
+    {
+        std::string shaderPrefix;
+        if (!node.getUserValue("shaderPrefix", shaderPrefix))
+            shaderPrefix = mDefaultShaderPrefix;
+        return shaderPrefix;
+    }
+
+    const osg::Program* ShaderVisitor::getSkinningProgramTemplate()
+    {
+        if (mSkinningProgramTemplate == nullptr)
+        {
+            const osg::Program* programTemplate
+                = mProgramTemplate != nullptr ? mProgramTemplate.get() : mShaderManager.getProgramTemplate();
+            mSkinningProgramTemplate = programTemplate != nullptr ? ShaderManager::cloneProgram(programTemplate)
+                                                                  : osg::ref_ptr<osg::Program>(new osg::Program);
+            mSkinningProgramTemplate->addBindAttribLocation(
+                "aBoneIndices", SceneUtil::RigGeometry::sBoneIndicesAttribute);
+            mSkinningProgramTemplate->addBindAttribLocation(
+                "aBoneWeights", SceneUtil::RigGeometry::sBoneWeightsAttribute);
+        }
+        return mSkinningProgramTemplate;
+    }
+
     void ShaderVisitor::ensureFFP(osg::Node& node)
     {
         if (!node.getStateSet() || !node.getStateSet()->getAttribute(osg::StateAttribute::PROGRAM))
@@ -934,7 +970,13 @@ namespace Shader
 
     void ShaderVisitor::apply(osg::Drawable& drawable)
     {
-        bool needPop = drawable.getStateSet() || mRequirements.empty();
+        auto rig = dynamic_cast<SceneUtil::RigGeometry*>(&drawable);
+        // Only the objects shader can skin, with a program of its own for the RigGeometry
+        const bool gpuSkinning = rig != nullptr && mGpuSkinning && rig->supportsGpuSkinning()
+            && getShaderPrefix(drawable) == "objects"
+            && (mRequirements.empty() || getShaderPrefix(*mRequirements.back().mNode) == "objects");
+
+        bool needPop = drawable.getStateSet() || mRequirements.empty() || gpuSkinning;
 
         // We need to push and pop a requirements object because particle systems can have
         // different shader requirements to other drawables, so might need a different shader variant.
@@ -949,11 +991,19 @@ namespace Shader
                 applyStateSet(drawable.getStateSet(), drawable);
         }
 
+        if (gpuSkinning)
+        {
+            mRequirements.back().mSkinning = true;
+            mRequirements.back().mShaderRequired = true;
+        }
+
         const ShaderRequirements& reqs = mRequirements.back();
         createProgram(reqs);
 
-        if (auto rig = dynamic_cast<SceneUtil::RigGeometry*>(&drawable))
+        if (rig != nullptr)
         {
+            rig->setGpuSkinning(gpuSkinning);
+
             osg::ref_ptr<osg::Geometry> sourceGeometry = rig->getSourceGeometry();
             if (sourceGeometry && adjustGeometry(*sourceGeometry, reqs))
                 rig->setSourceGeometry(std::move(sourceGeometry));
@@ -21,7 +21,11 @@ namespace Shader
         ShaderVisitor(
             ShaderManager& shaderManager, Resource::ImageManager& imageManager, const std::string& defaultShaderPrefix);
 
-        void setProgramTemplate(const osg::Program* programTemplate) { mProgramTemplate = programTemplate; }
+        void setProgramTemplate(const osg::Program* programTemplate)
+        {
+            mProgramTemplate = programTemplate;
+            mSkinningProgramTemplate = nullptr;
+        }
 
         /// By default, only bump mapped objects will have a shader added to them.
         /// Setting force = true will cause all objects to render using shaders, regardless of having a bump map.
@@ -53,6 +57,9 @@ namespace Shader
 
         void setWeatherParticleOcclusion(bool value) { mWeatherParticleOcclusion = value; }
 
+        /// Skin the RigGeometries drawn with the objects shader in the vertex shader when they fit its bone palette.
+        void setGpuSkinning(bool enabled) { mGpuSkinning = enabled; }
+
         void apply(osg::Node& node) override;
 
         void apply(osg::Drawable& drawable) override;
@@ -82,6 +89,8 @@ namespace Shader
         bool mSupportsNormalsRT;
         bool mWeatherParticleOcclusion = false;
 
+        bool mGpuSkinning = false;
+
         ShaderManager& mShaderManager;
         Resource::ImageManager& mImageManager;
 
@@ -117,6 +126,12 @@ namespace Shader
 
             bool mSoftParticles;
 
+            // per-instance transforms are supplied by vertex attributes
+            bool mInstancing;
+
+            // a RigGeometry skinned in the vertex shader
+            bool mSkinning;
+
             // the Node that requested these requirements
             osg::Node* mNode;
         };
@@ -127,8 +142,12 @@ namespace Shader
         void createProgram(const ShaderRequirements& reqs);
         void ensureFFP(osg::Node& node);
         bool adjustGeometry(osg::Geometry& sourceGeometry, const ShaderRequirements& reqs);
+        std::string getShaderPrefix(const osg::Node& node) const;
+        const osg::Program* getSkinningProgramTemplate();
 
         osg::ref_ptr<const osg::Program> mProgramTemplate;
+        // mProgramTemplate with the locations of the bone attributes
+        osg::ref_ptr<osg::Program> mSkinningProgramTemplate;
     };
 
     class ReinstateRemovedStateVisitor : public osg::NodeVisitor
@@ -1,10 +1,12 @@
 #include "chunkmanager.hpp"
 
+#include <osg/Image>
 #include <osg/Material>
 #include <osg/Texture2D>
 
 #include <osgUtil/IncrementalCompileOperation>
 
+#include <components/files/hash.hpp>
 #include <components/resource/objectcache.hpp>
 #include <components/resource/scenemanager.hpp>
 
@@ -18,6 +20,14 @@
 
 namespace Terrain
 {
+    namespace
+    {
+        template <class T>
+        void appendValue(std::string& data, const T& value)
+        {
+            data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }
 
     ChunkManager::ChunkManager(Storage* storage, Resource::SceneManager* sceneMgr, TextureManager* textureManager,
         CompositeMapRenderer* renderer, ESM::RefId worldspace, double expiryDelay)
@@ -31,6 +41,7 @@ namespace Terrain
         , mCompositeMapSize(512)
         , mCompositeMapLevel(1.f)
         , mMaxCompGeometrySize(1.f)
+        , mCompactVertices(false)
     {
         mMultiPassRoot = new osg::StateSet;
         mMultiPassRoot->setRenderingHint(osg::StateSet::OPAQUE_BIN);
@@ -64,6 +75,21 @@ namespace Terrain
     void ChunkManager::reportStats(unsigned int frameNumber, osg::Stats* stats) const
     {
         Resource::reportStats("Terrain Chunk", frameNumber, mCache->getStats(), *stats);
+
+        std::size_t vertexMemory = 0;
+        std::size_t uncompactedVertexMemory = 0;
+        mCache->call([&](const ChunkKey& /*key*/, osg::Object* object) {
+            const TerrainDrawable& drawable = static_cast<const TerrainDrawable&>(*object);
+            for (const osg::Array* array :
+                { drawable.getVertexArray(), drawable.getNormalArray(), drawable.getColorArray() })
+                if (array != nullptr)
+                    vertexMemory += array->getTotalDataSize();
+            uncompactedVertexMemory += drawable.getVertexArray()->getNumElements()
+                * (sizeof(osg::Vec3f) + sizeof(osg::Vec3f) + sizeof(osg::Vec4ub));
+        });
+        stats->setAttribute(frameNumber, "Terrain Vertex Memory", static_cast<double>(vertexMemory));
+        stats->setAttribute(
+            frameNumber, "Terrain Vertex Memory Uncompacted", static_cast<double>(uncompactedVertexMemory));
     }
 
     void ChunkManager::clearCache()
@@ -137,6 +163,69 @@ namespace Terrain
         }
     }
 
+    void ChunkManager::prepareCompositeMap(float chunkSize, const osg::Vec2f& chunkCenter, CompositeMap& compositeMap)
+    {
+        if (mCompositeMapCache != nullptr)
+        {
+            std::string entry = mWorldspace.serializeText();
+            appendValue(entry, chunkCenter.x());
+            appendValue(entry, chunkCenter.y());
+            appendValue(entry, chunkSize);
+            appendValue(entry, mCompositeMapSize);
+            std::string contents;
+            appendCompositeMapContents(chunkSize, chunkCenter, contents);
+            compositeMap.mCacheEntry = Files::getHash(entry);
+            compositeMap.mCacheContents = Files::getHash(contents);
+
+            osg::ref_ptr<osg::Image> image
+                = mCompositeMapCache->read(compositeMap.mCacheEntry, compositeMap.mCacheContents);
+            if (image != nullptr && image->s() == static_cast<int>(mCompositeMapSize)
+                && image->t() == static_cast<int>(mCompositeMapSize))
+            {
+                compositeMap.mTexture->setImage(image);
+                compositeMap.mTexture->setUnRefImageDataAfterApply(true);
+                return;
+            }
+
+            compositeMap.mCache = mCompositeMapCache;
+        }
+
+        createCompositeMapGeometry(chunkSize, chunkCenter, osg::Vec4f(0, 0, 1, 1), compositeMap);
+        mCompositeMapRenderer->addCompositeMap(&compositeMap, false);
+    }
+
+    void ChunkManager::appendCompositeMapContents(float chunkSize, const osg::Vec2f& chunkCenter, std::string& contents)
+    {
+        // Same subdivision as createCompositeMapGeometry
+        if (chunkSize > mMaxCompGeometrySize)
+        {
+            for (const osg::Vec2f& direction :
+                { osg::Vec2f(1, 1), osg::Vec2f(-1, 1), osg::Vec2f(1, -1), osg::Vec2f(-1, -1) })
+                appendCompositeMapContents(chunkSize / 2.f, chunkCenter + direction * (chunkSize / 4.f), contents);
+            return;
+        }
+
+        std::vector<LayerInfo> layerList;
+        std::vector<osg::ref_ptr<osg::Image>> blendmaps;
+        mStorage->getBlendmaps(chunkSize, chunkCenter, blendmaps, layerList, mWorldspace);
+
+        appendValue(contents, layerList.size());
+        for (const LayerInfo& layer : layerList)
+        {
+            appendValue(contents, layer.mDiffuseMap.size());
+            contents += layer.mDiffuseMap;
+        }
+        appendValue(contents, blendmaps.size());
+        for (const osg::ref_ptr<osg::Image>& blendmap : blendmaps)
+        {
+            appendValue(contents, blendmap->s());
+            appendValue(contents, blendmap->t());
+            appendValue(contents, blendmap->getPixelFormat());
+            contents.append(reinterpret_cast<const char*>(blendmap->data()), blendmap->getTotalSizeInBytes());
+        }
+        appendValue(contents, mStorage->getBlendmapScale(chunkSize));
+    }
+
     std::vector<osg::ref_ptr<osg::StateSet>> ChunkManager::createPasses(
         float chunkSize, const osg::Vec2f& chunkCenter, bool forCompositeMap)
     {
@@ -160,7 +249,8 @@ namespace Terrain
                 textureLayer.mDiffuseMap = mTextureManager->getTexture(it->mDiffuseMap);
 
                 if (!forCompositeMap && !it->mNormalMap.empty())
-                    textureLayer.mNormalMap = mTextureManager->getTexture(it->mNormalMap);
+                    textureLayer.mNormalMap
+                        = mTextureManager->getTexture(it->mNormalMap, Resource::ImageUsage::SceneData);
 
                 if (it->requiresShaders())
                     useShaders = true;
@@ -186,7 +276,7 @@ namespace Terrain
         float blendmapScale = mStorage->getBlendmapScale(chunkSize);
 
         return ::Terrain::createPasses(
-            useShaders, mSceneManager, layers, blendmapTextures, blendmapScale, blendmapScale);
+            useShaders, mSceneManager, layers, blendmapTextures, blendmapScale, blendmapScale, false);
     }
 
     osg::ref_ptr<osg::Node> ChunkManager::createChunk(float chunkSize, const osg::Vec2f& chunkCenter, unsigned char lod,
@@ -217,19 +307,25 @@ namespace Terrain
             // Unfortunately we need to copy vertex data because of poor coupling with VertexBufferObject.
             osg::ref_ptr<osg::Array> positions
                 = static_cast<osg::Array*>(templateGeometry->getVertexArray()->clone(osg::CopyOp::DEEP_COPY_ALL));
-            osg::ref_ptr<osg::Array> normals
-                = static_cast<osg::Array*>(templateGeometry->getNormalArray()->clone(osg::CopyOp::DEEP_COPY_ALL));
             osg::ref_ptr<osg::Array> colors
                 = static_cast<osg::Array*>(templateGeometry->getColorArray()->clone(osg::CopyOp::DEEP_COPY_ALL));
 
             osg::ref_ptr<osg::VertexBufferObject> vbo(new osg::VertexBufferObject);
             positions->setVertexBufferObject(vbo);
-            normals->setVertexBufferObject(vbo);
             colors->setVertexBufferObject(vbo);
 
             geometry->setVertexArray(positions);
-            geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
             geometry->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
+
+            if (templateGeometry->hasCompactVertices())
+                geometry->shareCompactVertexData(*templateGeometry);
+            else
+            {
+                osg::ref_ptr<osg::Array> normals
+                    = static_cast<osg::Array*>(templateGeometry->getNormalArray()->clone(osg::CopyOp::DEEP_COPY_ALL));
+                normals->setVertexBufferObject(vbo);
+                geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
+            }
         }
 
         geometry->setUseDisplayList(false);
@@ -247,10 +343,13 @@ namespace Terrain
 
         geometry->setTexCoordArrayList(osg::Geometry::ArrayList(numUvSets, mBufferCache.getUVBuffer(numVerts)));
 
-        geometry->createClusterCullingCallback();
+        if (!geometry->hasCompactVertices())
+            geometry->createClusterCullingCallback();
 
         geometry->setStateSet(mMultiPassRoot);
 
+        bool compactVertices = false;
+
         if (templateGeometry)
         {
             if (templateGeometry->getCompositeMap())
@@ -267,20 +366,21 @@ namespace Terrain
                 osg::ref_ptr<CompositeMap> compositeMap = new CompositeMap;
                 compositeMap->mTexture = createCompositeMapRTT();
 
-                createCompositeMapGeometry(chunkSize, chunkCenter, osg::Vec4f(0, 0, 1, 1), *compositeMap);
-
-                mCompositeMapRenderer->addCompositeMap(compositeMap.get(), false);
+                prepareCompositeMap(chunkSize, chunkCenter, *compositeMap);
 
                 geometry->setCompositeMap(compositeMap);
-                geometry->setCompositeMapRenderer(mCompositeMapRenderer);
+                if (!compositeMap->mDrawables.empty())
+                    geometry->setCompositeMapRenderer(mCompositeMapRenderer);
 
                 TextureLayer layer;
                 layer.mDiffuseMap = compositeMap->mTexture;
                 layer.mParallax = false;
                 layer.mSpecular = false;
-                geometry->setPasses(::Terrain::createPasses(
-                    mSceneManager->getForceShaders() || !mSceneManager->getClampLighting(), mSceneManager,
-                    std::vector<TextureLayer>(1, layer), std::vector<osg::ref_ptr<osg::Texture2D>>(), 1.f, 1.f));
+                const bool useShaders = mSceneManager->getForceShaders() || !mSceneManager->getClampLighting();
+                compactVertices = mCompactVertices && useShaders;
+                geometry->setPasses(::Terrain::createPasses(useShaders, mSceneManager,
+                    std::vector<TextureLayer>(1, layer), std::vector<osg::ref_ptr<osg::Texture2D>>(), 1.f, 1.f,
+                    compactVertices));
             }
             else
             {
@@ -288,7 +388,11 @@ namespace Terrain
             }
         }
 
-        geometry->setupWaterBoundingBox(-1, chunkSize * mStorage->getCellWorldSize(mWorldspace) / numVerts);
+        if (!geometry->hasCompactVertices())
+            geometry->setupWaterBoundingBox(-1, chunkSize * mStorage->getCellWorldSize(mWorldspace) / numVerts);
+
+        if (compactVertices)
+            geometry->compactVertices(chunkSize * mStorage->getCellWorldSize(mWorldspace));
 
         if (!templateGeometry && compile && mSceneManager->getIncrementalCompileOperation())
         {
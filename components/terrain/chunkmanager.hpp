@@ -1,11 +1,13 @@
 #ifndef OPENMW_COMPONENTS_TERRAIN_CHUNKMANAGER_H
 #define OPENMW_COMPONENTS_TERRAIN_CHUNKMANAGER_H
 
+#include <string>
 #include <tuple>
 
 #include <components/resource/resourcemanager.hpp>
 
 #include "buffercache.hpp"
+#include "compositemapcache.hpp"
 #include "quadtreeworld.hpp"
 
 namespace osg
@@ -84,6 +86,10 @@ namespace Terrain
         void setCompositeMapSize(unsigned int size) { mCompositeMapSize = size; }
         void setCompositeMapLevel(float level) { mCompositeMapLevel = level; }
         void setMaxCompositeGeometrySize(float maxCompGeometrySize) { mMaxCompGeometrySize = maxCompGeometrySize; }
+        void setCompositeMapCache(CompositeMapCache* cache) { mCompositeMapCache = cache; }
+        /// Use CompactVertices for the chunks drawn with shaders and a composite map.
+        /// @note Terrain must not be drawn by programs not aware of them, like the shadow casting one.
+        void setCompactVertices(bool value) { mCompactVertices = value; }
 
         void setNodeMask(unsigned int mask) { mNodeMask = mask; }
         unsigned int getNodeMask() override { return mNodeMask; }
@@ -106,10 +112,17 @@ namespace Terrain
         std::vector<osg::ref_ptr<osg::StateSet>> createPasses(
             float chunkSize, const osg::Vec2f& chunkCenter, bool forCompositeMap);
 
+        /// Set up the rendering of the composite map, unless the composite map cache has an up-to-date copy
+        void prepareCompositeMap(float chunkSize, const osg::Vec2f& chunkCenter, CompositeMap& compositeMap);
+
+        /// Append the layers and blendmaps the composite map is rendered from
+        void appendCompositeMapContents(float chunkSize, const osg::Vec2f& chunkCenter, std::string& contents);
+
         Terrain::Storage* mStorage;
         Resource::SceneManager* mSceneManager;
         TextureManager* mTextureManager;
         CompositeMapRenderer* mCompositeMapRenderer;
+        osg::ref_ptr<CompositeMapCache> mCompositeMapCache;
         BufferCache mBufferCache;
 
         osg::ref_ptr<osg::StateSet> mMultiPassRoot;
@@ -119,6 +132,7 @@ namespace Terrain
         unsigned int mCompositeMapSize;
         float mCompositeMapLevel;
         float mMaxCompGeometrySize;
+        bool mCompactVertices;
     };
 
 }
@@ -0,0 +1,101 @@
+#include "compactvertices.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Terrain
+{
+    namespace
+    {
+        constexpr float minHeightStep = 0.125f;
+        constexpr int heightOffset = 32768;
+        constexpr float maxHeightSteps = 65535;
+        constexpr float normalScale = 32767;
+
+        float signNotZero(float value)
+        {
+            return value < 0 ? -1.f : 1.f;
+        }
+    }
+
+    CompactVertices makeCompactVertices(const osg::Vec3Array& positions, const osg::Vec3Array& normals, float extent)
+    {
+        float minHeight = std::numeric_limits<float>::max();
+        float maxHeight = std::numeric_limits<float>::lowest();
+        for (const osg::Vec3f& position : positions)
+        {
+            minHeight = std::min(minHeight, position.z());
+            maxHeight = std::max(maxHeight, position.z());
+        }
+
+        CompactVertices result;
+        result.mVertices = new osg::Vec4sArray(positions.size());
+        result.mExtent = extent;
+        if (positions.empty())
+            return result;
+
+        result.mHeightStep = minHeightStep;
+        result.mBaseHeight = std::floor(minHeight / result.mHeightStep) * result.mHeightStep;
+        while ((maxHeight - result.mBaseHeight) / result.mHeightStep > maxHeightSteps)
+        {
+            result.mHeightStep *= 2;
+            result.mBaseHeight = std::floor(minHeight / result.mHeightStep) * result.mHeightStep;
+        }
+
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            const float steps = std::round((positions[i].z() - result.mBaseHeight) / result.mHeightStep);
+            const osg::Vec2s normal = encodeOctahedralNormal(normals[i]);
+            (*result.mVertices)[i] = osg::Vec4s(
+                static_cast<short>(std::clamp(steps, 0.f, maxHeightSteps) - heightOffset), normal.x(), normal.y(), 0);
+        }
+
+        return result;
+    }
+
+    float decodeCompactHeight(const CompactVertices& vertices, std::size_t index)
+    {
+        const float steps = static_cast<float>((*vertices.mVertices)[index].x() + heightOffset);
+        return vertices.mBaseHeight + steps * vertices.mHeightStep;
+    }
+
+    osg::ref_ptr<osg::Vec3Array> decodeCompactPositions(const CompactVertices& vertices, const osg::Vec2Array& uvs)
+    {
+        osg::ref_ptr<osg::Vec3Array> result(new osg::Vec3Array(vertices.mVertices->size()));
+        for (std::size_t i = 0; i < result->size(); ++i)
+            (*result)[i] = osg::Vec3f((uvs[i].x() - 0.5f) * vertices.mExtent, (0.5f - uvs[i].y()) * vertices.mExtent,
+                decodeCompactHeight(vertices, i));
+        return result;
+    }
+
+    osg::Vec2s encodeOctahedralNormal(const osg::Vec3f& normal)
+    {
+        const float length = std::abs(normal.x()) + std::abs(normal.y()) + std::abs(normal.z());
+        if (length == 0)
+            return osg::Vec2s(0, 0);
+
+        osg::Vec2f value(normal.x() / length, normal.y() / length);
+        if (normal.z() < 0)
+            value = osg::Vec2f((1 - std::abs(value.y())) * signNotZero(value.x()),
+                (1 - std::abs(value.x())) * signNotZero(value.y()));
+
+        return osg::Vec2s(static_cast<short>(std::round(std::clamp(value.x(), -1.f, 1.f) * normalScale)),
+            static_cast<short>(std::round(std::clamp(value.y(), -1.f, 1.f) * normalScale)));
+    }
+
+    osg::Vec3f decodeOctahedralNormal(const osg::Vec2s& value)
+    {
+        osg::Vec3f result(value.x() / normalScale, value.y() / normalScale, 0);
+        result.z() = 1 - std::abs(result.x()) - std::abs(result.y());
+        if (result.z() < 0)
+        {
+            const float x = result.x();
+            result.x() = (1 - std::abs(result.y())) * signNotZero(x);
+            result.y() = (1 - std::abs(x)) * signNotZero(result.y());
+        }
+        result.normalize();
+        return result;
+    }
+
+}
@@ -0,0 +1,48 @@
+#ifndef OPENMW_COMPONENTS_TERRAIN_COMPACTVERTICES_H
+#define OPENMW_COMPONENTS_TERRAIN_COMPACTVERTICES_H
+
+#include <osg/Array>
+#include <osg/Vec2s>
+#include <osg/Vec3f>
+#include <osg/ref_ptr>
+
+#include <cstddef>
+
+namespace Terrain
+{
+
+    /// Location of the per chunk (base height, height step, chunk extent, 0) vertex attribute read by terrain.vert
+    /// when the compactVertices define is set.
+    constexpr unsigned int compactVertexParamsAttribute = 6;
+
+    /// @brief Positions and normals of a terrain chunk in 8 bytes per vertex instead of 24. The horizontal position is
+    /// rebuilt in the vertex shader from the UV buffer the chunk shares with the other chunks of the same resolution,
+    /// so a vertex only stores its height as a number of steps above the base height and its octahedral normal.
+    struct CompactVertices
+    {
+        /// Height steps offset by -32768, octahedral normal x and y scaled by 32767, padding
+        osg::ref_ptr<osg::Vec4sArray> mVertices;
+        float mBaseHeight = 0;
+        float mHeightStep = 1;
+        /// Width of the chunk in world units
+        float mExtent = 0;
+    };
+
+    /// The step is the smallest power of two, no less than 1/8, covering the height range of the chunk, and the base
+    /// height is a multiple of it. Neighbouring chunks with the same step store the heights of their shared edge
+    /// identically, and the land heights of Morrowind, all multiples of 8, are stored exactly.
+    /// @param positions Vertices laid out like the UV buffer of BufferCache.
+    CompactVertices makeCompactVertices(const osg::Vec3Array& positions, const osg::Vec3Array& normals, float extent);
+
+    float decodeCompactHeight(const CompactVertices& vertices, std::size_t index);
+
+    /// Same positions as terrain.vert, for the users of the geometry on the CPU like intersection visitors.
+    osg::ref_ptr<osg::Vec3Array> decodeCompactPositions(const CompactVertices& vertices, const osg::Vec2Array& uvs);
+
+    osg::Vec2s encodeOctahedralNormal(const osg::Vec3f& normal);
+
+    osg::Vec3f decodeOctahedralNormal(const osg::Vec2s& value);
+
+}
+
+#endif
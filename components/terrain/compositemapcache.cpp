@@ -0,0 +1,144 @@
+#include "compositemapcache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <osg/Image>
+#include <osgDB/Registry>
+
+#include <components/debug/debuglog.hpp>
+#include <components/files/conversion.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+namespace Terrain
+{
+    namespace
+    {
+        constexpr char sMagic[8] = { 'O', 'M', 'W', 'C', 'M', 'A', 'P', '\0' };
+        constexpr std::uint32_t sFormatVersion = 1;
+
+        osgDB::ReaderWriter* getPngReaderWriter()
+        {
+            osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("png");
+            if (!rw)
+                throw std::runtime_error("png plugin not found");
+            return rw;
+        }
+
+        class WriteCompositeMapItem : public SceneUtil::WorkItem
+        {
+        public:
+            WriteCompositeMapItem(std::filesystem::path path, const CompositeMapCache::Hash& contents,
+                osg::ref_ptr<const osg::Image> image)
+                : mPath(std::move(path))
+                , mContents(contents)
+                , mImage(std::move(image))
+            {
+            }
+
+            void doWork() override
+            {
+                try
+                {
+                    write();
+                }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Warning) << "Failed to write cached composite map " << mPath << ": " << e.what();
+                }
+            }
+
+        private:
+            void write()
+            {
+                std::ostringstream payload(std::ios_base::out | std::ios_base::binary);
+                const osgDB::ReaderWriter::WriteResult result = getPngReaderWriter()->writeImage(*mImage, payload);
+                if (!result.success())
+                    throw std::runtime_error(result.message());
+
+                // Write to a temporary file first so a map being read never sees a partially written file
+                std::filesystem::path temporary = mPath;
+                temporary += '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+                {
+                    std::ofstream stream(temporary, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+                    if (!stream)
+                        throw std::runtime_error("failed to open " + Files::pathToUnicodeString(temporary));
+                    stream.write(sMagic, sizeof(sMagic));
+                    stream.write(reinterpret_cast<const char*>(&sFormatVersion), sizeof(sFormatVersion));
+                    stream.write(reinterpret_cast<const char*>(mContents.data()), sizeof(mContents));
+                    const std::string data = std::move(payload).str();
+                    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+                    if (!stream)
+                        throw std::runtime_error("failed to write " + Files::pathToUnicodeString(temporary));
+                }
+                std::filesystem::rename(temporary, mPath);
+            }
+
+            std::filesystem::path mPath;
+            CompositeMapCache::Hash mContents;
+            osg::ref_ptr<const osg::Image> mImage;
+        };
+    }
+
+    CompositeMapCache::CompositeMapCache(SceneUtil::WorkQueue* workQueue, std::filesystem::path path)
+        : mWorkQueue(workQueue)
+        , mPath(std::move(path))
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(mPath, ec);
+        if (ec)
+            Log(Debug::Warning) << "Failed to create composite map cache directory " << mPath << ": " << ec.message();
+    }
+
+    std::filesystem::path CompositeMapCache::getFilePath(const Hash& entry) const
+    {
+        std::ostringstream name;
+        name << std::hex << std::setfill('0') << std::setw(16) << entry[0] << std::setw(16) << entry[1] << ".cmap";
+        return mPath / name.str();
+    }
+
+    osg::ref_ptr<osg::Image> CompositeMapCache::read(const Hash& entry, const Hash& contents) const
+    {
+        const std::filesystem::path path = getFilePath(entry);
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+        if (!stream)
+            return nullptr;
+
+        char magic[sizeof(sMagic)];
+        std::uint32_t version = 0;
+        Hash storedContents{ 0, 0 };
+        stream.read(magic, sizeof(magic));
+        stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+        stream.read(reinterpret_cast<char*>(storedContents.data()), sizeof(storedContents));
+        if (!stream || !std::equal(std::begin(magic), std::end(magic), std::begin(sMagic)) || version != sFormatVersion
+            || storedContents != contents)
+            return nullptr;
+
+        try
+        {
+            osgDB::ReaderWriter::ReadResult result = getPngReaderWriter()->readImage(stream);
+            if (!result.success())
+                throw std::runtime_error(result.message());
+            return result.getImage();
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to read cached composite map " << path << ": " << e.what();
+            stream.close();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return nullptr;
+        }
+    }
+
+    void CompositeMapCache::write(const Hash& entry, const Hash& contents, osg::ref_ptr<const osg::Image> image) const
+    {
+        mWorkQueue->addWorkItem(new WriteCompositeMapItem(getFilePath(entry), contents, std::move(image)));
+    }
+
+}
@@ -0,0 +1,53 @@
+#ifndef OPENMW_COMPONENTS_TERRAIN_COMPOSITEMAPCACHE_H
+#define OPENMW_COMPONENTS_TERRAIN_COMPOSITEMAPCACHE_H
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+
+namespace osg
+{
+    class Image;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
+namespace Terrain
+{
+
+    /// @brief Stores rendered composite maps on disk as compressed images, so that later sessions can load them
+    /// instead of rendering them again.
+    /// @note Each entry has a single file which is overwritten whenever the entry's contents change.
+    class CompositeMapCache : public osg::Referenced
+    {
+    public:
+        using Hash = std::array<std::uint64_t, 2>;
+
+        CompositeMapCache(SceneUtil::WorkQueue* workQueue, std::filesystem::path path);
+
+        /// @param entry Identifies the chunk the map was rendered for.
+        /// @param contents Identifies everything the map was rendered from.
+        /// @return nullptr if there is no up-to-date entry.
+        /// @note Thread safe.
+        osg::ref_ptr<osg::Image> read(const Hash& entry, const Hash& contents) const;
+
+        /// Compress and write the image in the background.
+        /// @note Thread safe.
+        void write(const Hash& entry, const Hash& contents, osg::ref_ptr<const osg::Image> image) const;
+
+    private:
+        std::filesystem::path getFilePath(const Hash& entry) const;
+
+        osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+        std::filesystem::path mPath;
+    };
+
+}
+
+#endif
@@ -1,10 +1,14 @@
 #include "compositemaprenderer.hpp"
 
 #include <osg/FrameBufferObject>
+#include <osg/Image>
 #include <osg/RenderInfo>
 #include <osg/Texture2D>
 
+#include <components/sceneutil/uploadscheduler.hpp>
+
 #include <algorithm>
+#include <chrono>
 
 namespace Terrain
 {
@@ -28,14 +32,27 @@ namespace Terrain
         double dt = mTimer.time_s();
         dt = std::min(dt, 0.2);
         mTimer.setStartTick();
-        double targetFrameTime = 1.0 / static_cast<double>(mTargetFrameRate);
-        double conservativeTimeRatio(0.75);
-        double availableTime = std::max((targetFrameTime - dt) * conservativeTimeRatio, mMinimumTimeAvailable);
+        double availableTime;
+        if (mUploadScheduler != nullptr)
+            availableTime = std::max(
+                mUploadScheduler->getAllocatedTime(SceneUtil::UploadSubsystem::Terrain), mMinimumTimeAvailable);
+        else
+        {
+            double targetFrameTime = 1.0 / static_cast<double>(mTargetFrameRate);
+            double conservativeTimeRatio(0.75);
+            availableTime = std::max((targetFrameTime - dt) * conservativeTimeRatio, mMinimumTimeAvailable);
+        }
 
         std::lock_guard<std::mutex> lock(mMutex);
 
         if (mImmediateCompileSet.empty() && mCompileSet.empty())
+        {
+            if (mUploadScheduler != nullptr)
+                mUploadScheduler->reportUpload(SceneUtil::UploadSubsystem::Terrain, 0, 0, 0);
             return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
 
         while (!mImmediateCompileSet.empty())
         {
@@ -64,6 +81,19 @@ namespace Terrain
                 mCompileSet.insert(node);
             }
         }
+
+        if (mUploadScheduler != nullptr)
+        {
+            // Composite maps are rendered to GL_RGB textures
+            std::size_t queuedBytes = 0;
+            for (const osg::ref_ptr<CompositeMap>& compositeMap : mCompileSet)
+                queuedBytes += static_cast<std::size_t>(compositeMap->mTexture->getTextureWidth())
+                    * compositeMap->mTexture->getTextureHeight() * 3;
+            const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start;
+            mUploadScheduler->reportUpload(
+                SceneUtil::UploadSubsystem::Terrain, spent.count(), mCompileSet.size(), queuedBytes);
+        }
+
         mTimer.setStartTick();
     }
 
@@ -125,8 +155,21 @@ namespace Terrain
             compositeMap.mDrawables[i] = nullptr;
         }
         if (compositeMap.mCompiled == compositeMap.mDrawables.size())
+        {
             compositeMap.mDrawables = std::vector<osg::ref_ptr<osg::Drawable>>();
 
+            if (compositeMap.mCache != nullptr)
+            {
+                // Blocks until the map is rendered, but only once per map until its contents change
+                mFBO->apply(state, osg::FrameBufferObject::READ_FRAMEBUFFER);
+                osg::ref_ptr<osg::Image> image = new osg::Image;
+                image->readPixels(0, 0, compositeMap.mTexture->getTextureWidth(),
+                    compositeMap.mTexture->getTextureHeight(), GL_RGB, GL_UNSIGNED_BYTE);
+                compositeMap.mCache->write(compositeMap.mCacheEntry, compositeMap.mCacheContents, image);
+                compositeMap.mCache = nullptr;
+            }
+        }
+
         state.haveAppliedAttribute(osg::StateAttribute::VIEWPORT);
 
         GLuint fboId = state.getGraphicsContext() ? state.getGraphicsContext()->getDefaultFboId() : 0;
@@ -143,6 +186,11 @@ namespace Terrain
         mTargetFrameRate = framerate;
     }
 
+    void CompositeMapRenderer::setUploadScheduler(SceneUtil::UploadScheduler* scheduler)
+    {
+        mUploadScheduler = scheduler;
+    }
+
     void CompositeMapRenderer::addCompositeMap(CompositeMap* compositeMap, bool immediate)
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -6,6 +6,8 @@
 #include <mutex>
 #include <set>
 
+#include "compositemapcache.hpp"
+
 namespace osg
 {
     class FrameBufferObject;
@@ -13,6 +15,11 @@ namespace osg
     class Texture2D;
 }
 
+namespace SceneUtil
+{
+    class UploadScheduler;
+}
+
 namespace Terrain
 {
 
@@ -24,6 +31,11 @@ namespace Terrain
         std::vector<osg::ref_ptr<osg::Drawable>> mDrawables;
         osg::ref_ptr<osg::Texture2D> mTexture;
         unsigned int mCompiled;
+
+        /// If set, the rendered texture is read back and written to this cache once all drawables are compiled
+        osg::ref_ptr<CompositeMapCache> mCache;
+        CompositeMapCache::Hash mCacheEntry{ 0, 0 };
+        CompositeMapCache::Hash mCacheContents{ 0, 0 };
     };
 
     /**
@@ -46,6 +58,10 @@ namespace Terrain
         /// If current frame rate is higher than this, the extra time will be set aside to do more compiling
         void setTargetFrameRate(float framerate);
 
+        /// Take the time for compiling (non-immediate) composite maps from the terrain's share of the scheduler's
+        /// upload time rather than from the target frame rate, and report the work done and left to it
+        void setUploadScheduler(SceneUtil::UploadScheduler* scheduler);
+
         /// Add a composite map to be rendered
         void addCompositeMap(CompositeMap* map, bool immediate = false);
 
@@ -58,6 +74,7 @@ namespace Terrain
         float mTargetFrameRate;
         double mMinimumTimeAvailable;
         mutable osg::Timer mTimer;
+        osg::ref_ptr<SceneUtil::UploadScheduler> mUploadScheduler;
 
         typedef std::set<osg::ref_ptr<CompositeMap>> CompileSet;
 
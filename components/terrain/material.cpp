@@ -16,6 +16,8 @@
 
 #include <mutex>
 
+#include "compactvertices.hpp"
+
 namespace
 {
     class BlendmapTexMat
@@ -223,11 +225,20 @@ namespace Terrain
 {
     std::vector<osg::ref_ptr<osg::StateSet>> createPasses(bool useShaders, Resource::SceneManager* sceneManager,
         const std::vector<TextureLayer>& layers, const std::vector<osg::ref_ptr<osg::Texture2D>>& blendmaps,
-        int blendmapScale, float layerTileSize)
+        int blendmapScale, float layerTileSize, bool compactVertices)
     {
         auto& shaderManager = sceneManager->getShaderManager();
         std::vector<osg::ref_ptr<osg::StateSet>> passes;
 
+        osg::ref_ptr<osg::Program> programTemplate;
+        if (compactVertices)
+        {
+            programTemplate = shaderManager.getProgramTemplate()
+                ? Shader::ShaderManager::cloneProgram(shaderManager.getProgramTemplate())
+                : osg::ref_ptr<osg::Program>(new osg::Program);
+            programTemplate->addBindAttribLocation("aChunkParams", compactVertexParamsAttribute);
+        }
+
         unsigned int blendmapIndex = 0;
         for (std::vector<TextureLayer>::const_iterator it = layers.begin(); it != layers.end(); ++it)
         {
@@ -303,9 +314,10 @@ namespace Terrain
                 defineMap["parallax"] = parallax ? "1" : "0";
                 defineMap["writeNormals"] = (it == layers.end() - 1) ? "1" : "0";
                 defineMap["reconstructNormalZ"] = reconstructNormalZ ? "1" : "0";
+                defineMap["compactVertices"] = compactVertices ? "1" : "0";
                 Stereo::shaderStereoDefines(defineMap);
 
-                stateset->setAttributeAndModes(shaderManager.getProgram("terrain", defineMap));
+                stateset->setAttributeAndModes(shaderManager.getProgram("terrain", defineMap, programTemplate));
                 stateset->addUniform(UniformCollection::value().mColorMode);
             }
             else
@@ -24,9 +24,10 @@ namespace Terrain
         bool mSpecular;
     };
 
+    /// @param compactVertices The drawable uses CompactVertices, requires useShaders.
     std::vector<osg::ref_ptr<osg::StateSet>> createPasses(bool useShaders, Resource::SceneManager* sceneManager,
         const std::vector<TextureLayer>& layers, const std::vector<osg::ref_ptr<osg::Texture2D>>& blendmaps,
-        int blendmapScale, float layerTileSize);
+        int blendmapScale, float layerTileSize, bool compactVertices);
 
 }
 
@@ -6,6 +6,8 @@
 #include <osgUtil/CullVisitor>
 
 #include <limits>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <components/esm/util.hpp>
 #include <components/loadinglistener/reporter.hpp>
@@ -13,6 +15,7 @@
 #include <components/misc/mathutil.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/sharedcull.hpp>
 
 #include "chunkmanager.hpp"
 #include "compositemaprenderer.hpp"
@@ -291,6 +294,7 @@ namespace Terrain
         , mViewDistance(std::numeric_limits<float>::max())
         , mMinSize(ESM::isEsm4Ext(worldspace) ? 1 / 4.f : 1 / 8.f)
         , mDebugTerrainChunks(debugChunks)
+        , mSharedCullViewer(new osg::DummyObject)
     {
         mChunkManager->setCompositeMapSize(compMapResolution);
         mChunkManager->setCompositeMapLevel(compMapLevel);
@@ -404,6 +408,44 @@ namespace Terrain
         }
     }
 
+    // Flattens the quad tree nodes down to the entries of a view, depth first, so that the subtrees out of the shared
+    // cull are skipped at once
+    void addSharedCullTreeNodes(QuadTreeNode& node, const std::unordered_map<const QuadTreeNode*, std::size_t>& items,
+        const std::unordered_set<const QuadTreeNode*>& ancestors,
+        const std::vector<osg::ref_ptr<osg::Node>>& renderingNodes, std::vector<SceneUtil::SharedCullTreeNode>& tree)
+    {
+        const std::size_t index = tree.size();
+        if (const auto it = items.find(&node); it != items.end())
+        {
+            tree.push_back(SceneUtil::SharedCullTreeNode{
+                .mBound = renderingNodes[it->second]->getBound(),
+                .mEnd = index + 1,
+                .mItem = it->second,
+            });
+            return;
+        }
+
+        if (!ancestors.contains(&node))
+            return;
+
+        tree.emplace_back();
+        for (unsigned int i = 0; i < node.getNumChildren(); ++i)
+            addSharedCullTreeNodes(*node.getChild(i), items, ancestors, renderingNodes, tree);
+
+        SceneUtil::SharedCullTreeNode& inner = tree[index];
+        inner.mEnd = tree.size();
+        // The rendering nodes hold the object paging chunks too, the bounds of the quad tree nodes don't cover them
+        for (std::size_t child = index + 1; child < inner.mEnd; child = tree[child].mEnd)
+        {
+            if (!tree[child].mBound.valid())
+            {
+                inner.mBound.init();
+                break;
+            }
+            inner.mBound.expandBy(tree[child].mBound);
+        }
+    }
+
     void updateWaterCullingView(
         HeightCullCallback* callback, ViewData* vd, osgUtil::CullVisitor* cv, float cellworldsize, bool outofworld)
     {
@@ -469,9 +511,16 @@ namespace Terrain
         if (!isCullVisitor && nv.getVisitorType() != osg::NodeVisitor::INTERSECTION_VISITOR)
             return;
 
-        osg::Object* viewer = isCullVisitor ? static_cast<osgUtil::CullVisitor*>(&nv)->getCurrentCamera() : nullptr;
+        osgUtil::CullVisitor* cv = isCullVisitor ? static_cast<osgUtil::CullVisitor*>(&nv) : nullptr;
+        // The passes of the shared cull have the same view point, they share one view and its selection
+        const bool sharedCull = mSharedCull != nullptr && cv != nullptr && SceneUtil::SharedCull::isPass(*cv);
+        osg::Object* viewer = sharedCull ? mSharedCullViewer.get() : (cv != nullptr ? cv->getCurrentCamera() : nullptr);
         bool needsUpdate = true;
         osg::Vec3f viewPoint = viewer ? nv.getViewPoint() : nv.getEyePoint();
+
+        // Views can be culled on several threads at once (e.g. shadow casters), and may be copied from each other
+        std::unique_lock<std::mutex> lock(mViewDataMutex);
+
         ViewData* vd = mViewDataMap->getViewData(viewer, viewPoint, mActiveGrid, needsUpdate);
         if (needsUpdate)
         {
@@ -484,16 +533,32 @@ namespace Terrain
         const float cellWorldSize = ESM::getCellSize(mWorldspace);
 
         for (unsigned int i = 0; i < vd->getNumEntries(); ++i)
+            loadRenderingNode(vd->getEntry(i), vd, cellWorldSize, mActiveGrid, false);
+
+        std::shared_ptr<const std::vector<osg::ref_ptr<osg::Node>>> sharedCullNodes;
+        if (sharedCull)
+            sharedCullNodes = selectSharedCullNodes(*vd, nv.getTraversalNumber());
+
+        lock.unlock();
+
+        if (sharedCullNodes != nullptr)
         {
-            ViewDataEntry& entry = vd->getEntry(i);
-            loadRenderingNode(entry, vd, cellWorldSize, mActiveGrid, false);
-            entry.mRenderingNode->accept(nv);
+            // The cull visitor of each pass refines the selection of all of them
+            for (const osg::ref_ptr<osg::Node>& renderingNode : *sharedCullNodes)
+                renderingNode->accept(nv);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < vd->getNumEntries(); ++i)
+                vd->getEntry(i).mRenderingNode->accept(nv);
         }
 
         if (mHeightCullCallback && isCullVisitor)
             updateWaterCullingView(mHeightCullCallback, vd, static_cast<osgUtil::CullVisitor*>(&nv),
                 mStorage->getCellWorldSize(mWorldspace), !isGridEmpty());
 
+        lock.lock();
+
         vd->resetChanged();
 
         double referenceTime = nv.getFrameStamp() ? nv.getFrameStamp()->getReferenceTime() : 0.0;
@@ -504,6 +569,52 @@ namespace Terrain
         }
     }
 
+    std::shared_ptr<const std::vector<osg::ref_ptr<osg::Node>>> QuadTreeWorld::selectSharedCullNodes(
+        ViewData& vd, unsigned int frameNumber)
+    {
+        // Views may be copied from each other along with their changed flag, compare the rendering nodes instead
+        bool changed = vd.getNumEntries() != mSharedCullItems.size();
+        for (unsigned int i = 0; i < vd.getNumEntries() && !changed; ++i)
+            changed = vd.getEntry(i).mRenderingNode != mSharedCullItems[i];
+
+        if (changed)
+        {
+            mSharedCullItems.clear();
+            std::unordered_map<const QuadTreeNode*, std::size_t> items;
+            std::unordered_set<const QuadTreeNode*> ancestors;
+            for (unsigned int i = 0; i < vd.getNumEntries(); ++i)
+            {
+                const ViewDataEntry& entry = vd.getEntry(i);
+                mSharedCullItems.push_back(entry.mRenderingNode);
+                items.emplace(entry.mNode, i);
+                QuadTreeNode* parent = entry.mNode->getParent();
+                while (parent != nullptr && ancestors.insert(parent).second)
+                    parent = parent->getParent();
+            }
+
+            mSharedCullTree.clear();
+            addSharedCullTreeNodes(*mRootNode, items, ancestors, mSharedCullItems, mSharedCullTree);
+            mHasSharedCullFrame = false;
+        }
+
+        if (!mHasSharedCullFrame || frameNumber != mSharedCullFrame)
+        {
+            mHasSharedCullFrame = true;
+            mSharedCullFrame = frameNumber;
+
+            std::vector<std::size_t> items;
+            mSharedCull->select(frameNumber, mSharedCullTree, items);
+
+            auto nodes = std::make_shared<std::vector<osg::ref_ptr<osg::Node>>>();
+            nodes->reserve(items.size());
+            for (const std::size_t item : items)
+                nodes->push_back(mSharedCullItems[item]);
+            mSharedCullNodes = std::move(nodes);
+        }
+
+        return mSharedCullNodes;
+    }
+
     void QuadTreeWorld::ensureQuadTreeBuilt()
     {
         std::lock_guard<std::mutex> lock(mQuadTreeMutex);
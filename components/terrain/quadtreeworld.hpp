@@ -6,8 +6,10 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <components/esm/refid.hpp>
+#include <components/sceneutil/sharedcull.hpp>
 
 namespace osg
 {
@@ -91,6 +93,8 @@ namespace Terrain
         void ensureQuadTreeBuilt();
         void loadRenderingNode(
             ViewDataEntry& entry, ViewData* vd, float cellWorldSize, const osg::Vec4i& gridbounds, bool compile);
+        std::shared_ptr<const std::vector<osg::ref_ptr<osg::Node>>> selectSharedCullNodes(
+            ViewData& vd, unsigned int frameNumber);
 
         osg::ref_ptr<RootNode> mRootNode;
 
@@ -99,6 +103,7 @@ namespace Terrain
         std::vector<ChunkManager*> mChunkManagers;
 
         std::mutex mQuadTreeMutex;
+        std::mutex mViewDataMutex;
         bool mQuadTreeBuilt;
         float mLodFactor;
         int mVertexLodMod;
@@ -106,6 +111,16 @@ namespace Terrain
         float mMinSize;
         bool mDebugTerrainChunks;
         std::unique_ptr<DebugChunkManager> mDebugChunkManager;
+
+        // Key of the view shared by the passes of the shared cull
+        osg::ref_ptr<osg::Object> mSharedCullViewer;
+        // Rendering nodes of the entries of the shared view, the items of the tree
+        std::vector<osg::ref_ptr<osg::Node>> mSharedCullItems;
+        std::vector<SceneUtil::SharedCullTreeNode> mSharedCullTree;
+        bool mHasSharedCullFrame = false;
+        unsigned int mSharedCullFrame = 0;
+        // Selected for the last frame, kept by the passes still traversing them
+        std::shared_ptr<const std::vector<osg::ref_ptr<osg::Node>>> mSharedCullNodes;
     };
 
 }
@@ -9,6 +9,18 @@
 
 namespace Terrain
 {
+    namespace
+    {
+        template <class Functor>
+        void acceptDecoded(const CompactVertices& vertices, const osg::Geometry& geometry, Functor& functor)
+        {
+            const osg::ref_ptr<osg::Vec3Array> positions
+                = decodeCompactPositions(vertices, *static_cast<const osg::Vec2Array*>(geometry.getTexCoordArray(0)));
+            functor.setVertexArray(positions->getNumElements(), &positions->front());
+            for (const osg::ref_ptr<osg::PrimitiveSet>& primitiveSet : geometry.getPrimitiveSetList())
+                primitiveSet->accept(functor);
+        }
+    }
 
     TerrainDrawable::TerrainDrawable() {}
 
@@ -16,9 +28,13 @@ namespace Terrain
 
     TerrainDrawable::TerrainDrawable(const TerrainDrawable& copy, const osg::CopyOp& copyop)
         : osg::Geometry(copy, copyop)
+        , mCompactVertices(copy.mCompactVertices)
+        , mCompactBoundingBox(copy.mCompactBoundingBox)
         , mPasses(copy.mPasses)
         , mLightListCallback(copy.mLightListCallback)
     {
+        if (hasCompactVertices())
+            mCompactVertices.mVertices = static_cast<osg::Vec4sArray*>(getVertexArray());
     }
 
     void TerrainDrawable::accept(osg::NodeVisitor& nv)
@@ -151,6 +167,61 @@ namespace Terrain
         }
     }
 
+    void TerrainDrawable::compactVertices(float chunkExtent)
+    {
+        const osg::BoundingBox bound = getBoundingBox();
+        mCompactVertices = makeCompactVertices(*static_cast<const osg::Vec3Array*>(getVertexArray()),
+            *static_cast<const osg::Vec3Array*>(getNormalArray()), chunkExtent);
+        mCompactVertices.mVertices->setVertexBufferObject(getVertexArray()->getVertexBufferObject());
+
+        osg::ref_ptr<osg::Vec4Array> params(new osg::Vec4Array(osg::Array::BIND_OVERALL));
+        params->push_back(
+            osg::Vec4f(mCompactVertices.mBaseHeight, mCompactVertices.mHeightStep, mCompactVertices.mExtent, 0));
+
+        setVertexArray(mCompactVertices.mVertices);
+        setNormalArray(nullptr);
+        setVertexAttribArray(compactVertexParamsAttribute, params, osg::Array::BIND_OVERALL);
+        mCompactBoundingBox = bound;
+        dirtyBound();
+    }
+
+    void TerrainDrawable::shareCompactVertexData(const TerrainDrawable& source)
+    {
+        mCompactVertices = source.mCompactVertices;
+        mCompactVertices.mVertices = static_cast<osg::Vec4sArray*>(getVertexArray());
+        setVertexAttribArray(compactVertexParamsAttribute,
+            static_cast<osg::Array*>(
+                source.getVertexAttribArray(compactVertexParamsAttribute)->clone(osg::CopyOp::SHALLOW_COPY)),
+            osg::Array::BIND_OVERALL);
+        mCompactBoundingBox = source.mCompactBoundingBox;
+        mWaterBoundingBox = source.mWaterBoundingBox;
+        mClusterCullingCallback = source.mClusterCullingCallback;
+        dirtyBound();
+    }
+
+    osg::BoundingBox TerrainDrawable::computeBoundingBox() const
+    {
+        if (hasCompactVertices())
+            return mCompactBoundingBox;
+        return osg::Geometry::computeBoundingBox();
+    }
+
+    void TerrainDrawable::accept(osg::PrimitiveFunctor& functor) const
+    {
+        if (hasCompactVertices())
+            acceptDecoded(mCompactVertices, *this, functor);
+        else
+            osg::Geometry::accept(functor);
+    }
+
+    void TerrainDrawable::accept(osg::PrimitiveIndexFunctor& functor) const
+    {
+        if (hasCompactVertices())
+            acceptDecoded(mCompactVertices, *this, functor);
+        else
+            osg::Geometry::accept(functor);
+    }
+
     void TerrainDrawable::compileGLObjects(osg::RenderInfo& renderInfo) const
     {
         for (PassVector::const_iterator it = mPasses.begin(); it != mPasses.end(); ++it)
@@ -3,6 +3,8 @@
 
 #include <osg/Geometry>
 
+#include "compactvertices.hpp"
+
 namespace osg
 {
     class ClusterCullingCallback;
@@ -59,12 +61,31 @@ namespace Terrain
         void setupWaterBoundingBox(float waterheight, float margin);
         const osg::BoundingBox& getWaterBoundingBox() const { return mWaterBoundingBox; }
 
+        /// Replace the positions and normals by CompactVertices, the passes must use the compactVertices define.
+        /// @note Call after the cluster culling callback and water bounding box were set up, they need the positions.
+        void compactVertices(float chunkExtent);
+
+        /// Take the bounds, culling data and chunk parameters of a template with compact vertices, the vertex and color
+        /// arrays have to be copied by the caller.
+        void shareCompactVertexData(const TerrainDrawable& source);
+
+        bool hasCompactVertices() const { return mCompactVertices.mVertices != nullptr; }
+
+        osg::BoundingBox computeBoundingBox() const override;
+
+        /// Decode compact vertices for the intersection visitors and other CPU side users.
+        void accept(osg::PrimitiveFunctor& functor) const override;
+        void accept(osg::PrimitiveIndexFunctor& functor) const override;
+
         void setCompositeMap(CompositeMap* map) { mCompositeMap = map; }
         CompositeMap* getCompositeMap() const { return mCompositeMap; }
         void setCompositeMapRenderer(CompositeMapRenderer* renderer) { mCompositeMapRenderer = renderer; }
 
     private:
         osg::BoundingBox mWaterBoundingBox;
+        CompactVertices mCompactVertices;
+        // Bounds of the decoded vertices, the compact vertex array can not be used to compute them
+        osg::BoundingBox mCompactBoundingBox;
         PassVector mPasses;
 
         osg::ref_ptr<osg::ClusterCullingCallback> mClusterCullingCallback;
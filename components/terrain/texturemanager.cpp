@@ -35,7 +35,7 @@ namespace Terrain
         mCache->call(f);
     }
 
-    osg::ref_ptr<osg::Texture2D> TextureManager::getTexture(const std::string& name)
+    osg::ref_ptr<osg::Texture2D> TextureManager::getTexture(const std::string& name, Resource::ImageUsage usage)
     {
         // don't bother with case folding, since there is only one way of referring to terrain textures we can assume
         // the case is always the same
@@ -44,7 +44,8 @@ namespace Terrain
             return static_cast<osg::Texture2D*>(obj.get());
         else
         {
-            osg::ref_ptr<osg::Texture2D> texture(new osg::Texture2D(mSceneManager->getImageManager()->getImage(name)));
+            osg::ref_ptr<osg::Texture2D> texture(
+                new osg::Texture2D(mSceneManager->getImageManager()->getImage(name, false, usage)));
             texture->setWrap(osg::Texture::WRAP_S, osg::Texture::REPEAT);
             texture->setWrap(osg::Texture::WRAP_T, osg::Texture::REPEAT);
             mSceneManager->applyFilterSettings(texture);
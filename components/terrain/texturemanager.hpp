@@ -3,6 +3,7 @@
 
 #include <string>
 
+#include <components/resource/imageusage.hpp>
 #include <components/resource/resourcemanager.hpp>
 
 namespace Resource
@@ -25,7 +26,8 @@ namespace Terrain
 
         void updateTextureFiltering();
 
-        osg::ref_ptr<osg::Texture2D> getTexture(const std::string& name);
+        osg::ref_ptr<osg::Texture2D> getTexture(
+            const std::string& name, Resource::ImageUsage usage = Resource::ImageUsage::SceneColor);
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
 
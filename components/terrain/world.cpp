@@ -5,6 +5,7 @@
 
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/sharedcull.hpp>
 #include <components/settings/values.hpp>
 
 #include "chunkmanager.hpp"
@@ -126,6 +127,29 @@ namespace Terrain
         mCompositeMapRenderer->setTargetFrameRate(rate);
     }
 
+    void World::setSharedCull(SceneUtil::SharedCull* sharedCull)
+    {
+        mSharedCull = sharedCull;
+    }
+
+    void World::setUploadScheduler(SceneUtil::UploadScheduler* scheduler)
+    {
+        if (mCompositeMapRenderer)
+            mCompositeMapRenderer->setUploadScheduler(scheduler);
+    }
+
+    void World::setCompositeMapCache(CompositeMapCache* cache)
+    {
+        if (mChunkManager)
+            mChunkManager->setCompositeMapCache(cache);
+    }
+
+    void World::setCompactVertices(bool value)
+    {
+        if (mChunkManager)
+            mChunkManager->setCompactVertices(value);
+    }
+
     float World::getHeightAt(const osg::Vec3f& worldPos)
     {
         return mStorage->getHeightAt(worldPos, mWorldspace);
@@ -28,12 +28,19 @@ namespace Loading
     class Reporter;
 }
 
+namespace SceneUtil
+{
+    class SharedCull;
+    class UploadScheduler;
+}
+
 namespace Terrain
 {
     class Storage;
 
     class TextureManager;
     class ChunkManager;
+    class CompositeMapCache;
     class CompositeMapRenderer;
     class View;
     class HeightCullCallback;
@@ -58,6 +65,19 @@ namespace Terrain
         /// See CompositeMapRenderer::setTargetFrameRate
         void setTargetFrameRate(float rate);
 
+        /// See CompositeMapRenderer::setUploadScheduler
+        void setUploadScheduler(SceneUtil::UploadScheduler* scheduler);
+
+        /// Select the terrain and object paging chunks once per frame for all the passes of the shared cull, only
+        /// used by the quad tree world
+        void setSharedCull(SceneUtil::SharedCull* sharedCull);
+
+        /// Load composite maps from the cache when possible and add the ones rendered to it
+        void setCompositeMapCache(CompositeMapCache* cache);
+
+        /// See ChunkManager::setCompactVertices
+        void setCompactVertices(bool value);
+
         /// Apply the scene manager's texture filtering settings to all cached textures.
         /// @note Thread safe.
         void updateTextureFiltering();
@@ -133,6 +153,8 @@ namespace Terrain
 
         osg::Vec4i mActiveGrid;
         ESM::RefId mWorldspace;
+
+        osg::ref_ptr<SceneUtil::SharedCull> mSharedCull;
     };
 }
 
@@ -72,6 +72,14 @@ varying vec4 passTangent;
 #include "lib/light/lighting.glsl"
 #include "lib/view/depth.glsl"
 
+#if @instancing
+#include "lib/util/instancing.glsl"
+#endif
+
+#if @skinning
+#include "lib/util/skinning.glsl"
+#endif
+
 #if @particleOcclusion
 varying vec3 orthoDepthMapCoord;
 
@@ -81,22 +89,42 @@ uniform mat4 osg_ViewMatrixInverse;
 
 void main(void)
 {
+#if @instancing
+    vec4 vertex = instanceToModel(gl_Vertex);
+#elif @skinning
+    vec4 vertex = skinnedToModel(gl_Vertex);
+#else
+    vec4 vertex = gl_Vertex;
+#endif
+
 #if @particleOcclusion
     mat4 model = osg_ViewMatrixInverse * gl_ModelViewMatrix;
-    orthoDepthMapCoord = ((depthSpaceMatrix * model) * vec4(gl_Vertex.xyz, 1.0)).xyz;
+    orthoDepthMapCoord = ((depthSpaceMatrix * model) * vec4(vertex.xyz, 1.0)).xyz;
 #endif
 
-    gl_Position = modelToClip(gl_Vertex);
+    gl_Position = modelToClip(vertex);
 
-    vec4 viewPos = modelToView(gl_Vertex);
+    vec4 viewPos = modelToView(vertex);
     gl_ClipVertex = viewPos;
     passColor = gl_Color;
     passViewPos = viewPos.xyz;
+#if @instancing
+    passNormal = instanceNormalToModel(gl_Normal.xyz);
+#elif @skinning
+    passNormal = skinnedNormalToModel(gl_Normal.xyz);
+#else
     passNormal = gl_Normal.xyz;
+#endif
     normalToViewMatrix = gl_NormalMatrix;
 
 #if @normalMap || @diffuseParallax
+#if @instancing
+    passTangent = vec4(instanceNormalToModel(gl_MultiTexCoord7.xyz), gl_MultiTexCoord7.w);
+#elif @skinning
+    passTangent = vec4(skinnedNormalToModel(gl_MultiTexCoord7.xyz), gl_MultiTexCoord7.w);
+#else
     passTangent = gl_MultiTexCoord7.xyzw;
+#endif
     normalToViewMatrix *= generateTangentSpace(passTangent, passNormal);
 #endif
 
@@ -8,12 +8,18 @@ uniform int colorMode;
 uniform bool useTreeAnim;
 uniform bool useDiffuseMapForShadowAlpha = true;
 uniform bool alphaTestShadows = true;
+uniform bool useInstancing = false;
+
+#include "lib/util/instancing.glsl"
+#include "lib/util/skinning.glsl"
 
 void main(void)
 {
-    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+    vec4 vertex = useInstancing ? instanceToModel(gl_Vertex) : skinnedToModel(gl_Vertex);
+
+    gl_Position = gl_ModelViewProjectionMatrix * vertex;
 
-    vec4 viewPos = (gl_ModelViewMatrix * gl_Vertex);
+    vec4 viewPos = (gl_ModelViewMatrix * vertex);
     gl_ClipVertex = viewPos;
 
     if (useDiffuseMapForShadowAlpha)
@@ -31,17 +31,40 @@ varying vec3 passNormal;
 #include "lib/light/lighting.glsl"
 #include "lib/view/depth.glsl"
 
+#if @compactVertices
+// Base height, height step and extent of the chunk, see components/terrain/compactvertices.hpp
+attribute vec4 aChunkParams;
+
+vec3 decodeOctahedralNormal(vec2 value)
+{
+    vec3 normal = vec3(value, 1.0 - abs(value.x) - abs(value.y));
+    if (normal.z < 0.0)
+        normal.xy = (1.0 - abs(normal.yx)) * (step(0.0, normal.xy) * 2.0 - 1.0);
+    return normalize(normal);
+}
+#endif
+
 void main(void)
 {
-    gl_Position = modelToClip(gl_Vertex);
+#if @compactVertices
+    // Horizontal positions come from the grid shared by all chunks of the same resolution
+    vec4 vertex = vec4((gl_MultiTexCoord0.x - 0.5) * aChunkParams.z, (0.5 - gl_MultiTexCoord0.y) * aChunkParams.z,
+        aChunkParams.x + (gl_Vertex.x + 32768.0) * aChunkParams.y, 1.0);
+    vec3 normal = decodeOctahedralNormal(gl_Vertex.yz / 32767.0);
+#else
+    vec4 vertex = gl_Vertex;
+    vec3 normal = gl_Normal.xyz;
+#endif
+
+    gl_Position = modelToClip(vertex);
 
-    vec4 viewPos = modelToView(gl_Vertex);
+    vec4 viewPos = modelToView(vertex);
     gl_ClipVertex = viewPos;
     euclideanDepth = length(viewPos.xyz);
     linearDepth = getLinearDepth(gl_Position.z, viewPos.z);
 
     passColor = gl_Color;
-    passNormal = gl_Normal.xyz;
+    passNormal = normal;
     passViewPos = viewPos.xyz;
     normalToViewMatrix = gl_NormalMatrix;
 
@@ -55,10 +55,19 @@ void doLighting(vec3 viewPos, vec3 viewNormal, float shininess, out vec3 diffuse
     specularLight = vec3(0.0);
 #endif
 
+#if @lightingMethodClustered
+    int cluster = lcalcCluster(viewPos);
+    int clusterLightCount = lcalcClusterLightCount(cluster);
+#endif
+
     for (int i = @startLight; i < @endLight; ++i)
     {
 #if @lightingMethodUBO
         int lightIndex = PointLightIndex[i];
+#elif @lightingMethodClustered
+        int lightIndex = lcalcClusterLightIndex(cluster, i);
+        if (any(equal(ivec4(lightIndex), ClusterIgnoredLights)))
+            continue;
 #else
         int lightIndex = i;
 #endif
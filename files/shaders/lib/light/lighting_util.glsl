@@ -3,7 +3,7 @@
 
 #include "lib/util/quickstep.glsl"
 
-#if @lightingMethodUBO
+#if @lightingMethodUBO || @lightingMethodClustered
 
 const int mask = int(0xff);
 const ivec4 shift = ivec4(int(0), int(8), int(16), int(24));
@@ -35,8 +35,10 @@ struct LightData
     vec4 attenuation;
 };
 
+#if @lightingMethodUBO
 uniform int PointLightIndex[@maxLights];
 uniform int PointLightCount;
+#endif
 
 // Defaults to shared layout. If we ever move to GLSL 140, std140 layout should be considered
 uniform LightBufferBinding
@@ -44,6 +46,40 @@ uniform LightBufferBinding
     LightData LightBuffer[@maxLightsInScene];
 };
 
+#if @lightingMethodClustered
+/* Clusters tile the screen and slice the view depth exponentially.
+Row N of ClusterLightGrid holds the light count of cluster N followed by the LightBuffer indices of its lights.
+Point light positions are in world space, the sun position is in view space.
+*/
+uniform sampler2D ClusterLightGrid;
+uniform mat4 ClusterViewMatrix;
+uniform mat4 ClusterProjectionMatrix;
+// near depth, slice scale
+uniform vec2 ClusterDepthParams;
+// LightBuffer indices of the lights not lighting the current object, 0 for none
+uniform ivec4 ClusterIgnoredLights;
+
+int lcalcCluster(vec3 viewPos)
+{
+    vec4 clipPos = ClusterProjectionMatrix * vec4(viewPos, 1.0);
+    vec2 tiles = vec2(float(@clusterTilesX), float(@clusterTilesY));
+    vec2 tile = clamp(floor((clipPos.xy / clipPos.w * 0.5 + 0.5) * tiles), vec2(0.0), tiles - 1.0);
+    float depth = max(-viewPos.z, ClusterDepthParams.x);
+    float slice = clamp(floor(log(depth / ClusterDepthParams.x) * ClusterDepthParams.y), 0.0, float(@clusterSlices - 1));
+    return int((slice * tiles.y + tile.y) * tiles.x + tile.x);
+}
+
+int lcalcClusterLightCount(int cluster)
+{
+    return int(texelFetch2D(ClusterLightGrid, ivec2(0, cluster), 0).r);
+}
+
+int lcalcClusterLightIndex(int cluster, int i)
+{
+    return int(texelFetch2D(ClusterLightGrid, ivec2(i + 1, cluster), 0).r);
+}
+#endif
+
 #elif @lightingMethodPerObjectUniform
 
 /* Layout:
@@ -63,7 +99,7 @@ float lcalcConstantAttenuation(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][0].w;
-#elif @lightingMethodUBO
+#elif @lightingMethodUBO || @lightingMethodClustered
     return @getLight[lightIndex].attenuation.x;
 #else
     return @getLight[lightIndex].constantAttenuation;
@@ -74,7 +110,7 @@ float lcalcLinearAttenuation(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][1].w;
-#elif @lightingMethodUBO
+#elif @lightingMethodUBO || @lightingMethodClustered
     return @getLight[lightIndex].attenuation.y;
 #else
     return @getLight[lightIndex].linearAttenuation;
@@ -85,7 +121,7 @@ float lcalcQuadraticAttenuation(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][2].w;
-#elif @lightingMethodUBO
+#elif @lightingMethodUBO || @lightingMethodClustered
     return @getLight[lightIndex].attenuation.z;
 #else
     return @getLight[lightIndex].quadraticAttenuation;
@@ -106,7 +142,7 @@ float lcalcRadius(int lightIndex)
 float lcalcIllumination(int lightIndex, float dist)
 {
     float illumination = 1.0 / (lcalcConstantAttenuation(lightIndex) + lcalcLinearAttenuation(lightIndex) * dist + lcalcQuadraticAttenuation(lightIndex) * dist * dist);
-#if @lightingMethodPerObjectUniform || @lightingMethodUBO
+#if @lightingMethodPerObjectUniform || @lightingMethodUBO || @lightingMethodClustered
     // Fade illumination between the radius and the radius doubled to diminish pop-in
     illumination *= 1.0 - quickstep((dist / lcalcRadius(lightIndex)) - 1.0);
 #endif
@@ -117,6 +153,10 @@ vec3 lcalcPosition(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][0].xyz;
+#elif @lightingMethodClustered
+    if (lightIndex == 0)
+        return @getLight[lightIndex].position.xyz;
+    return (ClusterViewMatrix * vec4(@getLight[lightIndex].position.xyz, 1.0)).xyz;
 #else
     return @getLight[lightIndex].position.xyz;
 #endif
@@ -126,7 +166,7 @@ vec3 lcalcDiffuse(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][2].xyz;
-#elif @lightingMethodUBO
+#elif @lightingMethodUBO || @lightingMethodClustered
     return unpackRGB(@getLight[lightIndex].packedColors.x) * float(@getLight[lightIndex].packedColors.w);
 #else
     return @getLight[lightIndex].diffuse.xyz;
@@ -137,7 +177,7 @@ vec3 lcalcAmbient(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][1].xyz;
-#elif @lightingMethodUBO
+#elif @lightingMethodUBO || @lightingMethodClustered
     return unpackRGB(@getLight[lightIndex].packedColors.y);
 #else
     return @getLight[lightIndex].ambient.xyz;
@@ -148,7 +188,7 @@ vec4 lcalcSpecular(int lightIndex)
 {
 #if @lightingMethodPerObjectUniform
     return @getLight[lightIndex][3];
-#elif @lightingMethodUBO
+#elif @lightingMethodUBO || @lightingMethodClustered
     return unpackRGBA(@getLight[lightIndex].packedColors.z);
 #else
     return @getLight[lightIndex].specular;
@@ -0,0 +1,33 @@
+#ifndef LIB_UTIL_INSTANCING
+#define LIB_UTIL_INSTANCING
+
+// Per-instance attributes, bound to locations 6 and 7 with a vertex attrib divisor of 1
+attribute vec4 aOffset; // xyz: position relative to the chunk, w: scale
+attribute vec3 aRotation; // ESM euler angles
+
+mat3 instanceRotation(in vec3 angle)
+{
+    float sin_x = sin(angle.x);
+    float cos_x = cos(angle.x);
+    float sin_y = sin(angle.y);
+    float cos_y = cos(angle.y);
+    float sin_z = sin(angle.z);
+    float cos_z = cos(angle.z);
+
+    return mat3(
+        cos_z*cos_y+sin_x*sin_y*sin_z, -sin_z*cos_x, cos_z*sin_y+sin_z*sin_x*cos_y,
+        sin_z*cos_y+cos_z*sin_x*sin_y, cos_z*cos_x, sin_z*sin_y-cos_z*sin_x*cos_y,
+        -sin_y*cos_x, sin_x, cos_x*cos_y);
+}
+
+vec4 instanceToModel(in vec4 vertex)
+{
+    return vec4(instanceRotation(aRotation) * (vertex.xyz * aOffset.w) + aOffset.xyz, 1.0);
+}
+
+vec3 instanceNormalToModel(in vec3 normal)
+{
+    return instanceRotation(aRotation) * normal;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LIB_UTIL_SKINNING
+#define LIB_UTIL_SKINNING
+
+// Must match SceneUtil::maxGpuSkinningBones
+#define MAX_SKINNING_BONES 64
+
+// Bound to locations 4 and 5, unused influences have a weight of 0
+attribute vec4 aBoneIndices;
+attribute vec4 aBoneWeights;
+
+// First three columns of the matrix of every bone, mapping the bind pose to the skinned pose
+uniform vec4 boneMatrices[MAX_SKINNING_BONES * 3];
+// Only set by the geometries of a RigGeometry that are skinned on the GPU
+uniform bool useSkinning;
+
+mat4 skinningMatrix()
+{
+    ivec4 bones = ivec4(aBoneIndices) * 3;
+    mat4 result = mat4(0.0);
+    for (int column = 0; column < 3; ++column)
+    {
+        result[column] = boneMatrices[bones.x + column] * aBoneWeights.x
+            + boneMatrices[bones.y + column] * aBoneWeights.y
+            + boneMatrices[bones.z + column] * aBoneWeights.z
+            + boneMatrices[bones.w + column] * aBoneWeights.w;
+    }
+    result[3] = vec4(0.0, 0.0, 0.0, 1.0);
+    return result;
+}
+
+vec4 skinnedToModel(in vec4 vertex)
+{
+    if (!useSkinning)
+        return vertex;
+    return vec4(vertex.xyz, 1.0) * skinningMatrix();
+}
+
+vec3 skinnedNormalToModel(in vec3 normal)
+{
+    if (!useSkinning)
+        return normal;
+    return (vec4(normal, 0.0) * skinningMatrix()).xyz;
+}
+
+#endif